@@ -0,0 +1,15 @@
+## @author Ralf Quast
+## @date 2021
+## @copyright MIT License
+
+macro(mpi_optional)
+    option(ESPECIA_MPI "Distribute the evaluation of the objective function across MPI processes" OFF)
+    if (ESPECIA_MPI)
+        find_package(MPI REQUIRED)
+        if (MPI_CXX_FOUND)
+            add_definitions(-DESPECIA_WITH_MPI)
+            include_directories(${MPI_CXX_INCLUDE_PATH})
+            link_libraries(${MPI_CXX_LIBRARIES})
+        endif ()
+    endif ()
+endmacro()
@@ -0,0 +1,16 @@
+## @author Ralf Quast
+## @date 2021
+## @copyright MIT License
+
+macro(offload_optional)
+    option(ESPECIA_OFFLOAD "Offload the evaluation of optical depth profiles to an accelerator by means of OpenMP" OFF)
+    set(ESPECIA_OFFLOAD_FLAGS "" CACHE STRING "The compiler flags to select the offload target (e.g. -foffload=nvptx-none)")
+    if (ESPECIA_OFFLOAD)
+        if (NOT OPENMP_FOUND)
+            message(FATAL_ERROR "Offloading requires OpenMP")
+        endif ()
+        add_definitions(-DESPECIA_WITH_OFFLOAD)
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${ESPECIA_OFFLOAD_FLAGS}")
+        set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${ESPECIA_OFFLOAD_FLAGS}")
+    endif ()
+endmacro()
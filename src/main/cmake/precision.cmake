@@ -0,0 +1,10 @@
+## @author Ralf Quast
+## @date 2021
+## @copyright MIT License
+
+macro(float_pixels_optional)
+    option(ESPECIA_FLOAT_PIXELS "Model optical depth, absorption and line spread convolution in single precision" OFF)
+    if (ESPECIA_FLOAT_PIXELS)
+        add_definitions(-DESPECIA_WITH_FLOAT_PIXELS)
+    endif ()
+endmacro()
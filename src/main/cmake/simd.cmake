@@ -0,0 +1,13 @@
+## @author Ralf Quast
+## @date 2021
+## @copyright MIT License
+
+macro(simd_optional)
+    option(ESPECIA_SIMD "Vectorize the batch evaluation of optical depth profiles by means of OpenMP SIMD" OFF)
+    set(ESPECIA_SIMD_FLAGS "" CACHE STRING "The compiler flags to select the vector instruction set (e.g. -mavx2)")
+    if (ESPECIA_SIMD)
+        add_definitions(-DESPECIA_WITH_SIMD)
+        # Floating-point exceptions are not trapped, so conditional expressions can be vectorized
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fopenmp-simd -fno-trapping-math ${ESPECIA_SIMD_FLAGS}")
+    endif ()
+endmacro()
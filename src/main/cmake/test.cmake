@@ -28,4 +28,29 @@ endfunction()
 
 add_custom_target(unittests ctest --output-on-failure --label-regex unit)
 
+set(BENCHMARK_BASELINES ${CMAKE_BINARY_DIR}/baselines CACHE PATH "The directory of the benchmark baseline files")
+set(BENCHMARK_TOLERANCE 1.25 CACHE STRING "The maximum ratio of benchmark time to baseline time")
+file(MAKE_DIRECTORY ${BENCHMARK_BASELINES})
+
+add_custom_target(benchmarks)
+add_custom_target(benchmark_baselines)
+
+function(add_benchmark NAME)
+    add_executable(${NAME} EXCLUDE_FROM_ALL
+            ${ARGN}
+            ${TEST}/cxx/benchmark.h)
+    add_custom_target(run_${NAME}
+            COMMAND ${NAME} --baseline=${BENCHMARK_BASELINES}/${NAME}.txt --tolerance=${BENCHMARK_TOLERANCE}
+            DEPENDS ${NAME}
+            WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+            USES_TERMINAL)
+    add_custom_target(record_${NAME}
+            COMMAND ${NAME} --record=${BENCHMARK_BASELINES}/${NAME}.txt
+            DEPENDS ${NAME}
+            WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+            USES_TERMINAL)
+    add_dependencies(benchmarks run_${NAME})
+    add_dependencies(benchmark_baselines record_${NAME})
+endfunction()
+
 enable_testing()
@@ -0,0 +1,74 @@
+/// @file ebin.cxx
+/// Utility to convert spectroscopic data into the binary spectrum format
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <fstream>
+#include <stdexcept>
+
+#include "../core/exitcodes.h"
+#include "../core/spectrum.h"
+
+using namespace std;
+
+/// Writes the usage message to an output stream.
+///
+/// @param os The output stream.
+/// @param program_name The program name.
+void write_usage_message(ostream &os, const string &program_name) {
+    os << "usage: " << program_name << " {data file} {target file}" << endl;
+}
+
+/// Utility to convert spectroscopic data (text format) into the binary spectrum format,
+/// which is memory-mapped when a model is read. The data are sorted by wavelength.
+///
+/// @param argc The number of command line arguments supplied.
+/// @param argv The command line arguments:
+/// @parblock
+/// @c argv[0] The program name.
+///
+/// @c argv[1] The path name of the data file (text format).
+///
+/// @c argv[2] The path name of the target file (binary format).
+/// @endparblock
+/// @return an exit code.
+///
+/// @remark Usage: ebin {data file} {target file}
+int main(int argc, char *argv[]) {
+    const string program_name(argv[0]);
+
+    if (argc == 1) {
+        write_usage_message(cout, program_name);
+        return 0;
+    }
+    try {
+        if (argc != 3) {
+            throw invalid_argument("Error: an invalid number of arguments was supplied");
+        }
+
+        especia::Spectrum spectrum;
+
+        ifstream ifs(argv[1]);
+        if (!spectrum.get(ifs)) {
+            throw runtime_error("Error: an input error occurred");
+        }
+        ifs.close();
+
+        ofstream ofs(argv[2], ios_base::binary);
+        if (!spectrum.put(ofs)) {
+            throw runtime_error("Error: an output error occurred");
+        }
+        ofs.close();
+
+        return 0;
+    } catch (logic_error &e) {
+        cerr << e.what() << endl;
+        return especia::Exit_Codes::logic_error;
+    } catch (runtime_error &e) {
+        cerr << e.what() << endl;
+        return especia::Exit_Codes::runtime_error;
+    } catch (exception &e) {
+        cerr << e.what() << endl;
+        return especia::Exit_Codes::unspecific_exception;
+    }
+}
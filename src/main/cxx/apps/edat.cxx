@@ -3,27 +3,70 @@
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+
+#include "../core/dataio.h"
+#include "../core/exitcodes.h"
+#include "../core/resultindex.h"
 
 using namespace std;
 
 /// Extracts the section data from Especia result HTML. Reads from standard
-/// input and writes to standard output.
+/// input and writes to standard output. Alternatively, reads the section data
+/// from a data file in binary format, which is written by the Especia programs
+/// with the option @c --data-file. When the result file is indexed and seekable, the
+/// section data are copied from the position indexed, and the result is not scanned.
+///
+/// @param argc The number of command line arguments supplied.
+/// @param argv The command line arguments:
+/// @parblock
+/// @c argv[0] The program name.
 ///
+/// @c argv[1] The path name of the binary data file (optional).
+/// @endparblock
 /// @return an exit code.
 ///
-/// @remark Usage: edat < {result file} [> {target file}]
-int main() {
-    bool found = false;
-    string s;
-
-    while (getline(cin, s)) {
-        if (found and s != "</data>") {
-            cout << s << endl;
-        } else {
-            found = (s == "<data>");
+/// @remark Usage: edat [{data file}] < {result file} [> {target file}]
+int main(int argc, char *argv[]) {
+    try {
+        if (argc > 2) {
+            throw invalid_argument("Error: an invalid number of arguments was supplied");
         }
-    }
+        if (argc == 2) {
+            ifstream ifs(argv[1], ios_base::binary);
 
-    return 0;
+            if (!especia::read_data(ifs, cout)) {
+                throw runtime_error("Error: the data file cannot be read");
+            }
+            return 0;
+        }
+
+        if (especia::copy_blocks(cin, "data", cout)) {
+            return 0;
+        }
+
+        bool found = false;
+        string s;
+
+        while (getline(cin, s)) {
+            if (found and s != "</data>") {
+                cout << s << endl;
+            } else {
+                found = (s == "<data>");
+            }
+        }
+
+        return 0;
+    } catch (logic_error &e) {
+        cerr << e.what() << endl;
+        return especia::Exit_Codes::logic_error;
+    } catch (runtime_error &e) {
+        cerr << e.what() << endl;
+        return especia::Exit_Codes::runtime_error;
+    } catch (exception &e) {
+        cerr << e.what() << endl;
+        return especia::Exit_Codes::unspecific_exception;
+    }
 }
@@ -4,16 +4,30 @@
 /// @date 2021
 /// @copyright MIT License
 #include <iostream>
+#include <stdexcept>
+
+#include "../core/exitcodes.h"
+#include "../core/resultindex.h"
 
 using namespace std;
 
 /// Extracts the model definition from Especia result HTML. Reads from standard
-/// input and writes to standard output.
+/// input and writes to standard output. When the result file is indexed and seekable,
+/// the block is copied from the position indexed, and the result is not scanned.
 ///
 /// @return an exit code.
 ///
 /// @remark Usage: emod < {result file} [> {target file}]
 int main() {
+    try {
+        if (especia::copy_blocks(cin, "model", cout)) {
+            return 0;
+        }
+    } catch (runtime_error &e) {
+        cerr << e.what() << endl;
+        return especia::Exit_Codes::runtime_error;
+    }
+
     bool found = false;
     string s;
 
@@ -4,10 +4,11 @@
 /// @date 2021
 /// @copyright MIT License
 #include <fstream>
+#include <future>
 
 #include "../core/base.h"
-#include "../core/dataio.h"
 #include "../core/exitcodes.h"
+#include "../core/pipeline.h"
 
 using namespace std;
 
@@ -37,6 +38,8 @@ void write_usage_message(ostream &os, const string &program_name) {
 /// @endparblock
 /// @return an exit code.
 ///
+/// @remark The data are streamed in chunks, and both files are read concurrently.
+///
 /// @remark Usage: ezip {flux file} {uncertainty file} [lines to skip] [> {target file}]
 int main(int argc, char *argv[]) {
     const string program_name(argv[0]);
@@ -46,6 +49,9 @@ int main(int argc, char *argv[]) {
         return 0;
     }
     try {
+        // Chunks are read by another thread, so lock-free standard streams matter
+        ios_base::sync_with_stdio(false);
+
         if (argc != 3 and argc != 4) {
             throw invalid_argument("Error: an invalid number of arguments was supplied");
         }
@@ -53,25 +59,33 @@ int main(int argc, char *argv[]) {
         natural skip = 0;
 
         if (argc == 4) {
-            skip = especia::convert<natural>(string(argv[2]));
+            skip = especia::convert<natural>(string(argv[3]));
         }
 
-        valarray<real> x;
-        valarray<real> y;
-        valarray<real> z;
-
         ifstream fxy(argv[1]);
         ifstream fxz(argv[2]);
 
-        especia::get(fxy, x, y, skip);
-        especia::get(fxz, x, z, skip);
+        especia::Data_Chunk xy;
+        especia::Data_Chunk xz;
+        natural skip_xz = skip;
+        size_t n = 0;
+
+        do {
+            future<void> reading = async(launch::async, [&]() {
+                especia::get(fxz, xz, especia::default_chunk_size, skip_xz);
+            });
+            especia::get(fxy, xy, especia::default_chunk_size, skip);
+            reading.get();
 
-        fxy.close();
-        fxz.close();
+            if (!fxy or !fxz or xy.size() != xz.size()) {
+                throw runtime_error("Error: an input error occurred");
+            }
+            xy.z.swap(xz.y);
+            especia::put(cout, xy);
+            n += xy.size();
+        } while (xy.size() > 0);
 
-        if (fxy and fxz and y.size() == z.size()) {
-            especia::put(cout, x, y, z);
-        } else {
+        if (n == 0) {
             throw runtime_error("Error: an input error occurred");
         }
         return 0;
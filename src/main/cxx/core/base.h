@@ -8,6 +8,10 @@
 
 #include <cinttypes>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
@@ -24,12 +28,88 @@ namespace especia {
     /// The type of real numbers (denoted in maths as set R).
     typedef double real;
 
+#ifdef ESPECIA_WITH_FLOAT_PIXELS
+    /// The type of modelled per-pixel data, like optical depth and absorption terms. Is
+    /// single precision, if built with CMake option @c ESPECIA_FLOAT_PIXELS.
+    typedef float pixel;
+#else
+    /// The type of modelled per-pixel data, like optical depth and absorption terms. Is
+    /// single precision, if built with CMake option @c ESPECIA_FLOAT_PIXELS.
+    typedef real pixel;
+#endif
+
     /// The type of binary numbers with 32 binary digits.
     typedef uint32_t word32;
 
     /// The type of binary numbers with 64 binary digits.
     typedef uint64_t word64;
 
+    /// An allocator, which aligns the storage allocated to a boundary, e.g. the size of a cache
+    /// line or a SIMD register.
+    ///
+    /// @tparam T The value type.
+    /// @tparam Alignment The alignment (bytes). Must be a power of two and not less than the size
+    /// of a pointer.
+    template<class T, size_t Alignment = 64>
+    class Aligned_Allocator {
+    public:
+        /// The value type.
+        typedef T value_type;
+
+        /// Rebinds this allocator to another value type.
+        template<class U>
+        struct rebind {
+            /// The rebound allocator type.
+            typedef Aligned_Allocator<U, Alignment> other;
+        };
+
+        /// The constructor.
+        Aligned_Allocator() = default;
+
+        /// Constructs a copy of an allocator of another value type.
+        template<class U>
+        Aligned_Allocator(const Aligned_Allocator<U, Alignment> &) {
+        }
+
+        /// Allocates aligned storage.
+        ///
+        /// @param[in] n The number of values.
+        /// @return a pointer to the storage allocated.
+        T *allocate(size_t n) {
+            // The original address is stored in front of the aligned storage
+            void *const p = ::operator new(n * sizeof(T) + Alignment);
+            void *const q = reinterpret_cast<void *>(
+                    (reinterpret_cast<std::uintptr_t>(p) + Alignment) & ~std::uintptr_t(Alignment - 1));
+            static_cast<void **>(q)[-1] = p;
+
+            return static_cast<T *>(q);
+        }
+
+        /// Deallocates aligned storage.
+        ///
+        /// @param[in] q The pointer to the storage.
+        /// @param[in] n The number of values.
+        void deallocate(T *q, size_t n) {
+            ::operator delete(static_cast<void **>(static_cast<void *>(q))[-1]);
+        }
+
+        /// Tests for equality with another allocator.
+        ///
+        /// @return always @c true.
+        template<class U>
+        bool operator==(const Aligned_Allocator<U, Alignment> &) const {
+            return true;
+        }
+
+        /// Tests for inequality with another allocator.
+        ///
+        /// @return always @c false.
+        template<class U>
+        bool operator!=(const Aligned_Allocator<U, Alignment> &) const {
+            return false;
+        }
+    };
+
     /// The class of continuous univariate functions @c f(x) whose derivative exists and is continous.
     template<class T = real>
     class C1 {
@@ -164,6 +244,50 @@ namespace especia {
         return x * x;
     }
 
+    /// Returns the exponential of a number. The computation has no branches and calls no
+    /// library function, so a compiler can vectorize loops calling it. The relative error
+    /// does not exceed a few units in the last place.
+    ///
+    /// @param[in] x The number. Values less than -708 are replaced with -708, values greater
+    /// than 709 are replaced with 709.
+    /// @return the exponential of the number.
+    inline real fast_exp(real x) {
+        // The shift, which rounds to an integer in the lowest bits of the mantissa
+        const real shift = 6755399441055744.0;
+
+        x = x < -708.0 ? -708.0 : x;
+        x = x > 709.0 ? 709.0 : x;
+
+        // Cody & Waite (1980) reduction x = k ln(2) + r with |r| <= ln(2) / 2
+        const real t = x * 1.44269504088896340736 + shift;
+        const real k = t - shift;
+        const real r = (x - k * 6.93147180369123816490E-01) - k * 1.90821492927058770002E-10;
+
+        // The Taylor polynomial of degree 12
+        real p = 1.0 / 479001600.0;
+        p = p * r + 1.0 / 39916800.0;
+        p = p * r + 1.0 / 3628800.0;
+        p = p * r + 1.0 / 362880.0;
+        p = p * r + 1.0 / 40320.0;
+        p = p * r + 1.0 / 5040.0;
+        p = p * r + 1.0 / 720.0;
+        p = p * r + 1.0 / 120.0;
+        p = p * r + 1.0 / 24.0;
+        p = p * r + 1.0 / 6.0;
+        p = p * r + 0.5;
+        p = p * r + 1.0;
+        p = p * r + 1.0;
+
+        // The lowest bits of the shifted value hold k, which becomes the exponent of 2^k
+        std::uint64_t bits;
+        std::memcpy(&bits, &t, sizeof(bits));
+        bits = (bits + 1023) << 52;
+        real s;
+        std::memcpy(&s, &bits, sizeof(s));
+
+        return p * s;
+    }
+
 }
 
 #endif // ESPECIA_BASE_H
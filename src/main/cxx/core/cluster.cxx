@@ -0,0 +1,166 @@
+/// @file cluster.cxx
+/// Distributed evaluation of an objective function across the processes of a cluster.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <stdexcept>
+
+#ifdef ESPECIA_WITH_MPI
+#include <mpi.h>
+#endif
+
+#include "cluster.h"
+
+using especia::natural;
+using especia::real;
+using especia::word64;
+
+/// Returns the rank of the calling process.
+///
+/// @return the rank of the calling process.
+static natural process_rank() {
+#ifdef ESPECIA_WITH_MPI
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return static_cast<natural>(rank);
+#else
+    return 0;
+#endif
+}
+
+/// Returns the number of processes.
+///
+/// @return the number of processes.
+static natural process_count() {
+#ifdef ESPECIA_WITH_MPI
+    int size = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return static_cast<natural>(size);
+#else
+    return 1;
+#endif
+}
+
+especia::Cluster::Cluster() : rank(0), size(1), initialized(false) {
+#ifdef ESPECIA_WITH_MPI
+    int flag = 0;
+    MPI_Initialized(&flag);
+    if (!flag) {
+        int provided = 0;
+        MPI_Init_thread(nullptr, nullptr, MPI_THREAD_SERIALIZED, &provided);
+        initialized = true;
+    }
+    rank = process_rank();
+    size = process_count();
+#endif
+    distributed() = rank == 0 and size > 1;
+}
+
+especia::Cluster::~Cluster() {
+    if (distributed()) {
+        std::vector<real> x;
+        std::lock_guard<std::mutex> lock(guard());
+
+        send(0, 0, x);
+        distributed() = false;
+    }
+#ifdef ESPECIA_WITH_MPI
+    if (initialized) {
+        MPI_Finalize();
+    }
+#endif
+}
+
+#ifdef ESPECIA_WITH_MPI
+void especia::Cluster::broadcast(std::string &s) const {
+    if (size > 1) {
+        word64 length = s.size();
+
+        MPI_Bcast(&length, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+        s.resize(length);
+        if (length > 0) {
+            MPI_Bcast(&s[0], static_cast<int>(length), MPI_CHAR, 0, MPI_COMM_WORLD);
+        }
+    }
+}
+#else
+void especia::Cluster::broadcast(std::string &) const {
+}
+#endif
+
+bool especia::Cluster::all(bool condition) const {
+#ifdef ESPECIA_WITH_MPI
+    if (size > 1) {
+        int local = condition ? 1 : 0;
+        int global = 0;
+
+        MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+        condition = global != 0;
+    }
+#endif
+    if (not condition) {
+        distributed() = false;
+    }
+    return condition;
+}
+
+natural especia::Cluster::share_begin(natural m, natural offset) {
+    const word64 r = process_rank() + offset;
+
+    return static_cast<natural>((r * m) / process_count());
+}
+
+#ifdef ESPECIA_WITH_MPI
+void especia::Cluster::send(natural n, natural m, std::vector<real> &x) {
+    word64 header[] = {n, m};
+
+    MPI_Bcast(header, 2, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    if (m > 0) {
+        MPI_Bcast(&x[0], static_cast<int>(m * n), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    }
+}
+#else
+void especia::Cluster::send(natural, natural, std::vector<real> &) {
+}
+#endif
+
+#ifdef ESPECIA_WITH_MPI
+natural especia::Cluster::receive(natural n, std::vector<real> &x) {
+    word64 header[] = {0, 0};
+
+    MPI_Bcast(header, 2, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    const auto m = static_cast<natural>(header[1]);
+    if (m > 0) {
+        if (header[0] != n) {
+            throw std::logic_error(
+                    "especia::Cluster::receive() Error: the number of parameter values does not match");
+        }
+        x.resize(m * n);
+        MPI_Bcast(&x[0], static_cast<int>(m * n), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    }
+
+    return m;
+}
+#else
+natural especia::Cluster::receive(natural, std::vector<real> &) {
+    return 0;
+}
+#endif
+
+#ifdef ESPECIA_WITH_MPI
+void especia::Cluster::reduce(std::vector<real> &y) {
+    if (process_count() > 1) {
+        const auto m = static_cast<int>(y.size());
+
+        if (process_rank() == 0) {
+            MPI_Reduce(MPI_IN_PLACE, &y[0], m, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        } else {
+            MPI_Reduce(&y[0], nullptr, m, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        }
+    }
+}
+#else
+void especia::Cluster::reduce(std::vector<real> &) {
+}
+#endif
@@ -0,0 +1,213 @@
+/// @file cluster.h
+/// Distributed evaluation of an objective function across the processes of a cluster.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_CLUSTER_H
+#define ESPECIA_CLUSTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base.h"
+#include "threads.h"
+
+namespace especia {
+
+    /// A cluster of processes to evaluate an objective function. The root process
+    /// keeps the optimizer state and broadcasts blocks of parameter vectors, which
+    /// are evaluated by all processes in equal shares.
+    ///
+    /// When compiled without MPI support (see CMake option @c ESPECIA_MPI) the cluster
+    /// comprises the calling process only and no evaluation is distributed.
+    ///
+    /// @remark There must be only one instance of this class per process.
+    class Cluster {
+    public:
+        /// Creates a new cluster. Initializes MPI, if compiled with MPI support.
+        Cluster();
+
+        /// The destructor. On the root process, stops the other processes serving.
+        /// Finalizes MPI, if initialized by the constructor.
+        ~Cluster();
+
+        Cluster(const Cluster &) = delete;
+
+        Cluster &operator=(const Cluster &) = delete;
+
+        /// Returns the rank of the calling process. The root process has rank zero.
+        ///
+        /// @return the rank of the calling process.
+        natural get_rank() const {
+            return rank;
+        }
+
+        /// Returns the number of processes.
+        ///
+        /// @return the number of processes.
+        natural get_size() const {
+            return size;
+        }
+
+        /// Broadcasts a string from the root process to all other processes.
+        ///
+        /// @param[in,out] s The string.
+        void broadcast(std::string &s) const;
+
+        /// Tests if a condition holds on all processes. Must be called by all processes.
+        /// When the condition does not hold on any process, the other processes are not
+        /// expected to serve, and the root process does not stop them serving.
+        ///
+        /// @param[in] condition The condition on the calling process.
+        /// @return @c true, if the condition holds on all processes.
+        bool all(bool condition) const;
+
+        /// Serves the root process by evaluating shares of the blocks of parameter vectors
+        /// broadcast, until the root process stops serving. Must not be called by the root
+        /// process.
+        ///
+        /// @tparam F The function type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] n The number of parameter values.
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        template<class F>
+        void serve(const F &f, natural n, const Thread_Pool &pool) const {
+            std::vector<real> x;
+            std::vector<real> y;
+
+            for (natural m = receive(n, x); m > 0; m = receive(n, x)) {
+                evaluate_share(f, n, m, x, y, pool);
+            }
+        }
+
+        /// Tests if the evaluation of the objective function is distributed. Is @c true on
+        /// the root process of a cluster with more than one process only.
+        ///
+        /// @return @c true, if the evaluation of the objective function is distributed.
+        static bool is_distributed() {
+            return distributed();
+        }
+
+        /// Evaluates an objective function for many parameter vectors on all processes
+        /// of the cluster. Must be called by the root process only.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] constraint The constraint on parameter values.
+        /// @param[in] n The number of parameter values.
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[in] pool The pool of threads to evaluate the share of the root process.
+        ///
+        /// @remark Blocks submitted concurrently are evaluated one after another.
+        template<class F, class Constraint>
+        static void evaluate(const F &f, const Constraint &constraint, natural n, natural m,
+                             const real *const x[], real y[], const Thread_Pool &pool) {
+            std::lock_guard<std::mutex> lock(guard());
+
+            std::vector<real> block(m * n);
+            std::vector<real> z;
+
+            for (natural k = 0; k < m; ++k) {
+                std::copy(x[k], x[k] + n, &block[k * n]);
+            }
+            send(n, m, block);
+            evaluate_share(f, n, m, block, z, pool);
+
+            for (natural k = 0; k < m; ++k) {
+                y[k] = z[k] + constraint.cost(x[k], n);
+            }
+        }
+
+    private:
+        /// Evaluates the share of the calling process and reduces the values of the
+        /// objective function onto the root process.
+        ///
+        /// @tparam F The function type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] n The number of parameter values.
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors (in row-major layout).
+        /// @param[out] y The values of the objective function. Valid on the root process only.
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        template<class F>
+        static void evaluate_share(const F &f, natural n, natural m, const std::vector<real> &x,
+                                   std::vector<real> &y, const Thread_Pool &pool) {
+            const natural begin = share_begin(m);
+            const natural end = share_begin(m, 1);
+
+            // The values outside the share are zero, so the reduction by summation is exact
+            y.assign(m, 0.0);
+            pool.for_each(end - begin, [&](natural i) {
+                y[begin + i] = f(&x[(begin + i) * n], n);
+            });
+            reduce(y);
+        }
+
+        /// Returns the beginning of the share of the calling process (or a subsequent process).
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] offset The rank offset.
+        /// @return the index of the first parameter vector of the share.
+        static natural share_begin(natural m, natural offset = 0);
+
+        /// Broadcasts a block of parameter vectors from the root process.
+        ///
+        /// @param[in] n The number of parameter values.
+        /// @param[in] m The number of parameter vectors. Zero stops the other processes serving.
+        /// @param[in] x The parameter vectors (in row-major layout).
+        static void send(natural n, natural m, std::vector<real> &x);
+
+        /// Receives a block of parameter vectors broadcast by the root process.
+        ///
+        /// @param[in] n The number of parameter values.
+        /// @param[out] x The parameter vectors (in row-major layout).
+        /// @return the number of parameter vectors. Zero indicates that serving is stopped.
+        ///
+        /// @throw logic_error when the number of parameter values received does not match.
+        static natural receive(natural n, std::vector<real> &x);
+
+        /// Sums values across all processes onto the root process.
+        ///
+        /// @param[in,out] y The values.
+        static void reduce(std::vector<real> &y);
+
+        /// Returns the distribution flag.
+        ///
+        /// @return the distribution flag.
+        static std::atomic<bool> &distributed() {
+            static std::atomic<bool> flag(false);
+
+            return flag;
+        }
+
+        /// Returns the mutex serializing the communication.
+        ///
+        /// @return the mutex.
+        static std::mutex &guard() {
+            static std::mutex mutex;
+
+            return mutex;
+        }
+
+        /// The rank of the calling process.
+        natural rank;
+
+        /// The number of processes.
+        natural size;
+
+        /// Whether MPI was initialized by the constructor.
+        bool initialized;
+    };
+
+}
+
+#endif // ESPECIA_CLUSTER_H
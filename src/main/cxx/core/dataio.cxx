@@ -4,14 +4,26 @@
 /// @date 2021
 /// @copyright MIT License
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <vector>
 
 #include "dataio.h"
+#include "scanner.h"
 
 using namespace std;
 
+using especia::natural;
+using especia::real;
+
+/// The signature of the binary format of section data, including the format version.
+static const char signature[8] = {'E', 'S', 'P', 'D', 'A', 'T', 'A', '\x01'};
+
+/// The byte order mark of the binary format of section data.
+static const uint32_t byte_order_mark = 0x01020304;
+
 istream &especia::get(istream &is, valarray<real> &x, valarray<real> &y, natural skip) {
     const size_t room = 20000;
 
@@ -26,7 +38,7 @@ istream &especia::get(istream &is, valarray<real> &x, valarray<real> &y, natural
 
     while (getline(is, s)) {
         if (skip <= 0) {
-            istringstream ist(s);
+            Scanner ist(s);
             real a, b;
 
             if (ist >> a >> b) {
@@ -75,7 +87,7 @@ istream &especia::get(istream &is, valarray<real> &x, valarray<real> &y, valarra
 
     while (getline(is, s)) {
         if (skip <= 0) {
-            istringstream ist(s);
+            Scanner ist(s);
             real a, b, c;
 
             if (ist >> a >> b) {
@@ -112,7 +124,16 @@ istream &especia::get(istream &is, valarray<real> &x, valarray<real> &y, valarra
     return is;
 }
 
-ostream &especia::put(ostream &os, const valarray<real> &x, const valarray<real> &y, const valarray<real> &z) {
+/// Writes spectroscopic data to an output stream.
+///
+/// @param[in,out] os The output stream.
+/// @param[in] x The wavelength data.
+/// @param[in] y The spectral flux data.
+/// @param[in] z The spectral flux uncertainty data, or @c nullptr.
+/// @param[in] n The number of data points.
+///
+/// @return the output stream.
+static ostream &put(ostream &os, const real x[], const real y[], const real z[], const size_t n) {
     if (os) {
         const natural p = 6;  // precision
         const natural w = 14; // width
@@ -122,12 +143,12 @@ ostream &especia::put(ostream &os, const valarray<real> &x, const valarray<real>
         os.setf(ios_base::right, ios_base::adjustfield);
         os.precision(p);
 
-        for (size_t i = 0; i < x.size(); ++i) {
+        for (size_t i = 0; i < n; ++i) {
             os.setf(ios_base::fixed, ios_base::floatfield);
             os << setw(w) << x[i];
             os.setf(ios_base::scientific, ios_base::floatfield);
             os << setw(w) << y[i];
-            if (z.size() > 0) {
+            if (z != nullptr) {
                 os << setw(w) << z[i];
             }
             os << '\n';
@@ -139,3 +160,110 @@ ostream &especia::put(ostream &os, const valarray<real> &x, const valarray<real>
 
     return os;
 }
+
+ostream &especia::put(ostream &os, const valarray<real> &x, const valarray<real> &y, const valarray<real> &z) {
+    return x.size() > 0 ? ::put(os, &x[0], &y[0], z.size() > 0 ? &z[0] : nullptr, x.size()) : os;
+}
+
+istream &especia::get(istream &is, Data_Chunk &chunk, const size_t capacity, natural &skip) {
+    chunk.x.clear();
+    chunk.y.clear();
+    chunk.z.clear();
+
+    string s;
+
+    while (chunk.size() < capacity and getline(is, s)) {
+        if (skip <= 0) {
+            Scanner ist(s);
+            real a, b, c;
+
+            if (ist >> a >> b) {
+                chunk.x.push_back(a);
+                chunk.y.push_back(b);
+                chunk.z.push_back(ist >> c ? c : real(0.0));
+            } else {
+                is.setstate(ios_base::badbit | ios_base::failbit);
+
+                return is;
+            }
+        } else {
+            --skip;
+        }
+    }
+
+    if (is.eof() and !is.bad()) {
+        is.clear(is.rdstate() & ~ios_base::failbit);
+    }
+
+    return is;
+}
+
+ostream &especia::put(ostream &os, const Data_Chunk &chunk) {
+    return ::put(os, chunk.x.data(), chunk.y.data(), chunk.z.data(), chunk.size());
+}
+
+void especia::put_data_record(Writer &writer, const real record[]) {
+    // The precision.
+    const natural p = 8;
+    // The width of the output field.
+    const natural w = 16;
+
+    for (natural k = 0; k < data_record_length; ++k) {
+        if (k == 3) {
+            // The selection mask
+            writer.put(static_cast<natural>(record[k] != 0.0), 3);
+        } else {
+            writer.put_scientific(record[k], p, w);
+        }
+    }
+    writer.put('\n');
+}
+
+ostream &especia::write_data_header(ostream &os, const word64 section_count) {
+    if (os) {
+        const char reserved[4] = {0, 0, 0, 0};
+
+        os.write(signature, sizeof(signature));
+        os.write(reinterpret_cast<const char *>(&byte_order_mark), sizeof(byte_order_mark));
+        os.write(reserved, sizeof(reserved));
+        os.write(reinterpret_cast<const char *>(&section_count), sizeof(section_count));
+    }
+
+    return os;
+}
+
+istream &especia::read_data(istream &is, ostream &os) {
+    char bytes[sizeof(signature)];
+    uint32_t bom;
+    char reserved[4];
+    word64 section_count;
+
+    if (is.read(bytes, sizeof(bytes)) and memcmp(bytes, signature, sizeof(signature)) == 0 and
+        is.read(reinterpret_cast<char *>(&bom), sizeof(bom)) and bom == byte_order_mark and
+        is.read(reserved, sizeof(reserved)) and
+        is.read(reinterpret_cast<char *>(&section_count), sizeof(section_count))) {
+        Writer writer(os);
+        real record[data_record_length];
+
+        for (word64 i = 0; i < section_count; ++i) {
+            word64 record_count;
+
+            if (!is.read(reinterpret_cast<char *>(&record_count), sizeof(record_count))) {
+                break;
+            }
+            if (i > 0) {
+                writer.put('\n');
+            }
+            for (word64 j = 0; j < record_count; ++j) {
+                if (!is.read(reinterpret_cast<char *>(record), sizeof(record))) {
+                    break;
+                }
+                put_data_record(writer, record);
+            }
+        }
+    } else {
+        is.setstate(ios_base::failbit);
+    }
+
+    return is;
+}
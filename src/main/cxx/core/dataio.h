@@ -8,8 +8,10 @@
 
 #include <iostream>
 #include <valarray>
+#include <vector>
 
 #include "base.h"
+#include "writer.h"
 
 namespace especia {
 
@@ -49,6 +51,81 @@ namespace especia {
     put(std::ostream &os, const std::valarray<real> &x, const std::valarray<real> &y,
         const std::valarray<real> &z);
 
+    /// A chunk of spectroscopic data (wavelength, flux and uncertainty) in columnar
+    /// layout, which is streamed from an input stream to an output stream.
+    struct Data_Chunk {
+        /// The wavelength data.
+        std::vector<real> x;
+
+        /// The spectral flux data.
+        std::vector<real> y;
+
+        /// The spectral flux uncertainty data.
+        std::vector<real> z;
+
+        /// Returns the number of data points.
+        ///
+        /// @return the number of data points.
+        size_t size() const {
+            return x.size();
+        }
+    };
+
+    /// Reads a chunk of spectroscopic data from an input stream. A missing uncertainty
+    /// is read as zero. When the input is exhausted, the end-of-file flag is set, but the
+    /// stream does not fail.
+    ///
+    /// @param[in,out] is The input stream.
+    /// @param[out] chunk The chunk (previous content is overwritten).
+    /// @param[in] capacity The maximum number of data points to read.
+    /// @param[in,out] skip The number of leading lines still to skip.
+    ///
+    /// @return the input stream.
+    std::istream &get(std::istream &is, Data_Chunk &chunk, size_t capacity, natural &skip);
+
+    /// Writes a chunk of spectroscopic data to an output stream, like @c put() does.
+    ///
+    /// @param[in,out] os The output stream.
+    /// @param[in] chunk The chunk.
+    ///
+    /// @return the output stream.
+    std::ostream &put(std::ostream &os, const Data_Chunk &chunk);
+
+    /// The number of columns of a section data record.
+    const natural data_record_length = 13;
+
+    /// Writes a section data record as a line of text.
+    ///
+    /// @param[in,out] writer The writer.
+    /// @param[in] record The section data record.
+    void put_data_record(Writer &writer, const real record[]);
+
+    /// Writes the header of section data in binary format. The binary format consists of
+    ///
+    /// an 8-byte signature @c ESPDATA followed by the format version,
+    ///
+    /// a 4-byte byte order mark and 4 bytes reserved,
+    ///
+    /// the 8-byte number of sections,
+    ///
+    /// for each section, the 8-byte number of records @c n followed by @c n records (as
+    /// 8-byte floating point numbers).
+    ///
+    /// All numbers use the byte order of the machine, which has written the data.
+    ///
+    /// @param[in,out] os The output stream.
+    /// @param[in] section_count The number of sections.
+    /// @return the output stream.
+    std::ostream &write_data_header(std::ostream &os, word64 section_count);
+
+    /// Reads section data in binary format and writes them in text format, like the
+    /// data block of a result file.
+    ///
+    /// @param[in,out] is The input stream (binary format).
+    /// @param[in,out] os The output stream (text format).
+    /// @return the input stream.
+    std::istream &read_data(std::istream &is, std::ostream &os);
+
 }
 
 #endif // ESPECIA_DATAIO_H
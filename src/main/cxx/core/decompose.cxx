@@ -1,9 +1,11 @@
 /// @file decompose.cxx
-/// Symmetric eigenproblem solvers calling the LAPACK routines.
+/// Symmetric eigenproblem solvers calling the LAPACK routines, and a Jacobi solver for small problems.
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
 #include <algorithm>
+#include <array>
+#include <cmath>
 
 #include "decompose.h"
 
@@ -15,6 +17,7 @@ using std::string;
 using std::swap;
 using std::valarray;
 
+using especia::natural;
 using especia::real;
 using especia::integer;
 
@@ -274,3 +277,213 @@ const string especia::X_Decompose::message_ill_arg = // NOLINT
 #undef LAPACK_NAME_R_TYPE
 #undef LAPACK_NAME_SINGLE
 #undef LAPACK_NAME_DOUBLE
+
+/// Solves a symmetric eigenproblem of fixed dimension by means of the cyclic Jacobi method.
+/// Based on Press et al. (2007, Numerical Recipes, 3rd Edition, Sect. 11.1).
+///
+/// @tparam N The problem dimension.
+///
+/// @param[in] A The symmetric matrix (column-major, upper triangular).
+/// @param[out] Z The transformation matrix (column-major).
+/// @param[out] w The eigenvalues, in ascending order.
+/// @return @c true on convergence, @c false otherwise.
+template<natural N>
+static bool jacobi(const real A[], real Z[], real w[]) {
+    using std::abs;
+    using std::sqrt;
+
+    // The maximum number of sweeps
+    const natural max_sweeps = 50;
+
+    std::array<real, N * N> a;
+    std::array<real, N * N> v;
+    std::array<real, N> b;
+    std::array<real, N> z;
+
+    for (natural j = 0; j < N; ++j) {
+        for (natural i = 0; i <= j; ++i) {
+            a[i + j * N] = A[i + j * N];
+            v[i + j * N] = 0.0;
+            v[j + i * N] = 0.0;
+        }
+        v[j + j * N] = 1.0;
+        b[j] = a[j + j * N];
+        w[j] = b[j];
+        z[j] = 0.0;
+    }
+
+    bool converged = false;
+
+    for (natural sweep = 0; sweep < max_sweeps and not converged; ++sweep) {
+        real off = 0.0;
+        for (natural q = 1; q < N; ++q) {
+            for (natural p = 0; p < q; ++p) {
+                off += abs(a[p + q * N]);
+            }
+        }
+        converged = (off == 0.0);
+        if (converged) {
+            break;
+        }
+        // In the first sweeps only off-diagonal elements above a threshold are annihilated
+        const real threshold = (sweep < 3) ? 0.2 * off / real(N * N) : 0.0;
+
+        for (natural q = 1; q < N; ++q) {
+            for (natural p = 0; p < q; ++p) {
+                const real apq = a[p + q * N];
+                const real g = 100.0 * abs(apq);
+
+                if (sweep > 3 and abs(w[p]) + g == abs(w[p]) and abs(w[q]) + g == abs(w[q])) {
+                    a[p + q * N] = 0.0;
+                } else if (abs(apq) > threshold) {
+                    const real h = w[q] - w[p];
+
+                    real t;
+                    if (abs(h) + g == abs(h)) {
+                        t = apq / h;
+                    } else {
+                        const real theta = 0.5 * h / apq;
+
+                        t = 1.0 / (abs(theta) + sqrt(1.0 + theta * theta));
+                        if (theta < 0.0) {
+                            t = -t;
+                        }
+                    }
+                    const real c = 1.0 / sqrt(1.0 + t * t);
+                    const real s = t * c;
+                    const real tau = s / (1.0 + c);
+                    const real u = t * apq;
+
+                    z[p] -= u;
+                    z[q] += u;
+                    w[p] -= u;
+                    w[q] += u;
+                    a[p + q * N] = 0.0;
+
+                    // The rotation of the upper triangular part, with a(i, j) = a[i + j * N] for i < j
+                    const auto rotate = [s, tau](real &x, real &y) {
+                        const real xi = x;
+                        const real yi = y;
+
+                        x = xi - s * (yi + xi * tau);
+                        y = yi + s * (xi - yi * tau);
+                    };
+                    for (natural j = 0; j < p; ++j) {
+                        rotate(a[j + p * N], a[j + q * N]);
+                    }
+                    for (natural j = p + 1; j < q; ++j) {
+                        rotate(a[p + j * N], a[j + q * N]);
+                    }
+                    for (natural j = q + 1; j < N; ++j) {
+                        rotate(a[p + j * N], a[q + j * N]);
+                    }
+                    for (natural j = 0; j < N; ++j) {
+                        rotate(v[j + p * N], v[j + q * N]);
+                    }
+                }
+            }
+        }
+        for (natural i = 0; i < N; ++i) {
+            b[i] += z[i];
+            w[i] = b[i];
+            z[i] = 0.0;
+        }
+    }
+
+    // The eigenvalues are sorted into ascending order by straight insertion
+    std::array<natural, N> index;
+    for (natural i = 0; i < N; ++i) {
+        index[i] = i;
+    }
+    for (natural i = 1; i < N; ++i) {
+        const natural k = index[i];
+        const real t = w[i];
+
+        natural j = i;
+        for (; j > 0 and w[j - 1] > t; --j) {
+            w[j] = w[j - 1];
+            index[j] = index[j - 1];
+        }
+        w[j] = t;
+        index[j] = k;
+    }
+    for (natural j = 0; j < N; ++j) {
+        copy(&v[index[j] * N], &v[index[j] * N] + N, &Z[j * N]);
+    }
+
+    return converged;
+}
+
+/// The type of a solver for symmetric eigenproblems of fixed dimension.
+typedef bool (*Jacobi)(const real A[], real Z[], real w[]);
+
+/// The solvers for symmetric eigenproblems of (fixed) dimension one to ten.
+static const Jacobi jacobi_solvers[especia::J_Decompose::max_dimension] = {
+        jacobi<1>, jacobi<2>, jacobi<3>, jacobi<4>, jacobi<5>, jacobi<6>, jacobi<7>, jacobi<8>, jacobi<9>, jacobi<10>};
+
+especia::J_Decompose::J_Decompose(natural m)
+        : solve(0 < m and m <= max_dimension ? jacobi_solvers[m - 1] : nullptr) {
+    if (solve == nullptr) {
+        throw invalid_argument(message_ill_arg);
+    }
+}
+
+especia::J_Decompose::~J_Decompose() = default;
+
+void especia::J_Decompose::operator()(const real A[], real Z[], real w[]) const {
+    if (not solve(A, Z, w)) {
+        throw runtime_error(message_no_conv);
+    }
+}
+
+const natural especia::J_Decompose::max_dimension;
+const string especia::J_Decompose::message_no_conv = // NOLINT
+        "especia::J_Decompose() Error: the Jacobi method did not converge";
+const string especia::J_Decompose::message_ill_arg = // NOLINT
+        "especia::J_Decompose() Error: the problem dimension is not supported";
+
+
+/// Tests if the Jacobi solver is used for a given problem dimension and driver routine.
+///
+/// @param[in] m The problem dimension.
+/// @param[in] driver The driver routine.
+/// @return @c true if the Jacobi solver is used, @c false otherwise.
+static bool is_jacobi(const natural m, const especia::Decompose::Driver driver) {
+    return driver == especia::Decompose::Driver::jacobi and 0 < m and m <= especia::J_Decompose::max_dimension;
+}
+
+especia::Decompose::Decompose(natural m, Driver driver)
+        : m(m),
+          driver(driver),
+          d(driver == Driver::dsyevd ? new D_Decompose(m) : nullptr),
+          r(driver == Driver::dsyevr or (driver == Driver::jacobi and not is_jacobi(m, driver)) ? new R_Decompose(m)
+                                                                                                 : nullptr),
+          x(driver == Driver::dsyevx ? new X_Decompose(m) : nullptr),
+          j(is_jacobi(m, driver) ? new J_Decompose(m) : nullptr) {
+}
+
+especia::Decompose::Decompose(const Decompose &other) : Decompose(other.m, other.driver) {
+}
+
+especia::Decompose::~Decompose() = default;
+
+void especia::Decompose::operator()(const real A[], real Z[], real w[]) const {
+    switch (driver) {
+        case Driver::dsyevd:
+            (*d)(A, Z, w);
+            break;
+        case Driver::dsyevr:
+            (*r)(A, Z, w);
+            break;
+        case Driver::dsyevx:
+            (*x)(A, Z, w);
+            break;
+        case Driver::jacobi:
+            if (j) {
+                (*j)(A, Z, w);
+            } else {
+                (*r)(A, Z, w);
+            }
+            break;
+    }
+}
@@ -1,11 +1,12 @@
 /// @file decompose.h
-/// Symmetric eigenproblem solvers calling LAPACK routines.
+/// Symmetric eigenproblem solvers calling LAPACK routines, and a Jacobi solver for small problems.
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
 #ifndef ESPECIA_SYMEIG_H
 #define ESPECIA_SYMEIG_H
 
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <valarray>
@@ -198,8 +199,119 @@ namespace especia {
         static const std::string message_ill_arg;
     };
 
-    /// The default algorithm to solve symmetric eigenproblems.
-    typedef R_Decompose Decompose;
+    /// Class to solve symmetric eigenproblems of small dimension by means of the cyclic
+    /// Jacobi method. Does not call LAPACK and does not allocate any workspace. For each
+    /// problem dimension up to @c max_dimension there is a separate instantiation of the
+    /// solver, whose matrices are arrays of fixed size on the stack and whose loops are of
+    /// fixed length. The instantiation is selected on construction.
+    ///
+    /// @remark This algorithm is O(n^3) per sweep. It is faster than any LAPACK driver for
+    /// problem dimensions up to about ten.
+    class J_Decompose {
+    public:
+        /// The maximum problem dimension.
+        static const natural max_dimension = 10;
+
+        /// Constructs a new instance of this class for the problem dimension supplied as argument.
+        ///
+        /// @param[in] m The problem dimension.
+        ///
+        /// @throw invalid_argument when the problem dimension is zero or exceeds @c max_dimension.
+        explicit J_Decompose(natural m);
+
+        /// The destructor.
+        ~J_Decompose();
+
+        /// Solves a symmetric eigenproblem.
+        ///
+        /// @param[in] A The symmetric matrix (row-major, lower triangular).
+        /// @param[out] Z The transformation matrix (row-major).
+        /// @param[out] w The eigenvalues, in ascending order.
+        ///
+        /// @throw runtime_error when the Jacobi method does not converge.
+        void
+        operator()(const real A[], real Z[], real w[]) const;
+
+    private:
+        /// The solver instantiated for the problem dimension. Returns @c false, if the Jacobi
+        /// method does not converge.
+        bool (*const solve)(const real A[], real Z[], real w[]);
+
+        static const std::string message_no_conv;
+        static const std::string message_ill_arg;
+    };
+
+    /// Class to solve symmetric eigenproblems by means of a LAPACK driver routine
+    /// selected at runtime.
+    class Decompose {
+    public:
+        /// The LAPACK driver routines.
+        enum class Driver {
+            /// Divide and conquer, see @c D_Decompose.
+            dsyevd,
+            /// Relatively robust representations, see @c R_Decompose.
+            dsyevr,
+            /// Bisection and inverse iteration, see @c X_Decompose.
+            dsyevx,
+            /// The cyclic Jacobi method, see @c J_Decompose, if the problem dimension does
+            /// not exceed @c J_Decompose::max_dimension. Otherwise relatively robust
+            /// representations. The default.
+            jacobi
+        };
+
+        /// Constructs a new instance of this class for the problem dimension supplied as argument.
+        ///
+        /// @param[in] m The problem dimension.
+        /// @param[in] driver The LAPACK driver routine.
+        explicit Decompose(natural m, Driver driver = Driver::jacobi);
+
+        /// The copy constructor. The copy does not share any workspace with the original.
+        ///
+        /// @param[in] other The instance to be copied.
+        Decompose(const Decompose &other);
+
+        /// The destructor.
+        ~Decompose();
+
+        Decompose &operator=(const Decompose &) = delete;
+
+        /// Returns the LAPACK driver routine.
+        ///
+        /// @return the LAPACK driver routine.
+        Driver get_driver() const {
+            return driver;
+        }
+
+        /// Solves a symmetric eigenproblem.
+        ///
+        /// @param[in] A The symmetric matrix (row-major, lower triangular).
+        /// @param[out] Z The transformation matrix (row-major).
+        /// @param[out] w The eigenvalues, in ascending order.
+        ///
+        /// @throw invalid_argument when LAPACK was called with illegal arguments.
+        /// @throw runtime_error when an internal LAPACK error occurred.
+        void
+        operator()(const real A[], real Z[], real w[]) const;
+
+    private:
+        /// The problem dimension.
+        const natural m;
+
+        /// The LAPACK driver routine.
+        const Driver driver;
+
+        /// The divide and conquer solver, if selected.
+        const std::unique_ptr<const D_Decompose> d;
+
+        /// The relatively robust representations solver, if selected.
+        const std::unique_ptr<const R_Decompose> r;
+
+        /// The bisection and inverse iteration solver, if selected.
+        const std::unique_ptr<const X_Decompose> x;
+
+        /// The Jacobi solver, if selected.
+        const std::unique_ptr<const J_Decompose> j;
+    };
 
 }
 
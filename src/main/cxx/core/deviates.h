@@ -6,7 +6,12 @@
 #ifndef ESPECIA_DEVIATES_H
 #define ESPECIA_DEVIATES_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <valarray>
 
 #include "base.h"
 
@@ -16,7 +21,8 @@ namespace especia {
     ///
     /// The algorithm uses the polar method (e.g. Knuth, 1998,
     /// Sec. 3.4.1, Algorithm P) to generate standard normally distributed random
-    /// deviates.
+    /// deviates. To fill a block of deviates at once, the algorithm uses the Box-Muller
+    /// transformation (Box & Muller, 1958) on a block of uniform deviates.
     ///
     /// Further reading:
     ///
@@ -24,6 +30,10 @@ namespace especia {
     ///  *The art of computer programming 2. Seminumerical algorithms.*
     ///  Addison Wesley Longman, ISBN 0-201-89684-2.
     ///
+    /// G. E. P. Box, M. E. Muller (1958).
+    ///  *A Note on the Generation of Random Normal Deviates.*
+    ///  The Annals of Mathematical Statistics, 29, 2, 610-611.
+    ///
     /// @tparam U The strategy to generate random uniform deviates.
     template<class U>
     class Normal_Deviate {
@@ -34,6 +44,14 @@ namespace especia {
         explicit Normal_Deviate(word64 seed = 9600629759793949339ull) : uniform_deviate(seed) {
         }
 
+        /// Constructs a new instance of this class generating one of several independent
+        /// streams of random deviates.
+        ///
+        /// @param[in] seed The seed.
+        /// @param[in] stream The stream index.
+        Normal_Deviate(word64 seed, word64 stream) : uniform_deviate(U::for_stream(seed, stream)) {
+        }
+
         /// Constructs a new instance of this class from a uniform deviate.
         ///
         /// @param[in] u The instance of this class to be copied.
@@ -71,14 +89,92 @@ namespace especia {
             }
         }
 
+        /// Fills a block with random normal deviates.
+        ///
+        /// @param[out] z The block of random normal deviates.
+        /// @param[in] k The number of random normal deviates.
+        void fill(real z[], const size_t k) const {
+            using std::cos;
+            using std::log;
+            using std::min;
+            using std::sin;
+            using std::sqrt;
+
+            for (size_t i = 0; i < k; i += 2 * block_size) {
+                const size_t m = min(block_size, (k - i + 1) / 2);
+
+                uniform_deviate.generate(&uniform_block[0], 2 * m);
+                // The radial variate must be positive
+                for (size_t j = 0; j < 2 * m; j += 2) {
+                    while (uniform_block[j] >= 1.0) {
+                        uniform_block[j] = uniform_deviate();
+                    }
+                }
+                for (size_t j = 0; j < m; ++j) {
+                    radial_block[j] = sqrt(-2.0 * log(1.0 - uniform_block[2 * j]));
+                    angular_block[j] = (2.0 * pi) * uniform_block[2 * j + 1];
+                }
+                for (size_t j = 0; j < m; ++j) {
+                    z[i + 2 * j] = radial_block[j] * cos(angular_block[j]);
+                }
+                for (size_t j = 0; j < m and i + 2 * j + 1 < k; ++j) {
+                    z[i + 2 * j + 1] = radial_block[j] * sin(angular_block[j]);
+                }
+            }
+        }
+
+        /// Writes the state of this instance to an output stream (binary format).
+        ///
+        /// @param[in,out] os The output stream.
+        /// @return the output stream.
+        std::ostream &put(std::ostream &os) const {
+            const real values[] = {status ? 1.0 : 0.0, x, y};
+
+            uniform_deviate.put(os);
+
+            return os.write(reinterpret_cast<const char *>(values), sizeof(values));
+        }
+
+        /// Reads the state of this instance from an input stream (binary format). On failure,
+        /// the failbit of the input stream is set.
+        ///
+        /// @param[in,out] is The input stream.
+        /// @return the input stream.
+        std::istream &get(std::istream &is) const {
+            real values[3];
+
+            if (uniform_deviate.get(is) and is.read(reinterpret_cast<char *>(values), sizeof(values))) {
+                status = values[0] != 0.0;
+                x = values[1];
+                y = values[2];
+            }
+
+            return is;
+        }
+
     private:
+        /// The number of pairs of random normal deviates generated at once by @c fill().
+        static const size_t block_size = 256;
+
         const U uniform_deviate;
 
+        /// The block of uniform deviates.
+        mutable std::valarray<real> uniform_block = std::valarray<real>(2 * block_size);
+
+        /// The block of radial variates.
+        mutable std::valarray<real> radial_block = std::valarray<real>(block_size);
+
+        /// The block of angular variates.
+        mutable std::valarray<real> angular_block = std::valarray<real>(block_size);
+
         mutable bool status = false;
         mutable real x = 0.0;
         mutable real y = 0.0;
     };
 
+    template<class U>
+    const size_t Normal_Deviate<U>::block_size;
+
 }
 
 #endif // ESPECIA_DEVIATES_H
@@ -18,6 +18,9 @@ namespace especia {
         /// number of generations (exit code = 2).
         static const int optimization_stopped = 00002;
 
+        /// The optimization terminated early, because a termination criterion was met (exit code = 4).
+        static const int optimization_terminated = 00004;
+
         /// A logic error occurred (exit code = 8).
         static const int logic_error = 00010;
 
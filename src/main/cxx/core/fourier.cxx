@@ -0,0 +1,85 @@
+/// @file fourier.cxx
+/// Fast Fourier transform.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "fourier.h"
+
+using especia::real;
+
+especia::Fourier_Transform::Fourier_Transform(const size_t n)
+        : n(n), permutation(n), twiddles(n / 2) {
+    using std::cos;
+    using std::invalid_argument;
+    using std::sin;
+
+    if (n == 0 or (n & (n - 1)) != 0) {
+        throw invalid_argument("especia::Fourier_Transform(): Error: the size of the transform is not a power of two");
+    }
+    for (size_t i = 0, j = 0; i < n; ++i) {
+        permutation[i] = j;
+
+        size_t bit = n >> 1;
+        for (; bit > 0 and (j & bit) != 0; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+    }
+    for (size_t k = 0; k < n / 2; ++k) {
+        const real phi = -2.0 * pi * real(k) / real(n);
+
+        twiddles[k] = std::complex<real>(cos(phi), sin(phi));
+    }
+}
+
+especia::Fourier_Transform::~Fourier_Transform() = default;
+
+void especia::Fourier_Transform::forward(std::complex<real> z[]) const {
+    transform(z, -1);
+}
+
+void especia::Fourier_Transform::inverse(std::complex<real> z[]) const {
+    transform(z, 1);
+}
+
+size_t especia::Fourier_Transform::power_of_two(const size_t k) {
+    size_t n = 1;
+
+    while (n < k) {
+        n <<= 1;
+    }
+
+    return n;
+}
+
+void especia::Fourier_Transform::transform(std::complex<real> z[], const int sign) const {
+    using std::complex;
+    using std::swap;
+
+    for (size_t i = 0; i < n; ++i) {
+        const size_t j = permutation[i];
+
+        if (i < j) {
+            swap(z[i], z[j]);
+        }
+    }
+    // Danielson-Lanczos butterflies
+    for (size_t h = 1, stride = n / 2; h < n; h <<= 1, stride >>= 1) {
+        for (size_t i = 0; i < n; i += 2 * h) {
+            for (size_t k = 0; k < h; ++k) {
+                const complex<real> &w = twiddles[k * stride];
+                const complex<real> &u = z[i + k + h];
+                // Explicit arithmetic avoids the slow path of complex multiplication for infinite values
+                const real wi = sign < 0 ? w.imag() : -w.imag();
+                const complex<real> t(w.real() * u.real() - wi * u.imag(), w.real() * u.imag() + wi * u.real());
+
+                z[i + k + h] = z[i + k] - t;
+                z[i + k] += t;
+            }
+        }
+    }
+}
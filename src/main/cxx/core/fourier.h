@@ -0,0 +1,82 @@
+/// @file fourier.h
+/// Fast Fourier transform.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_FOURIER_H
+#define ESPECIA_FOURIER_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "base.h"
+
+namespace especia {
+
+    /// The radix-2 fast Fourier transform (FFT) of complex data.
+    ///
+    /// Further reading:
+    ///
+    /// W. H. Press, S. A. Teukolsky, W. T. Vetterling, B. P. Flannery (2002).
+    ///  *Numerical Recipes in C: The Art of Scientific Computing.*
+    ///  Cambridge University Press, ISBN 0-521-75033-4.
+    ///
+    /// @remark This class is thread safe.
+    class Fourier_Transform {
+    public:
+        /// Creates a new Fourier transform of a given size.
+        ///
+        /// @param[in] n The size of the transform. Must be a power of two.
+        ///
+        /// @throw std::invalid_argument if the size of the transform is not a power of two.
+        explicit Fourier_Transform(size_t n);
+
+        /// The destructor.
+        ~Fourier_Transform();
+
+        /// Returns the size of the transform.
+        ///
+        /// @return the size of the transform.
+        size_t size() const {
+            return n;
+        }
+
+        /// Computes the forward transform in place.
+        ///
+        /// @param[in,out] z The data to be transformed.
+        void forward(std::complex<real> z[]) const;
+
+        /// Computes the inverse transform in place. The inverse transform is not normalized,
+        /// i.e. applying the forward and inverse transform multiplies the data by the size
+        /// of the transform.
+        ///
+        /// @param[in,out] z The data to be transformed.
+        void inverse(std::complex<real> z[]) const;
+
+        /// Returns the smallest power of two, which is not less than a given number.
+        ///
+        /// @param[in] k The number.
+        /// @return the smallest power of two not less than @c k.
+        static size_t power_of_two(size_t k);
+
+    private:
+        /// Computes the transform in place.
+        ///
+        /// @param[in,out] z The data to be transformed.
+        /// @param[in] sign The sign of the exponent.
+        void transform(std::complex<real> z[], int sign) const;
+
+        /// The size of the transform.
+        const size_t n;
+
+        /// The bit-reversal permutation.
+        std::vector<size_t> permutation;
+
+        /// The twiddle factors exp(-2 pi i k / n) for k = 0, ..., n/2 - 1.
+        std::vector<std::complex<real>> twiddles;
+    };
+
+}
+
+#endif // ESPECIA_FOURIER_H
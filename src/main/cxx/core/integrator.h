@@ -8,13 +8,38 @@
 
 #include <algorithm>
 #include <cmath>
-#include <valarray>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "base.h"
 
 namespace especia {
 
+    /// Tests if an integrand provides the batch evaluation
+    ///
+    /// @c evaluate(x, y, n) evaluating the integrand at @c n abscissa values @c x.
+    ///
+    /// @tparam F The integrand type.
+    /// @tparam T The number type.
+    template<class F, class T>
+    class Is_Batched {
+    private:
+        template<class G>
+        static auto test(const G *g) -> decltype(g->evaluate(static_cast<const T *>(nullptr),
+                                                             static_cast<T *>(nullptr), size_t(0)),
+                std::true_type());
+
+        template<class G>
+        static std::false_type test(...);
+
+    public:
+        /// Is @c true if the integrand type provides the batch evaluation.
+        static const bool value = decltype(test<F>(nullptr))::value;
+    };
+
     /// Numerical integration by means of recursive monotone stable quadrature
     /// formulas.
     ///
@@ -62,7 +87,8 @@ namespace especia {
         ///
         /// @tparam F The integrand type.
         ///
-        /// @param[in] f The integrand.
+        /// @param[in] f The integrand. If the integrand provides the batch evaluation @c evaluate(x, y, n),
+        /// all quadrature points of a part are evaluated at once.
         /// @param[in] a The lower limit of integration.
         /// @param[in] b The upper limit of integration.
         /// @param[in] accuracy_goal The (absolute) accuracy goal.
@@ -70,7 +96,7 @@ namespace especia {
         /// @return the value of the integral.
         template<class F>
         T integrate(const F &f, T a, T b, T accuracy_goal = T(1.0E-6), natural max_iteration = 100) const {
-            Integrator::Partition<F, Integrator::Part<F>> partition(f, a, b, p, q);
+            Integrator::Partition<F, Integrator::Part<F>> partition(f, a, b, p, q, 2 * max_iteration + 1);
 
             for (natural i = 0; i < max_iteration; ++i) {
                 if (partition.absolute_error() < accuracy_goal) {
@@ -99,10 +125,7 @@ namespace especia {
         /// @f[ \lim_{x\to\infty} \frac{f(x)}{x} = 0 @f].
         template<class F>
         T integrate_positive_infinite(const F &f, T accuracy_goal = T(1.0E-6), natural max_iteration = 100) const {
-            using std::log;
-
-            return integrate([&f](T u) -> T { return u > T(0.0) ? f(-log(u)) / u : T(0.0); }, // infinity maps to zero
-                             T(0.0), T(1.0), accuracy_goal, max_iteration);
+            return integrate(Transformed<F>(f), T(0.0), T(1.0), accuracy_goal, max_iteration);
         }
 
         /// Computes the value of the negative-infinite integral of a function, i.e.
@@ -119,7 +142,7 @@ namespace especia {
         /// @f[ \lim_{x\to -\infty} \frac{f(x)}{x} = 0 @f].
         template<class F>
         T integrate_negative_infinite(const F &f, T accuracy_goal = T(1.0E-6), natural max_iteration = 100) const {
-            return integrate_positive_infinite([&f](T x) -> T { return f(-x); }, accuracy_goal, max_iteration);
+            return integrate_positive_infinite(Reflected<F>(f), accuracy_goal, max_iteration);
         }
 
         /// Computes the value of the infinite integral of a function, i.e.
@@ -141,6 +164,177 @@ namespace especia {
         }
 
     private:
+        /// The maximum number of integrand values evaluated at once.
+        static const natural batch_size = 42;
+
+        /// Evaluates an integrand at many abscissa values by means of its batch evaluation.
+        ///
+        /// @tparam F The integrand type.
+        ///
+        /// @param[in] f The integrand.
+        /// @param[in] x The abscissa values.
+        /// @param[out] y The integrand values.
+        /// @param[in] n The number of abscissa values.
+        template<class F>
+        static void evaluate(const F &f, const T x[], T y[], natural n, std::true_type) {
+            f.evaluate(x, y, n);
+        }
+
+        /// Evaluates an integrand at many abscissa values one by one.
+        ///
+        /// @tparam F The integrand type.
+        ///
+        /// @param[in] f The integrand.
+        /// @param[in] x The abscissa values.
+        /// @param[out] y The integrand values.
+        /// @param[in] n The number of abscissa values.
+        template<class F>
+        static void evaluate(const F &f, const T x[], T y[], natural n, std::false_type) {
+            for (natural i = 0; i < n; ++i) {
+                y[i] = f(x[i]);
+            }
+        }
+
+        /// Evaluates an integrand at many abscissa values.
+        ///
+        /// @tparam F The integrand type.
+        ///
+        /// @param[in] f The integrand.
+        /// @param[in] x The abscissa values.
+        /// @param[out] y The integrand values.
+        /// @param[in] n The number of abscissa values.
+        template<class F>
+        static void evaluate(const F &f, const T x[], T y[], natural n) {
+            evaluate(f, x, y, n, std::integral_constant<bool, Is_Batched<F, T>::value>());
+        }
+
+        /// The integrand of a positive-infinite integral after the variable transformation
+        /// @f$ u = \exp(-x) @f$.
+        ///
+        /// @tparam F The original integrand type.
+        template<class F>
+        class Transformed {
+        public:
+            /// The constructor.
+            ///
+            /// @param f The original integrand.
+            explicit Transformed(const F &f) : f(f) {
+            }
+
+            /// Returns the value of this integrand.
+            ///
+            /// @param u The abscissa value.
+            /// @return the value of this integrand at @c u.
+            T operator()(T u) const {
+                using std::log;
+
+                return u > T(0.0) ? f(-log(u)) / u : T(0.0); // infinity maps to zero
+            }
+
+            /// Returns the values of this integrand.
+            ///
+            /// @param u The abscissa values.
+            /// @param y The values of this integrand at @c u.
+            /// @param n The number of abscissa values.
+            void evaluate(const T u[], T y[], size_t n) const {
+                using std::log;
+
+                T x[batch_size];
+                for (size_t i = 0; i < n; ++i) {
+                    x[i] = u[i] > T(0.0) ? -log(u[i]) : T(0.0);
+                }
+                Integrator::evaluate(f, x, y, static_cast<natural>(n));
+                for (size_t i = 0; i < n; ++i) {
+                    y[i] = u[i] > T(0.0) ? y[i] / u[i] : T(0.0);
+                }
+            }
+
+        private:
+            /// The original integrand.
+            const F &f;
+        };
+
+        /// The integrand reflected at the origin.
+        ///
+        /// @tparam F The original integrand type.
+        template<class F>
+        class Reflected {
+        public:
+            /// The constructor.
+            ///
+            /// @param f The original integrand.
+            explicit Reflected(const F &f) : f(f) {
+            }
+
+            /// Returns the value of this integrand.
+            ///
+            /// @param x The abscissa value.
+            /// @return the value of this integrand at @c x.
+            T operator()(T x) const {
+                return f(-x);
+            }
+
+            /// Returns the values of this integrand.
+            ///
+            /// @param x The abscissa values.
+            /// @param y The values of this integrand at @c x.
+            /// @param n The number of abscissa values.
+            void evaluate(const T x[], T y[], size_t n) const {
+                T z[batch_size];
+                for (size_t i = 0; i < n; ++i) {
+                    z[i] = -x[i];
+                }
+                Integrator::evaluate(f, z, y, static_cast<natural>(n));
+            }
+
+        private:
+            /// The original integrand.
+            const F &f;
+        };
+
+        /// An arena of objects, which are allocated in a single block of storage and destroyed
+        /// all at once, when the arena is destroyed.
+        ///
+        /// @tparam P The object type.
+        template<class P>
+        class Arena {
+        public:
+            /// The constructor.
+            ///
+            /// @param capacity The maximum number of objects.
+            explicit Arena(natural capacity) : storage(capacity) {
+            }
+
+            /// The destructor.
+            ~Arena() {
+                for (natural i = 0; i < size; ++i) {
+                    reinterpret_cast<P *>(&storage[i])->~P();
+                }
+            }
+
+            Arena(const Arena &) = delete;
+
+            Arena &operator=(const Arena &) = delete;
+
+            /// Creates a new object in this arena.
+            ///
+            /// @tparam Args The constructor argument types.
+            ///
+            /// @param args The constructor arguments.
+            /// @return a pointer to the new object.
+            template<class... Args>
+            P *create(Args &&... args) {
+                return new(&storage.at(size++)) P(std::forward<Args>(args)...);
+            }
+
+        private:
+            /// The storage.
+            std::vector<typename std::aligned_storage<sizeof(P), alignof(P)>::type> storage;
+
+            /// The number of objects created.
+            natural size = 0;
+        };
+
         /// A part of a numerical integral.
         ///
         /// @tparam F The integrand type.
@@ -155,7 +349,7 @@ namespace especia {
             /// @param p The formula with less quadrature points.
             /// @param q The formula with more quadrature points.
             Part(const F &f, T a, T b, Formula p, Formula q)
-                    : f(f), a(a), b(b), p(p), q(q), c(T(0.5) * (a + b)), h(T(0.5) * (b - a)), yl(21), yu(21) {
+                    : f(f), a(a), b(b), p(p), q(q), c(T(0.5) * (a + b)), h(T(0.5) * (b - a)) {
                 evaluate();
             }
 
@@ -178,9 +372,10 @@ namespace especia {
 
             /// Creates a new part from the lower half of this part.
             ///
+            /// @param arena The arena to allocate the new part.
             /// @return the lower half part.
-            Part *new_lower_part() const {
-                auto *part = new Part(this, a, c);
+            Part *new_lower_part(Arena<Part> &arena) const {
+                Part *part = arena.create(this, a, c);
 
                 part->yu[0] = yl[2];
                 part->yu[1] = yl[7];
@@ -228,9 +423,10 @@ namespace especia {
 
             /// Creates a new part from the upper half of this part.
             ///
+            /// @param arena The arena to allocate the new part.
             /// @return the upper half part.
-            Part *new_upper_part() const {
-                auto *part = new Part(this, c, b);
+            Part *new_upper_part(Arena<Part> &arena) const {
+                Part *part = arena.create(this, c, b);
 
                 part->yl[0] = yu[2];
                 part->yl[1] = yu[7];
@@ -284,7 +480,7 @@ namespace especia {
             /// @param b The upper limit of integration.
             Part(const Part *parent, T a, T b)
                     : f(parent->f), a(a), b(b), p(parent->p), q(parent->q),
-                      c(T(0.5) * (a + b)), h(T(0.5) * (b - a)), yl(21), yu(21) {
+                      c(T(0.5) * (a + b)), h(T(0.5) * (b - a)) {
                 // do not evaluate
             }
 
@@ -304,17 +500,29 @@ namespace especia {
                 const natural m = Integrator::mw[q];
                 const natural n = Integrator::nw[q];
 
-                T result = T(0.0);
-#ifdef _OPENMP
-#pragma omp parallel for reduction(+:result)
-#endif
-                for (natural i = 0; i < n; ++i) {
-                    if (i >= nl) {
-                        yl[i] = f(c - h * Integrator::xi[i]);
+                // The integrand values not known yet are evaluated at once
+                T x[batch_size];
+                T y[batch_size];
+                natural k = 0;
+                for (natural i = nl; i < n; ++i) {
+                    x[k++] = c - h * Integrator::xi[i];
+                }
+                for (natural i = nu; i < n; ++i) {
+                    x[k++] = c + h * Integrator::xi[i];
+                }
+                if (k > 0) {
+                    Integrator::evaluate(f, x, y, k);
+                    k = 0;
+                    for (natural i = nl; i < n; ++i) {
+                        yl[i] = y[k++];
                     }
-                    if (i >= nu) {
-                        yu[i] = f(c + h * Integrator::xi[i]);
+                    for (natural i = nu; i < n; ++i) {
+                        yu[i] = y[k++];
                     }
+                }
+
+                T result = T(0.0);
+                for (natural i = 0; i < n; ++i) {
                     result += (yl[i] + yu[i]) * Integrator::wi[m + i];
                 }
                 if (nl < n) {
@@ -349,10 +557,10 @@ namespace especia {
             const T h;
 
             /// The integrand values for the lower half interval of integration.
-            std::valarray<T> yl;
+            T yl[21];
 
             /// The integrand values for the upper half interval of integration.
-            std::valarray<T> yu;
+            T yu[21];
 
             /// The number of evaluated integrand values for the lower half interval.
             natural nl = 0;
@@ -365,6 +573,8 @@ namespace especia {
 
             /// The integration result.
             T res = T(0.0);
+
+            friend class Arena<Part>;
         };
 
         /// Compares the absolute error of two parts of a numerical integration.
@@ -397,21 +607,15 @@ namespace especia {
             /// @param b The upper limit of integration.
             /// @param p The formula with less quadrature points.
             /// @param q The formula with more quadrature points.
-            Partition(const F &f, T a, T b, Formula p, Formula q) : part_compare(Part_Compare<P>()) {
-                using std::make_heap;
-                using std::push_heap;
-
-                auto *part = new P(f, a, b, p, q);
-                make_heap(parts.begin(), parts.end(), part_compare);
-                add_part(part);
+            /// @param capacity The maximum number of parts created, including refined parts.
+            Partition(const F &f, T a, T b, Formula p, Formula q, natural capacity)
+                    : part_compare(Part_Compare<P>()), arena(capacity) {
+                parts.reserve(capacity);
+                add_part(arena.create(f, a, b, p, q));
             }
 
             /// The destructor.
-            ~Partition() { // NOLINT
-                for (auto part : parts) {
-                    delete part;
-                }
-            }
+            ~Partition() = default;
 
             /// Returns the absolute error of the integration result for this partition.
             ///
@@ -441,11 +645,10 @@ namespace especia {
 
             /// Refines this partition.
             void refine() {
-                P *popped = pop_part();
-                add_part(popped->new_lower_part());
-                add_part(popped->new_upper_part());
-
-                delete popped;
+                // The part popped remains in the arena
+                const P *popped = pop_part();
+                add_part(popped->new_lower_part(arena));
+                add_part(popped->new_upper_part(arena));
             }
 
         private:
@@ -475,6 +678,9 @@ namespace especia {
             /// Compares the absolute error of integration of two parts.
             const Part_Compare<P> part_compare;
 
+            /// The arena of all parts created.
+            Arena<P> arena;
+
             /// The parts of this partition.
             std::vector<P *> parts{};
         };
@@ -0,0 +1,154 @@
+/// @file matrix.cxx
+/// Dense matrix operations calling the BLAS and LAPACK routines.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <algorithm>
+
+#include "matrix.h"
+
+using especia::integer;
+using especia::natural;
+using especia::real;
+
+
+#define BLAS_NAME_DOUBLE(x) d##x##_
+#define BLAS_NAME_SINGLE(x) s##x##_
+#define BLAS_NAME_R_TYPE(x) BLAS_NAME_DOUBLE(x)
+
+extern "C" {
+/// Interface to BLAS routine @c [DS]GEMM.
+void BLAS_NAME_R_TYPE(gemm)(const char &transa,
+                            const char &transb,
+                            const integer &m,
+                            const integer &n,
+                            const integer &k,
+                            const real &alpha,
+                            const real A[],
+                            const integer &lda,
+                            const real B[],
+                            const integer &ldb,
+                            const real &beta,
+                            real C[],
+                            const integer &ldc);
+
+/// Interface to BLAS routine @c [DS]SYRK.
+void BLAS_NAME_R_TYPE(syrk)(const char &uplo,
+                            const char &trans,
+                            const integer &n,
+                            const integer &k,
+                            const real &alpha,
+                            const real A[],
+                            const integer &lda,
+                            const real &beta,
+                            real C[],
+                            const integer &ldc);
+
+/// Interface to BLAS routine @c [DS]SYR.
+void BLAS_NAME_R_TYPE(syr)(const char &uplo,
+                           const integer &n,
+                           const real &alpha,
+                           const real x[],
+                           const integer &incx,
+                           real A[],
+                           const integer &lda);
+}
+
+#define LAPACK_NAME_DOUBLE(x) d##x##_
+#define LAPACK_NAME_SINGLE(x) s##x##_
+#define LAPACK_NAME_R_TYPE(x) LAPACK_NAME_DOUBLE(x)
+
+extern "C" {
+/// Interface to LAPACK routine @c [DS]POSV.
+void LAPACK_NAME_R_TYPE(posv)(const char &uplo,
+                              const integer &n,
+                              const integer &nrhs,
+                              real A[],
+                              const integer &lda,
+                              real B[],
+                              const integer &ldb,
+                              integer &info);
+
+/// Interface to LAPACK routine @c [DS]POTRF.
+void LAPACK_NAME_R_TYPE(potrf)(const char &uplo,
+                               const integer &n,
+                               real A[],
+                               const integer &lda,
+                               integer &info);
+
+/// Interface to LAPACK routine @c [DS]POTRI.
+void LAPACK_NAME_R_TYPE(potri)(const char &uplo,
+                               const integer &n,
+                               real A[],
+                               const integer &lda,
+                               integer &info);
+}
+
+/// The BLAS transpose parameter (here: do not transpose).
+static const char no_trans = 'N';
+
+/// The BLAS matrix store parameter (here: use the upper triangular part).
+static const char uplo = 'U';
+
+void especia::multiply(const natural m, const natural n, const natural k, const real A[], const real B[], real C[]) {
+    if (m > 0 and n > 0 and k > 0) {
+        const auto im = integer(m);
+        const auto in = integer(n);
+        const auto ik = integer(k);
+
+        BLAS_NAME_R_TYPE(gemm)(no_trans, no_trans, im, in, ik, 1.0, A, im, B, ik, 0.0, C, im);
+    } else {
+        std::fill(C, C + m * n, 0.0);
+    }
+}
+
+void especia::rank_k_update(const natural n, const natural k, const real alpha, const real A[], const real beta,
+                            real C[]) {
+    if (n > 0) {
+        const auto in = integer(n);
+        const auto ik = integer(k);
+
+        BLAS_NAME_R_TYPE(syrk)(uplo, no_trans, in, ik, alpha, A, in, beta, C, in);
+    }
+}
+
+void especia::rank_1_update(const natural n, const real alpha, const real x[], real C[]) {
+    if (n > 0) {
+        const auto in = integer(n);
+
+        BLAS_NAME_R_TYPE(syr)(uplo, in, alpha, x, 1, C, in);
+    }
+}
+
+bool especia::solve(const natural n, real A[], real b[]) {
+    integer info = 0;
+
+    if (n > 0) {
+        const auto in = integer(n);
+
+        LAPACK_NAME_R_TYPE(posv)(uplo, in, 1, A, in, b, in, info);
+    }
+    return info == 0;
+}
+
+bool especia::invert(const natural n, real A[]) {
+    integer info = 0;
+
+    if (n > 0) {
+        const auto in = integer(n);
+
+        LAPACK_NAME_R_TYPE(potrf)(uplo, in, A, in, info);
+        if (info == 0) {
+            LAPACK_NAME_R_TYPE(potri)(uplo, in, A, in, info);
+        }
+    }
+    return info == 0;
+}
+
+#undef LAPACK_NAME_R_TYPE
+#undef LAPACK_NAME_SINGLE
+#undef LAPACK_NAME_DOUBLE
+
+#undef BLAS_NAME_R_TYPE
+#undef BLAS_NAME_SINGLE
+#undef BLAS_NAME_DOUBLE
@@ -0,0 +1,67 @@
+/// @file matrix.h
+/// Dense matrix operations calling the BLAS and LAPACK routines.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_MATRIX_H
+#define ESPECIA_MATRIX_H
+
+#include "base.h"
+
+namespace especia {
+
+    /// Computes the matrix product @c C = A B by means of the BLAS routine @c DGEMM.
+    /// All matrices are stored in column-major layout.
+    ///
+    /// @param[in] m The number of rows of @c A and @c C.
+    /// @param[in] n The number of columns of @c B and @c C.
+    /// @param[in] k The number of columns of @c A and rows of @c B.
+    /// @param[in] A The left factor matrix.
+    /// @param[in] B The right factor matrix.
+    /// @param[out] C The product matrix.
+    void multiply(natural m, natural n, natural k, const real A[], const real B[], real C[]);
+
+    /// Computes the symmetric rank-k update @c C = alpha A A' + beta C by means of the BLAS
+    /// routine @c DSYRK. All matrices are stored in column-major layout. Only the upper
+    /// triangular part of @c C is referenced.
+    ///
+    /// @param[in] n The number of rows and columns of @c C and rows of @c A.
+    /// @param[in] k The number of columns of @c A.
+    /// @param[in] alpha The scaling factor of the update.
+    /// @param[in] A The update matrix.
+    /// @param[in] beta The scaling factor of the matrix updated.
+    /// @param[in,out] C The matrix updated.
+    void rank_k_update(natural n, natural k, real alpha, const real A[], real beta, real C[]);
+
+    /// Computes the symmetric rank-1 update @c C = alpha x x' + C by means of the BLAS
+    /// routine @c DSYR. The matrix is stored in column-major layout. Only the upper
+    /// triangular part of @c C is referenced.
+    ///
+    /// @param[in] n The number of rows and columns of @c C.
+    /// @param[in] alpha The scaling factor of the update.
+    /// @param[in] x The update vector.
+    /// @param[in,out] C The matrix updated.
+    void rank_1_update(natural n, real alpha, const real x[], real C[]);
+
+    /// Solves the symmetric positive definite linear system @c A x = b by means of the LAPACK
+    /// routine @c DPOSV. The matrix is stored in column-major layout. Only the upper triangular
+    /// part of @c A is referenced.
+    ///
+    /// @param[in] n The number of rows and columns of @c A.
+    /// @param[in,out] A The matrix. On exit, the Cholesky factor of the matrix.
+    /// @param[in,out] b The right-hand side. On exit, the solution.
+    /// @return @c true, if the matrix is positive definite.
+    bool solve(natural n, real A[], real b[]);
+
+    /// Inverts a symmetric positive definite matrix by means of the LAPACK routines @c DPOTRF
+    /// and @c DPOTRI. The matrix is stored in column-major layout. Only the upper triangular
+    /// part of @c A is referenced.
+    ///
+    /// @param[in] n The number of rows and columns of @c A.
+    /// @param[in,out] A The matrix. On exit, the upper triangular part of the inverse matrix.
+    /// @return @c true, if the matrix is positive definite.
+    bool invert(natural n, real A[]);
+
+}
+
+#endif // ESPECIA_MATRIX_H
@@ -7,11 +7,14 @@
 #define ESPECIA_MODEL_H
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <valarray>
@@ -22,6 +25,9 @@
 #include "profiles.h"
 #include "readline.h"
 #include "section.h"
+#include "spectrum.h"
+#include "telemetry.h"
+#include "threads.h"
 
 namespace especia {
 
@@ -63,6 +69,54 @@ namespace especia {
                 return false;
             }
 
+            /// Tests if a given parameter value violates its bounds.
+            ///
+            /// @param[in] i The parameter index.
+            /// @param[in] x The parameter value.
+            /// @return @c true, if the parameter value violates its bounds.
+            bool is_violated(natural i, const T &x) const {
+                return x < a[i] || x > b[i];
+            }
+
+            /// Reflects a given parameter vector into the feasible box. A parameter value, which
+            /// exceeds a bound, is mirrored at the bound, repeatedly if necessary.
+            ///
+            /// @param[in,out] x The parameter vector.
+            /// @param[in] n The number of parameters.
+            void reflect(T x[], natural n) const {
+                using std::fmod;
+
+                for (natural i = 0; i < n; ++i) {
+                    if (x[i] < a[i] || x[i] > b[i]) {
+                        const T w = b[i] - a[i];
+
+                        if (w > T(0)) {
+                            T t = fmod(x[i] - a[i], T(2) * w);
+                            if (t < T(0)) {
+                                t += T(2) * w;
+                            }
+                            x[i] = t <= w ? a[i] + t : b[i] - (t - w);
+                        } else {
+                            x[i] = a[i];
+                        }
+                    }
+                }
+            }
+
+            /// Projects a given parameter vector onto the feasible box.
+            ///
+            /// @param[in,out] x The parameter vector.
+            /// @param[in] n The number of parameters.
+            void repair(T x[], natural n) const {
+                for (natural i = 0; i < n; ++i) {
+                    if (x[i] < a[i]) {
+                        x[i] = a[i];
+                    } else if (x[i] > b[i]) {
+                        x[i] = b[i];
+                    }
+                }
+            }
+
             /// Computes the cost associated with the constraint.
             ///
             /// @param[in] x The parameter vector.
@@ -110,6 +164,7 @@ namespace especia {
 
             map<string, natural> profile_name_map;
             map<string, natural> section_name_map;
+            map<string, shared_ptr<const Spectrum>> spectrum_map;
 
             vector<string> ref;
 
@@ -117,6 +172,9 @@ namespace especia {
             stringstream st;
             string line;
 
+            // A large buffer for reading the data files in big chunks
+            vector<char> buffer(1 << 20);
+
             os << "<!DOCTYPE html>\n";
             os << "<html>\n";
             os << "<!--\n";
@@ -156,28 +214,49 @@ namespace especia {
                             if (section_name_map.find(sid) == section_name_map.end()) {
                                 section_name_map[sid] = sections.size();
 
-                                ifstream ifs(fn.c_str());
+                                shared_ptr<const Spectrum> &spectrum = spectrum_map[fn];
+
+                                // Read each data file only once
+                                if (!spectrum and spectrum_cache) {
+                                    spectrum = spectrum_cache->find(fn);
+                                }
+                                if (!spectrum) {
+                                    ifstream ifs;
+                                    ifs.rdbuf()->pubsetbuf(buffer.data(), static_cast<streamsize>(buffer.size()));
+                                    ifs.open(fn.c_str());
+
+                                    if (!ifs) {
+                                        is.setstate(ios_base::badbit | ios_base::failbit);
+                                        cerr << errmsg << fn << ": " << fnfmsg << endl;
 
-                                if (ifs) {
-                                    especia::Section s;
+                                        return is;
+                                    }
 
-                                    if (s.get(ifs, a, b)) {
-                                        istringstream is2(s2);
-                                        while (is2 >> a >> b)
-                                            s.mask(a, b);
+                                    shared_ptr<Spectrum> data(new Spectrum());
 
-                                        sections.push_back(s);
-                                        isc.push_back(i);
-                                        nle.push_back(p);
+                                    if (Spectrum::is_binary(fn) ? data->map(fn) : static_cast<bool>(data->get(ifs))) {
+                                        spectrum = spectrum_cache ? spectrum_cache->insert(fn, data) : data;
                                     } else {
                                         is.setstate(ios_base::badbit | ios_base::failbit);
                                         cerr << errmsg << fn << ": " << infmsg << endl;
 
                                         return is;
                                     }
+                                }
+
+                                especia::Section s(*spectrum, a, b);
+
+                                if (s.data_count() > 0) {
+                                    istringstream is2(s2);
+                                    while (is2 >> a >> b)
+                                        s.mask(a, b);
+
+                                    sections.push_back(s);
+                                    isc.push_back(i);
+                                    nle.push_back(p);
                                 } else {
                                     is.setstate(ios_base::badbit | ios_base::failbit);
-                                    cerr << errmsg << fn << ": " << fnfmsg << endl;
+                                    cerr << errmsg << fn << ": " << infmsg << endl;
 
                                     return is;
                                 }
@@ -353,6 +432,8 @@ namespace especia {
                 this->section_name_map = section_name_map;
                 this->profile_name_map = profile_name_map;
 
+                this->revision = next_revision();
+
                 is.clear(is.rdstate() & ~ios_base::failbit);
             } else
                 is.setstate(ios_base::badbit | ios_base::failbit);
@@ -360,7 +441,7 @@ namespace especia {
             return is;
         }
 
-        std::ostream &put(std::ostream &os) const {
+        std::ostream &put(std::ostream &os, const Thread_Pool &pool) const {
             using namespace std;
 
             typedef map<string, natural>::const_iterator id_index_map_ci;
@@ -445,7 +526,18 @@ namespace especia {
 
             const Equivalent_Width_Calculator<Integrator<real>> calculator;
 
+            // The equivalent widths of all lines are calculated in parallel, one line per thread
+            vector<natural> indexes;
             for (auto i = profile_name_map.begin(); i != profile_name_map.end(); ++i) {
+                indexes.push_back(i->second);
+            }
+            vector<real> equivalent_widths(indexes.size());
+            pool.for_each(static_cast<natural>(indexes.size()), [&](natural k) {
+                equivalent_widths[k] = calculator.calculate(Function(&val[indexes[k]]), milli);
+            }, 1);
+
+            natural k = 0;
+            for (auto i = profile_name_map.begin(); i != profile_name_map.end(); ++i, ++k) {
                 const natural j = i->second;
                 const string id = i->first;
 
@@ -458,7 +550,7 @@ namespace especia {
                 const real dz = err[j + 2];
                 const real dv = err[j + 3];
                 const real dw = dx + x * sqrt(sq((1.0 + v / c) * dz) + sq((1.0 + z) * dv / c));
-                const real ew = calculator.calculate(Function(&val[j]), milli);
+                const real ew = equivalent_widths[k];
 
                 os.precision(4);
 
@@ -513,6 +605,14 @@ namespace especia {
             return os;
         }
 
+        /// Writes the data sections to an output stream in binary format.
+        ///
+        /// @param[in,out] os The output stream.
+        /// @return the output stream.
+        std::ostream &write_data(std::ostream &os) const {
+            return write(os, sections);
+        }
+
         real operator()(const real x[], natural n) const {
             return cost(x, n);
         }
@@ -532,19 +632,167 @@ namespace especia {
         }
 
         real cost(const real x[], natural n) const {
-            using std::valarray;
+            real d = 0.0;
+            for (natural i = 0; i < sections.size(); ++i) {
+                d += cost(x, n, i);
+            }
+            return d;
+        }
 
-            valarray<real> y = val;
-            for (natural i = 0; i < y.size(); ++i) {
-                if (msk[i]) {
-                    y[i] = x[ind[i]];
+        real cost(const real x[], natural n, natural i) const {
+            // Per-thread scratch space, which is reused by subsequent calls
+            static thread_local std::vector<real> y;
+            static thread_local Superposition<Function> superposition;
+
+            get_section_parameters(x, i, y);
+
+            // A section depends on its own parameters only, so its cost is recomputed only if these
+            // parameters have changed since the recent evaluation of this section by the calling thread
+            Memo &memo = memo_of_thread();
+            if (memo.revision != revision) {
+                memo.revision = revision;
+                memo.y.assign(sections.size(), std::vector<real>());
+                memo.cost.assign(sections.size(), 0.0);
+            }
+            std::vector<real> &memo_y = memo.y[i];
+            if (memo_y != y) {
+                if (telemetry) {
+                    const Telemetry::Clock::time_point start = Telemetry::Clock::now();
+
+                    memo.cost[i] = sections[i].cost(superposition.assign(nli[i], &y[1]), y[0], nle[i]);
+                    telemetry->add_section_time(i, Telemetry::Clock::now() - start);
+                } else {
+                    memo.cost[i] = sections[i].cost(superposition.assign(nli[i], &y[1]), y[0], nle[i]);
                 }
+                memo_y = y;
             }
-            real d = 0.0;
+            return memo.cost[i];
+        }
+
+        /// Returns the cost of many parameter vectors.
+        ///
+        /// @param[in] x The parameter vectors, stored in a single column-major block.
+        /// @param[in] n The number of parameter values.
+        /// @param[in] lambda The number of parameter vectors.
+        /// @param[out] y The cost of each parameter vector.
+        ///
+        /// @remark The sections are processed in the outer loop, so the data and the line spread
+        /// function of each section are reused for all parameter vectors. The cost is the same as
+        /// computed for each parameter vector separately. The parameter vectors are evaluated one
+        /// after another, not in vector lanes. Vector lanes are mapped to the wavelengths of each
+        /// profile instead, when SIMD vectorization is enabled.
+        void cost_batch(const real x[], natural n, natural lambda, real y[]) const {
+            std::fill(y, y + lambda, 0.0);
             for (natural i = 0; i < sections.size(); ++i) {
-                d += sections[i].cost(Superposition<Function>(nli[i], &y[isc[i] + 1]), y[isc[i]], nle[i]);
+                for (natural k = 0; k < lambda; ++k) {
+                    y[k] += cost(&x[static_cast<size_t>(k) * n], n, i);
+                }
+            }
+        }
+
+        /// Returns the cost of a section for many parameter vectors.
+        ///
+        /// @param[in] x The parameter vectors, stored in a single column-major block.
+        /// @param[in] n The number of parameter values.
+        /// @param[in] lambda The number of parameter vectors.
+        /// @param[in] i The section index.
+        /// @param[out] y The cost of the section for each parameter vector.
+        void cost_batch(const real x[], natural n, natural lambda, natural i, real y[]) const {
+            for (natural k = 0; k < lambda; ++k) {
+                y[k] = cost(&x[static_cast<size_t>(k) * n], n, i);
             }
-            return d;
+        }
+
+        /// Returns the number of residuals, i.e. the number of valid data points of all sections.
+        ///
+        /// @return the number of residuals.
+        natural get_residual_count() const {
+            size_t count = 0;
+
+            for (const auto &section : sections) {
+                count += section.valid_data_count();
+            }
+
+            return static_cast<natural>(count);
+        }
+
+        /// Computes the residuals of the valid data points of all sections, ordered by section. Half
+        /// the sum of the squared residuals is the cost.
+        ///
+        /// @param[in] x The parameter values.
+        /// @param[in] n The number of parameter values.
+        /// @param[out] z The residuals.
+        void residuals(const real x[], natural n, real z[]) const {
+            static thread_local std::vector<real> y;
+            static thread_local Superposition<Function> superposition;
+
+            for (natural i = 0; i < sections.size(); ++i) {
+                get_section_parameters(x, i, y);
+                sections[i].residuals(superposition.assign(nli[i], &y[1]), y[0], nle[i], z);
+                z += sections[i].valid_data_count();
+            }
+        }
+
+        /// Returns a lower bound of the cost of a section, which is computed for a stratified
+        /// subset of the valid data points of the section (see @c Section::cost_bound()).
+        ///
+        /// @param[in] x The parameter values.
+        /// @param[in] n The number of parameter values.
+        /// @param[in] i The section index.
+        /// @return a lower bound of the cost of the section.
+        real cost_bound(const real x[], natural n, natural i) const {
+            static thread_local std::vector<real> y;
+            static thread_local Superposition<Function> superposition;
+
+            get_section_parameters(x, i, y);
+
+            return sections[i].cost_bound(superposition.assign(nli[i], &y[1]), y[0], nle[i], bound_stride);
+        }
+
+        /// Sets the number of valid data points per stratum to compute a lower bound of the cost
+        /// of a section.
+        ///
+        /// @param[in] stride The number of valid data points per stratum.
+        void set_bound_stride(natural stride) {
+            bound_stride = stride;
+        }
+
+        /// Times the cost calculation of each section by means of a telemetry collector.
+        ///
+        /// @param[in] t The telemetry collector, or @c nullptr to disable timing.
+        void set_telemetry(Telemetry *t) {
+            telemetry = t;
+        }
+
+        /// Shares the spectroscopic data read by this model with other models by means of a cache.
+        /// Each data file is read only once by all models sharing the cache.
+        ///
+        /// @param[in] c The cache, or @c nullptr to read the data files for this model only.
+        void set_spectrum_cache(Spectrum_Cache *c) {
+            spectrum_cache = c;
+        }
+
+        /// Moves the data of each section into the memory of the NUMA node, which the section is
+        /// assigned to by a pool of threads, so the section is evaluated with local memory access
+        /// by the threads on this node.
+        ///
+        /// @param[in] pool The pool of threads.
+        void localize(const Thread_Pool &pool) {
+            std::vector<natural> keys(sections.size());
+            for (natural i = 0; i < keys.size(); ++i) {
+                keys[i] = i;
+            }
+            pool.for_each_local(static_cast<natural>(keys.size()), keys.data(), 1, [this](natural i) {
+                sections[i].localize();
+            }, false);
+        }
+
+        natural get_partition_count() const {
+            return static_cast<natural>(sections.size());
+        }
+
+        real get_partition_weight(natural i) const {
+            return real(sections[i].data_count()) * real(nli[i] + 1);
         }
 
         natural get_parameter_count() const {
@@ -575,6 +823,34 @@ namespace especia {
             return z;
         }
 
+        /// Returns the names of the parameters optimized. The resolution of a section is named
+        /// by the section identifier followed by @c [r], the parameters of a profile function
+        /// are named by the line identifier followed by the parameter index in brackets.
+        ///
+        /// @return the parameter names.
+        std::vector<std::string> get_parameter_names() const {
+            std::vector<std::string> names(msk.size());
+
+            for (const auto &entry : section_name_map) {
+                names[isc[entry.second]] = entry.first + "[r]";
+            }
+            for (const auto &entry : profile_name_map) {
+                for (natural k = 0; k < Function::parameter_count(); ++k) {
+                    names[entry.second + k] = entry.first + "[" + std::to_string(k) + "]";
+                }
+            }
+
+            std::vector<std::string> parameter_names(get_parameter_count());
+
+            for (natural i = 0, j = 0; i < msk.size(); ++i) {
+                if (msk[i] and ind[i] == j) {
+                    parameter_names[j++] = names[i];
+                }
+            }
+
+            return parameter_names;
+        }
+
         Bounded_Constraint<real> get_constraint() const {
             std::valarray<real> a(get_parameter_count());
             std::valarray<real> b(get_parameter_count());
@@ -591,6 +867,53 @@ namespace especia {
         }
 
     private:
+        /// The recent section parameters and costs computed by a thread.
+        struct Memo {
+            /// The revision of the model, which has computed the section costs.
+            word64 revision = 0;
+
+            /// The recent section parameters.
+            std::vector<std::vector<real>> y;
+
+            /// The recent section costs.
+            std::vector<real> cost;
+        };
+
+        /// Returns the parameters of a section, i.e. the resolution followed by the line parameters.
+        ///
+        /// @param[in] x The parameter values optimized.
+        /// @param[in] i The section index.
+        /// @param[out] y The parameters of the section.
+        void get_section_parameters(const real x[], natural i, std::vector<real> &y) const {
+            const natural j = isc[i];
+            const natural k = j + 1 + nli[i] * Function::parameter_count();
+
+            y.assign(std::begin(val) + j, std::begin(val) + k);
+            for (natural l = j; l < k; ++l) {
+                if (msk[l]) {
+                    y[l - j] = x[ind[l]];
+                }
+            }
+        }
+
+        /// Returns the memo of the calling thread.
+        ///
+        /// @return the memo of the calling thread.
+        static Memo &memo_of_thread() {
+            static thread_local Memo memo;
+
+            return memo;
+        }
+
+        /// Returns a new revision number, which is unique for the process.
+        ///
+        /// @return a new revision number.
+        static word64 next_revision() {
+            static std::atomic<word64> revision_count(0);
+
+            return ++revision_count;
+        }
+
         std::ostream &put_parameter(std::ostream &os, std::ios_base::fmtflags f, natural p, real parameter) const {
             using namespace std;
 
@@ -639,6 +962,18 @@ namespace especia {
 
         std::map<std::string, natural> section_name_map;
         std::map<std::string, natural> profile_name_map;
+
+        /// The revision of this model. Changes, whenever a model is read.
+        word64 revision = next_revision();
+
+        /// The telemetry collector timing the cost calculation of sections, if any.
+        Telemetry *telemetry = nullptr;
+
+        /// The cache of spectroscopic data shared with other models, if any.
+        Spectrum_Cache *spectrum_cache = nullptr;
+
+        /// The number of valid data points per stratum to compute a lower bound of a section cost.
+        natural bound_stride = 16;
     };
 
 }
@@ -8,12 +8,19 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <future>
 #include <limits>
-#include <thread>
+#include <stdexcept>
+#include <type_traits>
 #include <valarray>
 #include <vector>
 
 #include "base.h"
+#include "cluster.h"
+#include "matrix.h"
+#include "telemetry.h"
+#include "threads.h"
 
 namespace especia {
 
@@ -49,6 +56,862 @@ namespace especia {
         const Compare &compare;
     };
 
+    /// Detects whether a function type is partitioned, i.e. whether the function value is the
+    /// sum of partial values, which can be evaluated independently. A partitioned function
+    /// type provides the methods
+    ///
+    /// @c get_partition_count() returning the number of partitions,
+    ///
+    /// @c get_partition_weight(i) returning the relative computational cost of partition @c i,
+    ///
+    /// @c cost(x, n, i) returning the partial value of partition @c i.
+    ///
+    /// @tparam F The function type.
+    template<class F>
+    class Is_Partitioned {
+    private:
+        template<class G>
+        static auto test(const G *g) -> decltype(g->get_partition_count(),
+                g->get_partition_weight(natural(0)),
+                g->cost(static_cast<const real *>(nullptr), natural(0), natural(0)),
+                std::true_type());
+
+        template<class G>
+        static std::false_type test(...);
+
+    public:
+        /// Is @c true if the function type is partitioned.
+        static const bool value = decltype(test<F>(nullptr))::value;
+    };
+
+    /// Detects whether a partitioned function type provides a lower bound of each partial value. A
+    /// bounded function type provides the method
+    ///
+    /// @c cost_bound(x, n, i) returning a lower bound of the partial value of partition @c i, which
+    /// is cheaper to compute than the partial value.
+    ///
+    /// @tparam F The function type.
+    template<class F>
+    class Is_Bounded {
+    private:
+        template<class G>
+        static auto test(const G *g) -> decltype(g->cost_bound(static_cast<const real *>(nullptr), natural(0), natural(0)),
+                std::true_type());
+
+        template<class G>
+        static std::false_type test(...);
+
+    public:
+        /// Is @c true if the function type is bounded.
+        static const bool value = decltype(test<F>(nullptr))::value;
+    };
+
+    /// Detects whether a function type is a least-squares function, i.e. whether the function
+    /// value is half the sum of squared residuals. A least-squares function type provides the
+    /// methods
+    ///
+    /// @c get_residual_count() returning the number of residuals,
+    ///
+    /// @c residuals(x, n, z) computing the residuals.
+    ///
+    /// @tparam F The function type.
+    template<class F>
+    class Is_Least_Squares {
+    private:
+        template<class G>
+        static auto test(const G *g) -> decltype(g->get_residual_count(),
+                g->residuals(static_cast<const real *>(nullptr), natural(0), static_cast<real *>(nullptr)),
+                std::true_type());
+
+        template<class G>
+        static std::false_type test(...);
+
+    public:
+        /// Is @c true if the function type is a least-squares function.
+        static const bool value = decltype(test<F>(nullptr))::value;
+    };
+
+    /// The strategies to handle offspring, which violate the constraint on parameter values.
+    enum class Boundary_Strategy {
+        /// Violating samples are rejected and redrawn.
+        rejection,
+        /// Like rejection, but each violating sample is mirrored at the parental mean first.
+        resampling,
+        /// Violating offspring are reflected into the feasible box.
+        reflection,
+        /// Violating offspring are projected onto the feasible box, and the fitness is penalized
+        /// in proportion to the squared projection distance.
+        repair
+    };
+
+    /// The termination criteria, which stop an optimization early, besides the accuracy goal,
+    /// the underflow of the mutation variance and the stop generation (Hansen, 2016, arXiv:1604.00772,
+    /// Sect. B.3).
+    enum class Termination {
+        /// No termination criterion is met.
+        none,
+        /// The range of the recent best fitness values is below the fitness tolerance (TolFun).
+        tol_fun,
+        /// The standard deviation of the mutation distribution is below the parameter tolerance
+        /// in all coordinates (TolX).
+        tol_x,
+        /// Adding a tenth of the standard deviation along a principal axis does not change the
+        /// distribution mean (NoEffectAxis).
+        no_effect_axis,
+        /// Adding a fifth of the standard deviation in any coordinate does not change the
+        /// distribution mean (NoEffectCoord).
+        no_effect_coordinate,
+        /// The condition number of the covariance matrix exceeds its limit (ConditionCov).
+        condition_cov,
+        /// Neither the best nor the median fitness have improved over many generations (Stagnation).
+        stagnation
+    };
+
+    /// The configuration of the termination criteria. All criteria are disabled by default.
+    struct Termination_Criteria {
+        /// The fitness tolerance (TolFun). Disabled, if zero.
+        real fitness_tolerance = 0.0;
+
+        /// The parameter tolerance (TolX). Disabled, if zero.
+        real parameter_tolerance = 0.0;
+
+        /// Whether to terminate, if a principal axis has no effect (NoEffectAxis).
+        bool no_effect_axis = false;
+
+        /// Whether to terminate, if a coordinate has no effect (NoEffectCoord).
+        bool no_effect_coordinate = false;
+
+        /// The maximum condition number of the covariance matrix (ConditionCov). Disabled, if zero.
+        /// Is effective below the condition number, to which the covariance matrix is limited anyway.
+        real max_condition = 0.0;
+
+        /// Whether to terminate on stagnation of the best and median fitness (Stagnation).
+        bool stagnation = false;
+
+        /// Returns whether the fitness history is needed to test the criteria.
+        ///
+        /// @return @c true, if the fitness history is needed.
+        bool is_history_needed() const {
+            return fitness_tolerance > 0.0 or stagnation;
+        }
+    };
+
+    /// The options of the evolution strategy, besides the strategy parameters.
+    struct Strategy_Options {
+        /// Whether to sample all offspring by means of a matrix product. When an offspring violates
+        /// the constraint, all its coordinates are sampled anew.
+        bool block_sampling = false;
+
+        /// Whether to adapt the covariance matrix by means of symmetric rank-k and rank-1 updates
+        /// calling the BLAS.
+        bool blas_update = false;
+
+        /// Whether to adapt a diagonal covariance matrix only (Ros & Hansen, 2008). The rotation
+        /// matrix remains the identity, sampling and adaption take linear time, and no eigenvalue
+        /// decomposition is performed. Overrides block sampling and the BLAS update.
+        bool separable = false;
+
+        /// Whether to perform the eigenvalue decomposition asynchronously, while the next population
+        /// is evaluated. The decomposition takes effect one generation later.
+        bool async_decompose = false;
+
+        /// Whether to evaluate the offspring by racing (see @c Evaluator::race()). Only the offspring,
+        /// which may be among the best parent number plus one, are evaluated exactly.
+        bool racing = false;
+
+        /// The boundary strategy.
+        Boundary_Strategy boundary_strategy = Boundary_Strategy::rejection;
+
+        /// The maximum number of samples rejected for an offspring.
+        natural rejection_limit = 1000;
+
+        /// The termination criteria.
+        Termination_Criteria criteria;
+
+        /// Whether the optimization is suspended at the stop generation and resumed later, e.g. to
+        /// write a checkpoint. Then a pending asynchronous decomposition is not installed.
+        bool suspend = false;
+    };
+
+    /// Detects whether a constraint type is a box constraint, which can move a parameter vector
+    /// into the feasible box. A box constraint type provides the methods
+    ///
+    /// @c reflect(x, n) reflecting the parameter values into the feasible box,
+    ///
+    /// @c repair(x, n) projecting the parameter values onto the feasible box.
+    ///
+    /// @tparam Constraint The constraint type.
+    template<class Constraint>
+    class Is_Box_Constraint {
+    private:
+        template<class G>
+        static auto test(const G *g) -> decltype(g->reflect(static_cast<real *>(nullptr), natural(0)),
+                g->repair(static_cast<real *>(nullptr), natural(0)),
+                std::true_type());
+
+        template<class G>
+        static std::false_type test(...);
+
+    public:
+        /// Is @c true if the constraint type is a box constraint.
+        static const bool value = decltype(test<Constraint>(nullptr))::value;
+    };
+
+    /// Reflects a parameter vector into the feasible box.
+    ///
+    /// @param[in] constraint The box constraint.
+    /// @param[in,out] x The parameter vector.
+    /// @param[in] n The number of parameter values.
+    /// @return @c true.
+    template<class Constraint>
+    bool reflect(const Constraint &constraint, real x[], natural n, std::true_type) {
+        constraint.reflect(x, n);
+        return true;
+    }
+
+    /// Does not reflect a parameter vector, since the constraint is not a box constraint.
+    ///
+    /// @return @c false.
+    template<class Constraint>
+    bool reflect(const Constraint &constraint, real x[], natural n, std::false_type) {
+        return false;
+    }
+
+    /// Projects a parameter vector onto the feasible box.
+    ///
+    /// @param[in] constraint The box constraint.
+    /// @param[in,out] x The parameter vector.
+    /// @param[in] n The number of parameter values.
+    /// @return @c true.
+    template<class Constraint>
+    bool repair(const Constraint &constraint, real x[], natural n, std::true_type) {
+        constraint.repair(x, n);
+        return true;
+    }
+
+    /// Does not project a parameter vector, since the constraint is not a box constraint.
+    ///
+    /// @return @c false.
+    template<class Constraint>
+    bool repair(const Constraint &constraint, real x[], natural n, std::false_type) {
+        return false;
+    }
+
+    /// Traces state information, including the rejection rate, if the tracer accepts it.
+    ///
+    /// @param[in] tracer The tracer.
+    /// @param[in] g The generation number.
+    /// @param[in] y The value of the objective function.
+    /// @param[in] min_step The minimum mutation step size.
+    /// @param[in] max_step The maximum mutation step size.
+    /// @param[in] rejection_rate The number of rejected samples per offspring.
+    template<class Tracing>
+    auto trace(const Tracing &tracer, natural g, real y, real min_step, real max_step, real rejection_rate, int)
+    -> decltype(tracer.trace(g, y, min_step, max_step, rejection_rate)) {
+        tracer.trace(g, y, min_step, max_step, rejection_rate);
+    }
+
+    /// Traces state information, with a tracer which does not accept the rejection rate.
+    ///
+    /// @param[in] tracer The tracer.
+    /// @param[in] g The generation number.
+    /// @param[in] y The value of the objective function.
+    /// @param[in] min_step The minimum mutation step size.
+    /// @param[in] max_step The maximum mutation step size.
+    /// @param[in] rejection_rate The number of rejected samples per offspring.
+    template<class Tracing>
+    void trace(const Tracing &tracer, natural g, real y, real min_step, real max_step, real, long) {
+        tracer.trace(g, y, min_step, max_step);
+    }
+
+    /// Detects whether a function type evaluates many parameter vectors in a single call. A
+    /// batched function type provides the method
+    ///
+    /// @c cost_batch(X, n, lambda, y) computing the values @c y of @c lambda parameter vectors,
+    /// which are stored in a single column-major block @c X with @c n rows.
+    ///
+    /// A batched partitioned function type provides the method
+    ///
+    /// @c cost_batch(X, n, lambda, i, y) computing the partial values @c y of partition @c i
+    /// instead.
+    ///
+    /// @tparam F The function type.
+    /// @tparam Partitioned Is @c true if the function type is partitioned.
+    template<class F, bool Partitioned = Is_Partitioned<F>::value>
+    class Is_Population_Batched {
+    private:
+        template<class G>
+        static auto test(const G *g) -> decltype(g->cost_batch(static_cast<const real *>(nullptr), natural(0),
+                natural(0), static_cast<real *>(nullptr)), std::true_type());
+
+        template<class G>
+        static std::false_type test(...);
+
+    public:
+        /// Is @c true if the function type is batched.
+        static const bool value = decltype(test<F>(nullptr))::value;
+    };
+
+    /// Detects whether a partitioned function type evaluates many parameter vectors in a single
+    /// call.
+    ///
+    /// @tparam F The function type.
+    template<class F>
+    class Is_Population_Batched<F, true> {
+    private:
+        template<class G>
+        static auto test(const G *g) -> decltype(g->cost_batch(static_cast<const real *>(nullptr), natural(0),
+                natural(0), natural(0), static_cast<real *>(nullptr)), std::true_type());
+
+        template<class G>
+        static std::false_type test(...);
+
+    public:
+        /// Is @c true if the function type is batched.
+        static const bool value = decltype(test<F>(nullptr))::value;
+    };
+
+    /// Returns the number of parameter vectors in a batch, such that each thread of a pool of
+    /// threads processes a batch of its own.
+    ///
+    /// @param[in] m The number of parameter vectors.
+    /// @param[in] task_count The number of tasks to run for each batch.
+    /// @param[in] pool The pool of threads.
+    /// @return the number of parameter vectors in a batch.
+    inline natural batch_size(natural m, natural task_count, const Thread_Pool &pool) {
+        const natural thread_count = pool.get_thread_count();
+        const natural batch_count = std::max<natural>(1, std::min(m, (thread_count + task_count - 1) / task_count));
+
+        return (m + batch_count - 1) / batch_count;
+    }
+
+    /// Packs many parameter vectors into a single column-major block.
+    ///
+    /// @param[in] m The number of parameter vectors.
+    /// @param[in] n The number of parameter values.
+    /// @param[in] x The parameter vectors.
+    /// @param[out] block The block of parameter vectors.
+    inline void pack_batch(natural m, natural n, const real *const x[], std::vector<real> &block) {
+        block.resize(static_cast<size_t>(m) * n);
+        for (natural k = 0; k < m; ++k) {
+            std::copy(x[k], x[k] + n, &block[static_cast<size_t>(k) * n]);
+        }
+    }
+
+    /// Evaluates an objective function for many parameter vectors in parallel.
+    ///
+    /// @tparam F The function type.
+    /// @tparam Constraint The constraint type.
+    /// @tparam Partitioned Is @c true if the function type is partitioned.
+    template<class F, class Constraint, bool Partitioned = Is_Partitioned<F>::value>
+    class Evaluator {
+    public:
+        /// Creates a new evaluator.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] constraint The constraint on parameter values.
+        /// @param[in] n The number of parameter values.
+        Evaluator(const F &f, const Constraint &constraint, natural n)
+                : f(f), constraint(constraint), n(n), c() {
+        }
+
+        /// Evaluates the objective function for many parameter vectors. Each parameter
+        /// vector is a task.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        ///
+        /// @remark When the function type is batched, the parameter vectors are packed into a
+        /// single block and each thread evaluates a batch of its own.
+        void operator()(natural m, const real *const x[], real y[], const Thread_Pool &pool) const {
+            if (Cluster::is_distributed()) {
+                Cluster::evaluate(f, constraint, n, m, x, y, pool);
+                return;
+            }
+            evaluate(m, x, y, pool, std::integral_constant<bool, Is_Population_Batched<F>::value>());
+        }
+
+        /// Evaluates the objective function for many parameter vectors. The objective function
+        /// is not bounded, so all parameter vectors are evaluated.
+        ///
+        /// @tparam Compare The strategy to compare fitness.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[out] exact Whether the value of the objective function is computed exactly.
+        /// @param[in] q The number of best values to be computed exactly.
+        /// @param[in] compare The comparator to compare fitness.
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        /// @return the number of parameter vectors evaluated.
+        template<class Compare>
+        natural race(natural m, const real *const x[], real y[], bool exact[], natural, const Compare &,
+                     const Thread_Pool &pool) const {
+            (*this)(m, x, y, pool);
+            std::fill(exact, exact + m, true);
+            return m;
+        }
+
+    private:
+        /// Evaluates the objective function for each parameter vector separately.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        void evaluate(natural m, const real *const x[], real y[], const Thread_Pool &pool, std::false_type) const {
+            pool.for_each(m, [this, x, y](natural k) {
+                y[k] = f(x[k], n) + constraint.cost(x[k], n);
+            });
+        }
+
+        /// Evaluates the objective function for batches of parameter vectors.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        void evaluate(natural m, const real *const x[], real y[], const Thread_Pool &pool, std::true_type) const {
+            const natural b = batch_size(m, 1, pool);
+
+            pack_batch(m, n, x, c);
+            const real *const block = c.data();
+
+            pool.for_each((m + b - 1) / b, [this, m, b, block, y](natural j) {
+                const natural k = j * b;
+
+                f.cost_batch(&block[static_cast<size_t>(k) * n], n, std::min(b, m - k), &y[k]);
+            }, 1);
+
+            for (natural k = 0; k < m; ++k) {
+                y[k] += constraint.cost(x[k], n);
+            }
+        }
+
+        const F &f;
+        const Constraint &constraint;
+        const natural n;
+
+        /// The block of parameter vectors.
+        mutable std::vector<real> c;
+    };
+
+    /// Evaluates a partitioned objective function for many parameter vectors in parallel.
+    ///
+    /// @tparam F The function type.
+    /// @tparam Constraint The constraint type.
+    template<class F, class Constraint>
+    class Evaluator<F, Constraint, true> {
+    public:
+        /// Creates a new evaluator.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] constraint The constraint on parameter values.
+        /// @param[in] n The number of parameter values.
+        Evaluator(const F &f, const Constraint &constraint, natural n)
+                : f(f), constraint(constraint), n(n), partitions(f.get_partition_count()), c(), block(), bounds(),
+                  order(), values() {
+            // The partitions are scheduled in order of decreasing weight, for better load balance
+            for (natural i = 0; i < partitions.size(); ++i) {
+                partitions[i] = i;
+            }
+            std::stable_sort(partitions.begin(), partitions.end(), [&f](natural i, natural j) {
+                return f.get_partition_weight(i) > f.get_partition_weight(j);
+            });
+        }
+
+        /// Evaluates the objective function for many parameter vectors. Each pair of parameter
+        /// vector and partition is a task.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        ///
+        /// @remark The partial values are summed in order of partitions, so the values of the
+        /// objective function are the same as those computed without partitioning. When the
+        /// function type is batched, each pair of batch of parameter vectors and partition is
+        /// a task. When the evaluation is distributed across a cluster, each process evaluates
+        /// whole parameter vectors.
+        void operator()(natural m, const real *const x[], real y[], const Thread_Pool &pool) const {
+            if (Cluster::is_distributed()) {
+                Cluster::evaluate(f, constraint, n, m, x, y, pool);
+                return;
+            }
+            evaluate(m, x, y, pool, std::integral_constant<bool, Is_Population_Batched<F>::value>());
+        }
+
+        /// Evaluates the objective function for many parameter vectors by racing. When the
+        /// objective function is bounded and minimized, all parameter vectors are first scored
+        /// by the lower bound of the objective function. Then the parameter vectors are evaluated
+        /// in order of ascending bound, in chunks of @c q parameter vectors, until the bound of
+        /// the next parameter vector exceeds the q-th best value evaluated. Each parameter vector
+        /// not evaluated is assigned its bound, which exceeds the q-th best value.
+        ///
+        /// @tparam Compare The strategy to compare fitness.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[out] exact Whether the value of the objective function is computed exactly.
+        /// @param[in] q The number of best values to be computed exactly.
+        /// @param[in] compare The comparator to compare fitness.
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        /// @return the number of parameter vectors evaluated.
+        ///
+        /// @remark The q best values and their ranking are the same as without racing. When the
+        /// objective function is not bounded, or maximized, or when the evaluation is distributed
+        /// across a cluster, all parameter vectors are evaluated.
+        template<class Compare>
+        natural race(natural m, const real *const x[], real y[], bool exact[], natural q, const Compare &,
+                     const Thread_Pool &pool) const {
+            return race(m, x, y, exact, q, pool, std::integral_constant<bool,
+                    Is_Bounded<F>::value and std::is_same<Compare, std::less<real>>::value>());
+        }
+
+    private:
+        /// Evaluates the objective function for each parameter vector separately.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        void evaluate(natural m, const real *const x[], real y[], const Thread_Pool &pool, std::false_type) const {
+            const natural p = static_cast<natural>(partitions.size());
+
+            c.resize(m * p);
+            real *const partial = c.data();
+
+            pool.for_each_local(p, partitions.data(), m, [this, m, p, x, partial](natural t) {
+                const natural i = partitions[t / m];
+                const natural k = t % m;
+
+                partial[k * p + i] = f.cost(x[k], n, i);
+            });
+
+            for (natural k = 0; k < m; ++k) {
+                real d = 0.0;
+                for (natural i = 0; i < p; ++i) {
+                    d += partial[k * p + i];
+                }
+                y[k] = d + constraint.cost(x[k], n);
+            }
+        }
+
+        /// Evaluates the objective function for batches of parameter vectors.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        void evaluate(natural m, const real *const x[], real y[], const Thread_Pool &pool, std::true_type) const {
+            const natural p = static_cast<natural>(partitions.size());
+            const natural b = batch_size(m, p, pool);
+            const natural batch_count = (m + b - 1) / b;
+
+            pack_batch(m, n, x, block);
+            c.resize(m * p);
+            const real *const X = block.data();
+            real *const partial = c.data();
+
+            // The partial values of partition i are stored in row i
+            pool.for_each_local(p, partitions.data(), batch_count, [this, m, b, batch_count, X, partial](natural t) {
+                const natural i = partitions[t / batch_count];
+                const natural k = (t % batch_count) * b;
+
+                f.cost_batch(&X[static_cast<size_t>(k) * n], n, std::min(b, m - k), i, &partial[i * m + k]);
+            });
+
+            for (natural k = 0; k < m; ++k) {
+                real d = 0.0;
+                for (natural i = 0; i < p; ++i) {
+                    d += partial[i * m + k];
+                }
+                y[k] = d + constraint.cost(x[k], n);
+            }
+        }
+
+        /// Evaluates the objective function for all parameter vectors.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[out] exact Whether the value of the objective function is computed exactly.
+        /// @param[in] q The number of best values to be computed exactly.
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        /// @return the number of parameter vectors evaluated.
+        natural race(natural m, const real *const x[], real y[], bool exact[], natural, const Thread_Pool &pool,
+                     std::false_type) const {
+            (*this)(m, x, y, pool);
+            std::fill(exact, exact + m, true);
+            return m;
+        }
+
+        /// Evaluates the objective function for the parameter vectors, which may be among the
+        /// q best.
+        ///
+        /// @param[in] m The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[out] exact Whether the value of the objective function is computed exactly.
+        /// @param[in] q The number of best values to be computed exactly.
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        /// @return the number of parameter vectors evaluated.
+        natural race(natural m, const real *const x[], real y[], bool exact[], natural q, const Thread_Pool &pool,
+                     std::true_type) const {
+            using std::abs;
+
+            // The relative margin of a bound, which guards against rounding
+            const real margin = 0.01;
+
+            if (Cluster::is_distributed() or q >= m) {
+                (*this)(m, x, y, pool);
+                std::fill(exact, exact + m, true);
+                return m;
+            }
+            const natural p = static_cast<natural>(partitions.size());
+
+            c.resize(m * p);
+            bounds.resize(m);
+            order.resize(m);
+            real *const partial = c.data();
+
+            pool.for_each_local(p, partitions.data(), m, [this, m, p, x, partial](natural t) {
+                const natural i = partitions[t / m];
+                const natural k = t % m;
+
+                partial[k * p + i] = f.cost_bound(x[k], n, i);
+            });
+
+            for (natural k = 0; k < m; ++k) {
+                real d = 0.0;
+                for (natural i = 0; i < p; ++i) {
+                    d += partial[k * p + i];
+                }
+                bounds[k] = d + constraint.cost(x[k], n);
+                order[k] = k;
+            }
+            std::stable_sort(order.begin(), order.end(), [this](natural i, natural j) {
+                return bounds[i] < bounds[j];
+            });
+
+            natural e = 0;
+            real threshold = std::numeric_limits<real>::infinity();
+            while (e < m) {
+                natural end = e;
+                while (end < m and end < e + q and bounds[order[end]] - margin * abs(bounds[order[end]]) <= threshold) {
+                    ++end;
+                }
+                if (end == e) {
+                    break;
+                }
+                evaluate(e, end - e, x, y, pool);
+                e = end;
+                if (e >= q) {
+                    values.resize(e);
+                    for (natural j = 0; j < e; ++j) {
+                        values[j] = y[order[j]];
+                    }
+                    std::nth_element(values.begin(), values.begin() + (q - 1), values.end());
+                    threshold = values[q - 1];
+                }
+            }
+            for (natural j = 0; j < e; ++j) {
+                exact[order[j]] = true;
+            }
+            for (natural j = e; j < m; ++j) {
+                y[order[j]] = bounds[order[j]];
+                exact[order[j]] = false;
+            }
+
+            return e;
+        }
+
+        /// Evaluates the objective function for a range of parameter vectors in order of racing.
+        ///
+        /// @param[in] first The position of the first parameter vector in order of racing.
+        /// @param[in] count The number of parameter vectors.
+        /// @param[in] x The parameter vectors.
+        /// @param[out] y The values of the objective function (including the constraint cost).
+        /// @param[in] pool The pool of threads to evaluate the objective function.
+        void evaluate(natural first, natural count, const real *const x[], real y[], const Thread_Pool &pool) const {
+            const natural p = static_cast<natural>(partitions.size());
+            real *const partial = c.data();
+
+            pool.for_each_local(p, partitions.data(), count, [this, first, count, p, x, partial](natural t) {
+                const natural i = partitions[t / count];
+                const natural k = order[first + t % count];
+
+                partial[k * p + i] = f.cost(x[k], n, i);
+            });
+
+            for (natural j = first; j < first + count; ++j) {
+                const natural k = order[j];
+
+                real d = 0.0;
+                for (natural i = 0; i < p; ++i) {
+                    d += partial[k * p + i];
+                }
+                y[k] = d + constraint.cost(x[k], n);
+            }
+        }
+
+        const F &f;
+        const Constraint &constraint;
+        const natural n;
+
+        /// The partitions, in order of scheduling. The tasks of a partition are executed by the
+        /// threads on the NUMA node the partition is assigned to first.
+        std::vector<natural> partitions;
+
+        /// The partial values of the objective function.
+        mutable std::vector<real> c;
+
+        /// The block of parameter vectors.
+        mutable std::vector<real> block;
+
+        /// The lower bounds of the objective function.
+        mutable std::vector<real> bounds;
+
+        /// The parameter vectors in order of racing.
+        mutable std::vector<natural> order;
+
+        /// The values of the objective function evaluated.
+        mutable std::vector<real> values;
+    };
+
+    /// Returns the median of a number of values.
+    ///
+    /// @param[in] first The first value.
+    /// @param[in] last The value past the last value.
+    /// @param[out] scratch The scratch buffer, which holds a copy of the values.
+    /// @return the median of at least one value.
+    inline real median_of(const real *first, const real *last, std::vector<real> &scratch) {
+        scratch.assign(first, last);
+
+        const auto m = scratch.begin() + scratch.size() / 2;
+        std::nth_element(scratch.begin(), m, scratch.end());
+        return scratch.size() % 2 == 1 ? *m : 0.5 * (*std::max_element(scratch.begin(), m) + *m);
+    }
+
+    /// Records the fitness of a generation and tests the termination criteria (Hansen, 2016,
+    /// arXiv:1604.00772, Sect. B.3).
+    ///
+    /// The range of the fitness values of the parents is taken for the range of the fitness values
+    /// of the recent generation, and the median fitness of the parents is taken for the median
+    /// fitness, because the fitness of the other offspring is not exact, when evaluated by racing.
+    ///
+    /// @tparam Compare The strategy to compare fitness.
+    ///
+    /// @param[in] criteria The termination criteria.
+    /// @param[in] n The number of parameters.
+    /// @param[in] population_size The number of individuals per generation.
+    /// @param[in] g The generation number.
+    /// @param[in] xw The distribution mean.
+    /// @param[in] step_size The global step size.
+    /// @param[in] d The local step sizes.
+    /// @param[in] B The rotation matrix (in column-major layout).
+    /// @param[in] C The covariance matrix (upper triangular part only, in column-major layout).
+    /// @param[in] pc The distribution cumulation path.
+    /// @param[in] best The best fitness of the generation.
+    /// @param[in] median The median fitness of the parents of the generation.
+    /// @param[in] worst The worst fitness of the parents of the generation.
+    /// @param[in,out] best_history The best fitness of the recent generations.
+    /// @param[in,out] median_history The median fitness of the recent generations.
+    /// @param[out] scratch The scratch buffer to compute the median fitness of the recent generations.
+    /// @param[in] compare The comparator to compare fitness.
+    /// @return the termination criterion met.
+    template<class Compare>
+    Termination terminate(const Termination_Criteria &criteria, natural n, natural population_size, natural g,
+                          const real xw[], real step_size, const real d[], const real B[], const real C[],
+                          const real pc[], real best, real median, real worst,
+                          std::vector<real> &best_history, std::vector<real> &median_history,
+                          std::vector<real> &scratch, const Compare &compare) {
+        using std::abs;
+        using std::sqrt;
+
+        const natural k = (30 * n + population_size - 1) / population_size;
+        // The number of recent generations tested for TolFun, and the minimum number
+        // of recent generations tested for Stagnation, which are the most recent 20
+        // percent of all generations, but not more than 20000
+        const size_t tol_fun_window = 10 + k;
+        const size_t stagnation_window = 120 + k;
+
+        if (criteria.is_history_needed()) {
+            const size_t capacity = std::min<size_t>(20000, criteria.stagnation
+                                                            ? std::max<size_t>(stagnation_window, g / 5)
+                                                            : tol_fun_window);
+
+            best_history.push_back(best);
+            median_history.push_back(median);
+            if (best_history.size() > capacity) {
+                best_history.erase(best_history.begin(), best_history.end() - capacity);
+                median_history.erase(median_history.begin(), median_history.end() - capacity);
+            }
+        }
+        if (criteria.fitness_tolerance > 0.0 and best_history.size() >= tol_fun_window) {
+            const auto minmax = std::minmax_element(best_history.end() - tol_fun_window, best_history.end());
+
+            if (*minmax.second - *minmax.first < criteria.fitness_tolerance and
+                abs(worst - best) < criteria.fitness_tolerance) {
+                return Termination::tol_fun;
+            }
+        }
+        if (criteria.parameter_tolerance > 0.0) {
+            bool below = true;
+            for (natural i = 0, ii = 0; i < n and below; ++i, ii += n + 1) {
+                below = step_size * sqrt(C[ii]) < criteria.parameter_tolerance and
+                        abs(step_size * pc[i]) < criteria.parameter_tolerance;
+            }
+            if (below) {
+                return Termination::tol_x;
+            }
+        }
+        if (criteria.no_effect_axis) {
+            const natural j = g % n;
+            const real t = 0.1 * step_size * d[j];
+
+            bool no_effect = true;
+            for (natural i = 0, ij = j * n; i < n and no_effect; ++i, ++ij) {
+                no_effect = (xw[i] + t * B[ij] == xw[i]);
+            }
+            if (no_effect) {
+                return Termination::no_effect_axis;
+            }
+        }
+        if (criteria.no_effect_coordinate) {
+            for (natural i = 0, ii = 0; i < n; ++i, ii += n + 1) {
+                if (xw[i] + 0.2 * step_size * sqrt(C[ii]) == xw[i]) {
+                    return Termination::no_effect_coordinate;
+                }
+            }
+        }
+        if (criteria.max_condition > 0.0) {
+            const auto minmax = std::minmax_element(d, d + n);
+
+            if (sq(*minmax.second) > criteria.max_condition * sq(*minmax.first)) {
+                return Termination::condition_cov;
+            }
+        }
+        if (criteria.stagnation and best_history.size() >= stagnation_window) {
+            const real *const b = best_history.data();
+            const real *const m = median_history.data();
+            const size_t h = best_history.size();
+            // The oldest and newest 30 percent of the generations tested
+            const size_t w = 3 * h / 10;
+
+            // For minimization, the newest values are not less than the oldest values
+            if (not compare(median_of(b + h - w, b + h, scratch), median_of(b, b + w, scratch)) and
+                not compare(median_of(m + h - w, m + h, scratch), median_of(m, m + w, scratch))) {
+                return Termination::stagnation;
+            }
+        }
+
+        return Termination::none;
+    }
+
     /// Evolution strategy with covariance matrix adaption (CMA-ES) for nonlinear function optimization.
     /// Based on Hansen (2014, http://cma.gforge.inria.fr/purecmaes.m).
     ///
@@ -84,6 +947,7 @@ namespace especia {
     /// @param[in] update_modulus The covariance matrix update modulus.
     /// @param[in] accuracy_goal The accuracy goal.
     /// @param[in] stop_generation The stop generation.
+    /// @param[in] options The options of the evolution strategy.
     /// @param[in,out] g The generation number.
     /// @param[in,out] xw The parameter values.
     /// @param[in,out] step_size The global step size.
@@ -95,10 +959,20 @@ namespace especia {
     /// @param[out] yw The fitness at @c xw.
     /// @param[out] optimized Set to @c true when the optimization has converged.
     /// @param[out] underflow Set to @c true when the mutation variance is too small.
+    /// @param[out] termination Set to the termination criterion met, if any.
+    /// @param[in,out] best_history The best fitness of the recent generations.
+    /// @param[in,out] median_history The median fitness of the recent generations.
+    /// @param[in,out] pending Set when the optimization is suspended while an asynchronous decomposition
+    /// is pending. When set on entry, the decomposition of the covariance matrix is computed anew and
+    /// installed in the first generation, like for an optimization, which has not been suspended.
     /// @param[in] deviate The random number generator.
+    /// @param[in] streams The independent random number generators to sample the offspring in parallel,
+    /// one for each offspring. If empty, the offspring are sampled serially by means of @c deviate.
     /// @param[in] decompose The eigenvalue decomposition.
     /// @param[in] compare The comparator to compare fitness.
-    /// @param[in] tracer The tracer.
+    /// @param[in] tracer The tracer. When the tracer provides a telemetry collector (see
+    /// @c telemetry_of()), the time spent in each phase is recorded.
+    /// @param[in] pool The pool of threads to evaluate the model function.
     template<class F, class Constraint, class Deviate, class Decompose, class Compare, class Tracing>
     void optimize(const F &f,
                   const Constraint &constraint,
@@ -114,6 +988,7 @@ namespace especia {
                   natural update_modulus,
                   real accuracy_goal,
                   natural stop_generation,
+                  const Strategy_Options &options,
                   natural &g,
                   real xw[],
                   real &step_size,
@@ -125,15 +1000,19 @@ namespace especia {
                   real &yw,
                   bool &optimized,
                   bool &underflow,
-                  const Deviate &deviate, const Decompose &decompose, const Compare &compare, const Tracing &tracer) {
+                  Termination &termination,
+                  std::vector<real> &best_history,
+                  std::vector<real> &median_history,
+                  bool &pending,
+                  const Deviate &deviate, const std::vector<Deviate> &streams,
+                  const Decompose &decompose, const Compare &compare, const Tracing &tracer,
+                  const Thread_Pool &pool) {
         using std::accumulate;
         using std::exp;
         using std::numeric_limits;
         using std::partial_sort;
         using std::sqrt;
-        using std::thread;
         using std::valarray;
-        using std::vector;
 
         const real expected_norm = (n - 0.25 + 1.0 / (21 * n)) / sqrt(real(n));
         const real max_covariance_matrix_condition = 0.01 / numeric_limits<real>::epsilon();
@@ -144,53 +1023,363 @@ namespace especia {
 
         valarray<real> uw(n);
         valarray<real> vw(n);
-        valarray<valarray<real>> u(uw, population_size);
-        valarray<valarray<real>> v = u;
-        valarray<valarray<real>> x = u;
+
+        // The offspring steps, the normalized offspring steps and the offspring are stored column-wise
+        // in contiguous aligned matrices, which are allocated once. The columns are accessed by means
+        // of pointers, which remain valid for the whole optimization.
+        std::vector<real, Aligned_Allocator<real>> U(n * population_size);
+        std::vector<real, Aligned_Allocator<real>> V(n * population_size);
+        std::vector<real, Aligned_Allocator<real>> X(n * population_size);
+        valarray<real *> u(population_size);
+        valarray<real *> v(population_size);
+        valarray<real *> x(population_size);
+        for (natural k = 0; k < population_size; ++k) {
+            u[k] = &U[k * n];
+            v[k] = &V[k * n];
+            x[k] = &X[k * n];
+        }
 
         valarray<real> y(population_size);
         valarray<natural> indexes(population_size);
 
+        // The number of samples rejected for each offspring
+        valarray<natural> rejected(natural(0), population_size);
+        real rejection_rate = 0.0;
+
+        // Violating samples are redrawn, unless violating offspring are moved into the feasible box
+        const bool rejecting = options.boundary_strategy == Boundary_Strategy::rejection or
+                               options.boundary_strategy == Boundary_Strategy::resampling;
+        const bool mirroring = options.boundary_strategy == Boundary_Strategy::resampling;
+        if (not rejecting and not Is_Box_Constraint<Constraint>::value) {
+            throw std::invalid_argument(
+                    "especia::optimize() Error: reflection and repair require a box constraint");
+        }
+        // The penalty of each offspring projected onto the feasible box
+        valarray<real> penalty;
+        if (options.boundary_strategy == Boundary_Strategy::repair) {
+            penalty.resize(population_size, 0.0);
+        }
+        // Whether the fitness of each offspring is evaluated exactly, which is not the case when racing
+        valarray<bool> exact(true, population_size);
+        // The scratch buffer to test for stagnation, which is reused across generations
+        std::vector<real> median_scratch;
+        Telemetry *const telemetry = telemetry_of(tracer);
+        Telemetry::Stopwatch stopwatch(telemetry);
+
+        // The partial sums of the offspring steps, stored column-wise
+        std::vector<real, Aligned_Allocator<real>> SU(n * population_size);
+        std::vector<real, Aligned_Allocator<real>> SV(n * population_size);
+
+        // The separable variant overrides block sampling and the BLAS update
+        const bool separable = options.separable;
+        const bool block_sampling = options.block_sampling and not separable;
+        const bool blas_update = options.blas_update and not separable;
+
+        // The weighted steps of the selected offspring for the BLAS update
+        valarray<real> W;
+        if (blas_update) {
+            W.resize(n * parent_number);
+        }
+
+        // The normal deviates and the scaled rotation matrix for block sampling
+        valarray<real> Z;
+        valarray<real> BD;
+        if (block_sampling) {
+            Z.resize(n * population_size);
+            BD.resize(n * n);
+        }
+
+        // The covariance matrix, rotation matrix and eigenvalues of the asynchronous decomposition
+        valarray<real> Ca;
+        valarray<real> Ba;
+        valarray<real> da;
+        if (options.async_decompose) {
+            Ca.resize(n * n);
+            Ba.resize(n * n);
+            da.resize(n);
+        }
+        std::future<void> decomposition;
+
+        // Limits the condition of the covariance matrix and converts the eigenvalues into local step sizes
+        const auto limit_condition = [&]() {
+            const real t = d[n - 1] / max_covariance_matrix_condition - d[0];
+            if (t > 0.0) {
+                for (natural i = 0, ii = 0; i < n; ++i, ii += n + 1) {
+                    C[ii] += t;
+                    d[i] += t;
+                }
+            }
+            for (natural i = 0; i < n; ++i) {
+                d[i] = sqrt(d[i]);
+            }
+        };
+        // Waits for the asynchronous decomposition and installs its result
+        const auto complete_decomposition = [&]() {
+            decomposition.get();
+            std::copy(&Ba[0], &Ba[0] + n * n, B);
+            std::copy(&da[0], &da[0] + n, d);
+            limit_condition();
+        };
+
+        const Evaluator<F, Constraint> evaluate(f, constraint, n);
+        valarray<const real *> xk(population_size);
+        for (natural k = 0; k < population_size; ++k) {
+            xk[k] = x[k];
+        }
+
+        // Moves a violating offspring into the feasible box, when violating samples are not redrawn,
+        // or when the number of rejected samples has reached the limit. An offspring, which cannot
+        // be reflected, is replaced with the parental mean.
+        const auto bound = [&](natural k) {
+            if ((rejecting and rejected[k] < options.rejection_limit) or not constraint.is_violated(x[k], n)) {
+                return;
+            }
+            if (not rejecting) {
+                ++rejected[k];
+            }
+            if (options.boundary_strategy == Boundary_Strategy::repair) {
+                real *const xr = &SU[k * n];
+
+                std::copy(x[k], x[k] + n, xr);
+                repair(constraint, xr, n, std::integral_constant<bool, Is_Box_Constraint<Constraint>::value>());
+                // The squared projection distance, in units of the mutation step size
+                real t = 0.0;
+                for (natural i = 0, ii = 0; i < n; ++i, ii += n + 1) {
+                    t += sq(x[k][i] - xr[i]) / (sq(step_size) * C[ii]);
+                }
+                penalty[k] = t;
+                std::copy(xr, xr + n, x[k]);
+            } else if (not reflect(constraint, x[k], n,
+                                   std::integral_constant<bool, Is_Box_Constraint<Constraint>::value>())) {
+                for (natural i = 0; i < n; ++i) {
+                    x[k][i] = xw[i];
+                    u[k][i] = v[k][i] = 0.0;
+                }
+                return;
+            }
+            // The mutation steps are recomputed for the offspring moved, so the adaption of step size
+            // and covariance matrix is consistent with the offspring selected
+            for (natural i = 0; i < n; ++i) {
+                u[k][i] = (x[k][i] - xw[i]) / step_size;
+            }
+            if (separable) {
+                for (natural i = 0; i < n; ++i) {
+                    v[k][i] = u[k][i] / d[i];
+                }
+            } else {
+                real *const z = &SV[k * n];
+
+                for (natural j = 0, nj = 0; j < n; ++j, nj += n) {
+                    real t = 0.0;
+                    for (natural i = 0, ij = nj; i < n; ++i, ++ij) {
+                        t += B[ij] * u[k][i];
+                    }
+                    z[j] = t / d[j];
+                }
+                for (natural i = 0; i < n; ++i) {
+                    real t = 0.0;
+                    for (natural j = 0, ij = i; j < n; ++j, ij += n) {
+                        t += B[ij] * z[j];
+                    }
+                    v[k][i] = t;
+                }
+            }
+        };
+
+        // The decomposition pending when the optimization was suspended is computed anew. The
+        // covariance matrix has not changed since.
+        if (pending) {
+            pending = false;
+            if (options.async_decompose) {
+                std::copy(C, C + n * n, &Ca[0]);
+                decomposition = std::async(std::launch::async, [&]() {
+                    decompose(&Ca[0], &Ba[0], &da[0]);
+                });
+            } else {
+                decompose(C, B, d);
+                limit_condition();
+            }
+        }
+
         while (g < stop_generation) {
+            stopwatch.lap(Telemetry::sampling);
             // Generate a new population of object parameter vectors,
             // sorted indirectly by fitness
-            for (natural k = 0; k < population_size; ++k) {
-                uw = 0.0;
-                vw = 0.0;
+            if (separable) {
+                const auto sample = [&](natural k, const Deviate &dev) {
+                    // Coordinates not yet sampled are not tested against the constraint
+                    for (natural j = 0; j < n; ++j) {
+                        real z = 0.0;
+                        bool mirrored = false;
+                        for (;;) {
+                            z = mirrored ? -z : dev();
+
+                            u[k][j] = z * d[j];
+                            v[k][j] = z;
+                            x[k][j] = xw[j] + u[k][j] * step_size; // Hansen & Ostermeier (2001, Eq. 13)
+                            if (!rejecting or rejected[k] >= options.rejection_limit or
+                                !constraint.is_violated(x[k], j + 1)) {
+                                break;
+                            }
+                            ++rejected[k];
+                            mirrored = mirroring and not mirrored;
+                        }
+                    }
+                    bound(k);
+                };
+                if (streams.empty()) {
+                    for (natural k = 0; k < population_size; ++k) {
+                        sample(k, deviate);
+                    }
+                } else {
+                    pool.for_each(population_size, [&](natural k) {
+                        sample(k, streams[k]);
+                    }, 1);
+                }
+            } else if (block_sampling) {
                 for (natural j = 0, nj = 0; j < n; ++j, nj += n) {
-                    do {
-                        const real z = deviate();
+                    for (natural i = 0, ij = nj; i < n; ++i, ++ij) {
+                        BD[ij] = B[ij] * d[j];
+                    }
+                }
+                if (streams.empty()) {
+                    deviate.fill(&Z[0], n * population_size);
+                } else {
+                    pool.for_each(population_size, [&](natural k) {
+                        streams[k].fill(&Z[k * n], n);
+                    }, 1);
+                }
+                multiply(n, population_size, n, &BD[0], &Z[0], &U[0]);
+                multiply(n, population_size, n, &B[0], &Z[0], &V[0]);
+
+                const auto accept = [&](natural k, const Deviate &dev) {
+                    const natural nk = k * n;
+
+                    for (natural i = 0; i < n; ++i) {
+                        x[k][i] = xw[i] + U[nk + i] * step_size; // Hansen & Ostermeier (2001, Eq. 13)
+                    }
+                    bool mirrored = false;
+                    while (rejecting and rejected[k] < options.rejection_limit and constraint.is_violated(x[k], n)) {
+                        ++rejected[k];
+                        mirrored = mirroring and not mirrored;
+                        if (mirrored) {
+                            for (natural i = 0; i < n; ++i) {
+                                U[nk + i] = -U[nk + i];
+                                V[nk + i] = -V[nk + i];
+                            }
+                        } else {
+                            for (natural i = 0; i < n; ++i) {
+                                U[nk + i] = V[nk + i] = 0.0;
+                            }
+                            for (natural j = 0, nj = 0; j < n; ++j, nj += n) {
+                                const real z = dev();
+
+                                for (natural i = 0, ij = nj; i < n; ++i, ++ij) {
+                                    U[nk + i] += z * BD[ij];
+                                    V[nk + i] += z * B[ij];
+                                }
+                            }
+                        }
+                        for (natural i = 0; i < n; ++i) {
+                            x[k][i] = xw[i] + U[nk + i] * step_size;
+                        }
+                    }
+                    bound(k);
+                };
+                if (streams.empty()) {
+                    for (natural k = 0; k < population_size; ++k) {
+                        accept(k, deviate);
+                    }
+                } else {
+                    pool.for_each(population_size, [&](natural k) {
+                        accept(k, streams[k]);
+                    }, 1);
+                }
+            } else {
+                const auto sample = [&](natural k, const Deviate &dev) {
+                    real *const uk = &SU[k * n];
+                    real *const vk = &SV[k * n];
+
+                    std::fill(uk, uk + n, 0.0);
+                    std::fill(vk, vk + n, 0.0);
+                    for (natural j = 0, nj = 0; j < n; ++j, nj += n) {
+                        real z = 0.0;
+                        bool mirrored = false;
+                        for (;;) {
+                            z = mirrored ? -z : dev();
 
-                        for (natural i = 0, ij = nj; i < n; ++i, ++ij) {
-                            u[k][i] = uw[i] + z * (B[ij] * d[j]);
-                            v[k][i] = vw[i] + z * B[ij];
-                            x[k][i] = xw[i] + u[k][i] * step_size; // Hansen & Ostermeier (2001, Eq. 13)
+                            for (natural i = 0, ij = nj; i < n; ++i, ++ij) {
+                                u[k][i] = uk[i] + z * (B[ij] * d[j]);
+                                v[k][i] = vk[i] + z * B[ij];
+                                x[k][i] = xw[i] + u[k][i] * step_size; // Hansen & Ostermeier (2001, Eq. 13)
+                            }
+                            if (!rejecting or rejected[k] >= options.rejection_limit or
+                                !constraint.is_violated(x[k], n)) {
+                                break;
+                            }
+                            ++rejected[k];
+                            mirrored = mirroring and not mirrored;
                         }
-                    } while (constraint.is_violated(&x[k][0], n));
-                    uw = u[k];
-                    vw = v[k];
+                        std::copy(u[k], u[k] + n, uk);
+                        std::copy(v[k], v[k] + n, vk);
+                    }
+                    bound(k);
+                };
+                if (streams.empty()) {
+                    for (natural k = 0; k < population_size; ++k) {
+                        sample(k, deviate);
+                    }
+                } else {
+                    pool.for_each(population_size, [&](natural k) {
+                        sample(k, streams[k]);
+                    }, 1);
                 }
             }
-#ifdef _OPENMP
-#pragma omp parallel for
-            for (natural k = 0; k < population_size; ++k) {
-                y[k] = f(&x[k][0], n) + constraint.cost(&x[k][0], n);
-                indexes[k] = k;
+            stopwatch.lap(Telemetry::evaluation);
+            natural evaluations = population_size;
+            if (options.racing) {
+                evaluations = evaluate.race(population_size, &xk[0], &y[0], &exact[0], parent_number + 1, compare,
+                                            pool);
+            } else {
+                evaluate(population_size, &xk[0], &y[0], pool);
             }
-#else // C++-11
-            vector<thread> threads; threads.reserve(population_size);
-            for (natural k = 0; k < population_size; ++k) {
-                threads.push_back(
-                        thread([k, &f, &constraint, &x, n, &y]() {
-                            y[k] = f(&x[k][0], n) + constraint.cost(&x[k][0], n);
-                        })
-                );
+            if (options.boundary_strategy == Boundary_Strategy::repair) {
+                // The penalty is scaled by the range of fitness values of the offspring evaluated
+                // exactly, because the other offspring are assigned a bound only
+                real lowest = std::numeric_limits<real>::infinity();
+                real highest = -std::numeric_limits<real>::infinity();
+                for (natural k = 0; k < population_size; ++k) {
+                    if (exact[k]) {
+                        lowest = std::min(lowest, y[k]);
+                        highest = std::max(highest, y[k]);
+                    }
+                }
+                const real range = highest - lowest;
+                const real sign = compare(0.0, 1.0) ? 1.0 : -1.0;
+
+                for (natural k = 0; k < population_size; ++k) {
+                    if (penalty[k] > 0.0) {
+                        y[k] += sign * range * penalty[k];
+                        penalty[k] = 0.0;
+                    }
+                }
+            }
+            const natural rejection_count = rejected.sum();
+            rejection_rate = real(rejection_count) / real(population_size);
+            rejected = 0;
+            if (telemetry) {
+                telemetry->add_evaluations(evaluations);
+                telemetry->add_rejections(rejection_count);
+                telemetry->add_generations(1);
+            }
+            stopwatch.lap(Telemetry::decomposition);
+            if (decomposition.valid()) {
+                complete_decomposition();
             }
+            stopwatch.lap(Telemetry::adaption);
             for (natural k = 0; k < population_size; ++k) {
-                threads[k].join();
                 indexes[k] = k;
             }
-#endif
             partial_sort(&indexes[0], &indexes[parent_number], &indexes[population_size],
                          Index_Compare<real, Compare>(y, compare));
             ++g;
@@ -201,14 +1390,22 @@ namespace especia {
                 break;
             }
 
-            // Recombine the best individuals
-            for (natural i = 0; i < n; ++i) {
-                uw[i] = vw[i] = xw[i] = 0.0;
-                for (natural k = 0; k < parent_number; ++k) {
-                    uw[i] += w[k] * u[indexes[k]][i];
-                    vw[i] += w[k] * v[indexes[k]][i];
-                    xw[i] += w[k] * x[indexes[k]][i];
+            // Recombine the best individuals by a weighted gather of contiguous columns
+            uw = 0.0;
+            vw = 0.0;
+            std::fill(xw, xw + n, 0.0);
+            for (natural k = 0; k < parent_number; ++k) {
+                const real *const us = u[indexes[k]];
+                const real *const vs = v[indexes[k]];
+                const real *const xs = x[indexes[k]];
+
+                for (natural i = 0; i < n; ++i) {
+                    uw[i] += w[k] * us[i];
+                    vw[i] += w[k] * vs[i];
+                    xw[i] += w[k] * xs[i];
                 }
+            }
+            for (natural i = 0; i < n; ++i) {
                 uw[i] /= ws;
                 vw[i] /= ws;
                 xw[i] /= ws;
@@ -216,30 +1413,71 @@ namespace especia {
 
             // Adapt the covariance matrix and the step size according to Hansen & Ostermeier (2001)
             // and Hansen (2014)
-            if (acov > 0.0 or ccov > 0.0) {
-                for (natural j = 0, nj = 0; j < n; ++j, nj += n) {
+            if (separable and (acov > 0.0 or ccov > 0.0)) {
+                // Ros & Hansen (2008)
+                for (natural j = 0, jj = 0; j < n; ++j, jj += n + 1) {
                     pc[j] = (1.0 - cc) * pc[j] + (ccu * cw) * uw[j]; // Hansen & Ostermeier (2001, Eq. 14)
-                    for (natural i = 0, ij = nj; i <= j; ++i, ++ij) {
-                        real z = 0.0;
-                        for (natural k = 0; k < parent_number; ++k) {
-                            z += w[k] * (u[indexes[k]][i] * u[indexes[k]][j]);
-                        }
-                        // Hansen (2014, http://www.lri.fr/~hansen/purecmaes.m)
-                        C[ij] = (C[ij] + acov * (pc[i] * pc[j] - C[ij])) + ccov * (z / ws - C[ij]);
+
+                    real z = 0.0;
+                    for (natural k = 0; k < parent_number; ++k) {
+                        z += w[k] * sq(u[indexes[k]][j]);
                     }
+                    C[jj] = (C[jj] + acov * (pc[j] * pc[j] - C[jj])) + ccov * (z / ws - C[jj]);
                 }
                 if (g % update_modulus == 0) {
-                    decompose(C, B, d);
-
-                    const real t = d[n - 1] / max_covariance_matrix_condition - d[0];
-                    if (t > 0.0) {
-                        for (natural i = 0, ii = 0; i < n; ++i, ii += n + 1) {
+                    real min_variance = C[0];
+                    real max_variance = C[0];
+                    for (natural i = 1, ii = n + 1; i < n; ++i, ii += n + 1) {
+                        min_variance = std::min(min_variance, C[ii]);
+                        max_variance = std::max(max_variance, C[ii]);
+                    }
+                    const real t = max_variance / max_covariance_matrix_condition - min_variance;
+                    for (natural i = 0, ii = 0; i < n; ++i, ii += n + 1) {
+                        if (t > 0.0) {
                             C[ii] += t;
-                            d[i] += t;
                         }
+                        d[i] = sqrt(C[ii]);
                     }
-                    for (natural i = 0; i < n; ++i) {
-                        d[i] = sqrt(d[i]);
+                }
+            } else if (acov > 0.0 or ccov > 0.0) {
+                if (blas_update) {
+                    for (natural j = 0; j < n; ++j) {
+                        pc[j] = (1.0 - cc) * pc[j] + (ccu * cw) * uw[j]; // Hansen & Ostermeier (2001, Eq. 14)
+                    }
+                    // Hansen (2014, http://www.lri.fr/~hansen/purecmaes.m)
+                    for (natural k = 0, nk = 0; k < parent_number; ++k, nk += n) {
+                        const real t = sqrt(w[k] / ws);
+
+                        for (natural i = 0; i < n; ++i) {
+                            W[nk + i] = t * u[indexes[k]][i];
+                        }
+                    }
+                    rank_k_update(n, parent_number, ccov, &W[0], 1.0 - acov - ccov, &C[0]);
+                    rank_1_update(n, acov, &pc[0], &C[0]);
+                } else {
+                    for (natural j = 0, nj = 0; j < n; ++j, nj += n) {
+                        pc[j] = (1.0 - cc) * pc[j] + (ccu * cw) * uw[j]; // Hansen & Ostermeier (2001, Eq. 14)
+                        for (natural i = 0, ij = nj; i <= j; ++i, ++ij) {
+                            real z = 0.0;
+                            for (natural k = 0; k < parent_number; ++k) {
+                                z += w[k] * (u[indexes[k]][i] * u[indexes[k]][j]);
+                            }
+                            // Hansen (2014, http://www.lri.fr/~hansen/purecmaes.m)
+                            C[ij] = (C[ij] + acov * (pc[i] * pc[j] - C[ij])) + ccov * (z / ws - C[ij]);
+                        }
+                    }
+                }
+                if (g % update_modulus == 0) {
+                    if (options.async_decompose) {
+                        std::copy(C, C + n * n, &Ca[0]);
+                        decomposition = std::async(std::launch::async, [&]() {
+                            decompose(&Ca[0], &Ba[0], &da[0]);
+                        });
+                    } else {
+                        stopwatch.lap(Telemetry::decomposition);
+                        decompose(C, B, d);
+                        limit_condition();
+                        stopwatch.lap(Telemetry::adaption);
                     }
                 }
             }
@@ -256,13 +1494,38 @@ namespace especia {
                     break;
                 }
             }
-            if (optimized or tracer.is_tracing(g)) {
-                tracer.trace(g, f(xw, n) + constraint.cost(xw, n), step_size * d[0], step_size * d[n - 1]);
+            if (not optimized) {
+                termination = terminate(options.criteria, n, population_size, g, xw, step_size, d, B, C, pc,
+                                        y[indexes[0]], y[indexes[parent_number / 2]], y[indexes[parent_number - 1]],
+                                        best_history, median_history, median_scratch, compare);
             }
-            if (optimized) {
+            if (optimized or termination != Termination::none or tracer.is_tracing(g)) {
+                stopwatch.lap(Telemetry::tracing);
+                if (separable) {
+                    const auto minmax = std::minmax_element(d, d + n);
+
+                    trace(tracer, g, f(xw, n) + constraint.cost(xw, n), step_size * *minmax.first,
+                          step_size * *minmax.second, rejection_rate, 0);
+                } else {
+                    trace(tracer, g, f(xw, n) + constraint.cost(xw, n), step_size * d[0], step_size * d[n - 1],
+                          rejection_rate, 0);
+                }
+            }
+            if (optimized or termination != Termination::none) {
                 break;
             }
         }
+        stopwatch.lap(Telemetry::decomposition);
+        if (decomposition.valid()) {
+            if (options.suspend and g >= stop_generation and not(optimized or underflow or termination != Termination::none)) {
+                // The decomposition is installed in the next generation, when the optimization is resumed
+                decomposition.get();
+                pending = true;
+            } else {
+                complete_decomposition();
+            }
+        }
+        stopwatch.stop();
 
         yw = f(xw, n) + constraint.cost(xw, n);
     }
@@ -285,6 +1548,7 @@ namespace especia {
     /// @param[in] C The covariance matrix (upper triangular part only, in column-major layout).
     /// @param[in] s The global step size.
     /// @param[out] z The parameter uncertainties.
+    /// @param[in] pool The pool of threads to evaluate the objective function.
     template<class F, class Constraint>
     void postopti(const F &f, const Constraint &constraint, natural n,
                   const real x[],
@@ -292,62 +1556,73 @@ namespace especia {
                   const real B[],
                   const real C[],
                   const real s,
-                  real z[]) {
+                  real z[],
+                  const Thread_Pool &pool) {
         using std::abs;
         using std::exp;
         using std::log;
         using std::sqrt;
         using std::valarray;
-        using std::thread;
+
+        const Evaluator<F, Constraint> evaluate(f, constraint, n);
 
         const real zx = f(&x[0], n) + constraint.cost(&x[0], n);
         // The rescaled global step sizes
         valarray<real> g(s, n);
+        // The computation steps, which are too small (a) and too large (b), and the current computation step (c)
+        valarray<real> a(0.0, n);
+        valarray<real> b(0.0, n);
+        valarray<real> c(s, n);
 
+        // The principal axes are bracketed concurrently. In each round, the two steps along every
+        // principal axis not yet bracketed are evaluated at once.
+        std::vector<natural> axes(n);
         for (natural j = 0; j < n; ++j) {
-            real a = 0.0;
-            real b = 0.0;
-            real c = g[j];
-
-            do {
-                // Compute two steps along a principal axis in opposite directions
-                valarray<real> p(x, n);
-                valarray<real> q(x, n);
+            axes[j] = j;
+        }
+        valarray<valarray<real>> pq(valarray<real>(x, n), 2 * n);
+        valarray<const real *> pqk(2 * n);
+        valarray<real> zpq(2 * n);
+
+        while (not axes.empty()) {
+            const auto m = static_cast<natural>(axes.size());
+
+            // Compute two steps along a principal axis in opposite directions
+            for (natural k = 0; k < m; ++k) {
+                const natural j = axes[k];
+                valarray<real> &p = pq[2 * k];
+                valarray<real> &q = pq[2 * k + 1];
+
                 for (natural i = 0, ij = j * n; i < n; ++i, ++ij) {
-                    p[i] += c * B[ij] * d[j];
-                    q[i] -= c * B[ij] * d[j];
-                }
-                real zp;
-                real zq;
-#ifdef _OPENMP
-#pragma omp parallel
-                {
-#pragma omp sections
-                    {
-#pragma omp section
-                        zp = f(&p[0], n) + constraint.cost(&p[0], n);
-#pragma omp section
-                        zq = f(&q[0], n) + constraint.cost(&q[0], n);
-                    }
+                    p[i] = x[i] + c[j] * B[ij] * d[j];
+                    q[i] = x[i] - c[j] * B[ij] * d[j];
                 }
-#else // C++-11
-                thread tp([&f, &constraint, &p, n, &zp]() { zp = f(&p[0], n) + constraint.cost(&p[0], n); });
-                thread tq([&f, &constraint, &q, n, &zq]() { zq = f(&q[0], n) + constraint.cost(&q[0], n); });
-                tp.join();
-                tq.join();
-#endif
+                pqk[2 * k] = &p[0];
+                pqk[2 * k + 1] = &q[0];
+            }
+            evaluate(2 * m, &pqk[0], &zpq[0], pool);
+
+            natural remaining = 0;
+            for (natural k = 0; k < m; ++k) {
+                const natural j = axes[k];
+                const real zp = zpq[2 * k];
+                const real zq = zpq[2 * k + 1];
                 // Compute the rescaled global step size
-                g[j] = c / sqrt(abs((zp + zq) - (zx + zx)));
+                g[j] = c[j] / sqrt(abs((zp + zq) - (zx + zx)));
 
-                // Make a smaller or larger computation step in the next iteration
+                // Make a smaller or larger computation step in the next round
                 if (abs(0.5 * (zp + zq) - zx) < 0.5) {
-                    a = c;
-                    c = c * 1.618;
+                    a[j] = c[j];
+                    c[j] = c[j] * 1.618;
                 } else {
-                    b = c;
-                    c = c * 0.618;
+                    b[j] = c[j];
+                    c[j] = c[j] * 0.618;
                 }
-            } while (a == 0.0 or b == 0.0); // the computation step is too small or too large
+                if (a[j] == 0.0 or b[j] == 0.0) { // the computation step is too small or too large
+                    axes[remaining++] = j;
+                }
+            }
+            axes.resize(remaining);
         }
         // Take the geometric mean to rescale the covariance matrix
         const real h = exp(g.apply(log).sum() / real(n));
@@ -357,6 +1632,191 @@ namespace especia {
         }
     }
 
+    /// Polishes the parameter values of a least-squares function by means of the Levenberg-Marquardt
+    /// method. The Jacobian matrix of the residuals is computed by central finite differences, which
+    /// are evaluated in parallel. A trial step violating the constraint is rejected like a step not
+    /// decreasing the function value, and a finite difference violating the constraint is replaced
+    /// with a one-sided difference. The parameter uncertainties are computed from the inverse of the
+    /// Gauss-Newton approximation of the Hessian matrix at the polished parameter values.
+    ///
+    /// Further reading:
+    ///
+    /// J. J. Moré (1978).
+    ///   *The Levenberg-Marquardt algorithm: Implementation and theory.*
+    ///   Numerical Analysis, Lecture Notes in Mathematics, 630, 105, ISBN 978-3-540-08538-6.
+    ///
+    /// @tparam F The function type.
+    /// @tparam Constraint The constraint type.
+    ///
+    /// @param[in] f The objective function.
+    /// @param[in] constraint The constraint on parameter values.
+    /// @param[in] n The number of parameter values.
+    /// @param[in,out] x The parameter values. Are changed only if the polishing converges.
+    /// @param[in] h The finite difference steps.
+    /// @param[in] accuracy_goal The accuracy goal.
+    /// @param[out] y The function value at the polished parameter values.
+    /// @param[out] z The parameter uncertainties.
+    /// @param[in] pool The pool of threads to evaluate the objective function.
+    /// @return @c true, if the polishing has converged. Is @c false, if the function type is not a
+    /// least-squares function (see @c Is_Least_Squares).
+    template<class F, class Constraint>
+    bool polish(const F &f, const Constraint &constraint, natural n,
+                real x[],
+                const real h[],
+                const real accuracy_goal,
+                real &y,
+                real z[],
+                const Thread_Pool &pool) {
+        return polish(f, constraint, n, x, h, accuracy_goal, y, z, pool,
+                      std::integral_constant<bool, Is_Least_Squares<F>::value>());
+    }
+
+    /// Does not polish the parameter values of a function, which is not a least-squares function.
+    ///
+    /// @return @c false.
+    template<class F, class Constraint>
+    bool polish(const F &, const Constraint &, natural, real[], const real[], real, real &, real[],
+                const Thread_Pool &, std::false_type) {
+        return false;
+    }
+
+    /// Polishes the parameter values of a least-squares function by means of the Levenberg-Marquardt
+    /// method.
+    ///
+    /// @return @c true, if the polishing has converged.
+    template<class F, class Constraint>
+    bool polish(const F &f, const Constraint &constraint, natural n,
+                real x[],
+                const real h[],
+                const real accuracy_goal,
+                real &y,
+                real z[],
+                const Thread_Pool &pool,
+                std::true_type) {
+        using std::max;
+        using std::numeric_limits;
+        using std::sqrt;
+        using std::valarray;
+
+        const real max_covariance_matrix_condition = 0.01 / numeric_limits<real>::epsilon();
+        const real max_damping = 1.0E+16;
+        const natural max_iteration_count = 100;
+
+        const natural m = f.get_residual_count();
+        if (m < n) {
+            return false;
+        }
+
+        valarray<real> xk(x, n);
+        valarray<real> xt(n);
+        valarray<real> r(m);
+        valarray<real> rt(m);
+        valarray<real> Jt(n * m);
+        valarray<real> A(n * n);
+        valarray<real> M(n * n);
+        valarray<real> g(n);
+        valarray<real> delta(n);
+        valarray<valarray<real>> xp(xk, 2 * n);
+        valarray<valarray<real>> rp(r, 2 * n);
+
+        // Computes the transposed Jacobian matrix, i.e. Jt[k * n + j] is the derivative of the
+        // residual k with respect to the parameter j
+        const auto jacobian = [&]() {
+            pool.for_each(2 * n, [&](natural t) {
+                const natural j = t / 2;
+
+                xp[t] = xk;
+                xp[t][j] += (t % 2 == 0) ? h[j] : -h[j];
+                if (constraint.is_violated(&xp[t][0], n)) {
+                    xp[t][j] = xk[j];
+                    rp[t] = r;
+                } else {
+                    f.residuals(&xp[t][0], n, &rp[t][0]);
+                }
+            }, 1);
+            for (natural j = 0; j < n; ++j) {
+                const real dj = xp[2 * j][j] - xp[2 * j + 1][j];
+
+                for (natural k = 0; k < m; ++k) {
+                    Jt[k * n + j] = (dj != 0.0) ? (rp[2 * j][k] - rp[2 * j + 1][k]) / dj : 0.0;
+                }
+            }
+            rank_k_update(n, m, 1.0, &Jt[0], 0.0, &A[0]);
+        };
+
+        f.residuals(&xk[0], n, &r[0]);
+        real cost = 0.5 * (r * r).sum() + constraint.cost(&xk[0], n);
+        real damping = 1.0E-03;
+        bool converged = false;
+
+        for (natural iteration = 0; iteration < max_iteration_count and not converged;) {
+            jacobian();
+            for (natural j = 0; j < n; ++j) {
+                g[j] = 0.0;
+                for (natural k = 0; k < m; ++k) {
+                    g[j] += Jt[k * n + j] * r[k];
+                }
+            }
+            for (;;) {
+                ++iteration;
+                // Solve the damped normal equations (A + damping diag(A)) delta = -g
+                M = A;
+                for (natural j = 0, jj = 0; j < n; ++j, jj += n + 1) {
+                    M[jj] += damping * max(A[jj], 1.0 / max_covariance_matrix_condition);
+                    delta[j] = -g[j];
+                }
+                if (solve(n, &M[0], &delta[0])) {
+                    xt = xk + delta;
+                    // The step is below the accuracy goal, like the final CMA-ES mutation
+                    converged = true;
+                    for (natural j = 0; j < n; ++j) {
+                        if (sq(delta[j]) >= sq(accuracy_goal * xk[j]) + 1.0 / max_covariance_matrix_condition) {
+                            converged = false;
+                            break;
+                        }
+                    }
+                    if (not constraint.is_violated(&xt[0], n)) {
+                        f.residuals(&xt[0], n, &rt[0]);
+
+                        const real trial = 0.5 * (rt * rt).sum() + constraint.cost(&xt[0], n);
+                        if (trial < cost) {
+                            xk = xt;
+                            r = rt;
+                            cost = trial;
+                            damping = max(0.1 * damping, 1.0 / max_covariance_matrix_condition);
+                            break;
+                        }
+                    }
+                    if (converged) {
+                        break;
+                    }
+                }
+                damping *= 10.0;
+                if (damping > max_damping or iteration >= max_iteration_count) {
+                    return false;
+                }
+            }
+        }
+        if (not converged) {
+            return false;
+        }
+
+        // The parameter uncertainties
+        jacobian();
+        if (not invert(n, &A[0])) {
+            return false;
+        }
+        for (natural j = 0, jj = 0; j < n; ++j, jj += n + 1) {
+            z[j] = sqrt(A[jj]);
+        }
+        for (natural j = 0; j < n; ++j) {
+            x[j] = xk[j];
+        }
+        y = f(x, n) + constraint.cost(x, n);
+
+        return true;
+    }
+
 }
 
 #endif // ESPECIA_OPTIMIZE_H
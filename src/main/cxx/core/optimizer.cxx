@@ -3,10 +3,39 @@
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
 
 #include "optimizer.h"
 
+using especia::real;
+using especia::word64;
+
+/// The signature of the checkpoint format, including the format version.
+static const char checkpoint_signature[8] = {'E', 'S', 'P', 'C', 'K', 'P', 'T', '\x02'};
+
+/// The byte order mark of the checkpoint format.
+static const std::uint32_t checkpoint_byte_order_mark = 0x01020304;
+
+/// The number of status flag bytes, which follow the byte order mark of the checkpoint format.
+static const size_t checkpoint_flag_size = 4;
+
+/// The status flag (first byte), which is set while an asynchronous decomposition is pending.
+static const char checkpoint_pending = '\x01';
+
+/// The status flag (first byte), which is set when the polishing has been attempted.
+static const char checkpoint_polish_attempted = '\x02';
+
+/// The signature of the optimization state format, including the format version.
+static const char state_signature[] = "especia-state-1";
+
 especia::Optimizer::Builder::Builder() : weights(parent_number) {
     with_strategy_parameters();
 }
@@ -19,7 +48,29 @@ especia::Optimizer::Builder &especia::Optimizer::Builder::with_defaults() {
             with_covariance_update_modulus().
             with_accuracy_goal().
             with_stop_generation().
-            with_random_seed();
+            with_random_seed().
+            with_block_sampling().
+            with_blas_update().
+            with_parallel_sampling().
+            with_separable().
+            with_decompose_driver().
+            with_async_decompose().
+            with_racing().
+            with_boundary_strategy().
+            with_rejection_limit().
+            with_fitness_tolerance().
+            with_parameter_tolerance().
+            with_no_effect_axis().
+            with_no_effect_coordinate().
+            with_max_condition().
+            with_stagnation().
+            with_polish_threshold().
+            with_restart_count().
+            with_restart_strategy().
+            with_thread_count().
+            with_thread_pool().
+            with_checkpoint_path().
+            with_checkpoint_modulus();
 }
 
 especia::Optimizer::Builder &especia::Optimizer::Builder::with_problem_dimension(natural n) {
@@ -69,6 +120,120 @@ especia::Optimizer::Builder &especia::Optimizer::Builder::with_stop_generation(n
     return *this;
 }
 
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_block_sampling(bool block_sampling) {
+    this->block_sampling = block_sampling;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_blas_update(bool blas_update) {
+    this->blas_update = blas_update;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_parallel_sampling(bool parallel_sampling) {
+    this->parallel_sampling = parallel_sampling;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_separable(bool separable) {
+    if (separable != this->separable) {
+        this->separable = separable;
+        with_strategy_parameters();
+    }
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_decompose_driver(Decompose::Driver decompose_driver) {
+    this->decompose_driver = decompose_driver;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_async_decompose(bool async_decompose) {
+    this->async_decompose = async_decompose;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_racing(bool racing) {
+    this->racing = racing;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_boundary_strategy(Boundary_Strategy boundary_strategy) {
+    this->boundary_strategy = boundary_strategy;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_rejection_limit(natural rejection_limit) {
+    this->rejection_limit = rejection_limit;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_fitness_tolerance(real fitness_tolerance) {
+    this->termination_criteria.fitness_tolerance = fitness_tolerance;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_parameter_tolerance(real parameter_tolerance) {
+    this->termination_criteria.parameter_tolerance = parameter_tolerance;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_no_effect_axis(bool no_effect_axis) {
+    this->termination_criteria.no_effect_axis = no_effect_axis;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_no_effect_coordinate(bool no_effect_coordinate) {
+    this->termination_criteria.no_effect_coordinate = no_effect_coordinate;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_max_condition(real max_condition) {
+    this->termination_criteria.max_condition = max_condition;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_stagnation(bool stagnation) {
+    this->termination_criteria.stagnation = stagnation;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_polish_threshold(real polish_threshold) {
+    this->polish_threshold = polish_threshold;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_restart_count(natural restart_count) {
+    this->restart_count = restart_count;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_restart_strategy(Restart_Strategy restart_strategy) {
+    this->restart_strategy = restart_strategy;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_thread_count(natural thread_count) {
+    this->thread_count = thread_count;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_checkpoint_path(const std::string &checkpoint_path) {
+    this->checkpoint_path = checkpoint_path;
+    return *this;
+}
+
+especia::Optimizer::Builder &especia::Optimizer::Builder::with_checkpoint_modulus(natural checkpoint_modulus) {
+    this->checkpoint_modulus = checkpoint_modulus;
+    return *this;
+}
+
+especia::Optimizer::Builder &
+especia::Optimizer::Builder::with_thread_pool(const std::shared_ptr<const Thread_Pool> &thread_pool) {
+    this->thread_pool = thread_pool;
+    return *this;
+}
+
 especia::Optimizer especia::Optimizer::Builder::build() {
     return Optimizer(*this);
 }
@@ -91,9 +256,37 @@ void especia::Optimizer::Builder::with_strategy_parameters() {
 
     acov = 2.0 / (sq(n + 1.3) + wv);
     ccov = min<real>(1.0 - acov, 2.0 * (wv - 2.0 + 1.0 / wv) / (sq(n + 2.0) + wv));
+    if (separable) {
+        // Ros & Hansen (2008)
+        acov = min<real>(1.0, acov * (n + 2.0) / 3.0);
+        ccov = min<real>(1.0 - acov, ccov * (n + 2.0) / 3.0);
+    }
     step_size_damping = cs + 1.0 + 2.0 * max<real>(0.0, sqrt((wv - 1.0) / (n + 1.0)) - 1.0);
 }
 
+especia::natural especia::Optimizer::Builder::get_automatic_update_modulus() const {
+    using std::floor;
+    using std::max;
+
+    // Hansen (2016, arXiv:1604.00772, Sect. B.2)
+    return max<natural>(1, static_cast<natural>(floor(1.0 / (10.0 * n * (acov + ccov)))));
+}
+
+especia::Strategy_Options especia::Optimizer::Builder::get_strategy_options() const {
+    Strategy_Options options;
+
+    options.block_sampling = block_sampling;
+    options.blas_update = blas_update;
+    options.separable = separable;
+    options.async_decompose = async_decompose;
+    options.racing = racing;
+    options.boundary_strategy = boundary_strategy;
+    options.rejection_limit = rejection_limit;
+    options.criteria = termination_criteria;
+
+    return options;
+}
+
 especia::Optimizer::Result::Result(natural n,
                                    const valarray<real> &x_in,
                                    const valarray<real> &d_in,
@@ -108,15 +301,398 @@ especia::Optimizer::Result::Result(natural n,
 
     optimized = false;
     underflow = false;
+    termination = Termination::none;
+    polish_attempted = false;
+    pending = false;
 
     g = 0;
+    r = 0;
 }
 
 especia::Optimizer::Result::~Result() = default;
 
 especia::Optimizer::Optimizer(const especia::Optimizer::Builder &builder)
-        : config(builder), decompose(builder.get_problem_dimension()), deviate(builder.get_random_seed()) {
+        : config(builder),
+          decompose(builder.get_problem_dimension(), builder.get_decompose_driver()),
+          deviate(builder.get_random_seed()),
+          pool(builder.get_thread_pool() ? builder.get_thread_pool()
+                                         : std::make_shared<Thread_Pool>(builder.get_thread_count())) {
 
 }
 
 especia::Optimizer::~Optimizer() = default;
+
+void especia::Optimizer::configure_restarts(std::vector<Builder> &configs, std::vector<real> &step_size_factors) const {
+    using std::floor;
+    using std::max;
+    using std::pow;
+
+    const natural m = config.get_restart_count() + 1;
+    const natural parent_number = config.get_parent_number();
+    const natural population_size = config.get_population_size();
+    const bool bipop = config.get_restart_strategy() == Restart_Strategy::bipop;
+
+    configs.assign(m, config);
+    step_size_factors.assign(m, 1.0);
+
+    natural total_population_size = 0;
+    for (natural r = 0; r < m; ++r) {
+        // The initial run is configured like a run without restarts, each restart is seeded independently
+        const Pcg_32 random = Pcg_32::for_stream(config.get_random_seed(), r);
+        const word64 seed = r == 0 ? config.get_random_seed() : (word64(random.rand()) << 32) | random.rand();
+
+        natural parents;
+        natural population;
+        if (bipop and r % 2 == 1) {
+            // A regime of small population size with a random population size and step size
+            const real u = random();
+            const real large_population_size = population_size * pow(2.0, (r + 1) / 2);
+
+            population = max<natural>(2, static_cast<natural>(
+                    floor(population_size * pow(large_population_size / population_size, u * u))));
+            parents = max<natural>(1, parent_number * population / population_size);
+            step_size_factors[r] = pow(10.0, -2.0 * u);
+        } else {
+            // A regime of increasing population size
+            const natural k = bipop ? r / 2 : r;
+
+            population = population_size << k;
+            parents = parent_number << k;
+        }
+
+        configs[r].with_restart_count(0).
+                with_checkpoint_path("").
+                with_thread_pool(nullptr).
+                with_parent_number(parents).
+                with_population_size(population).
+                with_random_seed(seed);
+        total_population_size += population;
+    }
+    // The threads are shared in proportion to the population size
+    for (natural r = 0; r < m; ++r) {
+        const natural thread_count = pool->get_thread_count() * configs[r].get_population_size() / total_population_size;
+
+        configs[r].with_thread_count(max<natural>(1, thread_count));
+    }
+}
+
+especia::Optimizer::Result especia::Optimizer::warm_start(const valarray<real> &x,
+                                                          const valarray<real> &d,
+                                                          const real s,
+                                                          const Result &prior,
+                                                          const std::vector<natural> &indexes) const {
+    using std::invalid_argument;
+    using std::max;
+    using std::sqrt;
+
+    const natural n = config.get_problem_dimension();
+    const natural m = static_cast<natural>(prior.x.size());
+
+    if (x.size() != n or d.size() != n or indexes.size() != n) {
+        throw invalid_argument(
+                "especia::Optimizer::warm_start() Error: the number of parameters does not match the optimizer configuration");
+    }
+
+    bool verbatim = (m == n);
+    for (natural i = 0; i < n and verbatim; ++i) {
+        verbatim = (indexes[i] == i);
+    }
+    if (verbatim) {
+        return prior;
+    }
+
+    // The covariances of new parameters are scaled, so their initial step sizes are as requested
+    const real t = s / prior.s;
+
+    Result state(n, x, d, prior.s);
+    for (natural j = 0, jj = 0; j < n; ++j, jj += n + 1) {
+        const natural pj = indexes[j];
+
+        if (pj < m) {
+            state.x[j] = prior.x[pj];
+            state.pc[j] = prior.pc[pj];
+
+            for (natural i = 0, ij = j * n; i <= j; ++i, ++ij) {
+                const natural pi = indexes[i];
+
+                if (pi < m) {
+                    state.C[ij] = pi <= pj ? prior.C[pj * m + pi] : prior.C[pi * m + pj];
+                }
+            }
+        } else {
+            state.C[jj] = sq(t * d[j]);
+        }
+    }
+
+    if (config.is_separable()) {
+        for (natural j = 0, jj = 0; j < n; ++j, jj += n + 1) {
+            for (natural i = 0, ij = j * n; i < j; ++i, ++ij) {
+                state.C[ij] = 0.0;
+            }
+            state.d[j] = sqrt(state.C[jj]);
+        }
+    } else {
+        decompose(&state.C[0], &state.B[0], &state.d[0]);
+
+        // Limits the condition of the covariance matrix like the optimization does
+        const real max_covariance_matrix_condition = 0.01 / std::numeric_limits<real>::epsilon();
+        const real u = state.d[n - 1] / max_covariance_matrix_condition - state.d[0];
+        for (natural i = 0, ii = 0; i < n; ++i, ii += n + 1) {
+            if (u > 0.0) {
+                state.C[ii] += u;
+                state.d[i] += u;
+            }
+            state.d[i] = sqrt(max<real>(state.d[i], 0.0));
+        }
+    }
+
+    return state;
+}
+
+std::ostream &especia::Optimizer::write_state(std::ostream &os,
+                                              const Result &state,
+                                              const std::vector<std::string> &names) {
+    using std::endl;
+    using std::ios_base;
+
+    const natural n = static_cast<natural>(state.x.size());
+
+    const ios_base::fmtflags fmt = os.flags();
+    const std::streamsize precision = os.precision();
+
+    os.setf(ios_base::fmtflags());
+    os.setf(ios_base::scientific, ios_base::floatfield);
+    os.precision(std::numeric_limits<real>::max_digits10);
+
+    os << state_signature << endl;
+    os << n << " " << state.s << " " << state.y << endl;
+    for (natural i = 0; i < n; ++i) {
+        os << (i < names.size() ? names[i] : std::to_string(i)) << " "
+           << state.x[i] << " " << state.d[i] << " " << state.pc[i] << " " << state.ps[i] << endl;
+    }
+    for (natural j = 0; j < n; ++j) {
+        for (natural i = 0, ij = j * n; i < n; ++i, ++ij) {
+            os << (i > 0 ? " " : "") << state.B[ij];
+        }
+        os << endl;
+    }
+    for (natural j = 0; j < n; ++j) {
+        for (natural i = 0, ij = j * n; i <= j; ++i, ++ij) {
+            os << (i > 0 ? " " : "") << state.C[ij];
+        }
+        os << endl;
+    }
+
+    os.flags(fmt);
+    os.precision(precision);
+
+    return os;
+}
+
+especia::Optimizer::Result especia::Optimizer::read_state(std::istream &is, std::vector<std::string> &names) {
+    using std::runtime_error;
+
+    std::string signature;
+    natural n = 0;
+    real s = 0.0;
+    real y = 0.0;
+
+    if (not(is >> signature >> n >> s >> y) or signature != state_signature or n == 0) {
+        throw runtime_error("especia::Optimizer::read_state() Error: the optimization state cannot be read");
+    }
+
+    Result state(n, valarray<real>(0.0, n), valarray<real>(1.0, n), s);
+    state.y = y;
+
+    names.resize(n);
+    for (natural i = 0; i < n; ++i) {
+        is >> names[i] >> state.x[i] >> state.d[i] >> state.pc[i] >> state.ps[i];
+    }
+    for (natural j = 0; j < n; ++j) {
+        for (natural i = 0, ij = j * n; i < n; ++i, ++ij) {
+            is >> state.B[ij];
+        }
+    }
+    for (natural j = 0; j < n; ++j) {
+        for (natural i = 0, ij = j * n; i <= j; ++i, ++ij) {
+            is >> state.C[ij];
+        }
+    }
+    if (not is) {
+        throw runtime_error("especia::Optimizer::read_state() Error: the optimization state cannot be read");
+    }
+
+    return state;
+}
+
+std::vector<especia::Optimizer::Deviate> especia::Optimizer::create_streams() const {
+    std::vector<Deviate> streams;
+
+    if (config.is_parallel_sampling()) {
+        streams.reserve(config.get_population_size());
+        for (natural k = 0; k < config.get_population_size(); ++k) {
+            streams.emplace_back(config.get_random_seed(), k);
+        }
+    }
+
+    return streams;
+}
+
+/// Writes an array of real numbers to an output stream (binary format).
+///
+/// @param[in,out] os The output stream.
+/// @param[in] x The array.
+/// @return the output stream.
+static std::ostream &put_array(std::ostream &os, const valarray<real> &x) {
+    return os.write(reinterpret_cast<const char *>(&x[0]), static_cast<std::streamsize>(x.size() * sizeof(real)));
+}
+
+/// Reads an array of real numbers from an input stream (binary format).
+///
+/// @param[in,out] is The input stream.
+/// @param[out] x The array. The size of the array determines the number of values read.
+/// @return the input stream.
+static std::istream &get_array(std::istream &is, valarray<real> &x) {
+    return is.read(reinterpret_cast<char *>(&x[0]), static_cast<std::streamsize>(x.size() * sizeof(real)));
+}
+
+/// Writes a vector of real numbers to an output stream (binary format).
+///
+/// @param[in,out] os The output stream.
+/// @param[in] x The vector.
+/// @return the output stream.
+static std::ostream &put_array(std::ostream &os, const std::vector<real> &x) {
+    return os.write(reinterpret_cast<const char *>(x.data()), static_cast<std::streamsize>(x.size() * sizeof(real)));
+}
+
+/// Reads a vector of real numbers from an input stream (binary format).
+///
+/// @param[in,out] is The input stream.
+/// @param[out] x The vector. The size of the vector determines the number of values read.
+/// @return the input stream.
+static std::istream &get_array(std::istream &is, std::vector<real> &x) {
+    return is.read(reinterpret_cast<char *>(x.data()), static_cast<std::streamsize>(x.size() * sizeof(real)));
+}
+
+void especia::Optimizer::read_checkpoint(const std::string &path,
+                                         const std::vector<Deviate> &streams,
+                                         Result &result) const {
+    using std::ifstream;
+    using std::memcmp;
+    using std::runtime_error;
+
+    ifstream is(path, std::ios_base::binary);
+    if (!is) {
+        throw runtime_error("especia::Optimizer::read_checkpoint() Error: the checkpoint file '" + path +
+                            "' cannot be opened");
+    }
+
+    char header[sizeof(checkpoint_signature) + sizeof(checkpoint_byte_order_mark) + checkpoint_flag_size];
+    word64 dimensions[6];
+    is.read(header, sizeof(header));
+    is.read(reinterpret_cast<char *>(dimensions), sizeof(dimensions));
+
+    std::uint32_t bom = 0;
+    std::memcpy(&bom, &header[sizeof(checkpoint_signature)], sizeof(bom));
+    if (!is or memcmp(header, checkpoint_signature, sizeof(checkpoint_signature)) != 0 or
+        bom != checkpoint_byte_order_mark) {
+        throw runtime_error("especia::Optimizer::read_checkpoint() Error: the file '" + path +
+                            "' is not a checkpoint file");
+    }
+    if (dimensions[0] != config.get_problem_dimension() or
+        dimensions[1] != config.get_parent_number() or
+        dimensions[2] != config.get_population_size() or
+        dimensions[3] != streams.size()) {
+        throw runtime_error("especia::Optimizer::read_checkpoint() Error: the checkpoint '" + path +
+                            "' does not match the optimizer configuration");
+    }
+
+    // The fitness history is never longer than 20000 generations
+    if (dimensions[5] > 20000) {
+        throw runtime_error("especia::Optimizer::read_checkpoint() Error: the checkpoint '" + path +
+                            "' is corrupt");
+    }
+
+    real scalars[2];
+    is.read(reinterpret_cast<char *>(scalars), sizeof(scalars));
+
+    result.__generation_number() = static_cast<natural>(dimensions[4]);
+    result.__global_step_size() = scalars[0];
+    result.__fitness() = scalars[1];
+
+    get_array(is, result.x);
+    get_array(is, result.d);
+    get_array(is, result.B);
+    get_array(is, result.C);
+    get_array(is, result.ps);
+    get_array(is, result.pc);
+    result.best_history.resize(static_cast<size_t>(dimensions[5]));
+    result.median_history.resize(static_cast<size_t>(dimensions[5]));
+    get_array(is, result.best_history);
+    get_array(is, result.median_history);
+    deviate.get(is);
+    for (const auto &stream : streams) {
+        stream.get(is);
+    }
+    if (!is or is.peek() != std::char_traits<char>::eof()) {
+        throw runtime_error("especia::Optimizer::read_checkpoint() Error: the checkpoint '" + path +
+                            "' is corrupt");
+    }
+
+    result.__optimized() = false;
+    result.__underflow() = false;
+    result.__termination() = Termination::none;
+    const char flags = header[sizeof(checkpoint_signature) + sizeof(checkpoint_byte_order_mark)];
+    result.__pending() = (flags & checkpoint_pending) != 0;
+    result.__polish_attempted() = (flags & checkpoint_polish_attempted) != 0;
+}
+
+void especia::Optimizer::write_checkpoint(const std::vector<Deviate> &streams, const Result &result) const {
+    using std::ofstream;
+    using std::runtime_error;
+
+    const std::string &path = config.get_checkpoint_path();
+    const std::string temporary_path = path + ".tmp";
+    {
+        ofstream os(temporary_path, std::ios_base::binary | std::ios_base::trunc);
+
+        const char flags[checkpoint_flag_size] = {
+                static_cast<char>((result.pending ? checkpoint_pending : 0) |
+                                  (result.polish_attempted ? checkpoint_polish_attempted : 0)), 0, 0, 0};
+        const word64 dimensions[] = {config.get_problem_dimension(),
+                                     config.get_parent_number(),
+                                     config.get_population_size(),
+                                     streams.size(),
+                                     result.get_generation_number(),
+                                     result.best_history.size()};
+        const real scalars[] = {result.get_global_step_size(), result.get_fitness()};
+
+        os.write(checkpoint_signature, sizeof(checkpoint_signature));
+        os.write(reinterpret_cast<const char *>(&checkpoint_byte_order_mark), sizeof(checkpoint_byte_order_mark));
+        os.write(flags, sizeof(flags));
+        os.write(reinterpret_cast<const char *>(dimensions), sizeof(dimensions));
+        os.write(reinterpret_cast<const char *>(scalars), sizeof(scalars));
+        put_array(os, result.x);
+        put_array(os, result.d);
+        put_array(os, result.B);
+        put_array(os, result.C);
+        put_array(os, result.ps);
+        put_array(os, result.pc);
+        put_array(os, result.best_history);
+        put_array(os, result.median_history);
+        deviate.put(os);
+        for (const auto &stream : streams) {
+            stream.put(os);
+        }
+        os.close();
+
+        if (!os) {
+            throw runtime_error("especia::Optimizer::write_checkpoint() Error: the checkpoint file '" +
+                                temporary_path + "' cannot be written");
+        }
+    }
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        throw runtime_error("especia::Optimizer::write_checkpoint() Error: the checkpoint file '" + path +
+                            "' cannot be replaced");
+    }
+}
@@ -6,13 +6,21 @@
 #ifndef ESPECIA_OPTIMIZER_H
 #define ESPECIA_OPTIMIZER_H
 
+#include <algorithm>
 #include <cstddef>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "decompose.h"
 #include "deviates.h"
 #include "optimize.h"
 #include "random.h"
+#include "threads.h"
 
 using std::valarray;
 
@@ -39,6 +47,20 @@ namespace especia {
             return false;
         }
 
+        /// Reflects a given parameter vector into the feasible box.
+        ///
+        /// @param[in,out] x The parameter vector. Is not modified.
+        /// @param[in] n The number of parameters.
+        void reflect(T x[], natural n) const {
+        }
+
+        /// Projects a given parameter vector onto the feasible box.
+        ///
+        /// @param[in,out] x The parameter vector. Is not modified.
+        /// @param[in] n The number of parameters.
+        void repair(T x[], natural n) const {
+        }
+
         /// Computes the cost associated with the constraint.
         ///
         /// @param[in] x The parameter vector.
@@ -94,6 +116,14 @@ namespace especia {
     ///   Evolutionary Computation, 9, 159, ISSN 1063-6560.
     class Optimizer {
     public:
+        /// The restart strategies.
+        enum class Restart_Strategy {
+            /// Restarts with increasing population size (Auger and Hansen, 2005).
+            ipop,
+            /// Restarts alternating between increasing and small random population sizes (Hansen, 2009).
+            bipop
+        };
+
         /// Builds a new optimizer.
         class Builder {
         public:
@@ -129,11 +159,12 @@ namespace especia {
                 return population_size;
             }
 
-            /// Returns the covariance matrix update modulus.
+            /// Returns the covariance matrix update modulus. When configured to be zero, the
+            /// update modulus is derived from the covariance matrix adaption rates.
             ///
             /// @return the covariance matrix update modulus.
             natural get_covariance_update_modulus() const {
-                return update_modulus;
+                return update_modulus > 0 ? update_modulus : get_automatic_update_modulus();
             }
 
             /// Returns the accuracy goal.
@@ -157,6 +188,130 @@ namespace especia {
                 return stop_generation;
             }
 
+            /// Returns whether the offspring are sampled by means of a matrix product.
+            ///
+            /// @return @c true, if the offspring are sampled by means of a matrix product.
+            bool is_block_sampling() const {
+                return block_sampling;
+            }
+
+            /// Returns whether the covariance matrix is adapted by calling the BLAS.
+            ///
+            /// @return @c true, if the covariance matrix is adapted by calling the BLAS.
+            bool is_blas_update() const {
+                return blas_update;
+            }
+
+            /// Returns whether the offspring are sampled in parallel.
+            ///
+            /// @return @c true, if the offspring are sampled in parallel.
+            bool is_parallel_sampling() const {
+                return parallel_sampling;
+            }
+
+            /// Returns whether a diagonal covariance matrix is adapted only.
+            ///
+            /// @return @c true, if a diagonal covariance matrix is adapted only.
+            bool is_separable() const {
+                return separable;
+            }
+
+            /// Returns the LAPACK driver to compute the eigenvalue decomposition.
+            ///
+            /// @return the LAPACK driver.
+            Decompose::Driver get_decompose_driver() const {
+                return decompose_driver;
+            }
+
+            /// Returns whether the eigenvalue decomposition is performed asynchronously.
+            ///
+            /// @return @c true, if the eigenvalue decomposition is performed asynchronously.
+            bool is_async_decompose() const {
+                return async_decompose;
+            }
+
+            /// Returns whether the offspring are evaluated by racing.
+            ///
+            /// @return @c true, if the offspring are evaluated by racing.
+            bool is_racing() const {
+                return racing;
+            }
+
+            /// Returns the boundary strategy.
+            ///
+            /// @return the boundary strategy.
+            Boundary_Strategy get_boundary_strategy() const {
+                return boundary_strategy;
+            }
+
+            /// Returns the maximum number of samples rejected for an offspring.
+            ///
+            /// @return the maximum number of samples rejected for an offspring.
+            natural get_rejection_limit() const {
+                return rejection_limit;
+            }
+
+            /// Returns the termination criteria.
+            ///
+            /// @return the termination criteria.
+            const Termination_Criteria &get_termination_criteria() const {
+                return termination_criteria;
+            }
+
+            /// Returns the options of the evolution strategy.
+            ///
+            /// @return the options of the evolution strategy.
+            Strategy_Options get_strategy_options() const;
+
+            /// Returns the polish threshold.
+            ///
+            /// @return the polish threshold.
+            real get_polish_threshold() const {
+                return polish_threshold;
+            }
+
+            /// Returns the number of restarts.
+            ///
+            /// @return the number of restarts.
+            natural get_restart_count() const {
+                return restart_count;
+            }
+
+            /// Returns the restart strategy.
+            ///
+            /// @return the restart strategy.
+            Restart_Strategy get_restart_strategy() const {
+                return restart_strategy;
+            }
+
+            /// Returns the number of threads.
+            ///
+            /// @return the number of threads.
+            natural get_thread_count() const {
+                return thread_count;
+            }
+
+            /// Returns the pool of threads to evaluate the objective function.
+            ///
+            /// @return the pool of threads, or @c nullptr if a pool is created by the optimizer.
+            const std::shared_ptr<const Thread_Pool> &get_thread_pool() const {
+                return thread_pool;
+            }
+
+            /// Returns the path name of the checkpoint file.
+            ///
+            /// @return the path name of the checkpoint file.
+            const std::string &get_checkpoint_path() const {
+                return checkpoint_path;
+            }
+
+            /// Returns the checkpoint modulus.
+            ///
+            /// @return the checkpoint modulus.
+            natural get_checkpoint_modulus() const {
+                return checkpoint_modulus;
+            }
+
             /// Returns the recombination weights.
             ///
             /// @return the recombination weights.
@@ -224,9 +379,13 @@ namespace especia {
             /// @return this builder.
             Builder &with_population_size(natural population_size);
 
-            /// Configures the covariance matrix update modulus.
+            /// Configures the covariance matrix update modulus, i.e. the number of generations between
+            /// eigenvalue decompositions of the covariance matrix.
             ///
-            /// @param[in] update_modulus The update modulus.
+            /// @param[in] update_modulus The update modulus. If zero, the update modulus is chosen
+            /// automatically, such that the covariance matrix is decomposed about once in every
+            /// 1 / (10 n (c_1 + c_µ)) generations (Hansen, 2016, arXiv:1604.00772, Sect. B.2). The
+            /// default is one, so automatic scheduling is opt-in.
             /// @return this builder.
             Builder &with_covariance_update_modulus(natural update_modulus = 1);
 
@@ -248,6 +407,196 @@ namespace especia {
             /// @return this builder.
             Builder &with_stop_generation(natural stop_generation = 1000);
 
+            /// Configures whether the offspring are sampled by means of a matrix product, which is
+            /// faster for large problem dimensions. When an offspring violates the constraint, all
+            /// its coordinates are sampled anew.
+            ///
+            /// @param[in] block_sampling Whether to sample the offspring by means of a matrix product.
+            /// @return this builder.
+            Builder &with_block_sampling(bool block_sampling = false);
+
+            /// Configures whether the covariance matrix is adapted by means of symmetric rank-k
+            /// and rank-1 updates calling the BLAS, which is faster for large problem dimensions.
+            /// The result differs from the default adaption by rounding.
+            ///
+            /// @param[in] blas_update Whether to adapt the covariance matrix by calling the BLAS.
+            /// @return this builder.
+            Builder &with_blas_update(bool blas_update = false);
+
+            /// Configures whether the offspring are sampled in parallel. Each offspring is sampled
+            /// from an independent stream of random numbers, so the result does not depend on the
+            /// number of threads. The result differs from serial sampling.
+            ///
+            /// @param[in] parallel_sampling Whether to sample the offspring in parallel.
+            /// @return this builder.
+            Builder &with_parallel_sampling(bool parallel_sampling = false);
+
+            /// Configures whether a diagonal covariance matrix is adapted only (sep-CMA-ES, Ros and
+            /// Hansen, 2008). Sampling and adaption then take linear time and memory per offspring, and
+            /// no eigenvalue decomposition is performed, which makes high problem dimensions feasible.
+            /// The covariance matrix adaption rates are increased by the factor (n + 2) / 3. Block
+            /// sampling and the BLAS update are not applicable.
+            ///
+            /// Further reading:
+            ///
+            /// R. Ros, N. Hansen (2008).
+            ///   *A Simple Modification in CMA-ES Achieving Linear Time and Space Complexity.*
+            ///   Parallel Problem Solving from Nature, PPSN X, 296-305.
+            ///
+            /// @param[in] separable Whether to adapt a diagonal covariance matrix only.
+            /// @return this builder.
+            Builder &with_separable(bool separable = false);
+
+            /// Configures the LAPACK driver to compute the eigenvalue decomposition of the covariance
+            /// matrix. The drivers differ in speed, but yield the same result except for rounding.
+            /// For small problems the Jacobi method avoids the overhead of calling LAPACK.
+            ///
+            /// @param[in] decompose_driver The LAPACK driver.
+            /// @return this builder.
+            Builder &with_decompose_driver(Decompose::Driver decompose_driver = Decompose::Driver::jacobi);
+
+            /// Configures whether the eigenvalue decomposition of the covariance matrix is performed
+            /// asynchronously, while the next population is evaluated. The decomposition then takes
+            /// effect with a delay of one generation. The result differs from the synchronous
+            /// decomposition.
+            ///
+            /// @param[in] async_decompose Whether to perform the eigenvalue decomposition asynchronously.
+            /// @return this builder.
+            Builder &with_async_decompose(bool async_decompose = false);
+
+            /// Configures whether the offspring are evaluated by racing. When the objective function
+            /// is partitioned and provides a lower bound of each partial value (see @c Is_Bounded), the
+            /// offspring are scored by the lower bound first, and only the offspring, which may still
+            /// be among the best, are evaluated exactly. The ranking of the parents is exact, so the
+            /// result is the same as without racing. Racing applies to minimization only.
+            ///
+            /// @param[in] racing Whether to evaluate the offspring by racing.
+            /// @return this builder.
+            Builder &with_racing(bool racing = false);
+
+            /// Configures the handling of offspring, which violate the constraint on parameter values.
+            /// Reflection and repair require a box constraint (see @c Is_Box_Constraint).
+            ///
+            /// @param[in] boundary_strategy The boundary strategy.
+            /// @return this builder.
+            Builder &with_boundary_strategy(Boundary_Strategy boundary_strategy = Boundary_Strategy::rejection);
+
+            /// Configures the maximum number of samples rejected for an offspring in a generation.
+            /// When the limit is reached, the offspring is reflected into the feasible box, or is
+            /// replaced with the parental mean, if the constraint is not a box constraint.
+            ///
+            /// @param[in] rejection_limit The maximum number of samples rejected for an offspring.
+            /// @return this builder.
+            Builder &with_rejection_limit(natural rejection_limit = 1000);
+
+            /// Configures the fitness tolerance (TolFun). The optimization terminates early, when the
+            /// range of the best fitness values of the recent 10 + 30 n / λ generations and the range
+            /// of the fitness values of the recent parents are below the tolerance.
+            ///
+            /// @param[in] fitness_tolerance The fitness tolerance. If zero, the criterion is disabled.
+            /// @return this builder.
+            Builder &with_fitness_tolerance(real fitness_tolerance = 0.0);
+
+            /// Configures the parameter tolerance (TolX). The optimization terminates early, when the
+            /// standard deviation of the mutation distribution and the distribution cumulation path,
+            /// scaled by the global step size, are below the tolerance in all coordinates.
+            ///
+            /// @param[in] parameter_tolerance The parameter tolerance. If zero, the criterion is disabled.
+            /// @return this builder.
+            Builder &with_parameter_tolerance(real parameter_tolerance = 0.0);
+
+            /// Configures whether the optimization terminates early, when adding a tenth of the standard
+            /// deviation along a principal axis does not change the distribution mean (NoEffectAxis).
+            /// The principal axes are tested in turn, one in each generation.
+            ///
+            /// @param[in] no_effect_axis Whether to terminate, if a principal axis has no effect.
+            /// @return this builder.
+            Builder &with_no_effect_axis(bool no_effect_axis = false);
+
+            /// Configures whether the optimization terminates early, when adding a fifth of the standard
+            /// deviation in any coordinate does not change the distribution mean (NoEffectCoord).
+            ///
+            /// @param[in] no_effect_coordinate Whether to terminate, if a coordinate has no effect.
+            /// @return this builder.
+            Builder &with_no_effect_coordinate(bool no_effect_coordinate = false);
+
+            /// Configures the maximum condition number of the covariance matrix (ConditionCov). The
+            /// optimization terminates early, when the condition number is exceeded. Without this
+            /// criterion, the condition number is limited to about 4.5E13 by adding to the diagonal.
+            ///
+            /// @param[in] max_condition The maximum condition number. If zero, the criterion is disabled.
+            /// @return this builder.
+            Builder &with_max_condition(real max_condition = 0.0);
+
+            /// Configures whether the optimization terminates early on stagnation (Stagnation), when
+            /// neither the median of the best fitness values nor the median of the median fitness
+            /// values of the newest 30 percent of the generations are better than of the oldest 30
+            /// percent in a history of the most recent 20 percent of all generations, but at least
+            /// 120 + 30 n / λ and at most 20000 generations.
+            ///
+            /// @param[in] stagnation Whether to terminate on stagnation.
+            /// @return this builder.
+            Builder &with_stagnation(bool stagnation = false);
+
+            /// Configures the polishing of the parameter values by means of the Levenberg-Marquardt
+            /// method. When the objective function is a least-squares function (see @c Is_Least_Squares),
+            /// the optimization stops once the mutation variance is below the polish threshold times
+            /// the accuracy goal, and the polishing takes over from the distribution mean. When the
+            /// polishing converges, the parameter uncertainties are computed from the Jacobian matrix
+            /// of the residuals. Otherwise the optimization proceeds to the accuracy goal. Applies to
+            /// minimization only.
+            ///
+            /// @param[in] polish_threshold The polish threshold. Polishing is disabled, when not greater
+            /// than one.
+            /// @return this builder.
+            Builder &with_polish_threshold(real polish_threshold = 0.0);
+
+            /// Configures the number of restarts. The initial run and all restarts are carried out
+            /// concurrently by independently seeded optimizer instances, which share the threads of
+            /// this optimizer in proportion to their population size. The best result is returned.
+            /// Only the initial run is traced.
+            ///
+            /// @param[in] restart_count The number of restarts.
+            /// @return this builder.
+            Builder &with_restart_count(natural restart_count = 0);
+
+            /// Configures the restart strategy.
+            ///
+            /// @param[in] restart_strategy The restart strategy.
+            /// @return this builder.
+            Builder &with_restart_strategy(Restart_Strategy restart_strategy = Restart_Strategy::ipop);
+
+            /// Configures the number of threads to evaluate the objective function.
+            ///
+            /// @param[in] thread_count The number of threads. If zero, the number of threads equals
+            /// the number of hardware threads.
+            /// @return this builder.
+            Builder &with_thread_count(natural thread_count = 0);
+
+            /// Configures a pool of threads to evaluate the objective function, which is shared with
+            /// other optimizers. When a pool is configured, the number of threads is ignored. Restarts
+            /// do not share the pool.
+            ///
+            /// @param[in] thread_pool The pool of threads. If @c nullptr, a pool is created by the optimizer.
+            /// @return this builder.
+            Builder &with_thread_pool(const std::shared_ptr<const Thread_Pool> &thread_pool = nullptr);
+
+            /// Configures the path name of the checkpoint file. If empty, no checkpoints are written.
+            /// Checkpoints are not written by restarts.
+            ///
+            /// @param[in] checkpoint_path The path name of the checkpoint file.
+            /// @return this builder.
+            Builder &with_checkpoint_path(const std::string &checkpoint_path = "");
+
+            /// Configures the checkpoint modulus, i.e. number of generations between checkpoints.
+            /// A checkpoint contains the complete optimization state, including the state of the
+            /// random number generators, so a resumed optimization yields the same result as an
+            /// optimization without interruption.
+            ///
+            /// @param[in] checkpoint_modulus The checkpoint modulus.
+            /// @return this builder.
+            Builder &with_checkpoint_modulus(natural checkpoint_modulus = 100);
+
         private:
             /// Returns a pointer to the recombination weights.
             ///
@@ -256,6 +605,12 @@ namespace especia {
                 return &weights[0];
             }
 
+            /// Returns the covariance matrix update modulus derived from the covariance matrix
+            /// adaption rates.
+            ///
+            /// @return the covariance matrix update modulus.
+            natural get_automatic_update_modulus() const;
+
             /// Configures strategy parameters like recombination weights, cumulation and adaption rates
             /// according to Hansen (2014, http://cma.gforge.inria.fr/purecmaes.m).
             void with_strategy_parameters();
@@ -281,6 +636,57 @@ namespace especia {
             /// The stop generation.
             natural stop_generation = 1000;
 
+            /// Whether the offspring are sampled by means of a matrix product.
+            bool block_sampling = false;
+
+            /// Whether the covariance matrix is adapted by calling the BLAS.
+            bool blas_update = false;
+
+            /// Whether the offspring are sampled in parallel.
+            bool parallel_sampling = false;
+
+            /// Whether a diagonal covariance matrix is adapted only.
+            bool separable = false;
+
+            /// The LAPACK driver to compute the eigenvalue decomposition.
+            Decompose::Driver decompose_driver = Decompose::Driver::jacobi;
+
+            /// Whether the eigenvalue decomposition is performed asynchronously.
+            bool async_decompose = false;
+
+            /// Whether the offspring are evaluated by racing.
+            bool racing = false;
+
+            /// The boundary strategy.
+            Boundary_Strategy boundary_strategy = Boundary_Strategy::rejection;
+
+            /// The maximum number of samples rejected for an offspring.
+            natural rejection_limit = 1000;
+
+            /// The termination criteria.
+            Termination_Criteria termination_criteria;
+
+            /// The polish threshold.
+            real polish_threshold = 0.0;
+
+            /// The number of restarts.
+            natural restart_count = 0;
+
+            /// The restart strategy.
+            Restart_Strategy restart_strategy = Restart_Strategy::ipop;
+
+            /// The number of threads.
+            natural thread_count = 0;
+
+            /// The pool of threads shared with other optimizers.
+            std::shared_ptr<const Thread_Pool> thread_pool;
+
+            /// The path name of the checkpoint file.
+            std::string checkpoint_path;
+
+            /// The checkpoint modulus.
+            natural checkpoint_modulus = 100;
+
             /// The recombination weights.
             std::valarray<real> weights;
 
@@ -395,6 +801,20 @@ namespace especia {
                 return underflow;
             }
 
+            /// Returns the termination criterion, which stopped the optimization early.
+            ///
+            /// @return the termination criterion met, or @c Termination::none.
+            Termination get_termination() const {
+                return termination;
+            }
+
+            /// Returns the number of the restart, which yielded this result. Zero indicates the initial run.
+            ///
+            /// @return the restart number.
+            natural get_restart_number() const {
+                return r;
+            }
+
         private:
             /// The constructor.
             ///
@@ -488,6 +908,48 @@ namespace especia {
                 return underflow;
             }
 
+            /// Returns a reference to the termination criterion met.
+            ///
+            /// @return a reference to the termination criterion met.
+            Termination &__termination() {
+                return termination;
+            }
+
+            /// Returns a reference to the best fitness of the recent generations.
+            ///
+            /// @return a reference to the best fitness of the recent generations.
+            std::vector<real> &__best_history() {
+                return best_history;
+            }
+
+            /// Returns a reference to the median fitness of the recent generations.
+            ///
+            /// @return a reference to the median fitness of the recent generations.
+            std::vector<real> &__median_history() {
+                return median_history;
+            }
+
+            /// Returns a reference to the polishing status flag.
+            ///
+            /// @return a reference to the polishing status flag.
+            bool &__polish_attempted() {
+                return polish_attempted;
+            }
+
+            /// Returns a reference to the pending decomposition status flag.
+            ///
+            /// @return a reference to the pending decomposition status flag.
+            bool &__pending() {
+                return pending;
+            }
+
+            /// Returns a reference to the restart number.
+            ///
+            /// @return a reference to the restart number.
+            natural &__restart_number() {
+                return r;
+            }
+
             /// The optimized parameter values.
             std::valarray<real> x;
 
@@ -521,15 +983,42 @@ namespace especia {
             /// The mutation variance underflow status flag.
             bool underflow;
 
+            /// The termination criterion met.
+            Termination termination;
+
+            /// The best fitness of the recent generations.
+            std::vector<real> best_history;
+
+            /// The median fitness of the recent generations.
+            std::vector<real> median_history;
+
+            /// The polishing status flag. Is set, when the polishing has been attempted, but has
+            /// not converged. Then the optimization proceeds to the accuracy goal.
+            bool polish_attempted;
+
+            /// The pending decomposition status flag. Is set, while the optimization is suspended
+            /// and the asynchronous decomposition of the covariance matrix is not installed.
+            bool pending;
+
             /// The final generation number.
             natural g;
 
+            /// The restart number.
+            natural r;
+
             friend class Optimizer;
         };
 
         /// The destructor.
         ~Optimizer();
 
+        /// Returns the pool of threads to evaluate the objective function.
+        ///
+        /// @return the pool of threads.
+        const Thread_Pool &get_thread_pool() const {
+            return *pool;
+        }
+
         /// Maximizes an objective function.
         ///
         /// @tparam F The function type.
@@ -596,7 +1085,194 @@ namespace especia {
             return optimize(f, x, d, s, No_Constraint<real>(), No_Tracing<real>(), std::less<real>());
         }
 
+        /// Resumes the maximization of an objective function from a checkpoint.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        /// @tparam Tracing The tracer type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] checkpoint_path The path name of the checkpoint file.
+        /// @param[in] constraint The constraint.
+        /// @param[in] tracer The tracer.
+        ///
+        /// @return the maximization result.
+        ///
+        /// @throw runtime_error when the checkpoint cannot be read or does not match the build configuration.
+        template<class F, class Constraint, class Tracing>
+        Result maximize(const F &f,
+                        const std::string &checkpoint_path,
+                        const Constraint &constraint,
+                        const Tracing &tracer) const {
+            return resume(f, checkpoint_path, constraint, tracer, std::greater<real>());
+        }
+
+        /// Resumes the minimization of an objective function from a checkpoint.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        /// @tparam Tracing The tracer type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] checkpoint_path The path name of the checkpoint file.
+        /// @param[in] constraint The constraint.
+        /// @param[in] tracer The tracer.
+        ///
+        /// @return the minimization result.
+        ///
+        /// @throw runtime_error when the checkpoint cannot be read or does not match the build configuration.
+        template<class F, class Constraint, class Tracing>
+        Result minimize(const F &f,
+                        const std::string &checkpoint_path,
+                        const Constraint &constraint,
+                        const Tracing &tracer) const {
+            return resume(f, checkpoint_path, constraint, tracer, std::less<real>());
+        }
+
+        /// Maximizes an objective function, starting from a given optimization state.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        /// @tparam Tracing The tracer type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] state The optimization state, e.g. a prior result or a state obtained by @c warm_start().
+        /// @param[in] constraint The constraint.
+        /// @param[in] tracer The tracer.
+        ///
+        /// @return the maximization result.
+        ///
+        /// @throw invalid_argument when the problem dimension of the state does not match the build configuration.
+        ///
+        /// @remark No restarts are carried out.
+        template<class F, class Constraint, class Tracing>
+        Result maximize(const F &f,
+                        const Result &state,
+                        const Constraint &constraint,
+                        const Tracing &tracer) const {
+            return proceed(f, state, constraint, tracer, std::greater<real>());
+        }
+
+        /// Minimizes an objective function, starting from a given optimization state.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        /// @tparam Tracing The tracer type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] state The optimization state, e.g. a prior result or a state obtained by @c warm_start().
+        /// @param[in] constraint The constraint.
+        /// @param[in] tracer The tracer.
+        ///
+        /// @return the minimization result.
+        ///
+        /// @throw invalid_argument when the problem dimension of the state does not match the build configuration.
+        ///
+        /// @remark No restarts are carried out.
+        template<class F, class Constraint, class Tracing>
+        Result minimize(const F &f,
+                        const Result &state,
+                        const Constraint &constraint,
+                        const Tracing &tracer) const {
+            return proceed(f, state, constraint, tracer, std::less<real>());
+        }
+
+        /// Reproduces the result of a completed minimization from its final state, without
+        /// evolving the state. The fitness and the parameter uncertainties are computed anew,
+        /// like at the end of the minimization.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] state The final optimization state, e.g. read by @c read_state().
+        /// @param[in] constraint The constraint.
+        ///
+        /// @return the minimization result.
+        ///
+        /// @throw invalid_argument when the problem dimension of the state does not match the build configuration.
+        template<class F, class Constraint>
+        Result replay(const F &f, const Result &state, const Constraint &constraint) const {
+            using especia::postopti;
+
+            const natural n = config.get_problem_dimension();
+
+            if (state.get_parameter_values().size() != n) {
+                throw std::invalid_argument(
+                        "especia::Optimizer::replay() Error: the optimization state does not match the optimizer configuration");
+            }
+
+            Result result(state);
+            result.__generation_number() = 0;
+            result.__restart_number() = 0;
+            result.__optimized() = true;
+            result.__underflow() = false;
+            result.__termination() = Termination::none;
+            result.__polish_attempted() = false;
+            result.__fitness() = f(result.get_parameter_values_pointer(), n) +
+                                 constraint.cost(result.get_parameter_values_pointer(), n);
+
+            postopti(f, constraint, n,
+                     result.get_parameter_values_pointer(),
+                     result.get_local_step_sizes_pointer(),
+                     result.get_rotation_matrix_pointer(),
+                     result.get_covariance_matrix_pointer(),
+                     result.get_global_step_size(),
+                     result.get_parameter_uncertainties_pointer(),
+                     *pool
+            );
+
+            return result;
+        }
+
+        /// Creates an optimization state to warm-start an optimization from a prior result, which
+        /// may have been obtained for a different set of parameters.
+        ///
+        /// The parameter values, covariances and the distribution cumulation path of parameters
+        /// found in the prior result are taken from the prior result. Parameters not found in the
+        /// prior result are uncorrelated and initialized with the initial values and step sizes
+        /// supplied as arguments. The rotation matrix and the local step sizes are obtained from
+        /// the eigenvalue decomposition of the covariance matrix. When all parameters are found in
+        /// the prior result in the same order, the state of the prior result is used verbatim.
+        ///
+        /// @param[in] x The initial parameter values.
+        /// @param[in] d The initial local step sizes.
+        /// @param[in] s The initial global step size.
+        /// @param[in] prior The prior result.
+        /// @param[in] indexes The index of each parameter in the prior result. An index not less
+        /// than the problem dimension of the prior result marks a parameter not found.
+        ///
+        /// @return the optimization state.
+        ///
+        /// @throw invalid_argument when the number of parameters does not match the build configuration.
+        Result warm_start(const std::valarray<real> &x,
+                          const std::valarray<real> &d,
+                          real s,
+                          const Result &prior,
+                          const std::vector<natural> &indexes) const;
+
+        /// Writes an optimization state to an output stream (text format). Each parameter is
+        /// identified by a name, which must not contain white space.
+        ///
+        /// @param[in,out] os The output stream.
+        /// @param[in] state The optimization state.
+        /// @param[in] names The parameter names.
+        /// @return the output stream.
+        static std::ostream &write_state(std::ostream &os, const Result &state, const std::vector<std::string> &names);
+
+        /// Reads an optimization state from an input stream (text format).
+        ///
+        /// @param[in,out] is The input stream.
+        /// @param[out] names The parameter names.
+        /// @return the optimization state.
+        ///
+        /// @throw runtime_error when the optimization state cannot be read.
+        static Result read_state(std::istream &is, std::vector<std::string> &names);
+
     private:
+        /// The type of the random number generator.
+        typedef Normal_Deviate<Mt19937_32> Deviate;
+
         /// Creates a new instance of this class with the build configuration supplied as argument.
         ///
         /// @param[in] builder The build configuration.
@@ -626,61 +1302,372 @@ namespace especia {
                         const Constraint &constraint,
                         const Tracing &tracer,
                         const Compare &compare) const {
+            if (config.get_restart_count() > 0) {
+                return restart(f, x, d, s, constraint, tracer, compare);
+            }
+
+            Result result(config.get_problem_dimension(), x, d, s);
+            const std::vector<Deviate> streams = create_streams();
+
+            return evolve(f, constraint, tracer, compare, streams, result);
+        }
+
+        /// Resumes the optimization of an objective function from a checkpoint.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        /// @tparam Tracing The tracer type.
+        /// @tparam Compare The fitness comparator type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] checkpoint_path The path name of the checkpoint file.
+        /// @param[in] constraint The constraint.
+        /// @param[in] tracer The tracer.
+        /// @param[in] compare The fitness comparator.
+        ///
+        /// @return the optimization result.
+        ///
+        /// @throw runtime_error when the checkpoint cannot be read or does not match the build configuration.
+        template<class F, class Constraint, class Tracing, class Compare>
+        Result resume(const F &f,
+                      const std::string &checkpoint_path,
+                      const Constraint &constraint,
+                      const Tracing &tracer,
+                      const Compare &compare) const {
+            const natural n = config.get_problem_dimension();
+
+            Result result(n, std::valarray<real>(0.0, n), std::valarray<real>(1.0, n), 1.0);
+            const std::vector<Deviate> streams = create_streams();
+            read_checkpoint(checkpoint_path, streams, result);
+
+            return evolve(f, constraint, tracer, compare, streams, result);
+        }
+
+        /// Proceeds with the optimization of an objective function from a given state.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        /// @tparam Tracing The tracer type.
+        /// @tparam Compare The fitness comparator type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] state The optimization state.
+        /// @param[in] constraint The constraint.
+        /// @param[in] tracer The tracer.
+        /// @param[in] compare The fitness comparator.
+        ///
+        /// @return the optimization result.
+        ///
+        /// @throw invalid_argument when the problem dimension of the state does not match the build configuration.
+        template<class F, class Constraint, class Tracing, class Compare>
+        Result proceed(const F &f,
+                       const Result &state,
+                       const Constraint &constraint,
+                       const Tracing &tracer,
+                       const Compare &compare) const {
+            if (state.get_parameter_values().size() != config.get_problem_dimension()) {
+                throw std::invalid_argument(
+                        "especia::Optimizer::proceed() Error: the optimization state does not match the optimizer configuration");
+            }
+
+            Result result(state);
+            result.__generation_number() = 0;
+            result.__restart_number() = 0;
+            result.__optimized() = false;
+            result.__underflow() = false;
+            result.__termination() = Termination::none;
+            result.__polish_attempted() = false;
+            result.__best_history().clear();
+            result.__median_history().clear();
+            const std::vector<Deviate> streams = create_streams();
+
+            return evolve(f, constraint, tracer, compare, streams, result);
+        }
+
+        /// Evolves the state of an optimization until the optimization is completed or stopped.
+        /// Writes a checkpoint whenever the number of generations evolved is a multiple of the
+        /// checkpoint modulus.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        /// @tparam Tracing The tracer type.
+        /// @tparam Compare The fitness comparator type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] constraint The constraint.
+        /// @param[in] tracer The tracer.
+        /// @param[in] compare The fitness comparator.
+        /// @param[in] streams The independent random number generators to sample the offspring in parallel.
+        /// @param[in,out] result The optimization state and result.
+        ///
+        /// @return the optimization result.
+        template<class F, class Constraint, class Tracing, class Compare>
+        Result evolve(const F &f,
+                      const Constraint &constraint,
+                      const Tracing &tracer,
+                      const Compare &compare,
+                      const std::vector<Deviate> &streams,
+                      Result &result) const {
             using especia::optimize;
+            using especia::polish;
             using especia::postopti;
 
             const natural n = config.get_problem_dimension();
+            const natural stop_generation = config.get_stop_generation();
+            const natural checkpoint_modulus = config.get_checkpoint_path().empty() ? 0 : config.get_checkpoint_modulus();
+            Strategy_Options options = config.get_strategy_options();
+
+            // The polishing takes over from the distribution mean, when the optimization has reached
+            // the polish threshold times the accuracy goal. The polishing is attempted only once.
+            bool polishing = config.get_polish_threshold() > 1.0 and Is_Least_Squares<F>::value and
+                             std::is_same<Compare, std::less<real>>::value and not result.__polish_attempted();
+            bool polished = false;
+
+            for (;;) {
+                const natural g = result.get_generation_number();
+                const natural next_checkpoint = checkpoint_modulus > 0 ? (g / checkpoint_modulus + 1) * checkpoint_modulus : stop_generation;
+
+                options.suspend = next_checkpoint < stop_generation;
+
+                optimize(f, constraint, n,
+                         config.get_parent_number(),
+                         config.get_population_size(),
+                         config.get_weights_pointer(),
+                         config.get_step_size_damping(),
+                         config.get_step_size_cumulation_rate(),
+                         config.get_distribution_cumulation_rate(),
+                         config.get_rank_1_covariance_matrix_adaption_rate(),
+                         config.get_rank_m_covariance_matrix_adaption_rate(),
+                         config.get_covariance_update_modulus(),
+                         polishing ? config.get_polish_threshold() * config.get_accuracy_goal()
+                                   : config.get_accuracy_goal(),
+                         std::min(stop_generation, next_checkpoint),
+                         options,
+                         result.__generation_number(),
+                         result.get_parameter_values_pointer(),
+                         result.__global_step_size(),
+                         result.get_local_step_sizes_pointer(),
+                         result.get_rotation_matrix_pointer(),
+                         result.get_covariance_matrix_pointer(),
+                         result.get_step_size_cumulation_path_pointer(),
+                         result.get_distribution_cumulation_path_pointer(),
+                         result.__fitness(),
+                         result.__optimized(),
+                         result.__underflow(),
+                         result.__termination(),
+                         result.__best_history(),
+                         result.__median_history(),
+                         result.__pending(),
+                         deviate, streams, decompose, compare, tracer, *pool
+                );
 
-            Result result(n, x, d, s);
-
-            optimize(f, constraint, n,
-                     config.get_parent_number(),
-                     config.get_population_size(),
-                     config.get_weights_pointer(),
-                     config.get_step_size_damping(),
-                     config.get_step_size_cumulation_rate(),
-                     config.get_distribution_cumulation_rate(),
-                     config.get_rank_1_covariance_matrix_adaption_rate(),
-                     config.get_rank_m_covariance_matrix_adaption_rate(),
-                     config.get_covariance_update_modulus(),
-                     config.get_accuracy_goal(),
-                     config.get_stop_generation(),
-                     result.__generation_number(),
-                     result.get_parameter_values_pointer(),
-                     result.__global_step_size(),
-                     result.get_local_step_sizes_pointer(),
-                     result.get_rotation_matrix_pointer(),
-                     result.get_covariance_matrix_pointer(),
-                     result.get_step_size_cumulation_path_pointer(),
-                     result.get_distribution_cumulation_path_pointer(),
-                     result.__fitness(),
-                     result.__optimized(),
-                     result.__underflow(),
-                     deviate, decompose, compare, tracer
-            );
+                if (result.is_optimized() and polishing) {
+                    Telemetry::Stopwatch stopwatch(telemetry_of(tracer));
+
+                    stopwatch.lap(Telemetry::polishing);
+                    polishing = false;
+                    polished = polish_result(f, constraint, result);
+                    if (not polished) {
+                        result.__polish_attempted() = true;
+                        // The optimization proceeds to the accuracy goal
+                        result.__optimized() = false;
+                        continue;
+                    }
+                }
+                if (result.is_optimized() or result.is_underflow() or result.get_termination() != Termination::none or
+                    result.get_generation_number() >= stop_generation) {
+                    break;
+                }
+                write_checkpoint(streams, result);
+            }
 
-            if (result.__optimized()) {
+            if (result.__optimized() and not polished) {
+                Telemetry::Stopwatch stopwatch(telemetry_of(tracer));
+
+                stopwatch.lap(Telemetry::postopti);
                 postopti(f, constraint, n,
                          result.get_parameter_values_pointer(),
                          result.get_local_step_sizes_pointer(),
                          result.get_rotation_matrix_pointer(),
                          result.get_covariance_matrix_pointer(),
                          result.get_global_step_size(),
-                         result.get_parameter_uncertainties_pointer()
+                         result.get_parameter_uncertainties_pointer(),
+                         *pool
                 );
             }
 
             return result;
         }
 
+        /// Polishes the parameter values of an optimization result by means of the Levenberg-Marquardt
+        /// method. The finite difference steps are the standard deviations of the mutation
+        /// distribution.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] constraint The constraint.
+        /// @param[in,out] result The optimization result. The parameter values, the fitness, and the
+        /// parameter uncertainties are changed only if the polishing converges.
+        /// @return @c true, if the polishing has converged.
+        template<class F, class Constraint>
+        bool polish_result(const F &f, const Constraint &constraint, Result &result) const {
+            using std::sqrt;
+
+            const natural n = config.get_problem_dimension();
+            const real *C = result.get_covariance_matrix_pointer();
+
+            std::valarray<real> h(n);
+            for (natural j = 0, jj = 0; j < n; ++j, jj += n + 1) {
+                h[j] = result.get_global_step_size() * sqrt(C[jj]);
+            }
+
+            return polish(f, constraint, n,
+                          result.get_parameter_values_pointer(),
+                          &h[0],
+                          config.get_accuracy_goal(),
+                          result.__fitness(),
+                          result.get_parameter_uncertainties_pointer(),
+                          *pool);
+        }
+
+        /// Optimizes an objective function by running several independently seeded optimizer
+        /// instances concurrently and selecting the best result.
+        ///
+        /// @tparam F The function type.
+        /// @tparam Constraint The constraint type.
+        /// @tparam Tracing The tracer type.
+        /// @tparam Compare The fitness comparator type.
+        ///
+        /// @param[in] f The objective function.
+        /// @param[in] x The initial parameter values.
+        /// @param[in] d The initial local step sizes.
+        /// @param[in] s The initial global step size.
+        /// @param[in] constraint The constraint.
+        /// @param[in] tracer The tracer. Traces the initial run only.
+        /// @param[in] compare The fitness comparator.
+        ///
+        /// @return the best optimization result.
+        ///
+        /// @throw any exception thrown by an optimizer instance. Only the first exception is thrown.
+        template<class F, class Constraint, class Tracing, class Compare>
+        Result restart(const F &f,
+                       const std::valarray<real> &x,
+                       const std::valarray<real> &d,
+                       const real &s,
+                       const Constraint &constraint,
+                       const Tracing &tracer,
+                       const Compare &compare) const {
+            using std::exception_ptr;
+            using std::thread;
+            using std::vector;
+
+            vector<Builder> configs;
+            vector<real> step_size_factors;
+            configure_restarts(configs, step_size_factors);
+
+            const natural m = static_cast<natural>(configs.size());
+
+            vector<Result> results(m, Result(config.get_problem_dimension(), x, d, s));
+            vector<exception_ptr> errors(m);
+            vector<thread> instances;
+
+            instances.reserve(m);
+            for (natural r = 0; r < m; ++r) {
+                instances.emplace_back([&, r]() {
+                    try {
+                        const Optimizer optimizer(configs[r]);
+                        const real step_size = s * step_size_factors[r];
+
+                        if (r == 0) {
+                            results[r] = optimizer.optimize(f, x, d, step_size, constraint, tracer, compare);
+                        } else {
+                            results[r] = optimizer.optimize(f, x, d, step_size, constraint, No_Tracing<real>(),
+                                                            compare);
+                        }
+                        results[r].__restart_number() = r;
+                    } catch (...) {
+                        errors[r] = std::current_exception();
+                    }
+                });
+            }
+            for (auto &instance : instances) {
+                instance.join();
+            }
+            for (const auto &error : errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+
+            natural best = 0;
+            for (natural r = 1; r < m; ++r) {
+                if (compare(results[r].get_fitness(), results[best].get_fitness())) {
+                    best = r;
+                }
+            }
+
+            return results[best];
+        }
+
+        /// Configures the optimizer instances of a restart run.
+        ///
+        /// @param[out] configs The build configurations of the optimizer instances.
+        /// @param[out] step_size_factors The factors to scale the initial global step size of
+        /// each instance.
+        void configure_restarts(std::vector<Builder> &configs, std::vector<real> &step_size_factors) const;
+
         /// The build configuration.
         const Builder config;
 
         /// The eigenvalue decomposition strategy.
         const Decompose decompose;
 
+        /// Creates the independent random number generators to sample the offspring in parallel.
+        ///
+        /// @return the random number generators, one for each offspring, or none if the offspring
+        /// are sampled serially.
+        std::vector<Deviate> create_streams() const;
+
+        /// Reads a checkpoint. Restores the state of the random number generators, too.
+        ///
+        /// @param[in] path The path name of the checkpoint file.
+        /// @param[in] streams The independent random number generators to sample the offspring in parallel.
+        /// @param[out] result The optimization state.
+        ///
+        /// @throw runtime_error when the checkpoint cannot be read or does not match the build configuration.
+        void read_checkpoint(const std::string &path, const std::vector<Deviate> &streams, Result &result) const;
+
+        /// Writes a checkpoint. The checkpoint file is replaced atomically. The checkpoint format
+        /// consists of
+        ///
+        /// an 8-byte signature @c ESPCKPT followed by the format version,
+        ///
+        /// a 4-byte byte order mark and 4 bytes reserved,
+        ///
+        /// the 8-byte problem dimension, parent number, population size, number of streams,
+        /// generation number and length of the fitness history,
+        ///
+        /// the global step size and the fitness, the parameter values, the local step sizes, the
+        /// rotation matrix, the covariance matrix, the step size and distribution cumulation paths,
+        /// the best and median fitness history (as 8-byte floating point numbers),
+        ///
+        /// the state of the random number generator followed by the states of the streams.
+        ///
+        /// All numbers use the byte order of the machine, which has written the file.
+        ///
+        /// @param[in] streams The independent random number generators to sample the offspring in parallel.
+        /// @param[in] result The optimization state.
+        ///
+        /// @throw runtime_error when the checkpoint cannot be written.
+        void write_checkpoint(const std::vector<Deviate> &streams, const Result &result) const;
+
         /// The random number generator.
-        const Normal_Deviate<Mt19937_32> deviate;
+        const Deviate deviate;
+
+        /// The pool of threads to evaluate the objective function. Is shared between copies of this optimizer.
+        const std::shared_ptr<const Thread_Pool> pool;
     };
 
 }
@@ -0,0 +1,153 @@
+/// @file pipeline.h
+/// Streaming transformation of spectroscopic data in chunks of bounded size.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_PIPELINE_H
+#define ESPECIA_PIPELINE_H
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base.h"
+#include "dataio.h"
+#include "spectrum.h"
+#include "threads.h"
+
+namespace especia {
+
+    /// The default number of data points in a chunk of streamed spectroscopic data.
+    const natural default_chunk_size = 65536;
+
+    /// Transforms the wavelengths of spectroscopic data read from an input stream and writes
+    /// the transformed data to an output stream (text format).
+    ///
+    /// The data are streamed in chunks of bounded size, so the memory used does not depend
+    /// on the length of the input. While a chunk is transformed in parallel and written, the
+    /// next chunk is read by another thread. The chunks are written in the order read.
+    ///
+    /// @tparam F The wavelength transformation type.
+    ///
+    /// @param[in,out] is The input stream.
+    /// @param[in,out] os The output stream.
+    /// @param[in] f The wavelength transformation. Is called concurrently.
+    /// @param[in] skip The number of leading lines to skip.
+    /// @param[in] pool The thread pool.
+    /// @param[in] chunk_size The maximum number of data points in a chunk.
+    /// @return @c true, if any data were read and all data were written, @c false otherwise.
+    ///
+    /// @throw any exception thrown by the wavelength transformation.
+    template<class F>
+    bool transform(std::istream &is, std::ostream &os, const F &f, natural skip, const Thread_Pool &pool,
+                   natural chunk_size = default_chunk_size) {
+        Data_Chunk current;
+        Data_Chunk next;
+        size_t n = 0;
+
+        // The input stream must not flush a tied output stream, while it is written
+        std::ostream *const tie = is.tie(nullptr);
+
+        get(is, current, chunk_size, skip);
+
+        while (is and os and current.size() > 0) {
+            std::future<void> reading = std::async(std::launch::async, [&]() {
+                get(is, next, chunk_size, skip);
+            });
+
+            pool.for_each(static_cast<natural>(current.size()), [&](natural i) {
+                current.x[i] = f(current.x[i]);
+            });
+            put(os, current);
+            n += current.size();
+
+            reading.get();
+            std::swap(current, next);
+        }
+        is.tie(tie);
+
+        return n > 0 and is and os;
+    }
+
+    /// Transforms the wavelengths of spectroscopic data in binary format and writes the
+    /// transformed data to an output stream (binary format).
+    ///
+    /// The wavelength data are transformed in parallel, in chunks of bounded size. All other
+    /// data are copied from the source. When the source is mapped into memory, the memory
+    /// used does not depend on the number of data points.
+    ///
+    /// @tparam F The wavelength transformation type. The transformation must be increasing,
+    /// for the wavelength data to remain sorted.
+    ///
+    /// @param[in] source The spectroscopic data.
+    /// @param[in,out] os The output stream.
+    /// @param[in] f The wavelength transformation. Is called concurrently.
+    /// @param[in] pool The thread pool.
+    /// @param[in] chunk_size The maximum number of data points in a chunk.
+    /// @return @c true, if all data were written, @c false otherwise.
+    ///
+    /// @throw any exception thrown by the wavelength transformation.
+    template<class F>
+    bool transform(const Spectrum &source, std::ostream &os, const F &f, const Thread_Pool &pool,
+                   natural chunk_size = default_chunk_size) {
+        const size_t n = source.size();
+        const real *wav = source.wavelengths();
+
+        std::vector<real> x;
+        x.reserve(std::min<size_t>(chunk_size, n));
+
+        Spectrum::put_header(os, n);
+
+        for (size_t i = 0; i < n and os; i += chunk_size) {
+            const size_t m = std::min<size_t>(chunk_size, n - i);
+
+            x.resize(m);
+            pool.for_each(static_cast<natural>(m), [&](natural k) {
+                x[k] = f(wav[i + k]);
+            });
+            os.write(reinterpret_cast<const char *>(x.data()), static_cast<std::streamsize>(m * sizeof(real)));
+        }
+        os.write(reinterpret_cast<const char *>(source.fluxes()), static_cast<std::streamsize>(n * sizeof(real)));
+        os.write(reinterpret_cast<const char *>(source.uncertainties()), static_cast<std::streamsize>(n * sizeof(real)));
+        os.write(reinterpret_cast<const char *>(source.masks()), static_cast<std::streamsize>(n));
+        os.flush();
+
+        return n > 0 and os;
+    }
+
+    /// Transforms the wavelengths of spectroscopic data read from a file and writes the
+    /// transformed data to an output stream. A file in binary format is mapped into memory
+    /// and written in binary format, any other file is streamed in text format.
+    ///
+    /// @tparam F The wavelength transformation type. The transformation must be increasing,
+    /// for the wavelength data to remain sorted.
+    ///
+    /// @param[in] path The path name of the file.
+    /// @param[in,out] os The output stream.
+    /// @param[in] f The wavelength transformation. Is called concurrently.
+    /// @param[in] skip The number of leading lines to skip (text format only).
+    /// @param[in] pool The thread pool.
+    /// @param[in] chunk_size The maximum number of data points in a chunk.
+    /// @return @c true, if any data were read and all data were written, @c false otherwise.
+    ///
+    /// @throw any exception thrown by the wavelength transformation.
+    template<class F>
+    bool transform(const std::string &path, std::ostream &os, const F &f, natural skip, const Thread_Pool &pool,
+                   natural chunk_size = default_chunk_size) {
+        if (Spectrum::is_binary(path)) {
+            Spectrum spectrum;
+
+            return spectrum.map(path) and transform(spectrum, os, f, pool, chunk_size);
+        }
+        std::ifstream ifs(path.c_str());
+
+        return transform(ifs, os, f, skip, pool, chunk_size);
+    }
+
+}
+
+#endif // ESPECIA_PIPELINE_H
@@ -3,12 +3,18 @@
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
+#include <algorithm>
+#include <complex>
+#include <vector>
+
 #include "profiles.h"
 
 using std::abs;
+using std::acosh;
 using std::cosh;
 using std::exp;
 using std::log;
+using std::max;
 using std::pow;
 using std::sqrt;
 
@@ -56,11 +62,64 @@ static real f_p(const real &x, const real &gamma) {
     return 1.0 / (2.0 * gamma * sq(cosh(x / gamma)));
 }
 
+/// Returns the abscissa value beyond which the Gaussian is less than a given value.
+///
+/// @param[in] t The value.
+/// @param[in] gamma The width (arbitrary unit).
+/// @return the abscissa value beyond which the Gaussian is less than @c t.
+static real x_g(const real &t, const real &gamma) {
+    const real u = 1.0 / (sqrt_of_pi * gamma * t);
+    return u > 1.0 ? gamma * sqrt(log(u)) : real(0.0);
+}
+
+/// Returns the abscissa value beyond which the Lorentzian is less than a given value.
+///
+/// @param[in] t The value.
+/// @param[in] gamma The width (arbitrary unit).
+/// @return the abscissa value beyond which the Lorentzian is less than @c t.
+static real x_l(const real &t, const real &gamma) {
+    const real u = 1.0 / (pi * gamma * t);
+    return u > 1.0 ? gamma * sqrt(u - 1.0) : real(0.0);
+}
+
+/// Returns the abscissa value beyond which the irrational function is less than a given value.
+///
+/// @param[in] t The value.
+/// @param[in] gamma The width (arbitrary unit).
+/// @return the abscissa value beyond which the irrational function is less than @c t.
+static real x_i(const real &t, const real &gamma) {
+    const real u = pow(1.0 / (2.0 * gamma * t), 2.0 / 3.0);
+    return u > 1.0 ? gamma * sqrt(u - 1.0) : real(0.0);
+}
+
+/// Returns the abscissa value beyond which the squared hyperbolic secant function is less
+/// than a given value.
+///
+/// @param[in] t The value.
+/// @param[in] gamma The width (arbitrary unit).
+/// @return the abscissa value beyond which the squared hyperbolic secant function is less than @c t.
+static real x_p(const real &t, const real &gamma) {
+    const real u = sqrt(1.0 / (2.0 * gamma * t));
+    return u > 1.0 ? gamma * acosh(u) : real(0.0);
+}
+
 template<class F>
 static real truncate(const F &f, const real &x, const real &b, const real &c) {
     return abs(x) < c * b ? f(x, b) : real(0.0);
 }
 
+/// The truncation of Doppler profiles (in units of the Doppler width).
+static const real truncation = 4.0;
+
+/// Returns the half width of the support of a truncated Doppler profile. The half width
+/// is slightly enlarged to account for rounding errors.
+///
+/// @param[in] b The Doppler width (arbitrary unit).
+/// @return the half width of the support.
+static real support(const real &b) {
+    return truncation * b * (1.0 + 1.0E-12);
+}
+
 template<class T>
 static T poly(const T &x, const T &h0, const T &h1, const T &h2, const T &h3, const T &h4, const T &h5, const T &h6) {
     return h0 + x * (h1 + x * (h2 + x * (h3 + x * (h4 + x * (h5 + x * h6)))));
@@ -110,6 +169,28 @@ real especia::Pseudo_Voigt::operator()(const real &x) const {
     return (1.0 - eta) * f_g(x, gamma_g) + eta * f_l(x, gamma_l);
 }
 
+void especia::Pseudo_Voigt::evaluate(const real x[], real y[], const size_t n) const {
+    // The loop invariants are hoisted, the arithmetic is the same as for a single abscissa value,
+    // unless SIMD vectorization is enabled
+    const real w_g = 1.0 - eta;
+    const real n_g = 1.0 / (sqrt_of_pi * gamma_g);
+    const real n_l = pi * gamma_l;
+    const real e_l = eta;
+    const real g_g = gamma_g;
+    const real g_l = gamma_l;
+
+#ifdef ESPECIA_WITH_SIMD
+#pragma omp simd
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = w_g * (n_g * batch_exp(-sq(x[i] / g_g))) + e_l * (1.0 / (n_l * (1.0 + sq(x[i] / g_l))));
+    }
+}
+
+real especia::Pseudo_Voigt::extent(const real &t) const {
+    return max(x_g(0.5 * t / abs(1.0 - eta), gamma_g), x_l(0.5 * t / abs(eta), gamma_l));
+}
+
 const real especia::Pseudo_Voigt::c_g = sqrt_of_ln_two;
 
 
@@ -134,13 +215,232 @@ real especia::Extended_Pseudo_Voigt::operator()(const real &x) const {
            eta_p * f_p(x, gamma_p);
 }
 
+void especia::Extended_Pseudo_Voigt::evaluate(const real x[], real y[], const size_t n) const {
+    // The loop invariants are hoisted, the arithmetic is the same as for a single abscissa value
+    const real w_g = 1.0 - eta_l - eta_i - eta_p;
+    const real n_g = 1.0 / (sqrt_of_pi * gamma_g);
+    const real n_l = pi * gamma_l;
+    const real n_i = 2.0 * gamma_i;
+    const real n_p = 2.0 * gamma_p;
+
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = w_g * (n_g * exp(-sq(x[i] / gamma_g))) +
+               eta_l * (1.0 / (n_l * (1.0 + sq(x[i] / gamma_l)))) +
+               eta_i * (1.0 / (n_i * pow(1.0 + sq(x[i] / gamma_i), 1.5))) +
+               eta_p * (1.0 / (n_p * sq(cosh(x[i] / gamma_p))));
+    }
+}
+
+real especia::Extended_Pseudo_Voigt::extent(const real &t) const {
+    return max(max(x_g(0.25 * t / abs(1.0 - eta_l - eta_i - eta_p), gamma_g), x_l(0.25 * t / abs(eta_l), gamma_l)),
+               max(x_i(0.25 * t / abs(eta_i), gamma_i), x_p(0.25 * t / abs(eta_p), gamma_p)));
+}
+
 const real especia::Extended_Pseudo_Voigt::c_g = sqrt_of_ln_two;
 const real especia::Extended_Pseudo_Voigt::c_i = sqrt(pow(2.0, 2.0 / 3.0) - 1.0); // NOLINT
 const real especia::Extended_Pseudo_Voigt::c_p = log(sqrt(2.0) + 1.0); // NOLINT
 
 
+/// The number of coefficients of the Weideman (1994) approximation to the Faddeeva function.
+static const int weideman_n = 32;
+
+/// Returns the coefficients of the Weideman (1994) approximation to the Faddeeva function.
+///
+/// @return the coefficients.
+static std::vector<real> weideman_coefficients() {
+    using std::cos;
+    using std::tan;
+
+    const int m = 2 * weideman_n;
+    const real l = sqrt(weideman_n / sqrt(2.0));
+
+    std::vector<real> coefficients(weideman_n, 0.0);
+    for (int k = 1 - m; k < m; ++k) {
+        const real t = l * tan(0.5 * k * pi / m);
+        const real f = exp(-sq(t)) * (sq(l) + sq(t));
+
+        for (int j = 0; j < weideman_n; ++j) {
+            coefficients[j] += f * cos((j + 1) * k * pi / m);
+        }
+    }
+    for (int j = 0; j < weideman_n; ++j) {
+        coefficients[j] /= 2 * m;
+    }
+
+    return coefficients;
+}
+
+/// Returns the Faddeeva function computed by means of the algorithm of Weideman (1994).
+///
+/// @param[in] z The argument. The imaginary part must not be negative.
+/// @return the value of the Faddeeva function at @c z.
+static std::complex<real> faddeeva_weideman(const std::complex<real> &z) {
+    using std::complex;
+
+    static const std::vector<real> coefficients = weideman_coefficients();
+    static const real l = sqrt(weideman_n / sqrt(2.0));
+
+    const complex<real> iz(-z.imag(), z.real());
+    const complex<real> q = 1.0 / (l - iz);
+    const complex<real> s = (l + iz) * q;
+
+    complex<real> p = 0.0;
+    for (int j = weideman_n - 1; j >= 0; --j) {
+        p = p * s + coefficients[j];
+    }
+
+    return (2.0 * p * q + 1.0 / sqrt_of_pi) * q;
+}
+
+/// Returns the real part of the Faddeeva function computed by means of the rational
+/// approximation of Humlicek (1982), which is accurate far from the origin.
+///
+/// @param[in] u The real part of the argument.
+/// @param[in] v The imaginary part of the argument.
+/// @return the real part of the Faddeeva function.
+static real faddeeva_humlicek(const real &u, const real &v) {
+    using std::complex;
+
+    const complex<real> t(v, -u);
+    const complex<real> s = t * t;
+
+    return (t * (1.410474 + s * 0.5641896) / (0.75 + s * (3.0 + s))).real();
+}
+
+/// The extent of the table of the Faddeeva function in each direction of the complex plane.
+static const real faddeeva_extent = 8.0;
+
+/// The spacing of the table of the Faddeeva function.
+static const real faddeeva_spacing = 0.05;
+
+/// The number of table nodes in each direction of the complex plane.
+static const int faddeeva_count = 161;
+
+/// Returns the table of the Faddeeva function. For each node the real part of the Faddeeva
+/// function and its first derivatives with respect to the real and imaginary part of the
+/// argument, and the mixed second derivative, are stored. The nodes are stored in row-major
+/// layout, where the rows correspond to the real part of the argument.
+///
+/// @return the table of the Faddeeva function.
+static const std::vector<real> &faddeeva_table() {
+    using std::complex;
+
+    static const std::vector<real> table = []() {
+        std::vector<real> t(4 * faddeeva_count * faddeeva_count);
+
+        for (int i = 0; i < faddeeva_count; ++i) {
+            for (int j = 0; j < faddeeva_count; ++j) {
+                const complex<real> z(i * faddeeva_spacing, j * faddeeva_spacing);
+                const complex<real> w = faddeeva_weideman(z);
+                // The derivatives follow from w'(z) = 2 i / sqrt(pi) - 2 z w(z)
+                const complex<real> w1 = complex<real>(0.0, 2.0 / sqrt_of_pi) - 2.0 * z * w;
+                const complex<real> w2 = -2.0 * (w + z * w1);
+                real *node = &t[4 * (i * faddeeva_count + j)];
+
+                node[0] = w.real();
+                node[1] = w1.real();
+                node[2] = -w1.imag();
+                node[3] = -w2.imag();
+            }
+        }
+        return t;
+    }();
+
+    return table;
+}
+
+/// The Hermite basis polynomials.
+///
+/// @param[in] t The interpolation parameter.
+/// @param[out] h The Hermite basis polynomials at @c t.
+static void hermite(const real &t, real h[]) {
+    const real s = 1.0 - t;
+
+    h[0] = (1.0 + 2.0 * t) * sq(s);
+    h[1] = t * sq(s);
+    h[2] = (3.0 - 2.0 * t) * sq(t);
+    h[3] = -sq(t) * s;
+}
+
+/// Returns the index of the table interval containing a coordinate. The index does not
+/// exceed the last interval, even if the coordinate is rounded onto the last node.
+///
+/// @param[in] x The coordinate, not less than zero and less than the table extent.
+/// @param[out] t The interpolation parameter within the interval, in [0, 1].
+/// @return the index of the interval.
+static int faddeeva_interval(const real &x, real &t) {
+    using std::floor;
+    using std::min;
+
+    const int k = min(static_cast<int>(floor(x / faddeeva_spacing)), faddeeva_count - 2);
+
+    t = min(x / faddeeva_spacing - k, 1.0);
+    return k;
+}
+
+
+especia::Tabulated_Voigt::Tabulated_Voigt(const real &b, const real &d)
+        : b(b), d(d), a(d / b), c(1.0 / (sqrt_of_pi * b)), row(nullptr), w() {
+    if (a < faddeeva_extent) {
+        real t;
+        const int j = faddeeva_interval(a, t);
+        real h[4];
+
+        hermite(t, h);
+        row = &faddeeva_table()[4 * j];
+        w[0] = h[0];
+        w[1] = h[1] * faddeeva_spacing;
+        w[2] = h[2];
+        w[3] = h[3] * faddeeva_spacing;
+    }
+}
+
+especia::Tabulated_Voigt::~Tabulated_Voigt() = default;
+
+real especia::Tabulated_Voigt::faddeeva(const real &u) const {
+    if (row == nullptr or u >= faddeeva_extent) {
+        return faddeeva_humlicek(u, a);
+    }
+    real t;
+    const int i = faddeeva_interval(u, t);
+    const real *p = &row[4 * faddeeva_count * i];
+    const real *q = &p[4 * faddeeva_count];
+    real h[4];
+
+    hermite(t, h);
+
+    // Interpolates the values and the derivatives along the real part at both adjacent rows
+    const real f0 = w[0] * p[0] + w[1] * p[2] + w[2] * p[4] + w[3] * p[6];
+    const real g0 = w[0] * p[1] + w[1] * p[3] + w[2] * p[5] + w[3] * p[7];
+    const real f1 = w[0] * q[0] + w[1] * q[2] + w[2] * q[4] + w[3] * q[6];
+    const real g1 = w[0] * q[1] + w[1] * q[3] + w[2] * q[5] + w[3] * q[7];
+
+    return h[0] * f0 + h[1] * faddeeva_spacing * g0 + h[2] * f1 + h[3] * faddeeva_spacing * g1;
+}
+
+real especia::Tabulated_Voigt::operator()(const real &x) const {
+    return c * faddeeva(abs(x) / b);
+}
+
+void especia::Tabulated_Voigt::evaluate(const real x[], real y[], const size_t n) const {
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = c * faddeeva(abs(x[i]) / b);
+    }
+}
+
+real especia::Tabulated_Voigt::extent(const real &t) const {
+    // The wings of the Gaussian and the Lorentzian provide the first guess
+    real x = max(max(x_g(0.5 * t, b), x_l(0.5 * t, d)), b);
+
+    while (operator()(x) >= t) {
+        x *= 1.1;
+    }
+    return x;
+}
+
+
 especia::Many_Multiplet::Many_Multiplet()
-        : u(0.0), z(1.0), c(0.0), b(0.5), a(1.0) {
+        : u(0.0), z(1.0), c(0.0), b(0.5), a(1.0), w(support(b)) {
 }
 
 especia::Many_Multiplet::Many_Multiplet(const real q[])
@@ -148,13 +448,30 @@ especia::Many_Multiplet::Many_Multiplet(const real q[])
           z((1.0 + q[2]) * (1.0 + q[3] / c0)),
           c(u * z),
           b(q[4] * c / c0),
-          a(c1 * q[1] * pow(10.0, q[5]) * (u * c)) {
+          a(c1 * q[1] * pow(10.0, q[5]) * (u * c)),
+          w(support(b)) {
 }
 
 especia::Many_Multiplet::~Many_Multiplet() = default;
 
 real especia::Many_Multiplet::operator()(const real &x) const {
-    return a * truncate(f_g, x - c, b, 4.0);
+    return a * truncate(f_g, x - c, b, truncation);
+}
+
+void especia::Many_Multiplet::evaluate(const real x[], real y[], const size_t n) const {
+    // The loop invariants are hoisted, the arithmetic is the same as for a single wavelength,
+    // unless SIMD vectorization is enabled
+    const real h = truncation * b;
+    const real g = 1.0 / (sqrt_of_pi * b);
+
+#ifdef ESPECIA_WITH_SIMD
+#pragma omp simd
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        const real d = x[i] - c;
+
+        y[i] = a * (abs(d) < h ? g * batch_exp(-sq(d / b)) : real(0.0));
+    }
 }
 
 const real especia::Many_Multiplet::c0 = 1.0E-03 * speed_of_light;
@@ -163,22 +480,153 @@ const real especia::Many_Multiplet::c1 = 1.0E-06 * sq(elementary_charge) / // NO
 
 
 especia::Intergalactic_Doppler::Intergalactic_Doppler()
-        : z(1.0), c(0.0), b(0.5), a(1.0) {
+        : z(1.0), c(0.0), b(0.5), a(1.0), w(support(b)) {
 }
 
 especia::Intergalactic_Doppler::Intergalactic_Doppler(const real q[])
         : z((1.0 + q[2]) * (1.0 + q[3] / c0)),
           c(q[0] * z),
           b(q[4] * c / c0),
-          a(c1 * q[1] * pow(10.0, q[5]) * (q[0] * c)) {
+          a(c1 * q[1] * pow(10.0, q[5]) * (q[0] * c)),
+          w(support(b)) {
 }
 
 especia::Intergalactic_Doppler::~Intergalactic_Doppler() = default;
 
 real especia::Intergalactic_Doppler::operator()(const real &x) const {
-    return a * truncate(f_g, x - c, b, 4.0);
+    return a * truncate(f_g, x - c, b, truncation);
+}
+
+void especia::Intergalactic_Doppler::evaluate(const real x[], real y[], const size_t n) const {
+    // The loop invariants are hoisted, the arithmetic is the same as for a single wavelength,
+    // unless SIMD vectorization is enabled
+    const real h = truncation * b;
+    const real g = 1.0 / (sqrt_of_pi * b);
+
+#ifdef ESPECIA_WITH_SIMD
+#pragma omp simd
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        const real d = x[i] - c;
+
+        y[i] = a * (abs(d) < h ? g * batch_exp(-sq(d / b)) : real(0.0));
+    }
 }
 
 const real especia::Intergalactic_Doppler::c0 = 1.0E-03 * speed_of_light;
 const real especia::Intergalactic_Doppler::c1 = 1.0E-06 * sq(elementary_charge) / // NOLINT
                                                           (4.0 * electric_constant * electron_mass * sq(speed_of_light));
+
+
+#ifdef ESPECIA_WITH_OFFLOAD
+especia::Doppler_Pack::Doppler_Pack(const Doppler_Pack &other)
+        : c(other.c), b(other.b), a(other.a), g(other.g), h(other.h), lo(other.lo), up(other.up) {
+    if (other.mapped > 0) {
+        finish();
+    }
+}
+
+especia::Doppler_Pack::~Doppler_Pack() {
+    unmap();
+}
+
+especia::Doppler_Pack &especia::Doppler_Pack::operator=(const Doppler_Pack &other) {
+    if (this != &other) {
+        clear();
+        c = other.c;
+        b = other.b;
+        a = other.a;
+        g = other.g;
+        h = other.h;
+        lo = other.lo;
+        up = other.up;
+        if (other.mapped > 0) {
+            finish();
+        }
+    }
+    return *this;
+}
+
+void especia::Doppler_Pack::unmap() {
+    if (mapped > 0) {
+        real *const pd = device.data();
+        const size_t s = mapped;
+
+#pragma omp target exit data map(delete: pd[0:s])
+        mapped = 0;
+    }
+}
+#endif
+
+void especia::Doppler_Pack::clear() {
+#ifdef ESPECIA_WITH_OFFLOAD
+    unmap();
+#endif
+    c.clear();
+    b.clear();
+    a.clear();
+    g.clear();
+    h.clear();
+    lo.clear();
+    up.clear();
+}
+
+void especia::Doppler_Pack::reserve(const size_t n) {
+    c.reserve(n);
+    b.reserve(n);
+    a.reserve(n);
+    g.reserve(n);
+    h.reserve(n);
+    lo.reserve(n);
+    up.reserve(n);
+}
+
+void especia::Doppler_Pack::push_back(const real c, const real b, const real a, const real lower_bound,
+                                      const real upper_bound) {
+    // The loop invariants are the same as for evaluating a single profile
+    this->c.push_back(c);
+    this->b.push_back(b);
+    this->a.push_back(a);
+    this->g.push_back(1.0 / (sqrt_of_pi * b));
+    this->h.push_back(truncation * b);
+    this->lo.push_back(lower_bound);
+    this->up.push_back(upper_bound);
+}
+
+void especia::Doppler_Pack::finish() {
+#ifdef ESPECIA_WITH_OFFLOAD
+    unmap();
+
+    const size_t m = c.size();
+    std::vector<size_t> order(m);
+    for (size_t k = 0; k < m; ++k) {
+        order[k] = k;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](size_t i, size_t j) {
+        return lo[i] < lo[j];
+    });
+
+    device.resize(profile_size * m);
+    width = 0.0;
+    for (size_t j = 0; j < m; ++j) {
+        const size_t k = order[j];
+        real *const p = &device[j * profile_size];
+
+        p[0] = lo[k];
+        p[1] = up[k];
+        p[2] = c[k];
+        p[3] = b[k];
+        p[4] = a[k];
+        p[5] = g[k];
+        p[6] = h[k];
+        width = std::max(width, up[k] - lo[k]);
+    }
+    if (m > 0) {
+        real *const pd = device.data();
+        const size_t s = device.size();
+
+#pragma omp target enter data map(to: pd[0:s])
+        mapped = s;
+    }
+#endif
+}
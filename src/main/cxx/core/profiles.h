@@ -6,13 +6,30 @@
 #ifndef ESPECIA_PROFILES_H
 #define ESPECIA_PROFILES_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <type_traits>
 #include <vector>
 
 #include "base.h"
 
 namespace especia {
 
+    /// Returns the exponential of a number, as computed by the batch evaluation of profiles.
+    /// When SIMD vectorization is enabled, this is the polynomial approximation @c fast_exp(),
+    /// otherwise the exponential function of the standard library.
+    ///
+    /// @param[in] x The number.
+    /// @return the exponential of the number.
+    inline real batch_exp(real x) {
+#ifdef ESPECIA_WITH_SIMD
+        return fast_exp(x);
+#else
+        return std::exp(x);
+#endif
+    }
+
     /// The pseudo-Voigt approximation to the Voigt function. The Voigt function is
     /// defined as the convolution of a Gaussian and a Lorentzian function.
     ///
@@ -40,6 +57,20 @@ namespace especia {
         /// @return the value of the pseudo-Voigt approximation at @c x.
         real operator()(const real &x) const;
 
+        /// Returns the values of the pseudo-Voigt approximation at given abscissa values.
+        ///
+        /// @param[in] x The abscissa values (arbitrary unit).
+        /// @param[out] y The values of the pseudo-Voigt approximation at @c x.
+        /// @param[in] n The number of abscissa values.
+        void evaluate(const real x[], real y[], size_t n) const;
+
+        /// Returns the (positive) abscissa value beyond which the pseudo-Voigt approximation
+        /// is less than a given value.
+        ///
+        /// @param[in] t The value.
+        /// @return the abscissa value beyond which the pseudo-Voigt approximation is less than @c t.
+        real extent(const real &t) const;
+
     private:
         const real rho;
         const real h;
@@ -78,6 +109,21 @@ namespace especia {
         /// @return the value of the extended pseudo-Voigt approximation at @c x.
         real operator()(const real &x) const;
 
+        /// Returns the values of the extended pseudo-Voigt approximation at given abscissa values.
+        ///
+        /// @param[in] x The abscissa values (arbitrary unit).
+        /// @param[out] y The values of the extended pseudo-Voigt approximation at @c x.
+        /// @param[in] n The number of abscissa values.
+        void evaluate(const real x[], real y[], size_t n) const;
+
+        /// Returns the (positive) abscissa value beyond which the extended pseudo-Voigt
+        /// approximation is less than a given value.
+        ///
+        /// @param[in] t The value.
+        /// @return the abscissa value beyond which the extended pseudo-Voigt approximation is
+        /// less than @c t.
+        real extent(const real &t) const;
+
     private:
         const real g;
         const real rho;
@@ -94,6 +140,83 @@ namespace especia {
         static const real c_p;
     };
 
+    /// The Voigt function computed from a precomputed table of the real part of the Faddeeva
+    /// function @c w(z), where @c z = (x + i d) / b. The table spans eight Gaussian widths in
+    /// each direction of the complex plane and is interpolated by bicubic Hermite polynomials,
+    /// whose derivatives follow from the differential equation of the Faddeeva function. Beyond
+    /// the table the Faddeeva function is approximated by the asymptotic rational expression of
+    /// Humlicek (1982). The table is computed once by means of the algorithm of Weideman (1994).
+    ///
+    /// Further reading:
+    ///
+    /// J. Humlicek (1982).
+    ///  *Optimized computation of the Voigt and complex probability functions.*
+    ///  J. Quant. Spectrosc. Radiat. Transfer, 27, 437.
+    ///
+    /// J. A. C. Weideman (1994).
+    ///  *Computation of the complex error function.*
+    ///  SIAM J. Numer. Anal., 31, 1497.
+    ///
+    /// @remark This class is thread safe.
+    class Tabulated_Voigt {
+    public:
+        /// Creates a new tabulated approximation to the Voigt function.
+        ///
+        /// @param[in] b The width of the Gaussian (arbitrary unit).
+        /// @param[in] d The width of the Lorentzian (arbitrary unit).
+        explicit Tabulated_Voigt(const real &b = 0.5, const real &d = 0.5);
+
+        /// The destructor.
+        ~Tabulated_Voigt();
+
+        /// Returns the value of the tabulated Voigt function at a given abscissa value.
+        ///
+        /// @param[in] x The abscissa value (arbitrary unit).
+        /// @return the value of the tabulated Voigt function at @c x.
+        real operator()(const real &x) const;
+
+        /// Returns the values of the tabulated Voigt function at given abscissa values.
+        ///
+        /// @param[in] x The abscissa values (arbitrary unit).
+        /// @param[out] y The values of the tabulated Voigt function at @c x.
+        /// @param[in] n The number of abscissa values.
+        void evaluate(const real x[], real y[], size_t n) const;
+
+        /// Returns the (positive) abscissa value beyond which the tabulated Voigt function
+        /// is less than a given value.
+        ///
+        /// @param[in] t The value.
+        /// @return the abscissa value beyond which the tabulated Voigt function is less than @c t.
+        real extent(const real &t) const;
+
+    private:
+        /// Returns the real part of the Faddeeva function for an argument whose imaginary part
+        /// is the ratio of widths.
+        ///
+        /// @param[in] u The real part of the argument.
+        /// @return the real part of the Faddeeva function.
+        real faddeeva(const real &u) const;
+
+        /// The width of the Gaussian.
+        const real b;
+
+        /// The width of the Lorentzian.
+        const real d;
+
+        /// The ratio of the widths of the Lorentzian and the Gaussian.
+        const real a;
+
+        /// The normalization factor.
+        const real c;
+
+        /// The table row located below the ratio of widths, or null if the ratio of widths is
+        /// beyond the table.
+        const real *row;
+
+        /// The Hermite weights to interpolate the table in the direction of the ratio of widths.
+        real w[4];
+    };
+
     /// The (Doppler) profile to infer the variation of the fine-structure constant
     /// alpha by means of a many-multiplet analysis.
     ///
@@ -143,6 +266,13 @@ namespace especia {
         /// @return the optical depth of the profile at @c x.
         real operator()(const real &x) const;
 
+        /// Returns the optical depth of the profile at given wavelengths.
+        ///
+        /// @param[in] x The wavelengths (Angstrom).
+        /// @param[out] y The optical depths of the profile at @c x.
+        /// @param[in] n The number of wavelengths.
+        void evaluate(const real x[], real y[], size_t n) const;
+
         /// Returns the central wavelength of the profile.
         ///
         /// @return the central wavelength of the profile (Angstrom).
@@ -150,6 +280,22 @@ namespace especia {
             return c;
         }
 
+        /// Returns the lower bound of the wavelength interval, outside of which the
+        /// optical depth of the profile vanishes.
+        ///
+        /// @return the lower bound of the support of the profile (Angstrom).
+        real lower_bound() const {
+            return c - w;
+        }
+
+        /// Returns the upper bound of the wavelength interval, outside of which the
+        /// optical depth of the profile vanishes.
+        ///
+        /// @return the upper bound of the support of the profile (Angstrom).
+        real upper_bound() const {
+            return c + w;
+        }
+
         /// Returns the redshift factor of the profile due to cosmology and proper motion.
         ///
         /// @return the redshift factor.
@@ -157,6 +303,20 @@ namespace especia {
             return z;
         }
 
+        /// Returns the Doppler width of the profile.
+        ///
+        /// @return the Doppler width (Angstrom).
+        real doppler_width() const {
+            return b;
+        }
+
+        /// Returns the amplitude of the profile.
+        ///
+        /// @return the amplitude.
+        real amplitude() const {
+            return a;
+        }
+
         /// Returns the number of parameters.
         static natural parameter_count() {
             return n;
@@ -178,6 +338,9 @@ namespace especia {
         /// The amplitude.
         const real a;
 
+        /// The half width of the support (Angstrom).
+        const real w;
+
         /// The number of parameters.
         static const natural n = 8;
 
@@ -223,6 +386,13 @@ namespace especia {
         /// @return the optical depth of the profile at @c x.
         real operator()(const real &x) const;
 
+        /// Returns the optical depth of the profile at given wavelengths.
+        ///
+        /// @param[in] x The wavelengths (Angstrom).
+        /// @param[out] y The optical depths of the profile at @c x.
+        /// @param[in] n The number of wavelengths.
+        void evaluate(const real x[], real y[], size_t n) const;
+
         /// Returns the central wavelength of the profile.
         ///
         /// @return the central wavelength of the profile (Angstrom).
@@ -230,6 +400,22 @@ namespace especia {
             return c;
         }
 
+        /// Returns the lower bound of the wavelength interval, outside of which the
+        /// optical depth of the profile vanishes.
+        ///
+        /// @return the lower bound of the support of the profile (Angstrom).
+        real lower_bound() const {
+            return c - w;
+        }
+
+        /// Returns the upper bound of the wavelength interval, outside of which the
+        /// optical depth of the profile vanishes.
+        ///
+        /// @return the upper bound of the support of the profile (Angstrom).
+        real upper_bound() const {
+            return c + w;
+        }
+
         /// Returns the redshift factor of the profile due to cosmology and proper motion.
         ///
         /// @return the redshift factor.
@@ -237,6 +423,20 @@ namespace especia {
             return z;
         }
 
+        /// Returns the Doppler width of the profile.
+        ///
+        /// @return the Doppler width (Angstrom).
+        real doppler_width() const {
+            return b;
+        }
+
+        /// Returns the amplitude of the profile.
+        ///
+        /// @return the amplitude.
+        real amplitude() const {
+            return a;
+        }
+
         /// Returns the number of parameters.
         static natural parameter_count() {
             return n;
@@ -255,6 +455,9 @@ namespace especia {
         /// The amplitude.
         const real a;
 
+        /// The half width of the support (Angstrom).
+        const real w;
+
         /// The number of parameters.
         static const natural n = 6;
 
@@ -273,7 +476,7 @@ namespace especia {
     public:
         /// Default constructor.
         Intergalactic_Voigt()
-                : z(1.0), c(0.0), a(1.0), approximation() {
+                : z(1.0), c(0.0), a(1.0), approximation(), w(approximation.extent(t / a)) {
         };
 
         /// Creates a new Voigt profile with the parameter values specified.
@@ -300,7 +503,8 @@ namespace especia {
                 : z((1.0 + q[2]) * (1.0 + q[3] / c0)),
                   c(q[0] * z),
                   a(c1 * q[1] * std::pow(10.0, q[5]) * (q[0] * c)),
-                  approximation(q[4] * c / c0, c2 * q[6] * (q[0] * c)) {
+                  approximation(q[4] * c / c0, c2 * q[6] * (q[0] * c)),
+                  w(approximation.extent(t / a)) {
         }
 
         /// The destructor.
@@ -314,6 +518,30 @@ namespace especia {
             return a * approximation(x - c);
         };
 
+        /// Returns the optical depth of the profile at given wavelengths.
+        ///
+        /// @param[in] x The wavelengths (Angstrom).
+        /// @param[out] y The optical depths of the profile at @c x.
+        /// @param[in] n The number of wavelengths.
+        void evaluate(const real x[], real y[], size_t n) const {
+            // The wavelengths are shifted in blocks, which fit into the L1 cache.
+            const size_t block_size = 256;
+
+            real d[block_size];
+
+            for (size_t i = 0; i < n; i += block_size) {
+                const size_t m = std::min(block_size, n - i);
+
+                for (size_t k = 0; k < m; ++k) {
+                    d[k] = x[i + k] - c;
+                }
+                approximation.evaluate(d, &y[i], m);
+                for (size_t k = 0; k < m; ++k) {
+                    y[i + k] = a * y[i + k];
+                }
+            }
+        }
+
         /// Returns the central wavelength of the profile.
         ///
         /// @return the central wavelength of the profile (Angstrom).
@@ -321,6 +549,22 @@ namespace especia {
             return c;
         }
 
+        /// Returns the lower bound of the wavelength interval, outside of which the
+        /// optical depth of the profile vanishes.
+        ///
+        /// @return the lower bound of the support of the profile (Angstrom).
+        real lower_bound() const {
+            return c - w;
+        }
+
+        /// Returns the upper bound of the wavelength interval, outside of which the
+        /// optical depth of the profile vanishes.
+        ///
+        /// @return the upper bound of the support of the profile (Angstrom).
+        real upper_bound() const {
+            return c + w;
+        }
+
         /// Returns the redshift factor of the profile due to cosmology and proper motion.
         ///
         /// @return the redshift factor.
@@ -346,14 +590,23 @@ namespace especia {
         /// The approximation.
         const A approximation;
 
+        /// The half width of the support (Angstrom).
+        const real w;
+
         /// The number of parameters.
         static const natural n = 7;
 
+        /// The optical depth, below which the profile wings are truncated.
+        static const real t;
+
         static const real c0;
         static const real c1;
         static const real c2;
     };
 
+    template<class A>
+    const real Intergalactic_Voigt<A>::t = 1.0E-08;
+
     template<class A>
     const real Intergalactic_Voigt<A>::c0 = 1.0E-03 * speed_of_light;
 
@@ -365,6 +618,212 @@ namespace especia {
     const real Intergalactic_Voigt<A>::c2 = 1.0E-10 / (4.0 * pi * speed_of_light);
 
 
+    /// Detects whether a profile type is a truncated Doppler profile, which is defined by its
+    /// center, Doppler width and amplitude.
+    ///
+    /// @tparam Function The profile type.
+    template<class Function>
+    class Is_Doppler {
+    private:
+        template<class G>
+        static auto test(const G *g) -> decltype(g->center(), g->doppler_width(), g->amplitude(), std::true_type());
+
+        template<class G>
+        static std::false_type test(...);
+
+    public:
+        /// Is @c true if the profile type is a truncated Doppler profile.
+        static const bool value = decltype(test<Function>(nullptr))::value;
+    };
+
+    /// The parameters of many truncated Doppler profiles, packed into contiguous arrays
+    /// (structure of arrays). All profiles are evaluated by the same loop, without calling
+    /// a profile function, and with the loop invariants of each profile precomputed.
+    ///
+    /// @remark This class is thread safe.
+    class Doppler_Pack {
+    public:
+#ifdef ESPECIA_WITH_OFFLOAD
+        /// Constructs a new empty pack of profiles.
+        Doppler_Pack() = default;
+
+        /// Constructs a copy of a pack of profiles.
+        ///
+        /// @param[in] other The pack of profiles.
+        Doppler_Pack(const Doppler_Pack &other);
+
+        /// The destructor. Releases the profiles copied to the target device.
+        ~Doppler_Pack();
+
+        /// The copy assignment operator.
+        ///
+        /// @param[in] other The pack of profiles.
+        /// @return this pack of profiles.
+        Doppler_Pack &operator=(const Doppler_Pack &other);
+#endif
+
+        /// Removes all profiles. The storage allocated is reused.
+        void clear();
+
+        /// Reserves storage for a number of profiles.
+        ///
+        /// @param[in] n The number of profiles.
+        void reserve(size_t n);
+
+        /// Appends a profile.
+        ///
+        /// @param[in] c The central wavelength (Angstrom).
+        /// @param[in] b The Doppler width (Angstrom).
+        /// @param[in] a The amplitude.
+        /// @param[in] lower_bound The lower bound of the support (Angstrom).
+        /// @param[in] upper_bound The upper bound of the support (Angstrom).
+        void push_back(real c, real b, real a, real lower_bound, real upper_bound);
+
+        /// Completes the packing of profiles, after the last profile is appended. When offloading,
+        /// the profiles are sorted by the lower bound of their support and copied to the target
+        /// device, where they remain until the pack is cleared.
+        void finish();
+
+        /// Returns the optical depth of all profiles at given wavelengths. The arithmetic is the
+        /// same as for each profile evaluated separately, unless the evaluation is offloaded to
+        /// the target device. When SIMD vectorization is enabled, the wavelengths in the support
+        /// of each profile are processed in vector lanes.
+        ///
+        /// @tparam T The optical depth type. Each profile is evaluated in double precision,
+        /// but the optical depths are accumulated in the precision of this type.
+        ///
+        /// @param[in] x The wavelengths (Angstrom). Must be sorted into ascending order.
+        /// @param[out] y The optical depths at @c x.
+        /// @param[in] n The number of wavelengths.
+        template<class T>
+        void evaluate(const real x[], T y[], size_t n) const {
+#ifdef ESPECIA_WITH_OFFLOAD
+            if (n * c.size() >= offload_threshold and mapped == profile_size * c.size()) {
+                evaluate_offload(x, y, n);
+                return;
+            }
+#endif
+            using std::abs;
+            using std::fill;
+
+            fill(y, y + n, 0.0);
+
+            for (size_t k = 0; k < c.size(); ++k) {
+                const size_t begin = static_cast<size_t>(std::lower_bound(x, x + n, lo[k]) - x);
+                const size_t end = static_cast<size_t>(std::upper_bound(x + begin, x + n, up[k]) - x);
+                const real ck = c[k];
+                const real bk = b[k];
+                const real ak = a[k];
+                const real gk = g[k];
+                const real hk = h[k];
+
+#ifdef ESPECIA_WITH_SIMD
+#pragma omp simd
+#endif
+                for (size_t i = begin; i < end; ++i) {
+                    const real d = x[i] - ck;
+
+                    y[i] += static_cast<T>(ak * (abs(d) < hk ? gk * batch_exp(-sq(d / bk)) : real(0.0)));
+                }
+            }
+        }
+
+    private:
+#ifdef ESPECIA_WITH_OFFLOAD
+        /// The minimum number of profile evaluations, which are offloaded to the target device.
+        static const size_t offload_threshold = 65536;
+
+        /// The number of values per profile copied to the target device.
+        static const size_t profile_size = 7;
+
+        /// Releases the profiles copied to the target device.
+        void unmap();
+
+        /// Returns the optical depth of all profiles at given wavelengths, computed on the target
+        /// device. Each wavelength is processed by a device thread of its own, which accumulates
+        /// only the profiles whose support may contain the wavelength, in order of their lower
+        /// bound. So the optical depths agree with those computed on the host up to rounding,
+        /// because the order of summation and the exponential function of the device differ.
+        ///
+        /// @tparam T The optical depth type.
+        ///
+        /// @param[in] x The wavelengths (Angstrom). Must be sorted into ascending order.
+        /// @param[out] y The optical depths at @c x.
+        /// @param[in] n The number of wavelengths.
+        template<class T>
+        void evaluate_offload(const real x[], T y[], size_t n) const {
+            const size_t m = c.size();
+            const size_t s = device.size();
+            const real *pd = device.data();
+            const real w = width;
+
+            // The profiles are mapped already, so only the wavelengths and optical depths are copied
+#pragma omp target teams distribute parallel for map(to: x[0:n], pd[0:s]) map(from: y[0:n])
+            for (size_t i = 0; i < n; ++i) {
+                const real xi = x[i];
+
+                // The first profile, whose support may contain the wavelength
+                size_t first = 0;
+                size_t last = m;
+                while (first < last) {
+                    const size_t mid = first + (last - first) / 2;
+
+                    if (pd[mid * profile_size] < xi - w) {
+                        first = mid + 1;
+                    } else {
+                        last = mid;
+                    }
+                }
+
+                T t = 0.0;
+                for (size_t k = first; k < m and pd[k * profile_size] <= xi; ++k) {
+                    const real *p = &pd[k * profile_size];
+
+                    if (xi <= p[1]) {
+                        const real d = xi - p[2];
+                        const real e = d / p[3];
+
+                        t += static_cast<T>(p[4] * ((d < 0.0 ? -d : d) < p[6] ? p[5] * std::exp(-(e * e)) : 0.0));
+                    }
+                }
+                y[i] = t;
+            }
+        }
+
+        /// The profiles copied to the target device, sorted by lower bound. The values of each profile
+        /// are the lower and upper bounds of its support, the central wavelength, the Doppler width,
+        /// the amplitude, the normalization factor and the truncation width.
+        std::vector<real> device;
+
+        /// The maximum width of the supports.
+        real width = 0.0;
+
+        /// The number of values mapped to the target device.
+        size_t mapped = 0;
+#endif
+
+        /// The central wavelengths.
+        std::vector<real> c;
+
+        /// The Doppler widths.
+        std::vector<real> b;
+
+        /// The amplitudes.
+        std::vector<real> a;
+
+        /// The normalization factors of the Doppler profiles.
+        std::vector<real> g;
+
+        /// The truncation widths.
+        std::vector<real> h;
+
+        /// The lower bounds of the supports.
+        std::vector<real> lo;
+
+        /// The upper bounds of the supports.
+        std::vector<real> up;
+    };
+
     /// The superposition of many optical depth profiles.
     ///
     /// @tparam Function The profile type.
@@ -378,11 +837,30 @@ namespace especia {
         /// @param[in] n The number of profiles.
         /// @param[in] q The parameter values. The semantics of parameter values and the
         /// number of parameters per component are defined by the profile type.
-        Superposition(natural n, const real q[]) : profiles() {
+        Superposition(natural n, const real q[]) : profiles(), pack() {
+            assign(n, q);
+        }
+
+        /// Constructs a new empty superposition of profiles.
+        Superposition() : profiles(), pack() {
+        }
+
+        /// Replaces the profiles of this superposition with the parameter values specified. The
+        /// storage allocated for the profiles is reused. Doppler profiles are packed into
+        /// contiguous arrays, too (see @c Doppler_Pack).
+        ///
+        /// @param[in] n The number of profiles.
+        /// @param[in] q The parameter values. The semantics of parameter values and the
+        /// number of parameters per component are defined by the profile type.
+        /// @return this superposition.
+        Superposition &assign(natural n, const real q[]) {
+            profiles.clear();
             profiles.reserve(n);
             for (natural i = 0; i < n; ++i, q += Function::parameter_count()) {
                 profiles.emplace_back(q);
             }
+            pack_profiles(std::integral_constant<bool, Is_Doppler<Function>::value>());
+            return *this;
         }
 
         /// The destructor.
@@ -402,9 +880,103 @@ namespace especia {
             return t;
         }
 
+        /// Returns the optical depth of the profile superposition at given wavelengths.
+        /// Each profile is evaluated only within its support, which is located by means
+        /// of binary search.
+        ///
+        /// @tparam T The optical depth type. Each profile is evaluated in double precision,
+        /// but the optical depths are accumulated in the precision of this type.
+        ///
+        /// @param[in] x The wavelengths (Angstrom). Must be sorted into ascending order.
+        /// @param[out] y The optical depths of the profile superposition at @c x.
+        /// @param[in] n The number of wavelengths.
+        template<class T>
+        void evaluate(const real x[], T y[], size_t n) const {
+            evaluate(x, y, n, std::integral_constant<bool, Is_Doppler<Function>::value>());
+        }
+
+        /// Calls a given function with the lower and upper bound of the support of each profile.
+        /// Beyond the supports of all profiles the optical depth of the superposition is zero.
+        ///
+        /// @tparam F The function type.
+        ///
+        /// @param[in] f The function.
+        template<class F>
+        void for_each_support(const F &f) const {
+            for (const Function &profile : profiles) {
+                f(profile.lower_bound(), profile.upper_bound());
+            }
+        }
+
     private:
+        /// Packs Doppler profiles into contiguous arrays.
+        void pack_profiles(std::true_type) {
+            pack.clear();
+            pack.reserve(profiles.size());
+            for (const Function &profile : profiles) {
+                pack.push_back(profile.center(), profile.doppler_width(), profile.amplitude(), profile.lower_bound(),
+                               profile.upper_bound());
+            }
+            pack.finish();
+        }
+
+        /// Does not pack profiles, which are not Doppler profiles.
+        void pack_profiles(std::false_type) {
+        }
+
+        /// Returns the optical depth of packed Doppler profiles at given wavelengths.
+        template<class T>
+        void evaluate(const real x[], T y[], size_t n, std::true_type) const {
+            pack.evaluate(x, y, n);
+        }
+
+        /// Returns the optical depth of the profile superposition at given wavelengths.
+        template<class T>
+        void evaluate(const real x[], T y[], size_t n, std::false_type) const {
+            using std::fill;
+            using std::lower_bound;
+            using std::upper_bound;
+
+            fill(y, y + n, 0.0);
+
+            for (const Function &profile : profiles) {
+                const real *begin = lower_bound(x, x + n, profile.lower_bound());
+                const real *end = upper_bound(begin, x + n, profile.upper_bound());
+
+                accumulate(profile, begin, &y[begin - x], static_cast<size_t>(end - begin));
+            }
+        }
+
+        /// Adds the optical depth of a profile to given optical depths.
+        ///
+        /// @tparam T The optical depth type.
+        ///
+        /// @param[in] profile The profile.
+        /// @param[in] x The wavelengths (Angstrom).
+        /// @param[in,out] y The optical depths at @c x.
+        /// @param[in] n The number of wavelengths.
+        template<class T>
+        static void accumulate(const Function &profile, const real x[], T y[], size_t n) {
+            // The profile is evaluated in blocks, which fit into the L1 cache.
+            const size_t block_size = 256;
+
+            real t[block_size];
+
+            for (size_t i = 0; i < n; i += block_size) {
+                const size_t m = std::min(block_size, n - i);
+
+                profile.evaluate(&x[i], t, m);
+                for (size_t k = 0; k < m; ++k) {
+                    y[i + k] += static_cast<T>(t[k]);
+                }
+            }
+        }
+
         /// The line profiles.
         std::vector<Function> profiles;
+
+        /// The packed line profiles, if the line profiles are Doppler profiles.
+        Doppler_Pack pack;
     };
 
 
@@ -467,20 +1039,72 @@ namespace especia {
         /// @tparam Function The profile function type.
         ///
         /// @param f The profile function.
-        /// @param f The profile function.
         /// @param prefix The unit prefix.
         /// @return the equivalent width (@c prefix Angstrom).
         template<class Function>
         real calculate(const Function &f, const real &prefix = 1.0) const {
-            using std::exp;
-
-            const real integral = integrator.integrate_positive_infinite(
-                    [&f](real x) -> real { return 1.0 - exp(-f(x + f.center())); });
+            const real integral = integrator.integrate_positive_infinite(Absorption<Function>(f));
 
             return (2.0 / prefix) * integral / f.redshift_factor();
         }
 
     private:
+        /// The absorption @f$ 1 - \exp(-\tau) @f$ of an optical depth profile, as a function of
+        /// the distance from the line center.
+        ///
+        /// @tparam Function The profile function type.
+        template<class Function>
+        class Absorption {
+        public:
+            /// The constructor.
+            ///
+            /// @param f The profile function.
+            explicit Absorption(const Function &f) : f(f), c(f.center()) {
+            }
+
+            /// Returns the absorption.
+            ///
+            /// @param x The distance from the line center.
+            /// @return the absorption.
+            real operator()(const real &x) const {
+                using std::exp;
+
+                return 1.0 - exp(-f(x + c));
+            }
+
+            /// Returns the absorption for many distances from the line center at once.
+            ///
+            /// @param[in] x The distances from the line center.
+            /// @param[out] y The absorption values.
+            /// @param[in] n The number of distances.
+            void evaluate(const real x[], real y[], size_t n) const {
+                using std::exp;
+
+                real z[block_size];
+                for (size_t i = 0; i < n; i += block_size) {
+                    const size_t m = std::min(n - i, size_t(block_size));
+
+                    for (size_t k = 0; k < m; ++k) {
+                        z[k] = x[i + k] + c;
+                    }
+                    f.evaluate(z, &y[i], m);
+                    for (size_t k = 0; k < m; ++k) {
+                        y[i + k] = 1.0 - exp(-y[i + k]);
+                    }
+                }
+            }
+
+        private:
+            /// The number of distances evaluated per block.
+            static constexpr size_t block_size = 64;
+
+            /// The profile function.
+            const Function &f;
+
+            /// The line center.
+            const real c;
+        };
+
         /// The strategy to integrate the line profile.
         const Integrate integrator;
     };
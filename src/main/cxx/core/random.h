@@ -7,7 +7,10 @@
 #define ESPECIA_RANDOM_H
 
 #include <algorithm>
+#include <cstddef>
+#include <istream>
 #include <limits>
+#include <ostream>
 #include <valarray>
 
 #include "base.h"
@@ -53,16 +56,77 @@ namespace especia {
         /// The destructor.
         ~Melg() = default;
 
+        /// Creates an instance of this functor generating one of several independent streams
+        /// of random numbers. The stream is selected by seeding the state array with both the
+        /// seed and the stream index.
+        ///
+        /// @param[in] seed The seed.
+        /// @param[in] stream The stream index.
+        /// @return the instance of this functor.
+        static Melg for_stream(const word64 seed, const word64 stream) {
+            const word64 seeds[] = {seed & 0x00000000FFFFFFFFULL, seed >> 32, stream & 0x00000000FFFFFFFFULL, stream >> 32};
+
+            return Melg(4, seeds);
+        }
+
         /// Returns a new real-valued  random number in the interval  [0, 1].
         ///
         /// @return a real-valued random number in [0, 1].
         real operator()() const {
-            using std::numeric_limits;
-            // the maximum mantissa value for a real number
-            const real max_mantissa =
-                    numeric_limits<word64>::max() >> (numeric_limits<word64>::digits - (w < numeric_limits<real>::digits ? w : numeric_limits<real>::digits));
+            return to_real(rand());
+        }
 
-            return (w < numeric_limits<real>::digits ? rand() : rand() >> (w - numeric_limits<real>::digits)) * (1.0 / max_mantissa);
+        /// Generates real-valued random numbers in the interval [0, 1]. The random numbers are
+        /// the same as those returned by successive calls of the function call operator.
+        ///
+        /// @param[out] x The random numbers.
+        /// @param[in] k The number of random numbers.
+        void generate(real x[], const size_t k) const {
+            size_t i = 0;
+
+            while (i < k) {
+                switch (cycle) {
+                    case 1:
+                        for (; index < n - m and i < k; ++index, ++i) {
+                            const word64 next = rock(index, index + 1);
+                            roll(next, index + m);
+                            x[i] = to_real(twist(next, index, index + l));
+                        }
+                        if (index == n - m) {
+                            cycle = 2;
+                        }
+                        break;
+                    case 2:
+                        for (; index < n - l and i < k; ++index, ++i) {
+                            const word64 next = rock(index, index + 1);
+                            roll(next, index + m - n);
+                            x[i] = to_real(twist(next, index, index + l));
+                        }
+                        if (index == n - l) {
+                            cycle = 3;
+                        }
+                        break;
+                    case 3:
+                        for (; index < n - 1 and i < k; ++index, ++i) {
+                            const word64 next = rock(index, index + 1);
+                            roll(next, index + m - n);
+                            x[i] = to_real(twist(next, index, index - (n - l)));
+                        }
+                        if (index == n - 1) {
+                            cycle = 4;
+                        }
+                        break;
+                    case 4: {
+                        const word64 next = rock(n - 1, 0);
+                        roll(next, m - 1);
+                        x[i] = to_real(twist(next, n - 1, index - (n - l)));
+                        ++i;
+                        index = 0;
+                        cycle = 1;
+                        break;
+                    }
+                }
+            }
         }
 
         /// Returns a new  random word.
@@ -111,7 +175,54 @@ namespace especia {
             return next;
         }
 
+        /// Writes the state of this functor to an output stream (binary format).
+        ///
+        /// @param[in,out] os The output stream.
+        /// @return the output stream.
+        std::ostream &put(std::ostream &os) const {
+            const word64 words[] = {index, cycle};
+
+            os.write(reinterpret_cast<const char *>(&state[0]), static_cast<std::streamsize>((n + 1) * sizeof(word64)));
+            os.write(reinterpret_cast<const char *>(words), sizeof(words));
+
+            return os;
+        }
+
+        /// Reads the state of this functor from an input stream (binary format). On failure,
+        /// the failbit of the input stream is set and the state is not changed.
+        ///
+        /// @param[in,out] is The input stream.
+        /// @return the input stream.
+        std::istream &get(std::istream &is) const {
+            std::valarray<word64> words(n + 3);
+
+            if (is.read(reinterpret_cast<char *>(&words[0]), static_cast<std::streamsize>((n + 3) * sizeof(word64)))) {
+                if (words[n + 1] < n and words[n + 2] >= 1 and words[n + 2] <= 4) {
+                    state = words[std::slice(0, n + 1, 1)];
+                    index = static_cast<natural>(words[n + 1]);
+                    cycle = static_cast<natural>(words[n + 2]);
+                } else {
+                    is.setstate(std::ios_base::failbit);
+                }
+            }
+
+            return is;
+        }
+
     private:
+        /// Converts a random word into a real-valued random number in the interval [0, 1].
+        ///
+        /// @param[in] word The random word.
+        /// @return the real-valued random number.
+        static real to_real(const word64 word) {
+            using std::numeric_limits;
+            // the maximum mantissa value for a real number
+            const real max_mantissa =
+                    numeric_limits<word64>::max() >> (numeric_limits<word64>::digits - (w < numeric_limits<real>::digits ? w : numeric_limits<real>::digits));
+
+            return (w < numeric_limits<real>::digits ? word : word >> (w - numeric_limits<real>::digits)) * (1.0 / max_mantissa);
+        }
+
         /// Resets this algorithm.
         ///
         /// @param[in] seed The seed.
@@ -251,16 +362,41 @@ namespace especia {
         /// The destructor.
         ~Mersenne_Twister() = default;
 
+        /// Creates an instance of this functor generating one of several independent streams
+        /// of random numbers. The stream is selected by seeding the state array with both the
+        /// seed and the stream index.
+        ///
+        /// @param[in] seed The seed.
+        /// @param[in] stream The stream index.
+        /// @return the instance of this functor.
+        static Mersenne_Twister for_stream(const word64 seed, const word64 stream) {
+            const word64 seeds[] = {seed & 0x00000000FFFFFFFFULL, seed >> 32, stream & 0x00000000FFFFFFFFULL, stream >> 32};
+
+            return Mersenne_Twister(4, seeds);
+        }
+
         /// Returns a new real-valued  random number in the interval  [0, 1].
         ///
         /// @return a real-valued random number in [0, 1].
         real operator()() const {
-            using std::numeric_limits;
-            // the maximum mantissa value for a real number
-            const real max_mantissa =
-                numeric_limits<word64>::max() >> (numeric_limits<word64>::digits - (w < numeric_limits<real>::digits ? w : numeric_limits<real>::digits));
+            return to_real(rand());
+        }
 
-            return (w < numeric_limits<real>::digits ? rand() : rand() >> (w - numeric_limits<real>::digits)) * (1.0 / max_mantissa);
+        /// Generates real-valued random numbers in the interval [0, 1]. The state array is
+        /// refilled at once, whenever it is exhausted. The random numbers are the same as
+        /// those returned by successive calls of the function call operator.
+        ///
+        /// @param[out] x The random numbers.
+        /// @param[in] k The number of random numbers.
+        void generate(real x[], const size_t k) const {
+            for (size_t i = 0; i < k;) {
+                if (index == n) {
+                    refill();
+                }
+                for (; index < n and i < k; ++index, ++i) {
+                    x[i] = to_real(temper(state[index]));
+                }
+            }
         }
 
         /// Returns a new  random word.
@@ -268,30 +404,86 @@ namespace especia {
         /// @return a random word.
         word64 rand() const {
             if (index == n) {
-                for (natural k = 0; k < n - m; ++k) {
-                    twist(k + m, k, k + 1);
-                }
+                refill();
+            }
+
+            return temper(state[index++]);
+        }
 
-                for (natural k = n - m; k < n - 1; ++k) {
-                    twist(k + m - n, k, k + 1);
+        /// Writes the state of this functor to an output stream (binary format).
+        ///
+        /// @param[in,out] os The output stream.
+        /// @return the output stream.
+        std::ostream &put(std::ostream &os) const {
+            const word64 i = index;
+
+            os.write(reinterpret_cast<const char *>(&state[0]), static_cast<std::streamsize>(n * sizeof(word64)));
+            os.write(reinterpret_cast<const char *>(&i), sizeof(i));
+
+            return os;
+        }
+
+        /// Reads the state of this functor from an input stream (binary format). On failure,
+        /// the failbit of the input stream is set and the state is not changed.
+        ///
+        /// @param[in,out] is The input stream.
+        /// @return the input stream.
+        std::istream &get(std::istream &is) const {
+            std::valarray<word64> words(n + 1);
+
+            if (is.read(reinterpret_cast<char *>(&words[0]), static_cast<std::streamsize>((n + 1) * sizeof(word64)))) {
+                if (words[n] <= n) {
+                    state = words[std::slice(0, n, 1)];
+                    index = static_cast<natural>(words[n]);
+                } else {
+                    is.setstate(std::ios_base::failbit);
                 }
+            }
 
-                twist(m - 1, n - 1, 0);
-                index = 0;
+            return is;
+        }
+
+    private:
+        /// Refills the state array at once.
+        void refill() const {
+            for (natural k = 0; k < n - m; ++k) {
+                twist(k + m, k, k + 1);
             }
 
-            word64 next = state[index];
-            ++index;
+            for (natural k = n - m; k < n - 1; ++k) {
+                twist(k + m - n, k, k + 1);
+            }
 
-            next ^= (next >> u) & d;
-            next ^= (next << s) & b;
-            next ^= (next << t) & c;
-            next ^= (next >> l);
+            twist(m - 1, n - 1, 0);
+            index = 0;
+        }
 
-            return next;
+        /// Tempers a state word.
+        ///
+        /// @param[in] word The state word.
+        /// @return the tempered word.
+        static word64 temper(word64 word) {
+            word ^= (word >> u) & d;
+            word ^= (word << s) & b;
+            word ^= (word << t) & c;
+            word ^= (word >> l);
+
+            return word;
+        }
+
+        /// Converts a random word into a real-valued random number in the interval [0, 1].
+        ///
+        /// @param[in] word The random word.
+        /// @return the real-valued random number.
+        static real to_real(const word64 word) {
+            using std::numeric_limits;
+            // the maximum mantissa value for a real number
+            const real max_mantissa =
+                    numeric_limits<word64>::max() >> (numeric_limits<word64>::digits - (w < numeric_limits<real>::digits ? w : numeric_limits<real>::digits));
+
+            return (w < numeric_limits<real>::digits ? word : word >> (w - numeric_limits<real>::digits)) * (1.0 / max_mantissa);
         }
 
-    private:
         /// Resets this algorithm.
         ///
         /// @param[in] seed The seed.
@@ -398,6 +590,43 @@ namespace especia {
         /// The destructor.
         ~Pcg() = default;
 
+        /// Creates an instance of this functor generating one of several independent streams
+        /// of random numbers. The stream is selected natively by the increment.
+        ///
+        /// @param[in] seed The seed.
+        /// @param[in] stream The stream index.
+        /// @return the instance of this functor.
+        static Pcg for_stream(const word64 seed, const word64 stream) {
+            return Pcg(seed, stream);
+        }
+
+        /// Advances the state as if a number of random words were generated. Based on
+        /// F. B. Brown (1994) the computation takes logarithmic time.
+        ///
+        /// Further reading:
+        ///
+        /// F. B. Brown (1994).
+        ///  *Random number generation with arbitrary strides.*
+        ///  Transactions of the American Nuclear Society, 71, 202-203.
+        ///
+        /// @param[in] delta The number of random words to skip.
+        void advance(word64 delta) const {
+            word64 cur_mult = mult;
+            word64 cur_plus = inc;
+            word64 acc_mult = 1ULL;
+            word64 acc_plus = 0ULL;
+
+            for (; delta > 0ULL; delta >>= 1) {
+                if ((delta & 1ULL) != 0ULL) {
+                    acc_mult *= cur_mult;
+                    acc_plus = acc_plus * cur_mult + cur_plus;
+                }
+                cur_plus = (cur_mult + 1ULL) * cur_plus;
+                cur_mult *= cur_mult;
+            }
+            state = acc_mult * state + acc_plus;
+        }
+
         /// Returns a new real-valued  random number in the interval  [0, 1].
         ///
         /// @return a real-valued random number in [0, 1].
@@ -405,6 +634,17 @@ namespace especia {
             return rand() / real(0xFFFFFFFFUL);
         }
 
+        /// Generates real-valued random numbers in the interval [0, 1]. The random numbers are
+        /// the same as those returned by successive calls of the function call operator.
+        ///
+        /// @param[out] x The random numbers.
+        /// @param[in] k The number of random numbers.
+        void generate(real x[], const size_t k) const {
+            for (size_t i = 0; i < k; ++i) {
+                x[i] = rand() / real(0xFFFFFFFFUL);
+            }
+        }
+
         /// Returns a new random word.
         ///
         /// @return a random word.
@@ -416,6 +656,36 @@ namespace especia {
             return ((s >> r) | (s << ((-r) & 31UL)));
         }
 
+        /// Writes the state of this functor to an output stream (binary format).
+        ///
+        /// @param[in,out] os The output stream.
+        /// @return the output stream.
+        std::ostream &put(std::ostream &os) const {
+            const word64 words[] = {inc, state};
+
+            return os.write(reinterpret_cast<const char *>(words), sizeof(words));
+        }
+
+        /// Reads the state of this functor from an input stream (binary format). On failure,
+        /// the failbit of the input stream is set and the state is not changed. The stream
+        /// read must match the stream of this functor.
+        ///
+        /// @param[in,out] is The input stream.
+        /// @return the input stream.
+        std::istream &get(std::istream &is) const {
+            word64 words[2];
+
+            if (is.read(reinterpret_cast<char *>(words), sizeof(words))) {
+                if (words[0] == inc) {
+                    state = words[1];
+                } else {
+                    is.setstate(std::ios_base::failbit);
+                }
+            }
+
+            return is;
+        }
+
     private:
         /// The increment.
         const word64 inc;
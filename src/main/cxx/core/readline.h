@@ -13,6 +13,8 @@
 #include <string>
 #include <vector>
 
+#include "scanner.h"
+
 namespace especia {
 
     /// Reads a vector of data from an input stream.
@@ -34,7 +36,7 @@ namespace especia {
         for (size_t i = 0; i < n; ++i) {
             A aa;
 
-            if (is >> aa) {
+            if (scan(is, aa)) {
                 ta.push_back(aa);
             }
         }
@@ -77,7 +79,7 @@ namespace especia {
             A aa;
             B bb;
 
-            if (is >> aa >> bb) {
+            if (scan(is, aa) and scan(is, bb)) {
                 ta.push_back(aa);
                 tb.push_back(bb);
             }
@@ -129,7 +131,7 @@ namespace especia {
             B bb;
             C cc;
 
-            if (is >> aa >> bb >> cc) {
+            if (scan(is, aa) and scan(is, bb) and scan(is, cc)) {
                 ta.push_back(aa);
                 tb.push_back(bb);
                 tc.push_back(cc);
@@ -191,7 +193,7 @@ namespace especia {
             C cc;
             D dd;
 
-            if (is >> aa >> bb >> cc >> dd) {
+            if (scan(is, aa) and scan(is, bb) and scan(is, cc) and scan(is, dd)) {
                 ta.push_back(aa);
                 tb.push_back(bb);
                 tc.push_back(cc);
@@ -260,7 +262,7 @@ namespace especia {
             D dd;
             E ee;
 
-            if (is >> aa >> bb >> cc >> dd >> ee) {
+            if (scan(is, aa) and scan(is, bb) and scan(is, cc) and scan(is, dd) and scan(is, ee)) {
                 ta.push_back(aa);
                 tb.push_back(bb);
                 tc.push_back(cc);
@@ -332,7 +334,7 @@ namespace especia {
             D dd;
             string ss;
 
-            if (is >> aa >> bb >> cc >> dd and getline(is, ss, eol)) {
+            if (scan(is, aa) and scan(is, bb) and scan(is, cc) and scan(is, dd) and getline(is, ss, eol)) {
                 istringstream ist(ss);
 
                 ist >> ss;
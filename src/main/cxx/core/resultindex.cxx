@@ -0,0 +1,232 @@
+/// @file resultindex.cxx
+/// Block index of Especia result files.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include "resultindex.h"
+
+using especia::word64;
+
+/// The prefix of the last line of an index trailer.
+static const std::string trailer_prefix = "<!--index ";
+
+/// The suffix of the last line of an index trailer.
+static const std::string trailer_suffix = "-->";
+
+/// Tests if a line opens or closes a block.
+///
+/// @param[in] line The line (without newline).
+/// @param[in] closing Whether to test for a closing line.
+/// @return the block name, or an empty string if the line neither opens nor closes a block.
+static std::string tag_name(const std::string &line, const bool closing) {
+    const size_t start = closing ? 2 : 1;
+
+    if (line.size() <= start + 1 or line[0] != '<' or (closing and line[1] != '/') or line.back() != '>') {
+        return std::string();
+    }
+    for (size_t i = start; i + 1 < line.size(); ++i) {
+        if (not(std::islower(static_cast<unsigned char>(line[i])) or line[i] == '_')) {
+            return std::string();
+        }
+    }
+    return line.substr(start, line.size() - start - 1);
+}
+
+especia::Indexing_Buffer::Indexing_Buffer(std::streambuf *target)
+        : target(target), buffer(1 << 12), offset(0), line_start(0), line(), comment(false), open(), open_offset(0),
+          blocks() {
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+especia::Indexing_Buffer::~Indexing_Buffer() {
+    drain();
+}
+
+bool especia::Indexing_Buffer::put_index() {
+    if (not drain()) {
+        return false;
+    }
+
+    std::ostringstream os;
+    os << "<!--\n";
+    os << "<index>\n";
+    for (const auto &block : blocks) {
+        os << block.name << " " << block.offset << " " << block.length << "\n";
+    }
+    os << "</index>\n";
+    os << "-->\n";
+    os << trailer_prefix << offset << trailer_suffix << "\n";
+
+    const std::string trailer = os.str();
+    const auto n = static_cast<std::streamsize>(trailer.size());
+
+    if (target->sputn(trailer.data(), n) != n) {
+        return false;
+    }
+    offset += static_cast<word64>(n);
+    line_start = offset;
+
+    return target->pubsync() == 0;
+}
+
+especia::Indexing_Buffer::int_type especia::Indexing_Buffer::overflow(int_type c) {
+    if (not drain()) {
+        return traits_type::eof();
+    }
+    if (not traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize especia::Indexing_Buffer::xsputn(const char *s, const std::streamsize n) {
+    if (n <= epptr() - pptr()) {
+        std::memcpy(pptr(), s, static_cast<size_t>(n));
+        pbump(static_cast<int>(n));
+        return n;
+    }
+    return drain() and pass(s, n) ? n : 0;
+}
+
+int especia::Indexing_Buffer::sync() {
+    return drain() and target->pubsync() == 0 ? 0 : -1;
+}
+
+bool especia::Indexing_Buffer::drain() {
+    const std::streamsize n = pptr() - pbase();
+
+    setp(buffer.data(), buffer.data() + buffer.size());
+
+    return n == 0 or pass(buffer.data(), n);
+}
+
+bool especia::Indexing_Buffer::pass(const char *s, const std::streamsize n) {
+    if (target->sputn(s, n) != n) {
+        return false;
+    }
+
+    for (const char *p = s, *end = s + n; p < end;) {
+        const auto *eol = static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char *q = eol != nullptr ? eol + 1 : end;
+
+        if (line.size() < max_tag_length) {
+            line.append(p, std::min(static_cast<size_t>(q - p), max_tag_length - line.size()));
+        }
+        offset += static_cast<word64>(q - p);
+        if (eol != nullptr) {
+            scan(line_start, offset);
+            line_start = offset;
+            line.clear();
+        }
+        p = q;
+    }
+
+    return true;
+}
+
+void especia::Indexing_Buffer::scan(const word64 start, const word64 end) {
+    if (end - start > max_tag_length) {
+        return;
+    }
+    const std::string s = line.substr(0, line.size() - 1);
+
+    if (not comment) {
+        comment = (s == "<!--");
+    } else if (s == "-->") {
+        comment = false;
+        open.clear();
+    } else if (open.empty()) {
+        open = tag_name(s, false);
+        open_offset = end;
+    } else if (tag_name(s, true) == open) {
+        blocks.push_back({open, open_offset, start - open_offset});
+        open.clear();
+    }
+}
+
+bool especia::read_index(std::istream &is, std::vector<Result_Block> &blocks) {
+    using std::ios_base;
+    using std::string;
+
+    blocks.clear();
+
+    if (not is.seekg(0, ios_base::end)) {
+        is.clear();
+        return false;
+    }
+    const std::streamoff size = is.tellg();
+    const std::streamoff tail = std::min<std::streamoff>(std::max<std::streamoff>(size, 0), 64);
+
+    string s(static_cast<size_t>(tail), '\0');
+    bool indexed = tail > 0 and is.seekg(size - tail) and is.read(&s[0], tail);
+
+    if (indexed) {
+        // The last line locates the index block
+        s.erase(s.find_last_not_of('\n') + 1);
+        s.erase(0, s.find_last_of('\n') + 1);
+
+        word64 index_offset = 0;
+        indexed = s.size() > trailer_prefix.size() + trailer_suffix.size() and
+                  s.compare(0, trailer_prefix.size(), trailer_prefix) == 0 and
+                  s.compare(s.size() - trailer_suffix.size(), trailer_suffix.size(), trailer_suffix) == 0 and
+                  std::istringstream(s.substr(trailer_prefix.size())) >> index_offset and
+                  index_offset < static_cast<word64>(size);
+
+        string line;
+        indexed = indexed and is.seekg(static_cast<std::streamoff>(index_offset)) and
+                  getline(is, line) and line == "<!--" and getline(is, line) and line == "<index>";
+        while (indexed and getline(is, line) and line != "</index>") {
+            std::istringstream ist(line);
+            Result_Block block;
+
+            indexed = static_cast<bool>(ist >> block.name >> block.offset >> block.length) and
+                      block.offset + block.length <= index_offset;
+            blocks.push_back(block);
+        }
+        indexed = indexed and line == "</index>";
+    }
+    if (not indexed) {
+        blocks.clear();
+        is.clear();
+        is.seekg(0);
+    }
+
+    return indexed;
+}
+
+bool especia::copy_blocks(std::istream &is, const std::string &name, std::ostream &os) {
+    std::vector<Result_Block> blocks;
+
+    if (not read_index(is, blocks)) {
+        return false;
+    }
+
+    std::vector<char> buffer(1 << 16);
+
+    for (const auto &block : blocks) {
+        if (block.name != name) {
+            continue;
+        }
+        is.clear();
+        is.seekg(static_cast<std::streamoff>(block.offset));
+
+        for (word64 n = block.length; n > 0;) {
+            const auto k = static_cast<std::streamsize>(std::min<word64>(n, buffer.size()));
+
+            if (not is.read(buffer.data(), k) or not os.write(buffer.data(), k)) {
+                throw std::runtime_error("especia::copy_blocks() Error: the block '" + name + "' cannot be copied");
+            }
+            n -= static_cast<word64>(k);
+        }
+    }
+    os.flush();
+
+    return true;
+}
@@ -0,0 +1,147 @@
+/// @file resultindex.h
+/// Block index of Especia result files.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_RESULTINDEX_H
+#define ESPECIA_RESULTINDEX_H
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "base.h"
+
+namespace especia {
+
+    /// A block of a result file, i.e. the lines enclosed by a line @c <name> and a line
+    /// @c </name> inside an HTML comment, like the @c <model>, @c <command>, @c <log>, and
+    /// @c <data> blocks.
+    struct Result_Block {
+        /// The block name.
+        std::string name;
+
+        /// The offset of the first line of the block (bytes).
+        word64 offset;
+
+        /// The length of the block, excluding the enclosing lines (bytes).
+        word64 length;
+    };
+
+    /// A stream buffer, which passes output through to another stream buffer and indexes the
+    /// blocks of a result file on the fly.
+    ///
+    /// The index is written as a trailer, which consists of an HTML comment enclosing an
+    /// @c <index> block with a line @c {name} {offset} {length} for each block, followed by
+    /// a last line @c <!--index {offset}--> locating the index block. Tools, which extract a
+    /// block from a seekable result file, seek from the last line to the block directly.
+    ///
+    /// @remark This class is not thread safe.
+    class Indexing_Buffer : public std::streambuf {
+    public:
+        /// Constructs a new stream buffer.
+        ///
+        /// @param[in] target The stream buffer to pass the output through to.
+        explicit Indexing_Buffer(std::streambuf *target);
+
+        /// The destructor. Passes any buffered output through.
+        ~Indexing_Buffer() override;
+
+        Indexing_Buffer(const Indexing_Buffer &) = delete;
+
+        Indexing_Buffer &operator=(const Indexing_Buffer &) = delete;
+
+        /// Returns the blocks indexed so far.
+        ///
+        /// @return the blocks indexed.
+        const std::vector<Result_Block> &get_blocks() {
+            sync();
+            return blocks;
+        }
+
+        /// Writes the index trailer. The trailer itself is not indexed.
+        ///
+        /// @return @c true on success, @c false otherwise.
+        bool put_index();
+
+    protected:
+        int_type overflow(int_type c) override;
+
+        std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+        int sync() override;
+
+    private:
+        /// Passes the buffered output through and indexes it.
+        ///
+        /// @return @c true on success, @c false otherwise.
+        bool drain();
+
+        /// Passes output through and indexes it.
+        ///
+        /// @param[in] s The output.
+        /// @param[in] n The number of characters.
+        /// @return @c true on success, @c false otherwise.
+        bool pass(const char *s, std::streamsize n);
+
+        /// Indexes a complete line of output.
+        ///
+        /// @param[in] start The offset of the line.
+        /// @param[in] end The offset past the terminating newline.
+        void scan(word64 start, word64 end);
+
+        /// The maximum length of a line, which may open or close a block (bytes).
+        static const size_t max_tag_length = 64;
+
+        /// The stream buffer to pass the output through to.
+        std::streambuf *const target;
+
+        /// The buffer of the put area.
+        std::vector<char> buffer;
+
+        /// The number of characters passed through.
+        word64 offset;
+
+        /// The offset of the current line.
+        word64 line_start;
+
+        /// The truncated current line.
+        std::string line;
+
+        /// Set while inside an HTML comment.
+        bool comment;
+
+        /// The name of the block currently open, if any.
+        std::string open;
+
+        /// The offset of the first line of the block currently open.
+        word64 open_offset;
+
+        /// The blocks indexed.
+        std::vector<Result_Block> blocks;
+    };
+
+    /// Reads the index trailer of a result file. When the input stream is seekable but has
+    /// no index trailer, the stream is rewound to the beginning.
+    ///
+    /// @param[in,out] is The input stream.
+    /// @param[out] blocks The blocks indexed.
+    /// @return @c true, if the index has been read, @c false otherwise.
+    bool read_index(std::istream &is, std::vector<Result_Block> &blocks);
+
+    /// Copies the blocks of a certain name from an indexed result file to an output stream.
+    ///
+    /// @param[in,out] is The input stream (result file).
+    /// @param[in] name The block name.
+    /// @param[in,out] os The output stream.
+    /// @return @c true, if the result file is indexed, @c false otherwise. Then nothing has been
+    /// read from a non-seekable input stream, and a seekable input stream is rewound to the
+    /// beginning.
+    ///
+    /// @throw runtime_error when an indexed block cannot be read or written.
+    bool copy_blocks(std::istream &is, const std::string &name, std::ostream &os);
+
+}
+
+#endif // ESPECIA_RESULTINDEX_H
@@ -3,18 +3,407 @@
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
+#include <utility>
+
+#include "readline.h"
 #include "runner.h"
 
+/// Returns a message describing a termination criterion.
+///
+/// @param[in] termination The termination criterion.
+/// @return the message.
+static const char *termination_message(const especia::Termination termination) {
+    using especia::Termination;
+
+    switch (termination) {
+        case Termination::tol_fun:
+            return "the range of the recent best fitness values is below the fitness tolerance";
+        case Termination::tol_x:
+            return "the standard deviation of the mutation distribution is below the parameter tolerance";
+        case Termination::no_effect_axis:
+            return "a principal axis of the mutation distribution has no effect";
+        case Termination::no_effect_coordinate:
+            return "a coordinate of the mutation distribution has no effect";
+        case Termination::condition_cov:
+            return "the condition number of the covariance matrix exceeds its maximum";
+        case Termination::stagnation:
+            return "the best and median fitness values stagnate";
+        default:
+            return "no termination criterion is met";
+    }
+}
+
 especia::Runner::Runner(int argc, char *argv[]) {
     using std::string;
 
     for (int i = 0; i < argc; ++i) {
-        args.emplace_back(argv[i]);
+        const string arg(argv[i]);
+
+        if (i > 0 and arg.compare(0, 2, "--") == 0) {
+            options.push_back(arg);
+        } else {
+            args.push_back(arg);
+        }
     }
 }
 
+especia::Runner::Runner(std::vector<std::string> args, std::vector<std::string> options)
+        : args(std::move(args)), options(std::move(options)) {
+}
+
 especia::Runner::~Runner() = default;
 
+especia::natural especia::Runner::parse_restart_count() const {
+    std::string value;
+
+    return find_option("--restarts", value) ? convert<natural>(value) : 0;
+}
+
+especia::Optimizer::Restart_Strategy especia::Runner::parse_restart_strategy() const {
+    using std::invalid_argument;
+
+    std::string value;
+
+    if (not find_option("--restart-strategy", value) or value == "ipop") {
+        return Optimizer::Restart_Strategy::ipop;
+    }
+    if (value == "bipop") {
+        return Optimizer::Restart_Strategy::bipop;
+    }
+    throw invalid_argument(
+            "especia::Runner::parse_restart_strategy() Error: the restart strategy '" + value + "' is unknown");
+}
+
+bool especia::Runner::parse_separable() const {
+    using std::invalid_argument;
+
+    std::string value;
+
+    if (not find_option("--covariance", value) or value == "full") {
+        return false;
+    }
+    if (value == "diagonal") {
+        return true;
+    }
+    throw invalid_argument(
+            "especia::Runner::parse_separable() Error: the covariance matrix type '" + value + "' is unknown");
+}
+
+especia::natural especia::Runner::parse_update_modulus() const {
+    std::string value;
+
+    if (not find_option("--update-modulus", value)) {
+        return 1;
+    }
+    return value == "auto" ? 0 : convert<natural>(value);
+}
+
+especia::Decompose::Driver especia::Runner::parse_decompose_driver() const {
+    using std::invalid_argument;
+
+    std::string value;
+
+    if (not find_option("--decompose", value) or value == "jacobi") {
+        return Decompose::Driver::jacobi;
+    }
+    if (value == "dsyevr") {
+        return Decompose::Driver::dsyevr;
+    }
+    if (value == "dsyevd") {
+        return Decompose::Driver::dsyevd;
+    }
+    if (value == "dsyevx") {
+        return Decompose::Driver::dsyevx;
+    }
+    throw invalid_argument(
+            "especia::Runner::parse_decompose_driver() Error: the LAPACK driver '" + value + "' is unknown");
+}
+
+bool especia::Runner::parse_async_decompose() const {
+    using std::invalid_argument;
+
+    std::string value;
+
+    if (not find_option("--async-decompose", value) or value == "false") {
+        return false;
+    }
+    if (value == "true") {
+        return true;
+    }
+    throw invalid_argument(
+            "especia::Runner::parse_async_decompose() Error: the value '" + value + "' is not a boolean");
+}
+
+especia::natural especia::Runner::parse_racing_stride() const {
+    std::string value;
+
+    return find_option("--racing", value) ? convert<natural>(value) : 0;
+}
+
+especia::real especia::Runner::parse_polish_threshold() const {
+    std::string value;
+
+    return find_option("--polish", value) ? convert<real>(value) : 0.0;
+}
+
+especia::Boundary_Strategy especia::Runner::parse_boundary_strategy() const {
+    using std::invalid_argument;
+
+    std::string value;
+
+    if (not find_option("--boundary", value) or value == "rejection") {
+        return Boundary_Strategy::rejection;
+    }
+    if (value == "resampling") {
+        return Boundary_Strategy::resampling;
+    }
+    if (value == "reflection") {
+        return Boundary_Strategy::reflection;
+    }
+    if (value == "repair") {
+        return Boundary_Strategy::repair;
+    }
+    throw invalid_argument(
+            "especia::Runner::parse_boundary_strategy() Error: the boundary strategy '" + value + "' is unknown");
+}
+
+especia::natural especia::Runner::parse_rejection_limit() const {
+    std::string value;
+
+    return find_option("--rejection-limit", value) ? convert<natural>(value) : 1000;
+}
+
+especia::real especia::Runner::parse_fitness_tolerance() const {
+    std::string value;
+
+    return find_option("--tol-fun", value) ? convert<real>(value) : 0.0;
+}
+
+especia::real especia::Runner::parse_parameter_tolerance() const {
+    std::string value;
+
+    return find_option("--tol-x", value) ? convert<real>(value) : 0.0;
+}
+
+bool especia::Runner::parse_no_effect() const {
+    using std::invalid_argument;
+
+    std::string value;
+
+    if (not find_option("--no-effect", value) or value == "false") {
+        return false;
+    }
+    if (value == "true") {
+        return true;
+    }
+    throw invalid_argument("especia::Runner::parse_no_effect() Error: the value '" + value + "' is not a boolean");
+}
+
+especia::real especia::Runner::parse_max_condition() const {
+    std::string value;
+
+    return find_option("--max-condition", value) ? convert<real>(value) : 0.0;
+}
+
+bool especia::Runner::parse_stagnation() const {
+    using std::invalid_argument;
+
+    std::string value;
+
+    if (not find_option("--stagnation", value) or value == "false") {
+        return false;
+    }
+    if (value == "true") {
+        return true;
+    }
+    throw invalid_argument("especia::Runner::parse_stagnation() Error: the value '" + value + "' is not a boolean");
+}
+
+std::string especia::Runner::parse_checkpoint_path() const {
+    std::string value;
+
+    return find_option("--checkpoint", value) ? value : std::string();
+}
+
+especia::natural especia::Runner::parse_checkpoint_modulus() const {
+    std::string value;
+
+    return find_option("--checkpoint-modulus", value) ? convert<natural>(value) : 100;
+}
+
+std::string especia::Runner::parse_data_path() const {
+    std::string value;
+
+    return find_option("--data-file", value) ? value : std::string();
+}
+
+std::string especia::Runner::parse_telemetry_path() const {
+    std::string value;
+
+    return find_option("--telemetry", value) ? value : std::string();
+}
+
+std::string especia::Runner::parse_warm_start_path() const {
+    std::string value;
+
+    return find_option("--warm-start", value) ? value : std::string();
+}
+
+std::string especia::Runner::parse_state_path() const {
+    std::string value;
+
+    return find_option("--save-state", value) ? value : std::string();
+}
+
+std::string especia::Runner::parse_replay_path() const {
+    std::string value;
+
+    return find_option("--replay", value) ? value : std::string();
+}
+
+bool especia::Runner::parse_index() const {
+    using std::invalid_argument;
+
+    std::string value;
+
+    if (not find_option("--index", value) or value == "false") {
+        return false;
+    }
+    if (value == "true") {
+        return true;
+    }
+    throw invalid_argument("especia::Runner::parse_index() Error: the value '" + value + "' is not a boolean");
+}
+
+bool especia::Runner::parse_numa() const {
+    using std::invalid_argument;
+
+    std::string value;
+
+    if (not find_option("--numa", value) or value == "false") {
+        return false;
+    }
+    if (value == "true") {
+        return true;
+    }
+    throw invalid_argument("especia::Runner::parse_numa() Error: the value '" + value + "' is not a boolean");
+}
+
+std::string especia::Runner::parse_batch_path() const {
+    std::string value;
+
+    return find_option("--batch", value) ? value : std::string();
+}
+
+especia::natural especia::Runner::parse_batch_concurrency() const {
+    std::string value;
+
+    return find_option("--batch-jobs", value) ? convert<natural>(value) : 1;
+}
+
+void especia::Runner::read_batch(const std::string &batch_path,
+                                 std::vector<Runner> &jobs,
+                                 std::vector<std::string> &model_paths,
+                                 std::vector<std::string> &result_paths) const {
+    using std::invalid_argument;
+    using std::runtime_error;
+    using std::string;
+    using std::vector;
+
+    // The options are shared by all jobs, but the files written by a job must be distinct
+    vector<string> job_options;
+    for (const auto &option : options) {
+        const string name = option.substr(0, option.find('='));
+
+        if (name == "--checkpoint" or name == "--data-file" or name == "--telemetry" or name == "--save-state") {
+            throw invalid_argument(
+                    "especia::Runner::run() Error: the option '" + name + "' is not supported in batch mode");
+        }
+        if (name != "--batch" and name != "--batch-jobs") {
+            job_options.push_back(option);
+        }
+    }
+
+    std::ifstream ifs(batch_path);
+    if (not ifs) {
+        throw runtime_error("especia::Runner::run() Error: the batch manifest '" + batch_path + "' cannot be read");
+    }
+
+    string line;
+    while (readline(ifs, line, '%')) {
+        std::istringstream is(line);
+        string model_path;
+        string result_path;
+
+        if (not(is >> model_path)) {
+            continue;
+        }
+        if (not(is >> result_path)) {
+            throw invalid_argument(
+                    "especia::Runner::run() Error: no result file is specified for the model '" + model_path + "'");
+        }
+
+        vector<string> job_args(args);
+        string value;
+        for (size_t i = 1; is >> value; ++i) {
+            if (i == job_args.size()) {
+                throw invalid_argument(
+                        "especia::Runner::run() Error: too many values are specified for the model '" + model_path +
+                        "'");
+            }
+            job_args[i] = value;
+        }
+
+        jobs.push_back(Runner(job_args, job_options));
+        model_paths.push_back(model_path);
+        result_paths.push_back(result_path);
+    }
+    if (not ifs.eof()) {
+        throw runtime_error("especia::Runner::run() Error: the batch manifest '" + batch_path + "' cannot be read");
+    }
+}
+
+void especia::Runner::report_job_error(const std::string &model_path, const std::exception &e) {
+    std::ostringstream os;
+
+    os << model_path << ": " << e.what() << std::endl;
+    std::cerr << os.str();
+}
+
+void especia::Runner::check_options() const {
+    using std::invalid_argument;
+    using std::string;
+
+    for (const auto &option : options) {
+        const string name = option.substr(0, option.find('='));
+
+        if (name != "--restarts" and name != "--restart-strategy" and name != "--covariance" and
+            name != "--update-modulus" and name != "--decompose" and name != "--async-decompose" and
+            name != "--racing" and name != "--polish" and name != "--boundary" and name != "--rejection-limit" and
+            name != "--tol-fun" and name != "--tol-x" and name != "--no-effect" and name != "--max-condition" and
+            name != "--stagnation" and
+            name != "--checkpoint" and name != "--checkpoint-modulus" and name != "--data-file" and
+            name != "--telemetry" and name != "--warm-start" and name != "--save-state" and name != "--replay" and
+            name != "--index" and name != "--numa" and name != "--batch" and name != "--batch-jobs") {
+            throw invalid_argument("especia::Runner::run() Error: the option '" + option + "' is unknown");
+        }
+    }
+}
+
+bool especia::Runner::find_option(const std::string &name, std::string &value) const {
+    bool found = false;
+
+    for (const auto &option : options) {
+        if (option.size() > name.size() and option.compare(0, name.size(), name) == 0 and
+            option[name.size()] == '=') {
+            value = option.substr(name.size() + 1);
+            found = true;
+        }
+    }
+
+    return found;
+}
+
 void especia::Runner::write_command_line(std::ostream &os) const {
     using std::endl;
 
@@ -26,6 +415,9 @@ void especia::Runner::write_command_line(std::ostream &os) const {
     for (const auto &arg : args) {
         os << " " << arg;
     }
+    for (const auto &option : options) {
+        os << " " << option;
+    }
 
     os << std::endl;
     os << "</command>" << endl;
@@ -33,14 +425,19 @@ void especia::Runner::write_command_line(std::ostream &os) const {
     os << "</html>" << endl;
 }
 
-void especia::Runner::write_result_messages(std::ostream &os, const Optimizer::Result &result) const {
+void especia::Runner::write_result_messages(std::ostream &os, const Optimizer::Result &result,
+                                            const std::string &replay_path) const {
     using std::cout;
     using std::endl;
 
     os << "<!--" << endl;
     os << "<message>" << endl;
 
-    if (result.is_optimized()) {
+    if (not replay_path.empty()) {
+        os << "especia::Runner::run() Message: the result was replayed from the state file '"
+           << replay_path << "'"
+           << endl;
+    } else if (result.is_optimized()) {
         os << "especia::Runner::run() Message: optimization completed successfully"
            << endl;
     } else {
@@ -53,6 +450,16 @@ void especia::Runner::write_result_messages(std::ostream &os, const Optimizer::R
            << "underflow of the mutation variance"
            << endl;
     }
+    if (result.get_termination() != Termination::none) {
+        os << "especia::Runner::run() Warning: optimization stopped because "
+           << termination_message(result.get_termination())
+           << endl;
+    }
+    if (parse_restart_count() > 0) {
+        os << "especia::Runner::run() Message: the best result was obtained by restart "
+           << result.get_restart_number()
+           << endl;
+    }
 
     os << "</message>" << endl;
     os << "-->" << endl;
@@ -63,6 +470,16 @@ void especia::Runner::write_usage_message(std::ostream &os) const {
 
     os << project_long_name << " " << project_doi << endl;
     os << "usage: " << get_program_name() << ": "
-       << "{seed} {parents} {population} {step} {accuracy} {stop} {trace} < {model file} [> {result file}]"
+       << "{seed} {parents} {population} {step} {accuracy} {stop} {trace} "
+       << "[--restarts={count}] [--restart-strategy={ipop|bipop}] [--covariance={full|diagonal}] "
+       << "[--update-modulus={generations|auto}] [--decompose={dsyevd|dsyevr|dsyevx|jacobi}] "
+       << "[--async-decompose={true|false}] [--racing={stride}] [--polish={threshold}] "
+       << "[--boundary={rejection|resampling|reflection|repair}] [--rejection-limit={count}] "
+       << "[--tol-fun={tolerance}] [--tol-x={tolerance}] [--no-effect={true|false}] [--max-condition={condition}] "
+       << "[--stagnation={true|false}] "
+       << "[--checkpoint={path}] [--checkpoint-modulus={generations}] [--data-file={path}] [--telemetry={path}] "
+       << "[--warm-start={path}] [--save-state={path}] [--replay={path}] [--index={true|false}] "
+       << "[--numa={true|false}] [--batch={manifest file}] [--batch-jobs={count}] "
+       << "< {model file} [> {result file}]"
        << endl;
 }
@@ -6,15 +6,29 @@
 #ifndef ESPECIA_RUNNER_H
 #define ESPECIA_RUNNER_H
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "cluster.h"
 #include "config.h"
 #include "exitcodes.h"
 #include "optimizer.h"
+#include "resultindex.h"
+#include "spectrum.h"
+#include "telemetry.h"
+#include "threads.h"
 
 namespace especia {
 
@@ -42,13 +56,99 @@ namespace especia {
         /// @c argv[6] The stop generation number.
         ///
         /// @c argv[7] The trace modulus.
+        ///
+        /// Options of the form @c --name=value may follow:
+        ///
+        /// @c --restarts={count} The number of restarts, carried out concurrently.
+        ///
+        /// @c --restart-strategy={ipop|bipop} The restart strategy.
+        ///
+        /// @c --covariance={full|diagonal} The covariance matrix adapted. A diagonal covariance matrix
+        /// is suitable for high problem dimensions.
+        ///
+        /// @c --update-modulus={generations|auto} The number of generations between eigenvalue
+        /// decompositions of the covariance matrix. The default is one, i.e. the covariance matrix
+        /// is decomposed in every generation. Automatic scheduling is used only if requested by
+        /// @c auto, because it changes the results.
+        ///
+        /// @c --decompose={dsyevd|dsyevr|dsyevx|jacobi} The LAPACK driver to compute the eigenvalue
+        /// decomposition, or the Jacobi method for problems of up to ten parameters, which is the
+        /// default. Larger problems are decomposed by @c dsyevr unless specified otherwise.
+        ///
+        /// @c --async-decompose={true|false} Whether to compute the eigenvalue decomposition while
+        /// the next population is evaluated.
+        ///
+        /// @c --racing={stride} Whether to evaluate the offspring by racing, when the value is not
+        /// zero. The offspring are scored on every stride-th valid data point of each section first,
+        /// and only the offspring, which may still be among the best, are evaluated on all data.
+        ///
+        /// @c --polish={threshold} The polish threshold, i.e. the multiple of the accuracy goal, from
+        /// which on the parameter values are polished by means of the Levenberg-Marquardt method.
+        ///
+        /// @c --boundary={rejection|resampling|reflection|repair} The handling of offspring, which
+        /// violate the parameter bounds. When supplied, the mean number of rejected samples per
+        /// offspring is traced, too.
+        ///
+        /// @c --rejection-limit={count} The maximum number of samples rejected for an offspring in
+        /// a generation. When reached, the offspring is reflected into the parameter bounds.
+        ///
+        /// @c --tol-fun={tolerance} The fitness tolerance. The optimization terminates early, when the
+        /// range of the recent best fitness values is below the tolerance.
+        ///
+        /// @c --tol-x={tolerance} The parameter tolerance. The optimization terminates early, when the
+        /// standard deviation of the mutation distribution is below the tolerance in all coordinates.
+        ///
+        /// @c --no-effect={true|false} Whether the optimization terminates early, when a principal axis
+        /// or a coordinate of the mutation distribution has no effect on the distribution mean.
+        ///
+        /// @c --max-condition={condition} The maximum condition number of the covariance matrix. The
+        /// optimization terminates early, when it is exceeded.
+        ///
+        /// @c --stagnation={true|false} Whether the optimization terminates early, when neither the best
+        /// nor the median fitness improve over many generations.
+        ///
+        /// @c --checkpoint={path} The checkpoint file. If the file exists, the optimization is
+        /// resumed from the checkpoint.
+        ///
+        /// @c --checkpoint-modulus={generations} The number of generations between checkpoints.
+        ///
+        /// @c --data-file={path} The file to write the data block of the result in binary format
+        /// (see @c edat).
+        ///
+        /// @c --telemetry={path} The file to write per-phase timings, evaluation and rejection counts,
+        /// and per-section cost timings of the run (JSON format).
+        ///
+        /// @c --warm-start={path} The state file of a prior optimization to start from. The parameters
+        /// are mapped by name, parameters not found are initialized like for a cold start.
+        ///
+        /// @c --save-state={path} The file to write the final optimization state to (see @c --warm-start).
+        ///
+        /// @c --replay={path} The final state file of a prior optimization of the same model (see
+        /// @c --save-state). The result is reproduced from the state, without optimization.
+        ///
+        /// @c --index={true|false} Whether to append a block index to the result, which lets @c ecom,
+        /// @c edat, @c elog and @c emod seek to the block extracted, instead of scanning the result.
+        ///
+        /// @c --numa={true|false} Whether to pin the evaluation threads to the processors of all NUMA
+        /// nodes, and to place the data of each section on the node, whose threads evaluate the
+        /// section.
+        ///
+        /// @c --batch={path} The batch manifest. Each line of the manifest specifies a job by the path
+        /// names of the model file and the result file, optionally followed by the random seed, the
+        /// parent number, the population size, the initial global step size, the accuracy goal, the
+        /// stop generation number and the trace modulus. Omitted values are taken from the command
+        /// line. The jobs share the spectroscopic data and the threads, and the model is not read
+        /// from standard input.
+        ///
+        /// @c --batch-jobs={count} The number of batch jobs fitted concurrently. Each concurrent job
+        /// evaluates its model on an equal share of the threads, which are not pinned to processors.
         /// @endparblock
         Runner(int argc, char *argv[]);
 
         /// The destructor.
         ~Runner();
 
-        /// Returns the command line arguments.
+        /// Returns the command line arguments, excluding options.
         ///
         /// @return the command line arguments.
         const std::vector<std::string> &get_args() const {
@@ -62,6 +162,13 @@ namespace especia {
             return args.size();
         }
 
+        /// Returns the command line options.
+        ///
+        /// @return the command line options.
+        const std::vector<std::string> &get_options() const {
+            return options;
+        }
+
         /// Returns the program name.
         ///
         /// @return the program name.
@@ -104,6 +211,160 @@ namespace especia {
             return convert<word64>(args[1]);
         }
 
+        /// Parses the number of restarts.
+        ///
+        /// @return the number of restarts.
+        /// @throw invalid_argument when the option value cannot be converted.
+        natural parse_restart_count() const;
+
+        /// Parses the restart strategy.
+        ///
+        /// @return the restart strategy.
+        /// @throw invalid_argument when the option value is not a known strategy.
+        Optimizer::Restart_Strategy parse_restart_strategy() const;
+
+        /// Parses whether a diagonal covariance matrix is adapted only.
+        ///
+        /// @return @c true, if a diagonal covariance matrix is adapted only.
+        /// @throw invalid_argument when the option value is not a known covariance matrix type.
+        bool parse_separable() const;
+
+        /// Parses the covariance matrix update modulus.
+        ///
+        /// @return the covariance matrix update modulus. Zero, if the update modulus is chosen
+        /// automatically.
+        /// @throw invalid_argument when the option value cannot be converted.
+        natural parse_update_modulus() const;
+
+        /// Parses the LAPACK driver to compute the eigenvalue decomposition.
+        ///
+        /// @return the LAPACK driver.
+        /// @throw invalid_argument when the option value is not a known driver.
+        Decompose::Driver parse_decompose_driver() const;
+
+        /// Parses whether the eigenvalue decomposition is performed asynchronously.
+        ///
+        /// @return @c true, if the eigenvalue decomposition is performed asynchronously.
+        /// @throw invalid_argument when the option value is neither @c true nor @c false.
+        bool parse_async_decompose() const;
+
+        /// Parses the number of valid data points per stratum to score the offspring by racing.
+        ///
+        /// @return the number of valid data points per stratum, or zero if the offspring are not
+        /// evaluated by racing.
+        /// @throw invalid_argument when the option value cannot be converted.
+        natural parse_racing_stride() const;
+
+        /// Parses the polish threshold.
+        ///
+        /// @return the polish threshold, or zero if the parameter values are not polished.
+        /// @throw invalid_argument when the option value cannot be converted.
+        real parse_polish_threshold() const;
+
+        /// Parses the boundary strategy.
+        ///
+        /// @return the boundary strategy.
+        /// @throw invalid_argument when the boundary strategy is unknown.
+        Boundary_Strategy parse_boundary_strategy() const;
+
+        /// Parses the maximum number of samples rejected for an offspring.
+        ///
+        /// @return the maximum number of samples rejected for an offspring.
+        /// @throw invalid_argument when the option value cannot be converted.
+        natural parse_rejection_limit() const;
+
+        /// Parses the fitness tolerance.
+        ///
+        /// @return the fitness tolerance, or zero if the criterion is disabled.
+        /// @throw invalid_argument when the option value cannot be converted.
+        real parse_fitness_tolerance() const;
+
+        /// Parses the parameter tolerance.
+        ///
+        /// @return the parameter tolerance, or zero if the criterion is disabled.
+        /// @throw invalid_argument when the option value cannot be converted.
+        real parse_parameter_tolerance() const;
+
+        /// Parses whether the optimization terminates, when the mutation has no effect.
+        ///
+        /// @return @c true, if the optimization terminates, when the mutation has no effect.
+        /// @throw invalid_argument when the option value is neither @c true nor @c false.
+        bool parse_no_effect() const;
+
+        /// Parses the maximum condition number of the covariance matrix.
+        ///
+        /// @return the maximum condition number, or zero if the criterion is disabled.
+        /// @throw invalid_argument when the option value cannot be converted.
+        real parse_max_condition() const;
+
+        /// Parses whether the optimization terminates on stagnation.
+        ///
+        /// @return @c true, if the optimization terminates on stagnation.
+        /// @throw invalid_argument when the option value is neither @c true nor @c false.
+        bool parse_stagnation() const;
+
+        /// Parses the path name of the checkpoint file.
+        ///
+        /// @return the path name of the checkpoint file, or an empty string if no checkpoint file
+        /// was supplied.
+        std::string parse_checkpoint_path() const;
+
+        /// Parses the checkpoint modulus.
+        ///
+        /// @return the checkpoint modulus.
+        /// @throw invalid_argument when the option value cannot be converted.
+        natural parse_checkpoint_modulus() const;
+
+        /// Parses the path name of the binary data file.
+        ///
+        /// @return the path name of the binary data file, or an empty string if no binary data file
+        /// is written.
+        std::string parse_data_path() const;
+
+        /// Parses the path name of the telemetry file.
+        ///
+        /// @return the path name of the telemetry file, or an empty string if no telemetry is
+        /// collected.
+        std::string parse_telemetry_path() const;
+
+        /// Parses the path name of the state file to warm-start from.
+        ///
+        /// @return the path name of the state file, or an empty string if no warm start is made.
+        std::string parse_warm_start_path() const;
+
+        /// Parses the path name of the state file to write.
+        ///
+        /// @return the path name of the state file, or an empty string if no state is written.
+        std::string parse_state_path() const;
+
+        /// Parses the path name of the state file to replay.
+        ///
+        /// @return the path name of the state file, or an empty string if no result is replayed.
+        std::string parse_replay_path() const;
+
+        /// Parses whether a block index is appended to the result.
+        ///
+        /// @return @c true, if a block index is appended to the result.
+        /// @throw invalid_argument when the option value is neither @c true nor @c false.
+        bool parse_index() const;
+
+        /// Parses whether the evaluation threads and the section data are placed on NUMA nodes.
+        ///
+        /// @return @c true, if the evaluation threads and the section data are placed on NUMA nodes.
+        /// @throw invalid_argument when the option value is neither @c true nor @c false.
+        bool parse_numa() const;
+
+        /// Parses the path name of the batch manifest.
+        ///
+        /// @return the path name of the batch manifest, or an empty string if no batch is run.
+        std::string parse_batch_path() const;
+
+        /// Parses the number of batch jobs fitted concurrently.
+        ///
+        /// @return the number of batch jobs fitted concurrently.
+        /// @throw invalid_argument when the option value cannot be converted.
+        natural parse_batch_concurrency() const;
+
         /// Parses the stop generation.
         ///
         /// @return the stop generation.
@@ -133,8 +394,12 @@ namespace especia {
             using std::invalid_argument;
             using std::runtime_error;
 
+            const Cluster cluster;
+
             if (get_arg_count() == 1) {
-                write_usage_message(cout);
+                if (cluster.get_rank() == 0) {
+                    write_usage_message(cout);
+                }
                 return 0;
             }
             if (get_arg_count() != 8) {
@@ -142,7 +407,88 @@ namespace especia {
                         "especia::Runner::run() Error: an invalid number of arguments was supplied");
             }
 
-            write_command_line(cout);
+            check_options();
+
+            // The result is indexed while written, if requested
+            const bool indexed = parse_index();
+            Indexing_Buffer index(cout.rdbuf());
+            std::ostream indexing(&index);
+            std::ostream &out = indexed ? indexing : cout;
+
+            if (cluster.get_rank() == 0) {
+                write_command_line(out);
+            }
+
+            const std::string batch_path = parse_batch_path();
+            if (not batch_path.empty()) {
+                if (cluster.get_size() > 1) {
+                    throw invalid_argument(
+                            "especia::Runner::run() Error: the batch mode is not supported with multiple processes");
+                }
+                return write_index(index, indexed, run_batch<M>(batch_path, out));
+            }
+
+            M model;
+
+            if (cluster.get_size() > 1) {
+                // The model definition is read by the root process and loaded by each process
+                std::string definition;
+                if (cluster.get_rank() == 0) {
+                    definition.assign(std::istreambuf_iterator<char>(cin), std::istreambuf_iterator<char>());
+                }
+                cluster.broadcast(definition);
+
+                std::istringstream is(definition);
+                std::ostringstream os;
+                std::exception_ptr error;
+                try {
+                    read_model(model, is, cluster.get_rank() == 0 ? out : os);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                // A process failing to read the model fails all processes
+                if (not cluster.all(not error)) {
+                    if (error) {
+                        std::rethrow_exception(error);
+                    }
+                    throw runtime_error(
+                            "especia::Runner::run() Error: the model could not be read by all processes");
+                }
+
+                if (cluster.get_rank() > 0) {
+                    const Thread_Pool pool;
+
+                    cluster.serve(model, model.get_parameter_count(), pool);
+                    return 0;
+                }
+            } else {
+                read_model(model, cin, out);
+            }
+
+            return write_index(index, indexed, optimize_model(model, out, nullptr));
+        }
+
+    private:
+        /// Constructs a new runner for a job of a batch.
+        ///
+        /// @param args The command line arguments.
+        /// @param options The command line options.
+        Runner(std::vector<std::string> args, std::vector<std::string> options);
+
+        /// Optimizes a model, which has been read, and writes the result to an output stream.
+        ///
+        /// @tparam M The model type.
+        ///
+        /// @param[in,out] model The model.
+        /// @param[in,out] os The output stream.
+        /// @param[in] pool The pool of threads to evaluate the model, or @c nullptr to create a pool.
+        /// @return an exit code.
+        /// @throw invalid_argument when an invalid argument was supplied.
+        /// @throw runtime_error when a runtime error occurred.
+        template<class M>
+        int optimize_model(M &model, std::ostream &os, const std::shared_ptr<const Thread_Pool> &pool) const {
+            using std::endl;
+            using std::invalid_argument;
 
             const word64 random_seed = parse_random_seed();
             const natural parent_number = parse_parent_number();
@@ -151,17 +497,51 @@ namespace especia {
             const real accuracy_goal = parse_accuracy_goal();
             const natural stop_generation = parse_stop_generation();
             const natural trace_modulus = parse_trace_modulus();
+            const natural restart_count = parse_restart_count();
+            const Optimizer::Restart_Strategy restart_strategy = parse_restart_strategy();
+            const bool separable = parse_separable();
+            const natural update_modulus = parse_update_modulus();
+            const Decompose::Driver decompose_driver = parse_decompose_driver();
+            const bool async_decompose = parse_async_decompose();
+            const natural racing_stride = parse_racing_stride();
+            const real polish_threshold = parse_polish_threshold();
+            const Boundary_Strategy boundary_strategy = parse_boundary_strategy();
+            const natural rejection_limit = parse_rejection_limit();
+            const real fitness_tolerance = parse_fitness_tolerance();
+            const real parameter_tolerance = parse_parameter_tolerance();
+            const bool no_effect = parse_no_effect();
+            const real max_condition = parse_max_condition();
+            const bool stagnation = parse_stagnation();
+            std::string boundary_option;
+            const bool trace_rejections = find_option("--boundary", boundary_option);
+            const std::string checkpoint_path = parse_checkpoint_path();
+            const natural checkpoint_modulus = parse_checkpoint_modulus();
+            const std::string data_path = parse_data_path();
+            const std::string telemetry_path = parse_telemetry_path();
+            const std::string warm_start_path = parse_warm_start_path();
+            const std::string state_path = parse_state_path();
+            const std::string replay_path = parse_replay_path();
+            const bool numa = parse_numa();
 
-            M model;
-            model.get(cin, cout);
-
-            if (cin.fail()) {
-                throw runtime_error(
-                        "especia::Runner::run() Error: an error occurred while reading the model definition");
+            if (restart_count > 0 and not checkpoint_path.empty()) {
+                throw invalid_argument(
+                        "especia::Runner::run() Error: checkpoints are not supported with restarts");
             }
-            if (not cin.eof()) {
-                throw runtime_error(
-                        "especia::Runner::run() Error: an error occurred while reading the model definition");
+            if (restart_count > 0 and not warm_start_path.empty()) {
+                throw invalid_argument(
+                        "especia::Runner::run() Error: warm starts are not supported with restarts");
+            }
+            if (not replay_path.empty() and (restart_count > 0 or not checkpoint_path.empty() or
+                                             not warm_start_path.empty())) {
+                throw invalid_argument(
+                        "especia::Runner::run() Error: replays are not supported with restarts, checkpoints or warm starts");
+            }
+
+            // The section data are first touched by the threads, which evaluate the sections
+            const std::shared_ptr<const Thread_Pool> evaluation_pool =
+                    pool or not numa ? pool : std::make_shared<Thread_Pool>(0, true);
+            if (numa) {
+                model.localize(*evaluation_pool);
             }
 
             const Optimizer optimizer = Optimizer::Builder().
@@ -171,42 +551,380 @@ namespace especia {
                     with_accuracy_goal(accuracy_goal).
                     with_stop_generation(stop_generation).
                     with_random_seed(random_seed).
+                    with_restart_count(restart_count).
+                    with_restart_strategy(restart_strategy).
+                    with_separable(separable).
+                    with_covariance_update_modulus(update_modulus).
+                    with_decompose_driver(decompose_driver).
+                    with_async_decompose(async_decompose).
+                    with_racing(racing_stride > 0).
+                    with_boundary_strategy(boundary_strategy).
+                    with_rejection_limit(rejection_limit).
+                    with_fitness_tolerance(fitness_tolerance).
+                    with_parameter_tolerance(parameter_tolerance).
+                    with_no_effect_axis(no_effect).
+                    with_no_effect_coordinate(no_effect).
+                    with_max_condition(max_condition).
+                    with_stagnation(stagnation).
+                    with_polish_threshold(polish_threshold).
+                    with_checkpoint_path(checkpoint_path).
+                    with_checkpoint_modulus(checkpoint_modulus).
+                    with_thread_pool(evaluation_pool).
                     build();
 
-            cout << "<!DOCTYPE html>" << endl;
-            cout << "<html>" << endl;
+            os << "<!DOCTYPE html>" << endl;
+            os << "<html>" << endl;
 
-            cout << "<!--" << endl;
-            cout << "<log>" << endl;
+            os << "<!--" << endl;
+            os << "<log>" << endl;
 
-            const Optimizer::Result result = optimizer.minimize(model,
+            // The telemetry is collected only if requested, so the model is not timed otherwise
+            std::unique_ptr<Telemetry> telemetry;
+            if (not telemetry_path.empty()) {
+                telemetry.reset(new Telemetry(static_cast<natural>(model.get_partition_count())));
+                model.set_telemetry(telemetry.get());
+            }
+            if (racing_stride > 0) {
+                model.set_bound_stride(racing_stride);
+            }
+
+            const bool resume = not checkpoint_path.empty() and std::ifstream(checkpoint_path).good();
+            const Optimizer::Result result = not replay_path.empty() ?
+                                             replay(optimizer, model, replay_path) :
+                                             resume ?
+                                             optimizer.minimize(model,
+                                                                checkpoint_path,
+                                                                model.get_constraint(),
+                                                                Tracer<>(os, trace_modulus, telemetry.get(), trace_rejections)) :
+                                             not warm_start_path.empty() ?
+                                             optimizer.minimize(model,
+                                                                warm_start(optimizer, model, warm_start_path,
+                                                                           global_step_size),
+                                                                model.get_constraint(),
+                                                                Tracer<>(os, trace_modulus, telemetry.get(), trace_rejections)) :
+                                             optimizer.minimize(model,
                                                                 model.get_initial_parameter_values(),
                                                                 model.get_initial_local_step_sizes(),
                                                                 global_step_size,
                                                                 model.get_constraint(),
-                                                                Tracer<>(cout, trace_modulus));
+                                                                Tracer<>(os, trace_modulus, telemetry.get(), trace_rejections));
 
-            cout << "</log>" << endl;
-            cout << "-->" << endl;
+            os << "</log>" << endl;
+            os << "-->" << endl;
 
-            write_result_messages(cout, result);
+            write_result_messages(os, result, replay_path);
 
-            cout << "</html>" << endl;
+            os << "</html>" << endl;
 
+            model.set_telemetry(nullptr);
             model.set(&result.get_parameter_values()[0], &result.get_parameter_uncertainties()[0]);
-            model.put(cout);
+            model.put(os, optimizer.get_thread_pool());
+            if (telemetry) {
+                std::ofstream ofs(telemetry_path);
+
+                if (not telemetry->put(ofs)) {
+                    throw std::runtime_error(
+                            "especia::Runner::run() Error: the telemetry file '" + telemetry_path + "' cannot be written");
+                }
+            }
+            if (not state_path.empty()) {
+                std::ofstream ofs(state_path);
+
+                if (not Optimizer::write_state(ofs, result, model.get_parameter_names())) {
+                    throw std::runtime_error(
+                            "especia::Runner::run() Error: the state file '" + state_path + "' cannot be written");
+                }
+            }
+            if (not data_path.empty()) {
+                std::ofstream ofs(data_path, std::ios_base::binary);
+
+                if (not model.write_data(ofs)) {
+                    throw std::runtime_error(
+                            "especia::Runner::run() Error: the data file '" + data_path + "' cannot be written");
+                }
+            }
 
             if (result.is_optimized()) {
                 return 0;
             }
             if (result.is_underflow()) {
                 return Exit_Codes::optimization_underflow;
+            } else if (result.get_termination() != Termination::none) {
+                return Exit_Codes::optimization_terminated;
             } else {
                 return Exit_Codes::optimization_stopped;
             }
         }
 
-    private:
+        /// Creates an optimization state to warm-start the optimization of a model from the state
+        /// of a prior optimization. The parameters are mapped by name. Parameters not found in the
+        /// prior state, or whose prior value violates the bounds of the model, are initialized like
+        /// for a cold start.
+        ///
+        /// @tparam M The model type.
+        ///
+        /// @param[in] optimizer The optimizer.
+        /// @param[in] model The model.
+        /// @param[in] path The path name of the prior state file.
+        /// @param[in] global_step_size The initial global step size.
+        /// @return the optimization state.
+        /// @throw runtime_error when the prior state cannot be read.
+        template<class M>
+        static Optimizer::Result warm_start(const Optimizer &optimizer,
+                                            const M &model,
+                                            const std::string &path,
+                                            real global_step_size) {
+            std::ifstream ifs(path);
+            if (not ifs) {
+                throw std::runtime_error(
+                        "especia::Runner::run() Error: the state file '" + path + "' cannot be read");
+            }
+
+            std::vector<std::string> prior_names;
+            const Optimizer::Result prior = Optimizer::read_state(ifs, prior_names);
+            const natural m = static_cast<natural>(prior_names.size());
+
+            std::map<std::string, natural> prior_indexes;
+            for (natural k = 0; k < m; ++k) {
+                prior_indexes[prior_names[k]] = k;
+            }
+
+            const std::vector<std::string> names = model.get_parameter_names();
+            const auto constraint = model.get_constraint();
+            std::vector<natural> indexes(names.size(), m);
+            for (natural i = 0; i < names.size(); ++i) {
+                const auto entry = prior_indexes.find(names[i]);
+
+                if (entry != prior_indexes.end() and
+                    not constraint.is_violated(i, prior.get_parameter_values()[entry->second])) {
+                    indexes[i] = entry->second;
+                }
+            }
+
+            return optimizer.warm_start(model.get_initial_parameter_values(),
+                                        model.get_initial_local_step_sizes(),
+                                        global_step_size,
+                                        prior,
+                                        indexes);
+        }
+
+        /// Reproduces the result of a prior optimization of a model from its final state.
+        ///
+        /// @tparam M The model type.
+        ///
+        /// @param[in] optimizer The optimizer.
+        /// @param[in] model The model.
+        /// @param[in] path The path name of the final state file.
+        /// @return the optimization result.
+        /// @throw invalid_argument when the parameters of the state and the model do not match.
+        /// @throw runtime_error when the state cannot be read.
+        template<class M>
+        static Optimizer::Result replay(const Optimizer &optimizer, const M &model, const std::string &path) {
+            std::ifstream ifs(path);
+            if (not ifs) {
+                throw std::runtime_error(
+                        "especia::Runner::run() Error: the state file '" + path + "' cannot be read");
+            }
+
+            std::vector<std::string> names;
+            const Optimizer::Result state = Optimizer::read_state(ifs, names);
+            if (names != model.get_parameter_names()) {
+                throw std::invalid_argument(
+                        "especia::Runner::run() Error: the state file '" + path + "' does not match the model");
+            }
+
+            return optimizer.replay(model, state, model.get_constraint());
+        }
+
+        /// Fits the models listed in a batch manifest, one after another or concurrently. The
+        /// jobs share the spectroscopic data read. Jobs fitted one after another share the pool
+        /// of threads to evaluate the models, while concurrent jobs divide the threads equally.
+        ///
+        /// @tparam M The model type.
+        ///
+        /// @param[in] batch_path The path name of the batch manifest.
+        /// @param[in,out] os The output stream to write the summary of the batch to.
+        /// @return an exit code, which combines the exit codes of all jobs.
+        /// @throw invalid_argument when an invalid argument was supplied.
+        /// @throw runtime_error when the batch manifest cannot be read.
+        template<class M>
+        int run_batch(const std::string &batch_path, std::ostream &os) const {
+            using std::endl;
+            using std::setw;
+
+            std::vector<Runner> jobs;
+            std::vector<std::string> model_paths;
+            std::vector<std::string> result_paths;
+            read_batch(batch_path, jobs, model_paths, result_paths);
+
+            const natural job_count = static_cast<natural>(jobs.size());
+            const natural concurrency = parse_batch_concurrency();
+
+            Spectrum_Cache spectrum_cache;
+            std::vector<int> exit_codes(job_count, 0);
+
+            const auto fit = [&](natural k, const std::shared_ptr<const Thread_Pool> &pool) {
+                exit_codes[k] = jobs[k].run_job<M>(model_paths[k], result_paths[k], spectrum_cache, pool);
+            };
+            if (concurrency > 1 and job_count > 1) {
+                // Each concurrent job evaluates its model on its own share of the threads, since a busy
+                // pool would execute the loops of all other jobs serially
+                const natural runner_count = std::min(concurrency, job_count);
+                const natural share = std::max<natural>(1, Thread_Pool().get_thread_count() / runner_count);
+                std::atomic<natural> next(0);
+                std::vector<std::thread> runners;
+
+                runners.reserve(runner_count);
+                for (natural t = 0; t < runner_count; ++t) {
+                    runners.emplace_back([&]() {
+                        const std::shared_ptr<const Thread_Pool> pool = std::make_shared<Thread_Pool>(share);
+
+                        for (natural k = next++; k < job_count; k = next++) {
+                            fit(k, pool);
+                        }
+                    });
+                }
+                for (auto &runner : runners) {
+                    runner.join();
+                }
+            } else {
+                const std::shared_ptr<const Thread_Pool> pool = std::make_shared<Thread_Pool>(0, parse_numa());
+
+                for (natural k = 0; k < job_count; ++k) {
+                    fit(k, pool);
+                }
+            }
+
+            int exit_code = 0;
+
+            os << "<!--" << endl;
+            os << "<batch>" << endl;
+            for (natural k = 0; k < job_count; ++k) {
+                os << setw(4) << exit_codes[k] << " " << model_paths[k] << " " << result_paths[k] << endl;
+                exit_code |= exit_codes[k];
+            }
+            os << "</batch>" << endl;
+            os << "-->" << endl;
+
+            return exit_code;
+        }
+
+        /// Appends the block index to a result, if the result is indexed.
+        ///
+        /// @param[in,out] index The indexing stream buffer, which the result was written to.
+        /// @param[in] indexed Whether the result is indexed.
+        /// @param[in] exit_code The exit code of the run.
+        /// @return the exit code of the run.
+        /// @throw runtime_error when the block index cannot be written.
+        static int write_index(Indexing_Buffer &index, bool indexed, int exit_code) {
+            if (indexed and not index.put_index()) {
+                throw std::runtime_error("especia::Runner::run() Error: the block index cannot be written");
+            }
+            return exit_code;
+        }
+
+        /// Runs a job of a batch. Errors are reported to standard error.
+        ///
+        /// @tparam M The model type.
+        ///
+        /// @param[in] model_path The path name of the model definition file.
+        /// @param[in] result_path The path name of the result file.
+        /// @param[in] spectrum_cache The cache of spectroscopic data shared between jobs.
+        /// @param[in] pool The pool of threads shared between jobs.
+        /// @return an exit code.
+        template<class M>
+        int run_job(const std::string &model_path,
+                    const std::string &result_path,
+                    Spectrum_Cache &spectrum_cache,
+                    const std::shared_ptr<const Thread_Pool> &pool) const {
+            using std::runtime_error;
+
+            try {
+                std::ifstream ifs(model_path);
+                if (not ifs) {
+                    throw runtime_error(
+                            "especia::Runner::run() Error: the model file '" + model_path + "' cannot be read");
+                }
+                std::ofstream ofs(result_path);
+                if (not ofs) {
+                    throw runtime_error(
+                            "especia::Runner::run() Error: the result file '" + result_path + "' cannot be written");
+                }
+
+                const bool indexed = parse_index();
+                Indexing_Buffer index(ofs.rdbuf());
+                std::ostream indexing(&index);
+                std::ostream &out = indexed ? indexing : ofs;
+
+                M model;
+                model.set_spectrum_cache(&spectrum_cache);
+
+                write_command_line(out);
+                read_model(model, ifs, out);
+                const int exit_code = write_index(index, indexed, optimize_model(model, out, pool));
+
+                if (not ofs.flush()) {
+                    throw runtime_error(
+                            "especia::Runner::run() Error: the result file '" + result_path + "' cannot be written");
+                }
+                return exit_code;
+            } catch (std::logic_error &e) {
+                report_job_error(model_path, e);
+                return Exit_Codes::logic_error;
+            } catch (runtime_error &e) {
+                report_job_error(model_path, e);
+                return Exit_Codes::runtime_error;
+            } catch (std::exception &e) {
+                report_job_error(model_path, e);
+                return Exit_Codes::unspecific_exception;
+            }
+        }
+
+        /// Reads a model definition.
+        ///
+        /// @tparam M The model type.
+        ///
+        /// @param[out] model The model.
+        /// @param[in] is The input stream to read the model definition from.
+        /// @param[in] os The output stream to write the model definition to.
+        ///
+        /// @throw runtime_error when an error occurred while reading the model definition.
+        template<class M>
+        static void read_model(M &model, std::istream &is, std::ostream &os) {
+            using std::runtime_error;
+
+            model.get(is, os);
+
+            if (is.fail()) {
+                throw runtime_error(
+                        "especia::Runner::run() Error: an error occurred while reading the model definition");
+            }
+            if (not is.eof()) {
+                throw runtime_error(
+                        "especia::Runner::run() Error: an error occurred while reading the model definition");
+            }
+        }
+
+        /// Reads a batch manifest.
+        ///
+        /// @param[in] batch_path The path name of the batch manifest.
+        /// @param[out] jobs The runners of the jobs.
+        /// @param[out] model_paths The path names of the model files.
+        /// @param[out] result_paths The path names of the result files.
+        ///
+        /// @throw invalid_argument when a job is invalid, or an option is not supported in batch mode.
+        /// @throw runtime_error when the batch manifest cannot be read.
+        void read_batch(const std::string &batch_path,
+                        std::vector<Runner> &jobs,
+                        std::vector<std::string> &model_paths,
+                        std::vector<std::string> &result_paths) const;
+
+        /// Reports an error, which occurred while running a job of a batch, to standard error.
+        ///
+        /// @param[in] model_path The path name of the model definition file.
+        /// @param[in] e The error.
+        static void report_job_error(const std::string &model_path, const std::exception &e);
+
         /// Traces optimizer state information to an output stream.
         ///
         /// @tparam T The number type.
@@ -217,10 +935,14 @@ namespace especia {
             ///
             /// @param[in] output_stream The output stream.
             /// @param[in] modulus The trace modulus.
+            /// @param[in] telemetry The telemetry collector (optional).
+            /// @param[in] rejections Whether to trace the number of rejected samples per offspring.
             /// @param[in] precision The precision of numeric output.
             /// @param[in] width The width of the numeric output fields.
-            Tracer(std::ostream &output_stream, natural modulus, natural precision = 4, natural width = 12)
-                    : os(output_stream), m(modulus), p(precision), w(width) {
+            Tracer(std::ostream &output_stream, natural modulus, Telemetry *telemetry = nullptr, bool rejections = false,
+                   natural precision = 4, natural width = 12)
+                    : os(output_stream), m(modulus), p(precision), w(width), telemetry(telemetry),
+                      rejections(rejections) {
             }
 
             /// The destructor.
@@ -234,6 +956,13 @@ namespace especia {
                 return m > 0 and g % m == 0;
             }
 
+            /// Returns the telemetry collector.
+            ///
+            /// @return the telemetry collector, or @c nullptr if no telemetry is collected.
+            Telemetry *get_telemetry() const {
+                return telemetry;
+            }
+
             /// Traces state information to an output stream..
             ///
             /// @param[in] g The generation number.
@@ -241,6 +970,18 @@ namespace especia {
             /// @param[in] min_step The minimum step size.
             /// @param[in] max_step The maximum step size.
             void trace(natural g, T y, T min_step, T max_step) const {
+                trace(g, y, min_step, max_step, T(0));
+            }
+
+            /// Traces state information to an output stream, including the number of rejected
+            /// samples per offspring, if requested.
+            ///
+            /// @param[in] g The generation number.
+            /// @param[in] y The value of the objective function.
+            /// @param[in] min_step The minimum step size.
+            /// @param[in] max_step The maximum step size.
+            /// @param[in] rejection_rate The number of rejected samples per offspring.
+            void trace(natural g, T y, T min_step, T max_step, T rejection_rate) const {
                 using std::endl;
                 using std::ios_base;
                 using std::setw;
@@ -256,6 +997,9 @@ namespace especia {
                 os << setw(w) << y;
                 os << setw(w) << min_step;
                 os << setw(w) << max_step;
+                if (rejections) {
+                    os << setw(w) << rejection_rate;
+                }
                 os << endl;
 
                 os.flags(fmt);
@@ -266,16 +1010,35 @@ namespace especia {
             const natural m;
             const natural p;
             const natural w;
+            Telemetry *const telemetry;
+            const bool rejections;
         };
 
+        /// Tests the command line options.
+        ///
+        /// @throw invalid_argument when an unknown option was supplied.
+        void check_options() const;
+
+        /// Finds the value of a command line option. When an option is supplied repeatedly, the
+        /// last value is found.
+        ///
+        /// @param[in] name The option name, including the leading dashes.
+        /// @param[out] value The option value.
+        /// @return @c true, if the option was supplied, @c false otherwise.
+        bool find_option(const std::string &name, std::string &value) const;
+
         void write_command_line(std::ostream &os) const;
 
-        void write_result_messages(std::ostream &os, const Optimizer::Result &result) const;
+        void write_result_messages(std::ostream &os, const Optimizer::Result &result,
+                                   const std::string &replay_path) const;
 
         void write_usage_message(std::ostream &os) const;
 
         /// The command line arguments.
         std::vector<std::string> args;
+
+        /// The command line options.
+        std::vector<std::string> options;
     };
 
 }
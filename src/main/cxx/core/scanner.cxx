@@ -0,0 +1,300 @@
+/// @file scanner.cxx
+/// Locale-independent procedures to scan numbers from text.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+#include "scanner.h"
+
+using especia::real;
+using especia::word64;
+
+/// The exactly representable powers of ten.
+static const real powers_of_ten[] = {1.0E+00, 1.0E+01, 1.0E+02, 1.0E+03, 1.0E+04, 1.0E+05, 1.0E+06, 1.0E+07,
+                                     1.0E+08, 1.0E+09, 1.0E+10, 1.0E+11, 1.0E+12, 1.0E+13, 1.0E+14, 1.0E+15,
+                                     1.0E+16, 1.0E+17, 1.0E+18, 1.0E+19, 1.0E+20, 1.0E+21, 1.0E+22};
+
+/// The maximum number of significant decimal digits accumulated into an integer.
+static const int max_digits = 19;
+
+/// The maximum length of a number, which is extracted from an input stream.
+static const size_t max_length = 512;
+
+/// Tests if a character is a decimal digit.
+///
+/// @param[in] c The character.
+/// @return @c true, if the character is a decimal digit.
+static inline bool is_digit(const char c) {
+    return c >= '0' and c <= '9';
+}
+
+/// Tests if a character is white space.
+///
+/// @param[in] c The character.
+/// @return @c true, if the character is white space.
+static inline bool is_space(const char c) {
+    return c == ' ' or c == '\t' or c == '\n' or c == '\v' or c == '\f' or c == '\r';
+}
+
+/// Returns the C locale, which the numbers not converted exactly by the fast path are
+/// converted in.
+///
+/// @return the C locale.
+static locale_t c_locale() {
+    static const locale_t locale = newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0));
+
+    return locale;
+}
+
+/// Converts a sequence of characters into a real number by means of @c strtod_l in the C locale.
+///
+/// @param[in] begin The beginning of the character sequence.
+/// @param[in] end The end of the character sequence.
+/// @param[out] x The real number.
+/// @return @c true on success, @c false if the number is out of range.
+static bool convert_by_strtod(const char *begin, const char *end, real &x) {
+    using std::memcpy;
+    using std::string;
+
+    const auto n = static_cast<size_t>(end - begin);
+
+    errno = 0;
+    if (n < max_length) {
+        char buffer[max_length];
+
+        memcpy(buffer, begin, n);
+        buffer[n] = '\0';
+        x = strtod_l(buffer, nullptr, c_locale());
+    } else {
+        const string s(begin, end);
+
+        x = strtod_l(s.c_str(), nullptr, c_locale());
+    }
+
+    return !(errno == ERANGE and std::abs(x) == HUGE_VAL);
+}
+
+const char *especia::parse(const char *begin, const char *end, real &x) {
+    const char *p = begin;
+
+    bool negative = false;
+    if (p < end and (*p == '+' or *p == '-')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    word64 w = 0;
+    int digits = 0;
+    int e10 = 0;
+    bool any = false;
+    bool truncated = false;
+
+    // The integral part
+    for (; p < end and is_digit(*p); ++p) {
+        const auto d = static_cast<word64>(*p - '0');
+
+        any = true;
+        if (digits < max_digits) {
+            if (w != 0 or d != 0) {
+                w = 10 * w + d;
+                ++digits;
+            }
+        } else {
+            truncated = truncated or d != 0;
+            ++e10;
+        }
+    }
+    // The fractional part
+    if (p < end and *p == '.') {
+        for (++p; p < end and is_digit(*p); ++p) {
+            const auto d = static_cast<word64>(*p - '0');
+
+            any = true;
+            if (digits < max_digits) {
+                if (w != 0 or d != 0) {
+                    w = 10 * w + d;
+                    ++digits;
+                }
+                --e10;
+            } else {
+                truncated = truncated or d != 0;
+            }
+        }
+    }
+    if (!any) {
+        return begin;
+    }
+    // The exponent
+    if (p < end and (*p == 'e' or *p == 'E')) {
+        const char *q = p + 1;
+
+        bool negative_exponent = false;
+        if (q < end and (*q == '+' or *q == '-')) {
+            negative_exponent = *q == '-';
+            ++q;
+        }
+        if (q == end or !is_digit(*q)) {
+            return begin;
+        }
+        int e = 0;
+        for (; q < end and is_digit(*q); ++q) {
+            if (e < 100000) {
+                e = 10 * e + (*q - '0');
+            }
+        }
+        e10 += negative_exponent ? -e : e;
+        p = q;
+    }
+
+    if (w == 0) {
+        x = negative ? -0.0 : 0.0;
+    } else if (!truncated and w <= (word64(1) << 53) and e10 >= -22 and e10 <= 22) {
+        // Clinger's fast path: both operands are exact, so the result is correctly rounded
+        const auto v = static_cast<real>(w);
+
+        x = e10 < 0 ? v / powers_of_ten[-e10] : v * powers_of_ten[e10];
+        if (negative) {
+            x = -x;
+        }
+    } else if (!convert_by_strtod(begin, p, x)) {
+        return begin;
+    }
+
+    return p;
+}
+
+const char *especia::parse(const char *begin, const char *end, bool &b) {
+    const char *p = begin;
+
+    if (p < end and (*p == '+' or *p == '-')) {
+        ++p;
+    }
+    if (p == end or !is_digit(*p)) {
+        return begin;
+    }
+    word64 w = 0;
+    for (; p < end and is_digit(*p); ++p) {
+        if (w < 10) {
+            w = 10 * w + static_cast<word64>(*p - '0');
+        }
+    }
+    if (w > 1) {
+        return begin;
+    }
+    b = w != 0;
+
+    return p;
+}
+
+especia::Scanner &especia::Scanner::operator>>(real &x) {
+    if (!failed) {
+        skip();
+
+        const char *p = parse(pos, end, x);
+
+        failed = p == pos;
+        pos = p;
+    }
+
+    return *this;
+}
+
+especia::Scanner &especia::Scanner::operator>>(bool &b) {
+    if (!failed) {
+        skip();
+
+        const char *p = parse(pos, end, b);
+
+        failed = p == pos;
+        pos = p;
+    }
+
+    return *this;
+}
+
+void especia::Scanner::skip() {
+    while (pos < end and is_space(*pos)) {
+        ++pos;
+    }
+}
+
+/// Extracts the characters of a number from an input stream.
+///
+/// @param[in,out] is The input stream.
+/// @param[out] buffer The buffer receiving the characters.
+/// @param[in] decimal Whether to extract a real number in decimal notation (or an integer number).
+/// @return the number of characters extracted, or @c max_length if the number is too long.
+static size_t extract(std::istream &is, char buffer[], const bool decimal) {
+    using std::char_traits;
+
+    std::streambuf *buf = is.rdbuf();
+    size_t n = 0;
+
+    bool point = false;
+    bool exponent = false;
+    bool sign = true;
+    auto c = buf->sgetc();
+
+    for (; c != char_traits<char>::eof() and n < max_length; c = buf->snextc()) {
+        const auto ch = char_traits<char>::to_char_type(c);
+
+        if (is_digit(ch)) {
+            sign = false;
+        } else if (sign and (ch == '+' or ch == '-')) {
+            sign = false;
+        } else if (decimal and !point and !exponent and ch == '.') {
+            point = true;
+            sign = false;
+        } else if (decimal and !exponent and n > 0 and (ch == 'e' or ch == 'E')) {
+            exponent = true;
+            sign = true;
+        } else {
+            break;
+        }
+        buffer[n++] = ch;
+    }
+    if (c == char_traits<char>::eof()) {
+        is.setstate(std::ios_base::eofbit);
+    }
+
+    return n;
+}
+
+std::istream &especia::scan(std::istream &is, real &x) {
+    const std::istream::sentry sentry(is);
+
+    if (sentry) {
+        char buffer[max_length];
+        const size_t n = extract(is, buffer, true);
+
+        if (n == 0 or n == max_length or parse(buffer, buffer + n, x) != buffer + n) {
+            is.setstate(std::ios_base::failbit);
+        }
+    }
+
+    return is;
+}
+
+std::istream &especia::scan(std::istream &is, bool &b) {
+    const std::istream::sentry sentry(is);
+
+    if (sentry) {
+        char buffer[max_length];
+        const size_t n = extract(is, buffer, false);
+
+        if (n == 0 or n == max_length or parse(buffer, buffer + n, b) != buffer + n) {
+            is.setstate(std::ios_base::failbit);
+        }
+    }
+
+    return is;
+}
@@ -0,0 +1,118 @@
+/// @file scanner.h
+/// Locale-independent procedures to scan numbers from text.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_SCANNER_H
+#define ESPECIA_SCANNER_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "base.h"
+
+namespace especia {
+
+    /// Parses a real number in decimal notation from a sequence of characters. Leading
+    /// white space is not skipped. The result is correctly rounded and does not depend
+    /// on the locale.
+    ///
+    /// @param[in] begin The beginning of the character sequence.
+    /// @param[in] end The end of the character sequence.
+    /// @param[out] x The real number parsed.
+    /// @return a pointer to the first character not parsed, or @c begin, if the sequence
+    /// does not start with a number.
+    const char *parse(const char *begin, const char *end, real &x);
+
+    /// Parses a selection flag (the integer number zero or one) from a sequence of characters.
+    /// Leading white space is not skipped.
+    ///
+    /// @param[in] begin The beginning of the character sequence.
+    /// @param[in] end The end of the character sequence.
+    /// @param[out] b The selection flag parsed.
+    /// @return a pointer to the first character not parsed, or @c begin, if the sequence
+    /// does not start with zero or one.
+    const char *parse(const char *begin, const char *end, bool &b);
+
+    /// Scans numbers from a line of text without allocating memory. Mimics the
+    /// extraction operators of an input string stream.
+    class Scanner {
+    public:
+        /// Constructs a new scanner for a sequence of characters.
+        ///
+        /// @param[in] begin The beginning of the character sequence.
+        /// @param[in] end The end of the character sequence.
+        Scanner(const char *begin, const char *end) : pos(begin), end(end), failed(false) {
+        }
+
+        /// Constructs a new scanner for a string. The string must outlive the scanner.
+        ///
+        /// @param[in] s The string.
+        explicit Scanner(const std::string &s) : Scanner(s.data(), s.data() + s.size()) {
+        }
+
+        /// Scans a real number.
+        ///
+        /// @param[out] x The real number scanned.
+        /// @return this scanner.
+        Scanner &operator>>(real &x);
+
+        /// Scans a selection flag.
+        ///
+        /// @param[out] b The selection flag scanned.
+        /// @return this scanner.
+        Scanner &operator>>(bool &b);
+
+        /// Tests if all scans have succeeded.
+        ///
+        /// @return @c true, if all scans have succeeded, @c false otherwise.
+        explicit operator bool() const {
+            return !failed;
+        }
+
+    private:
+        /// Skips white space.
+        void skip();
+
+        /// The current position.
+        const char *pos;
+
+        /// The end of the character sequence.
+        const char *const end;
+
+        /// The failure flag.
+        bool failed;
+    };
+
+    /// Extracts a real number from an input stream. Like the extraction operator, but
+    /// independent of the locale.
+    ///
+    /// @param[in,out] is The input stream.
+    /// @param[out] x The real number extracted.
+    /// @return the input stream.
+    std::istream &scan(std::istream &is, real &x);
+
+    /// Extracts a selection flag from an input stream. Like the extraction operator, but
+    /// independent of the locale.
+    ///
+    /// @param[in,out] is The input stream.
+    /// @param[out] b The selection flag extracted.
+    /// @return the input stream.
+    std::istream &scan(std::istream &is, bool &b);
+
+    /// Extracts an object from an input stream by means of the extraction operator.
+    ///
+    /// @tparam T The object type.
+    ///
+    /// @param[in,out] is The input stream.
+    /// @param[out] t The object extracted.
+    /// @return the input stream.
+    template<class T>
+    std::istream &scan(std::istream &is, T &t) {
+        return is >> t;
+    }
+
+}
+
+#endif // ESPECIA_SCANNER_H
@@ -5,15 +5,67 @@
 /// @copyright MIT License
 #include <algorithm>
 #include <cctype>
+#include <complex>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 
 #include "section.h"
+#include "dataio.h"
+#include "scanner.h"
+#include "writer.h"
 
+using especia::integer;
 using especia::natural;
+using especia::pixel;
 using especia::real;
 using especia::sqrt_of_ln_two;
 using especia::sqrt_of_pi;
+using especia::word64;
+
+#define LAPACK_NAME_DOUBLE(x) d##x##_
+#define LAPACK_NAME_SINGLE(x) s##x##_
+#define LAPACK_NAME_R_TYPE(x) LAPACK_NAME_DOUBLE(x)
+
+extern "C" {
+/// Interface to LAPACK routine @c [DS]POSV.
+void LAPACK_NAME_R_TYPE(posv)(const char &uplo,
+                              const integer &n,
+                              const integer &nrhs,
+                              real A[],
+                              const integer &lda,
+                              real B[],
+                              const integer &ldb,
+                              integer &info);
+}
+
+/// The number of primitive terms of the instrumental line spread function, from which on
+/// fast convolution is used.
+static const natural fft_threshold = 16;
+
+/// Returns the number of spectroscopic data points within a wavelength interval.
+///
+/// @param[in] spectrum The spectroscopic data.
+/// @param[in] a The minimum wavelength.
+/// @param[in] b The maximum wavelength.
+/// @return the number of data points within the interval.
+static size_t interval_data_count(const especia::Spectrum &spectrum, const real a, const real b) {
+    const size_t i = spectrum.lower_index(a);
+    const size_t j = spectrum.upper_index(b);
+
+    return j > i ? j - i : 0;
+}
+
+/// Moves an array into newly allocated memory.
+///
+/// @tparam T The element type.
+///
+/// @param[in,out] a The array.
+template<class T>
+static void relocate(std::valarray<T> &a) {
+    std::valarray<T> b(a);
+    a.swap(b);
+}
 
 especia::Section::Section()
         : wav(),
@@ -27,7 +79,10 @@ especia::Section::Section()
           tfl(),
           fit(),
           res(),
-          n(0) {
+          n(0),
+          lsf(),
+          basis(),
+          fast(true) {
 }
 
 especia::Section::Section(const size_t n_in)
@@ -42,7 +97,10 @@ especia::Section::Section(const size_t n_in)
           tfl(0.0, n_in),
           fit(0.0, n_in),
           res(0.0, n_in),
-          n(n_in) {
+          n(n_in),
+          lsf(),
+          basis(),
+          fast(true) {
 }
 
 especia::Section::Section(const size_t n_in, const real x[], const real y[], const real unc[])
@@ -57,101 +115,182 @@ especia::Section::Section(const size_t n_in, const real x[], const real y[], con
           tfl(0.0, n_in),
           fit(0.0, n_in),
           res(0.0, n_in),
-          n(n_in) {
+          n(n_in),
+          lsf(),
+          basis(),
+          fast(true) {
+}
+
+especia::Section::Section(const Spectrum &spectrum, const real a, const real b)
+        : Section(interval_data_count(spectrum, a, b)) {
+    const size_t k = spectrum.lower_index(a);
+
+    for (size_t i = 0; i < n; ++i) {
+        wav[i] = spectrum.wavelengths()[k + i];
+        flx[i] = spectrum.fluxes()[k + i];
+        unc[i] = spectrum.uncertainties()[k + i];
+        msk[i] = spectrum.masks()[k + i] != 0;
+    }
 }
 
 especia::Section::~Section() = default;
 
-void especia::Section::continuum(const natural m, const std::valarray<real> &cat, std::valarray<real> &cfl) const {
+void especia::Section::continuum(const natural m, const pixel cat[], real cfl[], Workspace &ws) const {
     using std::fill;
     using std::runtime_error;
-    using std::sqrt;
-    using std::valarray;
 
     if (m > 0) {
-        valarray<real> b(0.0, m);
-        valarray<real> c(0.0, m);
-        valarray<valarray<real>> a(b, m);
-        valarray<valarray<real>> l(valarray<real>(1.0, n), m);
+        const std::shared_ptr<const Basis> basis = legendre_basis(m);
 
-        if (m > 1) {
-            l[1] = 2.0 * (wav - lower_bound()) / width() - 1.0;
-            // Bonnet’s recursion formula
-            for (natural j = 1; j + 1 < m; ++j) {
-                l[j + 1] = (real(2 * j + 1) * l[1] * l[j] - real(j) * l[j - 1]) / real(j + 1);
-            }
-        }
+        ws.a.assign(m * m, 0.0);
+        ws.b.assign(m, 0.0);
+
+        // The matrix of the normal equations is stored in row-major layout, i.e. a[j][k] = a[j * m + k].
+        real *a = ws.a.data();
+        real *b = ws.b.data();
+        const real *l = basis->l.data();
 
         // Optimizing the background continuum is a linear optimization problem. Here the normal
-        // equations are established.
-        const valarray<real> p = cat / sq(unc);
-        for (natural j = 0; j < m; ++j) {
-            const valarray<real> &lj = l[j];
-            for (natural k = j; k < m; ++k) {
-                const valarray<real> &lk = l[k];
-                for (size_t i = 0; i < n; ++i) {
-                    if (msk[i]) {
-                        a[j][k] += cat[i] * p[i] * lj[i] * lk[i];
-                    }
+        // equations are established in a single pass over the valid data points.
+        for (size_t k = 0; k < basis->index.size(); ++k) {
+            const real c = cat[basis->index[k]];
+            const real p = c / basis->var[k];
+            const real q = c * p;
+            const real r = basis->flx[k] * p;
+            const real *v = &basis->v[k * m];
+
+            for (natural i = 0; i < m; ++i) {
+                const real s = q * v[i];
+
+                for (natural j = i; j < m; ++j) {
+                    a[i * m + j] += s * v[j];
                 }
+                b[i] += r * v[i];
             }
+        }
+        // The normal equations are solved by means of a Cholesky decomposition. In column-major
+        // layout, the elements established are the lower triangle of the matrix.
+        integer info = 0;
+        LAPACK_NAME_R_TYPE(posv)('L', static_cast<integer>(m), 1, a, static_cast<integer>(m), b,
+                                 static_cast<integer>(m), info);
+        if (info != 0) {
+            // The normal equations are (numerically) singular.
+            throw runtime_error("especia::section::continuum(): Error: normal equations are numerically singular");
+        }
+
+        // Compute the continuum flux. The first Legendre term is a constant.
+        fill(cfl, cfl + n, b[0]);
+        // The other terms depend on the abcissa value.
+        for (natural k = 1; k < m; ++k) {
             for (size_t i = 0; i < n; ++i) {
-                if (msk[i]) {
-                    b[j] += flx[i] * p[i] * lj[i];
-                }
+                cfl[i] += b[k] * l[k * n + i];
             }
         }
-        // The normal equations are solved by means of a Cholesky decomposition (e.g. Press et al. 2002).
-        //
-        // W. H. Press, S. A. Teukolsky, W. T. Vetterling, B. P. Flannery (2002).
-        //   Numerical Recipes in C: The Art of Scientific Computing.
-        //   Cambridge University Press, ISBN 0-521-75033-4.
-        for (natural i = 0; i < m; ++i) {
-            for (natural j = i; j < m; ++j) {
-                real s = a[i][j];
-
-                for (natural k = 0; k < i; ++k) {
-                    s -= a[i][k] * a[j][k];
-                }
-                if (i < j) {
-                    a[j][i] = s / a[i][i];
-                } else if (s > 0.0) {
-                    a[i][i] = sqrt(s);
-                } else {
-                    // The normal equations are (numerically) singular.
-                    throw runtime_error(
-                            "especia::section::continuum(): Error: normal equations are numerically singular");
+    } else {
+        fill(cfl, cfl + n, 1.0);
+    }
+}
+
+real especia::Section::subset_cost(const Basis &basis, const natural stride, const pixel cat[], Workspace &ws) {
+    const natural m = basis.m;
+    const size_t count = basis.index.size();
+
+    if (m > 0) {
+        ws.a.assign(m * m, 0.0);
+        ws.b.assign(m, 0.0);
+
+        real *a = ws.a.data();
+        real *b = ws.b.data();
+
+        // The normal equations are established like for all valid data points
+        for (size_t k = stride / 2, c = 0; k < count; k += stride, ++c) {
+            const real p = cat[c] / basis.var[k];
+            const real q = cat[c] * p;
+            const real r = basis.flx[k] * p;
+            const real *v = &basis.v[k * m];
+
+            for (natural i = 0; i < m; ++i) {
+                const real s = q * v[i];
+
+                for (natural j = i; j < m; ++j) {
+                    a[i * m + j] += s * v[j];
                 }
+                b[i] += r * v[i];
             }
         }
-        for (natural i = 0; i < m; ++i) {
-            real s = b[i];
+        integer info = 0;
+        LAPACK_NAME_R_TYPE(posv)('L', static_cast<integer>(m), 1, a, static_cast<integer>(m), b,
+                                 static_cast<integer>(m), info);
+        if (info != 0) {
+            // The subset is too small to determine the background continuum, but zero is a bound
+            return 0.0;
+        }
+    }
 
-            for (natural k = 0; k < i; ++k) {
-                s -= a[i][k] * c[k];
-            }
+    real cost = 0.0;
+    for (size_t k = stride / 2, c = 0; k < count; k += stride, ++c) {
+        real cfl = 1.0;
 
-            c[i] = s / a[i][i];
-        }
-        for (natural i = m - 1; i + 1 > 0; --i) {
-            real s = c[i];
+        if (m > 0) {
+            const real *v = &basis.v[k * m];
 
-            for (natural k = i + 1; k < m; ++k) {
-                s -= a[k][i] * c[k];
+            cfl = ws.b[0];
+            for (natural j = 1; j < m; ++j) {
+                cfl += ws.b[j] * v[j];
             }
-
-            c[i] = s / a[i][i];
         }
+        cost += sq(basis.flx[k] - cfl * cat[c]) / basis.var[k];
+    }
 
-        // Compute the continuum flux. The first Legendre term is a constant.
-        cfl = c[0];
-        // The other terms depend on the abcissa value.
-        for (natural k = 1; k < m; ++k) {
-            cfl += c[k] * l[k];
+    return 0.5 * cost;
+}
+
+std::shared_ptr<const especia::Section::Basis> especia::Section::legendre_basis(const natural m) const {
+    using std::atomic_load;
+    using std::atomic_store;
+    using std::fill;
+    using std::make_shared;
+    using std::shared_ptr;
+
+    shared_ptr<const Basis> cached = atomic_load(&basis);
+
+    if (!cached or cached->m != m) {
+        const shared_ptr<Basis> b = make_shared<Basis>();
+
+        b->m = m;
+        b->l.resize(m * n);
+
+        real *l = b->l.data();
+
+        fill(l, l + n, 1.0);
+        if (m > 1) {
+            for (size_t i = 0; i < n; ++i) {
+                l[n + i] = 2.0 * (wav[i] - lower_bound()) / width() - 1.0;
+            }
+            // Bonnet’s recursion formula
+            for (natural j = 1; j + 1 < m; ++j) {
+                for (size_t i = 0; i < n; ++i) {
+                    l[(j + 1) * n + i] = (real(2 * j + 1) * l[n + i] * l[j * n + i] - real(j) * l[(j - 1) * n + i]) /
+                                         real(j + 1);
+                }
+            }
         }
-    } else {
-        fill(&cfl[0], &cfl[n], 1.0);
+        for (size_t i = 0; i < n; ++i) {
+            if (msk[i]) {
+                b->index.push_back(i);
+                b->flx.push_back(flx[i]);
+                b->var.push_back(sq(unc[i]));
+                for (natural j = 0; j < m; ++j) {
+                    b->v.push_back(l[j * n + i]);
+                }
+            }
+        }
+
+        atomic_store(&basis, shared_ptr<const Basis>(b));
+        cached = b;
     }
+
+    return cached;
 }
 
 size_t especia::Section::valid_data_count() const {
@@ -184,6 +323,28 @@ void especia::Section::mask(const real a, const real b) {
             msk[i] = false;
         }
     }
+    basis.reset();
+}
+
+void especia::Section::localize() {
+    relocate(wav);
+    relocate(flx);
+    relocate(unc);
+    relocate(msk);
+    relocate(opt);
+    relocate(atm);
+    relocate(cat);
+    relocate(cfl);
+    relocate(tfl);
+    relocate(fit);
+    relocate(res);
+    lsf.reset();
+    basis.reset();
+}
+
+void especia::Section::set_fast_convolution(const bool fast) {
+    this->fast = fast;
+    lsf.reset();
 }
 
 void especia::Section::primitive(const real &x, const real &h, real &p, real &q) {
@@ -197,19 +358,263 @@ void especia::Section::primitive(const real &x, const real &h, real &p, real &q)
     q = 0.5 * exp(-sq(x / b)) * (-d);
 }
 
-void especia::Section::supersample(const std::valarray<real> &source, const natural k, std::valarray<real> &target) {
-    for (natural is = 0, it = 0; is < source.size(); ++is, it += k) {
+void especia::Section::supersample(const real source[], const size_t n, const natural k, real target[]) {
+    for (size_t is = 0, it = 0; is < n; ++is, it += k) {
         target[it] = source[is];
     }
     for (natural j = 1; j < k; ++j) {
         const real w = real(j) / real(k);
 
-        for (size_t is = 0, it = j; is + 1 < source.size(); ++is, it += k) {
+        for (size_t is = 0, it = j; is + 1 < n; ++is, it += k) {
             target[it] = source[is] + w * (source[is + 1] - source[is]);
         }
     }
 }
 
+std::shared_ptr<const especia::Section::Kernel> especia::Section::line_spread_function(const real r) const {
+    using std::atomic_load;
+    using std::atomic_store;
+    using std::ceil;
+    using std::make_shared;
+    using std::shared_ptr;
+    using std::vector;
+
+    shared_ptr<const Kernel> cached = atomic_load(&lsf);
+
+    if (!cached or cached->r != r) {
+        const shared_ptr<Kernel> kernel = make_shared<Kernel>();
+
+        // The half width at half maximum (HWHM) of the instrumental profile.
+        const real h = 0.5 * center() / (r * kilo);
+        // The data spacing.
+        const real d = width() / (n - 1);
+        // The super-sampling factor. Is greater than one, if the data spacing is greater than the HWHM.
+        const auto s = static_cast<natural>(ceil(d / h));
+        // The super-sampled spacing.
+        const real w = d / s;
+        // The Gaussian line spread function is truncated at 4 HWHM.
+        const auto m = static_cast<natural>(4.0 * (h / w)) + 1;
+
+        kernel->r = r;
+        kernel->s = s;
+        kernel->w = w;
+        kernel->m = m;
+        kernel->dp.resize(m - 1);
+        kernel->dq.resize(m - 1);
+
+        // Computation of the instrumental line spread function's primitive terms.
+        real p0;
+        real q0;
+        primitive(0.0, h, p0, q0);
+        for (natural j = 0; j + 1 < m; ++j) {
+            real p1;
+            real q1;
+            primitive((j + 1) * w, h, p1, q1);
+
+            kernel->dp[j] = static_cast<pixel>(p1 - p0);
+            kernel->dq[j] = static_cast<pixel>(q1 - q0);
+            p0 = p1;
+            q0 = q1;
+        }
+
+        // The convolution of a unit absorption term, computed like for any data point
+        const vector<pixel> unit(2 * m - 1, 1.0);
+        kernel->unit = convolve(*kernel, unit.data(), unit.size(), m - 1);
+
+        if (fast and m >= fft_threshold) {
+            // The convolution filter far from the boundaries, given by the differences of the primitive
+            // terms, i.e. cat[i] = sum_t h[|t|] atm[i + t] with -m < t < m.
+            vector<real> h(m, 0.0);
+            for (natural j = 0; j + 1 < m; ++j) {
+                const real e = kernel->dq[j] / w - real(j) * kernel->dp[j];
+
+                h[j] += kernel->dp[j] - e;
+                h[j + 1] += e;
+            }
+            h[0] *= 2.0;
+
+            const size_t size = Fourier_Transform::power_of_two(4 * (2 * m - 1));
+            const auto fft = make_shared<Fourier_Transform>(size);
+
+            kernel->spectrum.assign(size, 0.0);
+            for (natural j = 0; j < m; ++j) {
+                kernel->spectrum[m - 1 + j] = h[j] / real(size);
+                kernel->spectrum[m - 1 - j] = h[j] / real(size);
+            }
+            fft->forward(kernel->spectrum.data());
+            kernel->fft = fft;
+        }
+
+        atomic_store(&lsf, shared_ptr<const Kernel>(kernel));
+        cached = kernel;
+    }
+
+    return cached;
+}
+
+void especia::Section::convolve(const Kernel &kernel, const pixel f[], const size_t nf, pixel g[], const size_t ng,
+                                Workspace &ws) {
+    using std::min;
+
+    const natural s = kernel.s;
+    const natural m = kernel.m;
+
+    // The data points far from the boundaries, i.e. m - 1 <= s i <= nf - m
+    size_t begin = (m - 1 + s - 1) / s;
+    size_t end = (nf >= m) ? min(ng, (nf - m) / s + 1) : 0;
+
+    if (end <= begin) {
+        begin = ng;
+        end = ng;
+    }
+    for (size_t i = 0; i < begin; ++i) {
+        g[i] = convolve(kernel, f, nf, s * i);
+    }
+    if (kernel.fft and s * (end - begin) >= kernel.fft->size() / 2) {
+        convolve_fft(kernel, f, nf, g, begin, end, ws);
+    } else {
+        convolve_direct(kernel, f, g, begin, end);
+    }
+    for (size_t i = end; i < ng; ++i) {
+        g[i] = convolve(kernel, f, nf, s * i);
+    }
+}
+
+void especia::Section::convolve(const Kernel &kernel, const pixel f[], const size_t nf, pixel g[], const size_t ng,
+                                const size_t first, const size_t last) {
+    using std::max;
+    using std::min;
+
+    const natural s = kernel.s;
+    const natural m = kernel.m;
+
+    // The data points far from the boundaries, like for all data points
+    size_t begin = (m - 1 + s - 1) / s;
+    size_t end = (nf >= m) ? min(ng, (nf - m) / s + 1) : 0;
+
+    if (end <= begin) {
+        begin = ng;
+        end = ng;
+    }
+    for (size_t i = first; i < min(last, begin); ++i) {
+        g[i] = convolve(kernel, f, nf, s * i);
+    }
+    if (max(first, begin) < min(last, end)) {
+        convolve_direct(kernel, f, g, max(first, begin), min(last, end));
+    }
+    for (size_t i = max(first, end); i < last; ++i) {
+        g[i] = convolve(kernel, f, nf, s * i);
+    }
+}
+
+pixel especia::Section::convolve(const Kernel &kernel, const pixel f[], const size_t nf, const size_t i) {
+    const natural m = kernel.m;
+    const pixel *dp = kernel.dp.data();
+    const pixel *dq = kernel.dq.data();
+
+    pixel a = 0.0;
+    pixel b = 0.0;
+
+    for (natural j = 0; j + 1 < m; ++j) {
+        const size_t k = (i < j + 1) ? 0 : i - j - 1;
+        const size_t l = (i + j + 2 > nf) ? nf - 2 : i + j;
+        const pixel c = (f[l + 1] - f[l]) - (f[k + 1] - f[k]);
+
+        a += dp[j] * (f[k + 1] + f[l] - pixel(j) * c);
+        b += dq[j] * c;
+    }
+
+    return a + b / pixel(kernel.w);
+}
+
+void especia::Section::convolve_direct(const Kernel &kernel, const pixel f[], pixel g[], const size_t begin,
+                                       const size_t end) {
+    using std::fill;
+    using std::min;
+
+    const natural s = kernel.s;
+    const natural m = kernel.m;
+    const pixel *dp = kernel.dp.data();
+    const pixel *dq = kernel.dq.data();
+    const auto w = pixel(kernel.w);
+
+    // The data points are processed in blocks, which fit into the L1 cache. Within a block the
+    // loop over data points is innermost, so it can be vectorized, while the terms are summed
+    // in the same order as for a single data point.
+    const size_t block_size = 256;
+
+    pixel a[block_size];
+    pixel b[block_size];
+
+    for (size_t i0 = begin; i0 < end; i0 += block_size) {
+        const size_t nb = min(block_size, end - i0);
+
+        fill(a, a + nb, 0.0);
+        fill(b, b + nb, 0.0);
+
+        for (natural j = 0; j + 1 < m; ++j) {
+            const pixel p = dp[j];
+            const pixel q = dq[j];
+            const auto u = pixel(j);
+
+            for (size_t k = 0; k < nb; ++k) {
+                const size_t i = s * (i0 + k);
+                const pixel c = (f[i + j + 1] - f[i + j]) - (f[i - j] - f[i - j - 1]);
+
+                a[k] += p * (f[i - j] + f[i + j] - u * c);
+                b[k] += q * c;
+            }
+        }
+        for (size_t k = 0; k < nb; ++k) {
+            g[i0 + k] = a[k] + b[k] / w;
+        }
+    }
+}
+
+void especia::Section::convolve_fft(const Kernel &kernel, const pixel f[], const size_t nf, pixel g[],
+                                    const size_t begin, const size_t end, Workspace &ws) {
+    using std::complex;
+
+    const natural s = kernel.s;
+    const size_t d = kernel.m - 1;
+    const size_t size = kernel.fft->size();
+    // The number of valid data points per block
+    const size_t step = size - 2 * d;
+
+    ws.z.resize(size);
+    complex<real> *z = ws.z.data();
+    const complex<real> *h = kernel.spectrum.data();
+
+    // Two real-valued blocks are transformed at once, as real and imaginary part
+    for (size_t o = s * begin - d, i = begin; i < end; o += 2 * step) {
+        for (size_t k = 0; k < size; ++k) {
+            const size_t k1 = o + k;
+            const size_t k2 = o + step + k;
+
+            z[k] = complex<real>(k1 < nf ? f[k1] : 0.0, k2 < nf ? f[k2] : 0.0);
+        }
+        kernel.fft->forward(z);
+        for (size_t k = 0; k < size; ++k) {
+            z[k] = complex<real>(z[k].real() * h[k].real() - z[k].imag() * h[k].imag(),
+                                 z[k].real() * h[k].imag() + z[k].imag() * h[k].real());
+        }
+        kernel.fft->inverse(z);
+
+        for (; i < end and s * i < o + d + step; ++i) {
+            g[i] = static_cast<pixel>(z[s * i + d - o].real());
+        }
+        for (; i < end and s * i < o + d + 2 * step; ++i) {
+            g[i] = static_cast<pixel>(z[s * i + d - o - step].imag());
+        }
+    }
+}
+
+especia::Section::Workspace &especia::Section::workspace() {
+    static thread_local Workspace workspace;
+
+    return workspace;
+}
+
 std::istream &especia::Section::get(std::istream &is, const real a, const real b) {
     using namespace std;
 
@@ -234,7 +639,7 @@ std::istream &especia::Section::get(std::istream &is, const real a, const real b
             continue;
         }
 
-        istringstream ist(line);
+        Scanner ist(line);
         bool tw;
         real tx, ty, tz;
 
@@ -278,6 +683,8 @@ std::istream &especia::Section::get(std::istream &is, const real a, const real b
         res.resize(i, 0.0);
 
         n = i;
+        lsf.reset();
+        basis.reset();
 
         copy(x.begin(), x.end(), &wav[0]);
         copy(y.begin(), y.end(), &flx[0]);
@@ -293,51 +700,56 @@ std::istream &especia::Section::get(std::istream &is, const real a, const real b
 }
 
 std::ostream &especia::Section::put(std::ostream &os, const real a, const real b) const {
-    using namespace std;
-
     if (os) {
-        // The precision.
-        const natural p = 8;
-        // The width of the output field.
-        const natural w = 16;
-
-        const ios_base::fmtflags f = os.flags();
-
-        os.setf(ios_base::fmtflags());
-        os.setf(ios_base::scientific, ios_base::floatfield);
-        os.setf(ios_base::right, ios_base::adjustfield);
-        os.precision(p);
+        Writer writer(os);
+        real record[data_record_length];
 
         for (size_t i = 0; i < n; ++i)
             if (a <= wav[i] and wav[i] <= b) {
-                // The normalized observed spectral flux and its uncertainty.
-                const real nfl = flx[i] / cfl[i];
-                const real nun = unc[i] / cfl[i];
-
-                os << setw(w) << wav[i]; // 1
-                os << setw(w) << flx[i]; // 2
-                os << setw(w) << unc[i]; // 3
-                os << setw(3) << msk[i]; // 4
-                os << setw(w) << opt[i]; // 5
-                os << setw(w) << atm[i]; // 6
-                os << setw(w) << cat[i]; // 7
-                os << setw(w) << cfl[i]; // 8
-                os << setw(w) << tfl[i]; // 9
-                os << setw(w) << fit[i]; // 10
-                os << setw(w) << res[i]; // 11
-                os << setw(w) << nfl;    // 12
-                os << setw(w) << nun;    // 13
-
-                os << '\n';
+                get_record(i, record);
+                put_data_record(writer, record);
             }
 
+        writer.flush();
         os.flush();
-        os.flags(f);
     }
 
     return os;
 }
 
+std::ostream &especia::Section::write(std::ostream &os) const {
+    if (os) {
+        const auto count = static_cast<word64>(n);
+        std::vector<real> records(n * data_record_length);
+
+        for (size_t i = 0; i < n; ++i) {
+            get_record(i, &records[i * data_record_length]);
+        }
+        os.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        os.write(reinterpret_cast<const char *>(records.data()),
+                 static_cast<std::streamsize>(records.size() * sizeof(real)));
+    }
+
+    return os;
+}
+
+void especia::Section::get_record(const size_t i, real record[]) const {
+    record[0] = wav[i];
+    record[1] = flx[i];
+    record[2] = unc[i];
+    record[3] = msk[i] ? 1.0 : 0.0;
+    record[4] = opt[i];
+    record[5] = atm[i];
+    record[6] = cat[i];
+    record[7] = cfl[i];
+    record[8] = tfl[i];
+    record[9] = fit[i];
+    record[10] = res[i];
+    // The normalized observed spectral flux and its uncertainty.
+    record[11] = flx[i] / cfl[i];
+    record[12] = unc[i] / cfl[i];
+}
+
 std::istream &especia::operator>>(std::istream &is, std::vector<Section> &sections) {
     using std::vector;
 
@@ -360,3 +772,13 @@ std::ostream &especia::operator<<(std::ostream &os, const std::vector<Section> &
 
     return os;
 }
+
+std::ostream &especia::write(std::ostream &os, const std::vector<Section> &sections) {
+    write_data_header(os, static_cast<word64>(sections.size()));
+    for (const auto &section : sections) {
+        section.write(os);
+    }
+    os.flush();
+
+    return os;
+}
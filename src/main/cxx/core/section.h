@@ -8,17 +8,45 @@
 
 #include <algorithm>
 #include <cmath>
+#include <complex>
 #include <cstddef>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <valarray>
 #include <vector>
 
 #include "base.h"
+#include "fourier.h"
+#include "spectrum.h"
 
 namespace especia {
 
+    /// Detects whether an optical depth function type provides the supports of its profiles. A
+    /// supported function type provides the method
+    ///
+    /// @c for_each_support(f) calling @c f(lo, up) with the lower and upper bound of the support
+    /// of each profile. Beyond the supports of all profiles the optical depth is zero.
+    ///
+    /// @tparam Function The optical depth function type.
+    template<class Function>
+    class Is_Supported {
+    private:
+        template<class G>
+        static auto test(const G *g) -> decltype(g->for_each_support(static_cast<void (*)(real, real)>(nullptr)),
+                std::true_type());
+
+        template<class G>
+        static std::false_type test(...);
+
+    public:
+        /// Is @c true if the optical depth function type is supported.
+        static const bool value = decltype(test<Function>(nullptr))::value;
+    };
+
     /// Represents a section of (observed and modelled) spectroscopic data.
     class Section {
     public:
@@ -40,6 +68,14 @@ namespace especia {
         /// @param[in] unc The spectral flux uncertainty data.
         Section(size_t n_in, const real wav[], const real flx[], const real unc[]);
 
+        /// Constructs a new instance of this class from the spectroscopic data within a
+        /// certain wavelength interval. The interval is located by means of binary search.
+        ///
+        /// @param[in] spectrum The spectroscopic data.
+        /// @param[in] a The minimum wavelength.
+        /// @param[in] b The maximum wavelength.
+        Section(const Spectrum &spectrum, real a, real b);
+
         /// The destructor.
         ~Section();
 
@@ -59,6 +95,12 @@ namespace especia {
         /// @return the output stream.
         std::ostream &put(std::ostream &os, real a = 0.0, real b = std::numeric_limits<real>::max()) const;
 
+        /// Writes a data section to an output stream in binary format (see @c write_data_header()).
+        ///
+        /// @param[in,out] os The output stream.
+        /// @return the output stream.
+        std::ostream &write(std::ostream &os) const;
+
         /// Returns the lower wavelength bound of this data section.
         ///
         /// @return the lower wavelength bound of this data section.
@@ -117,42 +159,158 @@ namespace especia {
         /// @return the value of the cost function.
         ///
         /// @remark calling this method is thread safe, if the optical depth model is thread safe.
+        /// @remark Once the scratch space of the calling thread has grown to the size of this section,
+        /// calling this method does not allocate any memory.
         template<class Function>
         real cost(const Function &tau, const real r, const natural m) const {
-            using std::abs;
-            using std::valarray;
+            Workspace &ws = workspace();
+            ws.opt.resize(n);
+            ws.atm.resize(n);
+            ws.cat.resize(n);
+            ws.cfl.resize(n);
 
-            valarray<real> opt(n);
-            valarray<real> atm(n);
-            valarray<real> cat(n);
-            valarray<real> cfl(n);
-            valarray<real> tfl(n);
-            valarray<real> fit(n);
-            valarray<real> res(n);
+            // The modelled per-pixel data are of type pixel, but the cost is accumulated in double precision
 
-            convolute(r, tau, opt, atm, cat);
-            continuum(m, cat, cfl);
-
-            tfl = cfl * atm;
-            fit = cfl * cat;
-            res = (flx - fit) / unc;
+            convolute(r, tau, ws.opt.data(), ws.atm.data(), ws.cat.data(), ws);
+            continuum(m, ws.cat.data(), ws.cfl.data(), ws);
 
             real cost = 0.0;
             for (size_t i = 0; i < n; ++i) {
                 if (msk[i]) {
-                    cost += sq(res[i]);
+                    cost += sq((flx[i] - ws.cfl[i] * ws.cat[i]) / unc[i]);
                 }
             }
 
             return 0.5 * cost;
         }
 
+        /// Computes the residuals of the valid data points as a function of a given optical depth
+        /// function. Half the sum of the squared residuals is the value of the cost function.
+        ///
+        /// @tparam Function The type of optical depth function.
+        ///
+        /// @param[in] tau The optical depth function.
+        /// @param[in] r The spectral resolution of the instrument.
+        /// @param[in] m The number of Legendre basis polynomials to model the background continuum.
+        /// @param[out] z The residuals of the valid data points.
+        ///
+        /// @remark calling this method is thread safe, if the optical depth model is thread safe.
+        template<class Function>
+        void residuals(const Function &tau, const real r, const natural m, real z[]) const {
+            Workspace &ws = workspace();
+            ws.opt.resize(n);
+            ws.atm.resize(n);
+            ws.cat.resize(n);
+            ws.cfl.resize(n);
+
+            convolute(r, tau, ws.opt.data(), ws.atm.data(), ws.cat.data(), ws);
+            continuum(m, ws.cat.data(), ws.cfl.data(), ws);
+
+            for (size_t i = 0, k = 0; i < n; ++i) {
+                if (msk[i]) {
+                    z[k++] = (flx[i] - ws.cfl[i] * ws.cat[i]) / unc[i];
+                }
+            }
+        }
+
+        /// Returns a lower bound of the cost function as a function of a given optical depth
+        /// function. The bound is the cost of a stratified subset of the valid data points, i.e.
+        /// the central point of each stratum of @c stride consecutive valid data points, with the
+        /// background continuum optimized for the subset. The optical depth is evaluated only for
+        /// the super-sampled points within the support of the line spread function of each point
+        /// selected.
+        ///
+        /// @tparam Function The type of optical depth function.
+        ///
+        /// @param[in] tau The optical depth function.
+        /// @param[in] r The spectral resolution of the instrument.
+        /// @param[in] m The number of Legendre basis polynomials to model the background continuum.
+        /// @param[in] stride The number of valid data points per stratum.
+        ///
+        /// @return a lower bound of the value of the cost function.
+        ///
+        /// @remark The bound is exact except for rounding, because the convoluted absorption term
+        /// of a data point is computed like the convolution near the boundaries.
+        /// @remark calling this method is thread safe, if the optical depth model is thread safe.
+        template<class Function>
+        real cost_bound(const Function &tau, const real r, const natural m, const natural stride) const {
+            using std::exp;
+            using std::min;
+
+            if (n <= 2 or stride == 0) {
+                return 0.0;
+            }
+            const std::shared_ptr<const Basis> basis = legendre_basis(m);
+            const std::shared_ptr<const Kernel> kernel = line_spread_function(r);
+            // The super-sampling factor, the number of super-samples, and the half-width of the
+            // support of the line spread function (in super-samples)
+            const natural s = kernel->s;
+            const size_t ns = s * (n - 1) + 1;
+            const size_t d = kernel->m - 1;
+
+            Workspace &ws = workspace();
+            ws.wavs.clear();
+            ws.off.clear();
+
+            // The supports of the points selected are merged, so the optical depth is evaluated
+            // at ascending wavelengths, by a single call, like for the whole section
+            size_t end = 0;
+            for (size_t k = stride / 2; k < basis->index.size(); k += stride) {
+                const size_t i = s * basis->index[k];
+                const size_t a = (i > d) ? i - d : 0;
+                const size_t b = min(ns - 1, i + d);
+
+                ws.off.push_back(ws.wavs.size() - (end > a ? end : a) + a);
+                for (size_t t = (end > a ? end : a); t <= b; ++t) {
+                    const size_t j = t / s;
+                    const natural u = static_cast<natural>(t % s);
+
+                    // The super-sampled wavelengths are interpolated like for the whole section
+                    ws.wavs.push_back((u == 0) ? wav[j] : wav[j] + (real(u) / real(s)) * (wav[j + 1] - wav[j]));
+                }
+                end = b + 1;
+            }
+            ws.opts.resize(ws.wavs.size());
+            ws.atms.resize(ws.wavs.size());
+            pixel *opts = ws.opts.data();
+            pixel *atms = ws.atms.data();
+
+            tau.evaluate(ws.wavs.data(), opts, ws.wavs.size());
+            for (size_t t = 0; t < ws.wavs.size(); ++t) {
+                atms[t] = exp(-opts[t]);
+            }
+
+            ws.cat.clear();
+            for (size_t k = stride / 2, c = 0; k < basis->index.size(); k += stride, ++c) {
+                const size_t i = s * basis->index[k];
+                const size_t a = (i > d) ? i - d : 0;
+                const size_t b = min(ns - 1, i + d);
+
+                ws.cat.push_back(convolve(*kernel, atms + ws.off[c], b - a + 1, i - a));
+            }
+
+            return subset_cost(*basis, stride, ws.cat.data(), ws);
+        }
+
         /// Masks the data in a certain interval as invalid.
         ///
         /// @param[in] a The lower bound of the interval.
         /// @param[in] b The upper bound of the interval.
         void mask(real a, real b);
 
+        /// Moves the data of this section into memory, which is newly allocated and first touched
+        /// by the calling thread, so the memory is placed on the NUMA node of the calling thread.
+        /// The cached line spread function and Legendre basis polynomials are discarded and
+        /// recomputed when needed.
+        void localize();
+
+        /// Configures whether fast convolution is used, if the instrumental line spread function
+        /// is wide. Fast convolution is used by default. The cached line spread function is
+        /// discarded and recomputed when needed.
+        ///
+        /// @param[in] fast Whether to use fast convolution.
+        void set_fast_convolution(bool fast);
+
         /// Applies an optical depth and background continuum model to this section.
         ///
         /// @tparam Function The type of optical depth function.
@@ -164,8 +322,19 @@ namespace especia {
         /// @return this section.
         template<class Function>
         Section &apply(const natural m, const real r, const Function &tau) {
-            convolute(r, tau, opt, atm, cat);
-            continuum(m, cat, cfl);
+            using std::begin;
+            using std::copy;
+
+            Workspace &ws = workspace();
+            ws.opt.resize(n);
+            ws.atm.resize(n);
+            ws.cat.resize(n);
+
+            convolute(r, tau, ws.opt.data(), ws.atm.data(), ws.cat.data(), ws);
+            continuum(m, ws.cat.data(), begin(cfl), ws);
+            copy(ws.opt.begin(), ws.opt.end(), begin(opt));
+            copy(ws.atm.begin(), ws.atm.end(), begin(atm));
+            copy(ws.cat.begin(), ws.cat.end(), begin(cat));
 
             tfl = cfl * atm;
             fit = cfl * cat;
@@ -175,103 +344,388 @@ namespace especia {
         }
 
     private:
+        /// Returns the data record of a data point, with the columns written to an output stream.
+        ///
+        /// @param[in] i The index of the data point.
+        /// @param[out] record The data record.
+        void get_record(size_t i, real record[]) const;
+
+        /// Scratch space to evaluate the cost function. The buffers grow on demand, but
+        /// never shrink, so they are allocated once per thread in the steady state.
+        class Workspace {
+        public:
+            /// The evaluated optical depth.
+            std::vector<pixel> opt;
+
+            /// The evaluated absorption term.
+            std::vector<pixel> atm;
+
+            /// The evaluated convoluted absorption term.
+            std::vector<pixel> cat;
+
+            /// The evaluated background continuum flux.
+            std::vector<real> cfl;
+
+            /// The super-sampled wavelength data.
+            std::vector<real> wavs;
+
+            /// The super-sampled optical depth.
+            std::vector<pixel> opts;
+
+            /// The super-sampled absorption term.
+            std::vector<pixel> atms;
+
+            /// The runs of consecutive data points, whose absorption term is super-sampled.
+            std::vector<std::pair<size_t, size_t>> runs;
+
+            /// The offsets of the supports of the data points selected to compute a lower bound of
+            /// the cost function.
+            std::vector<size_t> off;
+
+            /// The data blocks of the fast convolution.
+            std::vector<std::complex<real>> z;
+
+            /// The matrix of the normal equations (in row-major layout).
+            std::vector<real> a;
+
+            /// The right-hand side of the normal equations, which is replaced with the solution.
+            std::vector<real> b;
+        };
+
+        /// The Legendre basis polynomials to model the background continuum, and the data of
+        /// all valid data points, which do not change between evaluations of the cost function.
+        class Basis {
+        public:
+            /// The number of Legendre basis polynomials.
+            natural m;
+
+            /// The Legendre basis polynomials for all data points (in row-major layout), i.e.
+            /// l[j][i] = l[j * n + i].
+            std::vector<real> l;
+
+            /// The indexes of the valid data points.
+            std::vector<size_t> index;
+
+            /// The Legendre basis polynomials for the valid data points (in column-major layout),
+            /// i.e. l[j][k] = v[k * m + j] for the valid data point k.
+            std::vector<real> v;
+
+            /// The flux of the valid data points.
+            std::vector<real> flx;
+
+            /// The squared flux uncertainty of the valid data points.
+            std::vector<real> var;
+        };
+
+        /// The instrumental line spread function for a given spectral resolution.
+        class Kernel {
+        public:
+            /// The spectral resolution of the instrument.
+            real r;
+
+            /// The super-sampling factor.
+            natural s;
+
+            /// The super-sampled spacing.
+            real w;
+
+            /// The number of primitive terms.
+            natural m;
+
+            /// The differences of consecutive primitive terms of g(x).
+            std::vector<pixel> dp;
+
+            /// The differences of consecutive primitive terms of x g(x).
+            std::vector<pixel> dq;
+
+            /// The convoluted absorption term of a data point far from any line, i.e. the
+            /// convolution of a unit absorption term.
+            pixel unit;
+
+            /// The Fourier transform used for fast convolution. Is null, if the number of primitive
+            /// terms is too small to make fast convolution pay off.
+            std::shared_ptr<const Fourier_Transform> fft;
+
+            /// The (normalized) Fourier spectrum of the convolution filter.
+            std::vector<std::complex<real>> spectrum;
+        };
+
+        /// Returns the instrumental line spread function for a given spectral resolution. The
+        /// line spread function is computed only if the spectral resolution differs from the
+        /// spectral resolution of the recent call. The cache holds a single line spread function
+        /// and saves the computation only when the spectral resolution is fixed. When the spectral
+        /// resolution is a free parameter, almost every call computes the line spread function anew.
+        ///
+        /// @param[in] r The spectral resolution of the instrument.
+        /// @return the instrumental line spread function.
+        ///
+        /// @remark calling this method is thread safe.
+        std::shared_ptr<const Kernel> line_spread_function(real r) const;
+
+        /// Returns the Legendre basis polynomials for a given number of polynomials. The basis
+        /// is computed only if the number of polynomials differs from the number of the recent
+        /// call.
+        ///
+        /// @param[in] m The number of Legendre basis polynomials.
+        /// @return the Legendre basis polynomials.
+        ///
+        /// @remark calling this method is thread safe.
+        std::shared_ptr<const Basis> legendre_basis(natural m) const;
+
+        /// Returns the scratch space of the calling thread.
+        ///
+        /// @return the scratch space of the calling thread.
+        static Workspace &workspace();
+
+        /// Convolutes a given (super-sampled) absorption term with the instrumental line spread
+        /// function. The convolution integral is evaluated for a piecewise linear interpolation of
+        /// the absorption term.
+        ///
+        /// Far from the boundaries, the convolution is a linear filter. Here the convolution is
+        /// computed either directly, without clamping any indexes, or by means of the overlap-save
+        /// method, if the line spread function is wide. The few data points near the boundaries
+        /// are treated separately.
+        ///
+        /// @param[in] kernel The instrumental line spread function.
+        /// @param[in] f The (super-sampled) absorption term.
+        /// @param[in] nf The number of (super-sampled) data points.
+        /// @param[out] g The convoluted absorption term (not super-sampled).
+        /// @param[in] ng The number of data points.
+        /// @param[in,out] ws The scratch space.
+        static void convolve(const Kernel &kernel, const pixel f[], size_t nf, pixel g[], size_t ng, Workspace &ws);
+
+        /// Computes the convolution for a single data point. Near the boundaries the absorption
+        /// term is extrapolated by a constant.
+        ///
+        /// @param[in] kernel The instrumental line spread function.
+        /// @param[in] f The (super-sampled) absorption term.
+        /// @param[in] nf The number of (super-sampled) data points.
+        /// @param[in] i The (super-sampled) index of the data point.
+        /// @return the convoluted absorption term at the data point.
+        static pixel convolve(const Kernel &kernel, const pixel f[], size_t nf, size_t i);
+
+        /// Convolutes a given (super-sampled) absorption term with the instrumental line spread
+        /// function for a range of data points. The convolution is computed directly, like for
+        /// all data points.
+        ///
+        /// @param[in] kernel The instrumental line spread function.
+        /// @param[in] f The (super-sampled) absorption term.
+        /// @param[in] nf The number of (super-sampled) data points.
+        /// @param[out] g The convoluted absorption term (not super-sampled).
+        /// @param[in] ng The number of data points.
+        /// @param[in] first The index of the first data point.
+        /// @param[in] last The index of the end data point (exclusive).
+        static void convolve(const Kernel &kernel, const pixel f[], size_t nf, pixel g[], size_t ng, size_t first,
+                             size_t last);
+
+        /// Computes the convolution for a range of data points far from the boundaries directly.
+        ///
+        /// @param[in] kernel The instrumental line spread function.
+        /// @param[in] f The (super-sampled) absorption term.
+        /// @param[out] g The convoluted absorption term (not super-sampled).
+        /// @param[in] begin The index of the first data point.
+        /// @param[in] end The index of the end data point (exclusive).
+        static void convolve_direct(const Kernel &kernel, const pixel f[], pixel g[], size_t begin, size_t end);
+
+        /// Computes the convolution for a range of data points far from the boundaries by means of
+        /// the overlap-save method. The Fourier transform is computed in double precision.
+        ///
+        /// @param[in] kernel The instrumental line spread function.
+        /// @param[in] f The (super-sampled) absorption term.
+        /// @param[in] nf The number of (super-sampled) data points.
+        /// @param[out] g The convoluted absorption term (not super-sampled).
+        /// @param[in] begin The index of the first data point.
+        /// @param[in] end The index of the end data point (exclusive).
+        /// @param[in,out] ws The scratch space.
+        static void convolve_fft(const Kernel &kernel, const pixel f[], size_t nf, pixel g[], size_t begin, size_t end,
+                                 Workspace &ws);
+
         /// Calculates an optimized background continuum.
         ///
         /// @param[in] m The number of Legendre basis polynomials to model the background continuum.
         /// @param[in] cat The evaluated convoluted absorption term.
         /// @param[out] cfl The evaluated background continuum flux.
-        void continuum(natural m, const std::valarray<real> &cat, std::valarray<real> &cfl) const;
+        /// @param[in,out] ws The scratch space.
+        void continuum(natural m, const pixel cat[], real cfl[], Workspace &ws) const;
+
+        /// Returns the cost of a stratified subset of the valid data points, with the background
+        /// continuum optimized for the subset.
+        ///
+        /// @param[in] basis The Legendre basis polynomials.
+        /// @param[in] stride The number of valid data points per stratum.
+        /// @param[in] cat The evaluated convoluted absorption term of the data points selected.
+        /// @param[in,out] ws The scratch space.
+        /// @return the cost of the subset, or zero, if the normal equations are singular.
+        static real subset_cost(const Basis &basis, natural stride, const pixel cat[], Workspace &ws);
 
         /// Convolutes a given optical depth function with the instrumental line spread function.
         ///
-        /// @tparam Function The type of optical depth function.
+        /// @tparam Function The type of optical depth function. Must provide a method
+        /// @c evaluate(x, y, n) to evaluate the optical depth (of type @c pixel) at ascending
+        /// wavelengths (of type @c real). If the function provides the supports of its profiles
+        /// (see @c Is_Supported), super-sampling is confined to the data intervals near lines.
         ///
         /// @param[in] r The spectral resolution of the instrument.
         /// @param[in] tau The optical depth function.
         /// @param[out] opt The evaluated optical depth.
         /// @param[out] atm The evaluated absorption term.
         /// @param[out] cat The evaluated convoluted absorption term.
+        /// @param[in,out] ws The scratch space.
         template<class Function>
-        void convolute(const real r, const Function &tau,
-                       std::valarray<real> &opt, std::valarray<real> &atm, std::valarray<real> &cat) const {
-            using std::ceil;
+        void convolute(const real r, const Function &tau, pixel opt[], pixel atm[], pixel cat[], Workspace &ws) const {
+            using std::begin;
             using std::exp;
-            using std::transform;
-            using std::valarray;
+            using std::fill;
 
             if (n > 2) {
-                // The half width at half maximum (HWHM) of the instrumental profile.
-                const real h = 0.5 * center() / (r * kilo);
-                // The data spacing.
-                const real d = width() / (n - 1);
-                // The super-sampling factor. Is greater than one, if the data spacing is greater than the HWHM.
-                const auto s = static_cast<natural>(ceil(d / h));
-                // The super-sampled spacing.
-                const real w = d / s;
-                // The Gaussian line spread function is truncated at 4 HWHM.
-                const auto m = static_cast<natural>(4.0 * (h / w)) + 1;
-
-                // Computation of the instrumental line spread function's primitive terms.
-                valarray<real> p(m);
-                valarray<real> q(m);
-                for (natural i = 0; i < m; ++i) {
-                    primitive(i * w, h, p[i], q[i]);
+                // The instrumental line spread function, which is cached for the resolution given.
+                const std::shared_ptr<const Kernel> kernel = line_spread_function(r);
+                // The super-sampling factor.
+                const natural s = kernel->s;
+
+                if (s > 1 and not kernel->fft and
+                    convolute_locally(*kernel, tau, opt, atm, cat, ws,
+                                      std::integral_constant<bool, Is_Supported<Function>::value>())) {
+                    return;
                 }
-
                 if (s == 1) {
                     // Computation of optical depth and absorption term.
-                    transform(begin(wav), end(wav), begin(opt), tau);
-                    atm = exp(-opt);
-
-                    // Convolution of the absorption term with the instrumental line spread function.
+                    tau.evaluate(begin(wav), opt, n);
                     for (size_t i = 0; i < n; ++i) {
-                        real a = 0.0;
-                        real b = 0.0;
-
-                        for (natural j = 0; j + 1 < m; ++j) {
-                            const size_t k = (i < j + 1) ? 0 : i - j - 1;
-                            const size_t l = (i + j + 2 > n) ? n - 2 : i + j;
-                            const real c = (atm[l + 1] - atm[l]) - (atm[k + 1] - atm[k]);
-
-                            a += (p[j + 1] - p[j]) * (atm[k + 1] + atm[l] - real(j) * c);
-                            b += (q[j + 1] - q[j]) * c;
-                        }
-
-                        cat[i] = a + b / w;
+                        atm[i] = exp(-opt[i]);
                     }
+
+                    // Convolution of the absorption term with the instrumental line spread function.
+                    convolve(*kernel, atm, n, cat, n, ws);
                 } else {
                     // The number of super-samples.
                     const size_t ns = s * (n - 1) + 1;
 
-                    valarray<real> wavs(ns);
-                    valarray<real> opts(ns);
-                    valarray<real> atms(ns);
-                    supersample(wav, s, wavs);
+                    ws.wavs.resize(ns);
+                    ws.opts.resize(ns);
+                    ws.atms.resize(ns);
+                    real *wavs = ws.wavs.data();
+                    pixel *opts = ws.opts.data();
+                    pixel *atms = ws.atms.data();
+                    supersample(begin(wav), n, s, wavs);
 
                     // Super-sampled computation of optical depth and absorption term.
-                    transform(begin(wavs), end(wavs), begin(opts), tau);
-                    atms = exp(-opts);
+                    tau.evaluate(wavs, opts, ns);
+                    for (size_t i = 0; i < ns; ++i) {
+                        atms[i] = exp(-opts[i]);
+                    }
 
                     // Super-sampled convolution of the absorption term with the instrumental line spread function.
+                    convolve(*kernel, atms, ns, cat, n, ws);
                     for (size_t is = 0, it = 0; it < n; is += s, ++it) {
-                        real a = 0.0;
-                        real b = 0.0;
-
-                        for (natural j = 0; j + 1 < m; ++j) {
-                            const size_t k = (is < j + 1) ? 0 : is - j - 1;
-                            const size_t l = (is + j + 2 > ns) ? ns - 2 : is + j;
-                            const real c = (atms[l + 1] - atms[l]) - (atms[k + 1] - atms[k]);
-
-                            a += (p[j + 1] - p[j]) * (atms[k + 1] + atms[l] - real(j) * c);
-                            b += (q[j + 1] - q[j]) * c;
-                        }
-
                         opt[it] = opts[is];
                         atm[it] = atms[is];
-                        cat[it] = a + b / w;
                     }
                 }
+            } else {
+                fill(opt, opt + n, 0.0);
+                fill(atm, atm + n, 0.0);
+                fill(cat, cat + n, 0.0);
+            }
+        }
+
+        /// Convolutes a given optical depth function with the instrumental line spread function,
+        /// when the data are super-sampled. Only the data intervals near the supports of the
+        /// profiles are super-sampled. Far from any line the absorption term is unity and the
+        /// convoluted absorption term is the convolution of a unit absorption term. The result
+        /// is the same as for super-sampling the whole section.
+        ///
+        /// @tparam Function The type of optical depth function.
+        ///
+        /// @param[in] kernel The instrumental line spread function.
+        /// @param[in] tau The optical depth function.
+        /// @param[out] opt The evaluated optical depth.
+        /// @param[out] atm The evaluated absorption term.
+        /// @param[out] cat The evaluated convoluted absorption term.
+        /// @param[in,out] ws The scratch space.
+        /// @return @c true.
+        template<class Function>
+        bool convolute_locally(const Kernel &kernel, const Function &tau, pixel opt[], pixel atm[], pixel cat[],
+                               Workspace &ws, std::true_type) const {
+            using std::exp;
+            using std::fill;
+            using std::lower_bound;
+            using std::max;
+            using std::min;
+            using std::upper_bound;
+
+            const natural s = kernel.s;
+            const size_t ns = s * (n - 1) + 1;
+            // The half-width of the support of the line spread function (in data points)
+            const size_t e = (kernel.m - 1 + s - 1) / s;
+            const real *x = std::begin(wav);
+
+            // The data intervals enclosing the support of each profile, with a margin of one data
+            // interval on either side
+            ws.runs.clear();
+            tau.for_each_support([&](const real lo, const real up) {
+                if (up >= x[0] and lo <= x[n - 1]) {
+                    const auto a = static_cast<size_t>(upper_bound(x, x + n, lo) - x);
+                    const auto b = static_cast<size_t>(lower_bound(x, x + n, up) - x);
+
+                    ws.runs.emplace_back(a > 2 * e + 2 ? a - 2 * e - 2 : 0, min(n - 1, b + 2 * e + 1));
+                }
+            });
+            std::sort(ws.runs.begin(), ws.runs.end());
+
+            fill(opt, opt + n, 0.0);
+            fill(atm, atm + n, 1.0);
+            fill(cat, cat + n, kernel.unit);
+
+            ws.wavs.resize(ns);
+            ws.opts.resize(ns);
+            ws.atms.resize(ns);
+            real *wavs = ws.wavs.data();
+            pixel *opts = ws.opts.data();
+            pixel *atms = ws.atms.data();
+
+            for (size_t k = 0; k < ws.runs.size();) {
+                // The run of data points, whose absorption term is super-sampled
+                const size_t a = ws.runs[k].first;
+                size_t b = ws.runs[k].second;
+                for (++k; k < ws.runs.size() and ws.runs[k].first <= b; ++k) {
+                    b = max(b, ws.runs[k].second);
+                }
+
+                // The super-sampled wavelengths are interpolated like for the whole section
+                for (size_t t = s * a; t <= s * b; ++t) {
+                    const size_t j = t / s;
+                    const natural u = static_cast<natural>(t % s);
+
+                    wavs[t] = (u == 0) ? x[j] : x[j] + (real(u) / real(s)) * (x[j + 1] - x[j]);
+                }
+                tau.evaluate(&wavs[s * a], &opts[s * a], s * (b - a) + 1);
+                for (size_t t = s * a; t <= s * b; ++t) {
+                    atms[t] = exp(-opts[t]);
+                }
+
+                // The data points, whose line spread function is within the run
+                const size_t first = (a == 0) ? 0 : a + e;
+                const size_t last = (b == n - 1) ? n : b + 1 - e;
+
+                convolve(kernel, atms, ns, cat, n, first, last);
+                for (size_t i = first; i < last; ++i) {
+                    opt[i] = opts[s * i];
+                    atm[i] = atms[s * i];
+                }
             }
+
+            return true;
+        }
+
+        /// Does not convolute an optical depth function, which does not provide the supports of
+        /// its profiles.
+        ///
+        /// @return @c false.
+        template<class Function>
+        bool convolute_locally(const Kernel &, const Function &, pixel[], pixel[], pixel[], Workspace &,
+                               std::false_type) const {
+            return false;
         }
 
         /// Evaluates the primitive functions of g(x) and x g(x), where g(x) is the (Gaussian)
@@ -286,9 +740,10 @@ namespace especia {
         /// Super-samples a given data vector.
         ///
         /// @param[in] source The source data vector.
+        /// @param[in] n The number of source data.
         /// @param[in] k The super-sampling factor.
         /// @param[out] target The target data vector (super-sampled).
-        static void supersample(const std::valarray<real> &source, natural k, std::valarray<real> &target);
+        static void supersample(const real source[], size_t n, natural k, real target[]);
 
         /// The observed wavelength data (arbitrary units).
         std::valarray<real> wav;
@@ -325,6 +780,15 @@ namespace especia {
 
         /// The number of data points.
         size_t n;
+
+        /// The cached instrumental line spread function for the spectral resolution of the recent call.
+        mutable std::shared_ptr<const Kernel> lsf;
+
+        /// The cached Legendre basis polynomials.
+        mutable std::shared_ptr<const Basis> basis;
+
+        /// Whether fast convolution is used for a wide line spread function.
+        bool fast;
     };
 
 
@@ -361,6 +825,13 @@ namespace especia {
     /// @param section[in] The data sections.
     /// @return the output stream.
     std::ostream &operator<<(std::ostream &os, const std::vector<Section> &sections);
+
+    /// Writes data sections to an output stream in binary format (see @c write_data_header()).
+    ///
+    /// @param os[in,out] The output stream.
+    /// @param sections[in] The data sections.
+    /// @return the output stream.
+    std::ostream &write(std::ostream &os, const std::vector<Section> &sections);
 }
 
 #endif // ESPECIA_SECTION_H
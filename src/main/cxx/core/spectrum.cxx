@@ -0,0 +1,264 @@
+/// @file spectrum.cxx
+/// Class for spectroscopic data in columnar layout.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "spectrum.h"
+#include "scanner.h"
+
+using especia::real;
+using especia::word64;
+
+/// The signature of the binary format, including the format version.
+static const char signature[8] = {'E', 'S', 'P', 'S', 'P', 'E', 'C', '\x01'};
+
+/// The byte order mark of the binary format.
+static const std::uint32_t byte_order_mark = 0x01020304;
+
+/// The size of the header of the binary format (bytes).
+static const size_t header_size = 24;
+
+/// The size of a data point in binary format (bytes).
+static const size_t record_size = 3 * sizeof(real) + 1;
+
+class especia::Spectrum::Mapping {
+public:
+    /// Maps a file into memory.
+    ///
+    /// @param[in] address The start address of the mapping.
+    /// @param[in] length The length of the mapping (bytes).
+    Mapping(void *address, size_t length) : address(address), length(length) {
+    }
+
+    /// The destructor. Unmaps the file.
+    ~Mapping() {
+        munmap(address, length);
+    }
+
+    /// The start address of the mapping.
+    void *const address;
+
+    /// The length of the mapping (bytes).
+    const size_t length;
+};
+
+especia::Spectrum::Spectrum()
+        : mapping(), owned_wav(), owned_flx(), owned_unc(), owned_msk(),
+          wav(nullptr), flx(nullptr), unc(nullptr), msk(nullptr), n(0) {
+}
+
+especia::Spectrum::~Spectrum() = default;
+
+std::istream &especia::Spectrum::get(std::istream &is) {
+    using namespace std;
+
+    const size_t room = 20000;
+
+    vector<real> x;
+    vector<real> y;
+    vector<real> z;
+    vector<unsigned char> w;
+
+    x.reserve(room);
+    y.reserve(room);
+    z.reserve(room);
+    w.reserve(room);
+
+    string line;
+
+    while (getline(is, line) and !line.empty()) {
+        // Skip comments.
+        if (line[0] == '#' or line[0] == '%' or line[0] == '!') {
+            continue;
+        }
+
+        Scanner ist(line);
+        bool tw;
+        real tx, ty, tz;
+
+        if (ist >> tx >> ty) {
+            x.push_back(tx);
+            y.push_back(ty);
+
+            if (ist >> tz) {
+                z.push_back(tz);
+            } else {
+                z.push_back(1.0);
+            }
+            if (ist >> tw) {
+                w.push_back(tw);
+            } else {
+                w.push_back(1);
+            }
+        } else {
+            is.setstate(ios_base::badbit | ios_base::failbit);
+
+            return is;
+        }
+    }
+
+    if (!x.empty()) {
+        const size_t m = x.size();
+
+        // Sort the data by wavelength, unless already sorted
+        vector<size_t> k(m);
+        iota(k.begin(), k.end(), 0);
+        if (!is_sorted(x.begin(), x.end())) {
+            stable_sort(k.begin(), k.end(), [&x](size_t i, size_t j) { return x[i] < x[j]; });
+        }
+
+        mapping.reset();
+        owned_wav.resize(m);
+        owned_flx.resize(m);
+        owned_unc.resize(m);
+        owned_msk.resize(m);
+        for (size_t i = 0; i < m; ++i) {
+            owned_wav[i] = x[k[i]];
+            owned_flx[i] = y[k[i]];
+            owned_unc[i] = z[k[i]];
+            owned_msk[i] = w[k[i]];
+        }
+        own();
+
+        is.clear(is.rdstate() & ~ios_base::failbit);
+    } else {
+        is.setstate(ios_base::failbit);
+    }
+
+    return is;
+}
+
+bool especia::Spectrum::map(const std::string &path) {
+    using std::memcmp;
+    using std::memcpy;
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 or static_cast<size_t>(status.st_size) < header_size) {
+        close(fd);
+        return false;
+    }
+
+    const auto length = static_cast<size_t>(status.st_size);
+    void *address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+
+    std::unique_ptr<const Mapping> m(new Mapping(address, length));
+
+    const auto *bytes = static_cast<const char *>(address);
+    std::uint32_t bom;
+    word64 count;
+    memcpy(&bom, &bytes[8], sizeof(bom));
+    memcpy(&count, &bytes[16], sizeof(count));
+
+    if (memcmp(bytes, signature, sizeof(signature)) != 0 or bom != byte_order_mark or
+        count > (length - header_size) / record_size or header_size + count * record_size != length) {
+        return false;
+    }
+
+    const auto *data = reinterpret_cast<const real *>(&bytes[header_size]);
+
+    // The data are sorted by wavelength, when written, and cannot be sorted when mapped
+    if (not std::is_sorted(data, data + count)) {
+        return false;
+    }
+
+    mapping = std::move(m);
+    owned_wav.clear();
+    owned_flx.clear();
+    owned_unc.clear();
+    owned_msk.clear();
+    n = static_cast<size_t>(count);
+    wav = &data[0];
+    flx = &data[n];
+    unc = &data[2 * n];
+    msk = reinterpret_cast<const unsigned char *>(&data[3 * n]);
+
+    return true;
+}
+
+std::ostream &especia::Spectrum::put(std::ostream &os) const {
+    if (put_header(os, n)) {
+        os.write(reinterpret_cast<const char *>(wav), static_cast<std::streamsize>(n * sizeof(real)));
+        os.write(reinterpret_cast<const char *>(flx), static_cast<std::streamsize>(n * sizeof(real)));
+        os.write(reinterpret_cast<const char *>(unc), static_cast<std::streamsize>(n * sizeof(real)));
+        os.write(reinterpret_cast<const char *>(msk), static_cast<std::streamsize>(n));
+        os.flush();
+    }
+
+    return os;
+}
+
+size_t especia::Spectrum::lower_index(const real a) const {
+    return static_cast<size_t>(std::lower_bound(wav, wav + n, a) - wav);
+}
+
+size_t especia::Spectrum::upper_index(const real b) const {
+    return static_cast<size_t>(std::upper_bound(wav, wav + n, b) - wav);
+}
+
+std::ostream &especia::Spectrum::put_header(std::ostream &os, const size_t n) {
+    if (os) {
+        const char reserved[4] = {0, 0, 0, 0};
+        const auto count = static_cast<word64>(n);
+
+        os.write(signature, sizeof(signature));
+        os.write(reinterpret_cast<const char *>(&byte_order_mark), sizeof(byte_order_mark));
+        os.write(reserved, sizeof(reserved));
+        os.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    }
+
+    return os;
+}
+
+bool especia::Spectrum::is_binary(const std::string &path) {
+    std::ifstream ifs(path.c_str(), std::ios_base::binary);
+    char bytes[sizeof(signature)];
+
+    return ifs.read(bytes, sizeof(bytes)) and std::memcmp(bytes, signature, sizeof(signature)) == 0;
+}
+
+void especia::Spectrum::own() {
+    n = owned_wav.size();
+    wav = owned_wav.data();
+    flx = owned_flx.data();
+    unc = owned_unc.data();
+    msk = owned_msk.data();
+}
+
+especia::Spectrum_Cache::Spectrum_Cache() = default;
+
+especia::Spectrum_Cache::~Spectrum_Cache() = default;
+
+std::shared_ptr<const especia::Spectrum> especia::Spectrum_Cache::find(const std::string &path) const {
+    const std::lock_guard<std::mutex> lock(guard);
+    const auto i = spectra.find(path);
+
+    return i != spectra.end() ? i->second : nullptr;
+}
+
+std::shared_ptr<const especia::Spectrum>
+especia::Spectrum_Cache::insert(const std::string &path, const std::shared_ptr<const Spectrum> &spectrum) {
+    const std::lock_guard<std::mutex> lock(guard);
+
+    return spectra.emplace(path, spectrum).first->second;
+}
@@ -0,0 +1,216 @@
+/// @file spectrum.h
+/// Class for spectroscopic data in columnar layout.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_SPECTRUM_H
+#define ESPECIA_SPECTRUM_H
+
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base.h"
+
+namespace especia {
+
+    /// Spectroscopic data (wavelength, flux, uncertainty and selection mask) in columnar
+    /// layout, sorted by wavelength.
+    ///
+    /// The data are either read from a text stream, or mapped into memory from a file in
+    /// binary format. The binary format consists of
+    ///
+    /// an 8-byte signature @c ESPSPEC followed by the format version,
+    ///
+    /// a 4-byte byte order mark and 4 bytes reserved,
+    ///
+    /// the 8-byte number of data points @c n,
+    ///
+    /// @c n wavelengths, @c n fluxes, and @c n uncertainties (as 8-byte floating point numbers),
+    ///
+    /// @c n selection mask bytes.
+    ///
+    /// All numbers use the byte order of the machine, which has written the file.
+    ///
+    /// @remark This class is thread safe.
+    class Spectrum {
+    public:
+        /// Constructs a new instance of this class, which contains no data.
+        Spectrum();
+
+        /// The destructor.
+        ~Spectrum();
+
+        Spectrum(const Spectrum &) = delete;
+
+        Spectrum &operator=(const Spectrum &) = delete;
+
+        /// Reads spectroscopic data from an input stream (text format). Each line consists
+        /// of wavelength, flux, and optionally uncertainty and selection mask. Comment lines
+        /// are skipped, an empty line terminates the data.
+        ///
+        /// @param[in,out] is The input stream.
+        /// @return the input stream.
+        std::istream &get(std::istream &is);
+
+        /// Maps a file in binary format into memory. The wavelengths are verified to be in
+        /// ascending order, which reads the wavelength column of the file once, when mapped.
+        ///
+        /// @param[in] path The path name of the file.
+        /// @return @c true on success, @c false otherwise (including wavelengths not in
+        /// ascending order).
+        bool map(const std::string &path);
+
+        /// Writes the spectroscopic data to an output stream (binary format).
+        ///
+        /// @param[in,out] os The output stream.
+        /// @return the output stream.
+        std::ostream &put(std::ostream &os) const;
+
+        /// Returns the number of data points.
+        ///
+        /// @return the number of data points.
+        size_t size() const {
+            return n;
+        }
+
+        /// Returns the wavelength data (sorted into ascending order).
+        ///
+        /// @return the wavelength data.
+        const real *wavelengths() const {
+            return wav;
+        }
+
+        /// Returns the spectral flux data.
+        ///
+        /// @return the spectral flux data.
+        const real *fluxes() const {
+            return flx;
+        }
+
+        /// Returns the spectral flux uncertainty data.
+        ///
+        /// @return the spectral flux uncertainty data.
+        const real *uncertainties() const {
+            return unc;
+        }
+
+        /// Returns the selection mask data.
+        ///
+        /// @return the selection mask data (zero means masked).
+        const unsigned char *masks() const {
+            return msk;
+        }
+
+        /// Returns the index of the first data point, whose wavelength is not less than a given
+        /// wavelength.
+        ///
+        /// @param[in] a The wavelength.
+        /// @return the index of the first data point with wavelength not less than @c a.
+        size_t lower_index(real a) const;
+
+        /// Returns the index of the first data point, whose wavelength is greater than a given
+        /// wavelength.
+        ///
+        /// @param[in] b The wavelength.
+        /// @return the index of the first data point with wavelength greater than @c b.
+        size_t upper_index(real b) const;
+
+        /// Writes the header of the binary format to an output stream. The header is followed
+        /// by the wavelength, flux, uncertainty and selection mask data.
+        ///
+        /// @param[in,out] os The output stream.
+        /// @param[in] n The number of data points.
+        /// @return the output stream.
+        static std::ostream &put_header(std::ostream &os, size_t n);
+
+        /// Tests if a file is in binary format.
+        ///
+        /// @param[in] path The path name of the file.
+        /// @return @c true, if the file exists and is in binary format.
+        static bool is_binary(const std::string &path);
+
+    private:
+        /// A file mapped into memory.
+        class Mapping;
+
+        /// Resets the data pointers to the owned data.
+        void own();
+
+        /// The mapped file, if any.
+        std::unique_ptr<const Mapping> mapping;
+
+        /// The owned wavelength data.
+        std::vector<real> owned_wav;
+
+        /// The owned spectral flux data.
+        std::vector<real> owned_flx;
+
+        /// The owned spectral flux uncertainty data.
+        std::vector<real> owned_unc;
+
+        /// The owned selection mask data.
+        std::vector<unsigned char> owned_msk;
+
+        /// The wavelength data.
+        const real *wav;
+
+        /// The spectral flux data.
+        const real *flx;
+
+        /// The spectral flux uncertainty data.
+        const real *unc;
+
+        /// The selection mask data.
+        const unsigned char *msk;
+
+        /// The number of data points.
+        size_t n;
+    };
+
+
+    /// A cache of spectroscopic data, which are read once and shared between models, keyed
+    /// by the path name of the data file.
+    ///
+    /// @remark This class is thread safe.
+    class Spectrum_Cache {
+    public:
+        /// Constructs a new empty cache.
+        Spectrum_Cache();
+
+        /// The destructor.
+        ~Spectrum_Cache();
+
+        Spectrum_Cache(const Spectrum_Cache &) = delete;
+
+        Spectrum_Cache &operator=(const Spectrum_Cache &) = delete;
+
+        /// Finds the spectroscopic data read from a data file.
+        ///
+        /// @param[in] path The path name of the data file.
+        /// @return the spectroscopic data, or @c nullptr if the cache does not contain the data.
+        std::shared_ptr<const Spectrum> find(const std::string &path) const;
+
+        /// Inserts the spectroscopic data read from a data file. When the cache already contains
+        /// data for the path name, the cached data are retained.
+        ///
+        /// @param[in] path The path name of the data file.
+        /// @param[in] spectrum The spectroscopic data.
+        /// @return the cached spectroscopic data.
+        std::shared_ptr<const Spectrum> insert(const std::string &path, const std::shared_ptr<const Spectrum> &spectrum);
+
+    private:
+        /// The cached spectroscopic data.
+        std::map<std::string, std::shared_ptr<const Spectrum>> spectra;
+
+        /// Guards the cached spectroscopic data.
+        mutable std::mutex guard;
+    };
+
+}
+
+#endif // ESPECIA_SPECTRUM_H
@@ -0,0 +1,101 @@
+/// @file telemetry.cxx
+/// Performance telemetry of optimization runs.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <iomanip>
+
+#include "telemetry.h"
+
+using especia::natural;
+using especia::real;
+
+/// Converts a number of clock ticks into seconds.
+///
+/// @param[in] ticks The number of clock ticks.
+/// @return the number of seconds.
+static real seconds(const especia::Telemetry::Clock::rep ticks) {
+    using especia::Telemetry;
+
+    return std::chrono::duration<real>(Telemetry::Clock::duration(ticks)).count();
+}
+
+especia::Telemetry::Telemetry(const natural section_count)
+        : start(Clock::now()),
+          section_count(section_count),
+          generations(0),
+          evaluations(0),
+          rejections(0),
+          section_calls(section_count),
+          section_times(section_count) {
+    for (auto &t : phase_times) {
+        t = 0;
+    }
+    for (natural i = 0; i < section_count; ++i) {
+        section_calls[i] = 0;
+        section_times[i] = 0;
+    }
+}
+
+especia::Telemetry::~Telemetry() = default;
+
+std::ostream &especia::Telemetry::put(std::ostream &os) const {
+    using std::ios_base;
+
+    const real wall_time = seconds((Clock::now() - start).count());
+    const real evaluation_time = seconds(phase_times[evaluation]);
+
+    const ios_base::fmtflags fmt = os.flags();
+    const std::streamsize precision = os.precision();
+
+    os.setf(ios_base::fmtflags());
+    os.setf(ios_base::scientific, ios_base::floatfield);
+    os.precision(6);
+
+    os << "{\n";
+    os << "  \"wall_time\": " << wall_time << ",\n";
+    os << "  \"generations\": " << generations << ",\n";
+    os << "  \"evaluations\": " << evaluations << ",\n";
+    os << "  \"evaluations_per_second\": " << (evaluation_time > 0.0 ? evaluations / evaluation_time : 0.0)
+       << ",\n";
+    os << "  \"rejections\": " << rejections << ",\n";
+    os << "  \"phases\": {\n";
+    for (int p = 0; p < phase_count; ++p) {
+        os << "    \"" << get_phase_name(static_cast<Phase>(p)) << "\": " << seconds(phase_times[p]);
+        os << (p + 1 < phase_count ? ",\n" : "\n");
+    }
+    os << "  },\n";
+    os << "  \"sections\": [";
+    for (natural i = 0; i < section_count; ++i) {
+        os << (i > 0 ? ",\n" : "\n");
+        os << "    {\"calls\": " << section_calls[i] << ", \"time\": " << seconds(section_times[i]) << "}";
+    }
+    os << (section_count > 0 ? "\n  ]\n" : "]\n");
+    os << "}\n";
+
+    os.flags(fmt);
+    os.precision(precision);
+
+    return os;
+}
+
+const char *especia::Telemetry::get_phase_name(const Phase phase) {
+    switch (phase) {
+        case sampling:
+            return "sampling";
+        case evaluation:
+            return "evaluation";
+        case adaption:
+            return "adaption";
+        case decomposition:
+            return "decomposition";
+        case tracing:
+            return "tracing";
+        case polishing:
+            return "polishing";
+        case postopti:
+            return "postopti";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,233 @@
+/// @file telemetry.h
+/// Performance telemetry of optimization runs.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_TELEMETRY_H
+#define ESPECIA_TELEMETRY_H
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "base.h"
+
+namespace especia {
+
+    /// Collects timings and counts of an optimization run by means of a monotonic clock.
+    ///
+    /// A tracer provides a collector to the optimization by means of the method
+    /// @c get_telemetry(). When a tracer does not provide this method, or returns
+    /// @c nullptr, no telemetry is collected and the clock is never read.
+    ///
+    /// @remark This class is thread safe.
+    class Telemetry {
+    public:
+        /// The monotonic clock.
+        typedef std::chrono::steady_clock Clock;
+
+        /// The phases of an optimization.
+        enum Phase {
+            /// Sampling the offspring.
+            sampling,
+            /// Evaluating the objective function for the offspring.
+            evaluation,
+            /// Recombination and adaption of step size and covariance matrix.
+            adaption,
+            /// Eigenvalue decomposition (or waiting for the asynchronous decomposition).
+            decomposition,
+            /// Evaluating the objective function for tracing.
+            tracing,
+            /// Polishing the parameter values by means of the Levenberg-Marquardt method.
+            polishing,
+            /// Computing the parameter uncertainties.
+            postopti,
+            /// The number of phases.
+            phase_count
+        };
+
+        /// Measures the time spent in consecutive phases.
+        ///
+        /// @remark This class is not thread safe.
+        class Stopwatch {
+        public:
+            /// Creates a new stopwatch.
+            ///
+            /// @param[in] telemetry The collector. When @c nullptr, the stopwatch does nothing.
+            explicit Stopwatch(Telemetry *telemetry) : telemetry(telemetry), phase(phase_count) {
+            }
+
+            /// The destructor. Records the time of the current phase.
+            ~Stopwatch() {
+                stop();
+            }
+
+            Stopwatch(const Stopwatch &) = delete;
+
+            Stopwatch &operator=(const Stopwatch &) = delete;
+
+            /// Records the time of the current phase, if any, and starts the next phase.
+            ///
+            /// @param[in] next The next phase.
+            void lap(Phase next) {
+                if (telemetry) {
+                    const Clock::time_point now = Clock::now();
+
+                    if (phase != phase_count) {
+                        telemetry->add_time(phase, now - start);
+                    }
+                    phase = next;
+                    start = now;
+                }
+            }
+
+            /// Records the time of the current phase, if any.
+            void stop() {
+                lap(phase_count);
+            }
+
+        private:
+            /// The collector.
+            Telemetry *const telemetry;
+
+            /// The current phase.
+            Phase phase;
+
+            /// The start of the current phase.
+            Clock::time_point start;
+        };
+
+        /// Creates a new collector. The wall-clock time is measured from construction.
+        ///
+        /// @param[in] section_count The number of sections, whose cost is timed.
+        explicit Telemetry(natural section_count = 0);
+
+        /// The destructor.
+        ~Telemetry();
+
+        Telemetry(const Telemetry &) = delete;
+
+        Telemetry &operator=(const Telemetry &) = delete;
+
+        /// Adds the time spent in a phase.
+        ///
+        /// @param[in] phase The phase.
+        /// @param[in] duration The time spent.
+        void add_time(Phase phase, Clock::duration duration) {
+            phase_times[phase] += duration.count();
+        }
+
+        /// Adds a number of evolved generations.
+        ///
+        /// @param[in] count The number of generations.
+        void add_generations(natural count) {
+            generations += count;
+        }
+
+        /// Adds a number of evaluations of the objective function.
+        ///
+        /// @param[in] count The number of evaluations.
+        void add_evaluations(natural count) {
+            evaluations += count;
+        }
+
+        /// Adds a number of offspring rejected because of violating the constraint.
+        ///
+        /// @param[in] count The number of rejections.
+        void add_rejections(natural count) {
+            rejections += count;
+        }
+
+        /// Adds the time spent to calculate the cost of a section.
+        ///
+        /// @param[in] i The section index.
+        /// @param[in] duration The time spent.
+        void add_section_time(natural i, Clock::duration duration) {
+            if (i < section_count) {
+                section_calls[i] += 1;
+                section_times[i] += duration.count();
+            }
+        }
+
+        /// Returns the number of sections timed.
+        ///
+        /// @return the number of sections.
+        natural get_section_count() const {
+            return section_count;
+        }
+
+        /// Writes the telemetry to an output stream (JSON format).
+        ///
+        /// @param[in,out] os The output stream.
+        /// @return the output stream.
+        std::ostream &put(std::ostream &os) const;
+
+        /// Returns the name of a phase.
+        ///
+        /// @param[in] phase The phase.
+        /// @return the name of the phase.
+        static const char *get_phase_name(Phase phase);
+
+    private:
+        /// The start of the run.
+        const Clock::time_point start;
+
+        /// The number of sections.
+        const natural section_count;
+
+        /// The time spent in each phase (clock ticks).
+        std::atomic<Clock::rep> phase_times[phase_count];
+
+        /// The number of generations.
+        std::atomic<word64> generations;
+
+        /// The number of evaluations.
+        std::atomic<word64> evaluations;
+
+        /// The number of rejections.
+        std::atomic<word64> rejections;
+
+        /// The number of cost calculations for each section.
+        std::vector<std::atomic<word64>> section_calls;
+
+        /// The time spent to calculate the cost of each section (clock ticks).
+        std::vector<std::atomic<Clock::rep>> section_times;
+    };
+
+    /// Returns the telemetry collector of a tracer, if it provides one.
+    ///
+    /// @tparam Tracing The tracer type.
+    ///
+    /// @param[in] tracer The tracer.
+    /// @return the telemetry collector.
+    template<class Tracing>
+    auto telemetry_of(const Tracing &tracer, int) -> decltype(tracer.get_telemetry()) {
+        return tracer.get_telemetry();
+    }
+
+    /// Returns no telemetry collector, for a tracer which does not provide one.
+    ///
+    /// @tparam Tracing The tracer type.
+    ///
+    /// @param[in] tracer The tracer.
+    /// @return @c nullptr.
+    template<class Tracing>
+    Telemetry *telemetry_of(const Tracing &tracer, long) {
+        return nullptr;
+    }
+
+    /// Returns the telemetry collector of a tracer, or @c nullptr if it does not provide one.
+    ///
+    /// @tparam Tracing The tracer type.
+    ///
+    /// @param[in] tracer The tracer.
+    /// @return the telemetry collector, or @c nullptr.
+    template<class Tracing>
+    Telemetry *telemetry_of(const Tracing &tracer) {
+        return telemetry_of(tracer, 0);
+    }
+
+}
+
+#endif // ESPECIA_TELEMETRY_H
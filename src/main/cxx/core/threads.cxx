@@ -0,0 +1,427 @@
+/// @file threads.cxx
+/// A persistent pool of worker threads for data-parallel loops.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "threads.h"
+
+using especia::natural;
+
+/// The maximum number of NUMA nodes probed.
+static const natural max_node_count = 256;
+
+/// Returns the default number of threads.
+///
+/// @return the default number of threads.
+static natural default_thread_count() {
+#ifdef _OPENMP
+    return static_cast<natural>(omp_get_max_threads());
+#else
+    return std::max<natural>(1, std::thread::hardware_concurrency());
+#endif
+}
+
+/// Reads the processors available to the process and the NUMA node of each processor.
+///
+/// @param[out] cpus The processors available, one of each node in turn.
+/// @param[out] node_of_cpu The node of each processor.
+static void read_topology(std::vector<natural> &cpus, std::vector<natural> &node_of_cpu) {
+    cpus.clear();
+    node_of_cpu.clear();
+#ifdef __linux__
+    cpu_set_t available;
+    CPU_ZERO(&available);
+    if (sched_getaffinity(0, sizeof(available), &available) != 0) {
+        return;
+    }
+    node_of_cpu.assign(CPU_SETSIZE, max_node_count);
+
+    std::vector<std::vector<natural>> cpus_of_node;
+    for (natural node = 0; node < max_node_count; ++node) {
+        std::ifstream is("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+
+        if (not std::getline(is, list)) {
+            continue;
+        }
+        // A list of processors looks like '0-3,8-11'
+        std::istringstream ist(list);
+        std::vector<natural> node_cpus;
+        for (std::string range; std::getline(ist, range, ',');) {
+            natural first = 0;
+            natural last = 0;
+            char dash = '-';
+
+            std::istringstream(range) >> first >> dash >> last;
+            for (natural cpu = first; cpu <= std::max(first, last) and cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &available)) {
+                    node_of_cpu[cpu] = node;
+                    node_cpus.push_back(cpu);
+                }
+            }
+        }
+        if (not node_cpus.empty()) {
+            cpus_of_node.push_back(node_cpus);
+        }
+    }
+    if (cpus_of_node.empty()) {
+        // No NUMA information, a single node
+        std::vector<natural> node_cpus;
+        for (natural cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &available)) {
+                node_of_cpu[cpu] = 0;
+                node_cpus.push_back(cpu);
+            }
+        }
+        cpus_of_node.push_back(node_cpus);
+    }
+    for (size_t k = 0; cpus.size() < static_cast<size_t>(CPU_COUNT(&available)); ++k) {
+        for (const auto &node_cpus : cpus_of_node) {
+            if (k < node_cpus.size()) {
+                cpus.push_back(node_cpus[k]);
+            }
+        }
+    }
+#endif
+}
+
+/// Pins the calling thread to a processor.
+///
+/// @param[in] cpu The processor.
+static void pin_current_thread(natural cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+#endif
+}
+
+#ifdef _OPENMP
+/// Pins the calling thread of a parallel region for the lifetime of the pinning, and
+/// restores the previous affinity of the thread afterwards.
+class Pinning {
+public:
+    /// Constructs a new pinning of the calling thread.
+    ///
+    /// @param[in] cpus The processors to pin the threads of the parallel region to. The
+    /// master thread is never pinned.
+    explicit Pinning(const std::vector<natural> &cpus) : pinned(false) {
+        const auto t = static_cast<natural>(omp_get_thread_num());
+
+        if (t > 0 and not cpus.empty()) {
+#ifdef __linux__
+            CPU_ZERO(&previous);
+            pinned = sched_getaffinity(0, sizeof(previous), &previous) == 0;
+#endif
+            if (pinned) {
+                pin_current_thread(cpus[t % cpus.size()]);
+            }
+        }
+    }
+
+    /// Destructor. Restores the previous affinity of the calling thread.
+    ~Pinning() {
+#ifdef __linux__
+        if (pinned) {
+            sched_setaffinity(0, sizeof(previous), &previous);
+        }
+#endif
+    }
+
+private:
+    Pinning(const Pinning &) = delete;
+
+    Pinning &operator=(const Pinning &) = delete;
+
+#ifdef __linux__
+    /// The previous affinity of the calling thread.
+    cpu_set_t previous;
+#endif
+
+    /// Whether the calling thread is pinned.
+    bool pinned;
+};
+#endif
+
+especia::Thread_Pool::Thread_Pool(natural thread_count, bool pinned)
+        : thread_count(thread_count > 0 ? thread_count : default_thread_count()), cpus(),
+          node_of_cpu(), node_count(1), workers(), next(0), positions(), next_of_node() {
+    if (pinned) {
+        read_topology(cpus, node_of_cpu);
+    }
+    if (not cpus.empty()) {
+        // The nodes are indexed in order of appearance among the pinned worker threads
+        std::vector<natural> nodes;
+        for (natural t = 1; t < std::min<natural>(this->thread_count, static_cast<natural>(cpus.size()) + 1); ++t) {
+            const natural node = node_of_cpu[cpus[t % cpus.size()]];
+
+            if (std::find(nodes.begin(), nodes.end(), node) == nodes.end()) {
+                nodes.push_back(node);
+            }
+        }
+        for (auto &node : node_of_cpu) {
+            node = static_cast<natural>(std::find(nodes.begin(), nodes.end(), node) - nodes.begin());
+        }
+        node_count = std::max<natural>(1, static_cast<natural>(nodes.size()));
+    }
+    positions.resize(node_count);
+    next_of_node.reset(new std::atomic<natural>[node_count]);
+#ifndef _OPENMP
+    workers.reserve(this->thread_count - 1);
+    for (natural i = 1; i < this->thread_count; ++i) {
+        workers.emplace_back(&Thread_Pool::serve, this, i);
+    }
+#endif
+}
+
+especia::Thread_Pool::~Thread_Pool() {
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        shutdown = true;
+    }
+    started.notify_all();
+
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+natural especia::Thread_Pool::automatic_chunk_size(natural n) const {
+    return std::max<natural>(1, n / (4 * thread_count));
+}
+
+void especia::Thread_Pool::run(natural n, natural chunk_size, Body body, const void *f) const {
+    using std::mutex;
+    using std::unique_lock;
+
+    if (n == 0) {
+        return;
+    }
+    // A nested loop or a loop submitted concurrently is run serially
+    unique_lock<mutex> lock(submission, std::try_to_lock);
+#ifdef _OPENMP
+    if (!lock or thread_count == 1 or n == 1 or omp_in_parallel()) {
+        run_serial(n, body, f);
+        return;
+    }
+
+    error = nullptr;
+#pragma omp parallel num_threads(thread_count)
+    {
+        const Pinning pinning(cpus);
+
+#pragma omp for schedule(dynamic, chunk_size)
+        for (natural i = 0; i < n; ++i) {
+            try {
+                body(f, i);
+            } catch (...) {
+                fail();
+            }
+        }
+    }
+#else // C++-11
+    if (!lock or workers.empty() or n == 1) {
+        run_serial(n, body, f);
+        return;
+    }
+    {
+        std::lock_guard<mutex> state_lock(guard);
+
+        this->body = body;
+        this->function = f;
+        this->local = false;
+        this->count = n;
+        this->chunk = chunk_size;
+        this->next = 0;
+        this->error = nullptr;
+        this->busy = static_cast<natural>(workers.size());
+        ++sequence;
+    }
+    started.notify_all();
+
+    work();
+
+    unique_lock<mutex> state_lock(guard);
+    finished.wait(state_lock, [this]() { return busy == 0; });
+#endif
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void especia::Thread_Pool::run_local(natural p, const natural keys[], natural m, bool steal, Body body,
+                                     const void *f) const {
+    using std::mutex;
+    using std::unique_lock;
+
+    if (p == 0 or m == 0) {
+        return;
+    }
+    unique_lock<mutex> lock(submission, std::try_to_lock);
+#ifdef _OPENMP
+    if (!lock or thread_count == 1 or omp_in_parallel()) {
+        run_serial(p * m, body, f);
+        return;
+    }
+#else // C++-11
+    if (!lock or workers.empty()) {
+        run_serial(p * m, body, f);
+        return;
+    }
+#endif
+    {
+        std::lock_guard<mutex> state_lock(guard);
+
+        for (natural g = 0; g < node_count; ++g) {
+            positions[g].clear();
+            next_of_node[g] = 0;
+        }
+        for (natural j = 0; j < p; ++j) {
+            positions[keys[j] % node_count].push_back(j);
+        }
+        this->body = body;
+        this->function = f;
+        this->local = true;
+        this->stealing = steal;
+        this->count = m;
+        this->error = nullptr;
+#ifndef _OPENMP
+        this->busy = static_cast<natural>(workers.size());
+        ++sequence;
+#endif
+    }
+#ifdef _OPENMP
+#pragma omp parallel num_threads(thread_count)
+    {
+        const Pinning pinning(cpus);
+
+        work_local(steal);
+    }
+#else // C++-11
+    started.notify_all();
+
+    work_local(steal);
+    {
+        unique_lock<mutex> state_lock(guard);
+        finished.wait(state_lock, [this]() { return busy == 0; });
+    }
+#endif
+    // The tasks of any node without threads are left
+    for (natural g = 0; g < node_count; ++g) {
+        work_node(g);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void especia::Thread_Pool::run_serial(natural n, Body body, const void *f) {
+    for (natural i = 0; i < n; ++i) {
+        body(f, i);
+    }
+}
+
+void especia::Thread_Pool::work() const {
+    for (natural begin = next.fetch_add(chunk); begin < count; begin = next.fetch_add(chunk)) {
+        const natural end = std::min(begin + chunk, count);
+
+        for (natural i = begin; i < end; ++i) {
+            try {
+                body(function, i);
+            } catch (...) {
+                fail();
+            }
+        }
+    }
+}
+
+void especia::Thread_Pool::work_local(bool steal) const {
+    const natural home = current_node();
+
+    if (home < node_count) {
+        work_node(home);
+    }
+    if (steal) {
+        for (natural r = 1; r <= node_count; ++r) {
+            work_node((home + r) % node_count);
+        }
+    }
+}
+
+void especia::Thread_Pool::work_node(natural g) const {
+    const std::vector<natural> &p = positions[g];
+    const natural task_count = static_cast<natural>(p.size()) * count;
+
+    for (natural u = next_of_node[g].fetch_add(1); u < task_count; u = next_of_node[g].fetch_add(1)) {
+        try {
+            body(function, p[u / count] * count + u % count);
+        } catch (...) {
+            fail();
+        }
+    }
+}
+
+natural especia::Thread_Pool::current_node() const {
+#ifdef __linux__
+    const int cpu = sched_getcpu();
+
+    if (cpu >= 0 and static_cast<size_t>(cpu) < node_of_cpu.size()) {
+        return std::min(node_of_cpu[static_cast<size_t>(cpu)], node_count);
+    }
+#endif
+    return node_count;
+}
+
+void especia::Thread_Pool::serve(natural t) const {
+    using std::mutex;
+    using std::unique_lock;
+
+    natural seen = 0;
+
+    if (not cpus.empty()) {
+        pin_current_thread(cpus[t % cpus.size()]);
+    }
+    for (;;) {
+        {
+            unique_lock<mutex> lock(guard);
+            started.wait(lock, [this, seen]() { return shutdown or sequence != seen; });
+            if (shutdown) {
+                return;
+            }
+            seen = sequence;
+        }
+
+        if (local) {
+            work_local(stealing);
+        } else {
+            work();
+        }
+        {
+            std::lock_guard<mutex> lock(guard);
+            if (--busy == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+}
+
+void especia::Thread_Pool::fail() const {
+    std::lock_guard<std::mutex> lock(guard);
+
+    if (!error) {
+        error = std::current_exception();
+    }
+}
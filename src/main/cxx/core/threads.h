@@ -0,0 +1,254 @@
+/// @file threads.h
+/// A persistent pool of worker threads for data-parallel loops.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_THREADS_H
+#define ESPECIA_THREADS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base.h"
+
+namespace especia {
+
+    /// A pool of worker threads, which are created once and reused for any number of
+    /// parallel loops.
+    ///
+    /// When compiled with OpenMP, loops are delegated to the OpenMP runtime and no
+    /// threads are created by the pool itself.
+    ///
+    /// The worker threads may be pinned to the processors available to the process, which
+    /// are assigned to the workers in turn, one of each NUMA node, so the workers spread
+    /// evenly across all nodes. Loops over the tasks of partitions, like the sections of a
+    /// model, then execute the tasks of a partition by workers on the same node, which keeps
+    /// the memory traffic of the partition local to the node. When compiled with OpenMP,
+    /// the threads of the runtime are pinned only within the loops of the pool, and their
+    /// previous affinity is restored afterwards.
+    ///
+    /// @remark This class is thread safe. A loop submitted while the pool is busy (e.g.
+    /// a nested loop) is executed by the calling thread.
+    class Thread_Pool {
+    public:
+        /// Constructs a new pool of worker threads.
+        ///
+        /// @param[in] thread_count The number of threads, including the calling thread. If zero,
+        /// the number of threads equals the number of hardware threads.
+        /// @param[in] pinned Whether to pin the worker threads to processors. The calling thread
+        /// is never pinned. Has no effect on systems other than Linux.
+        explicit Thread_Pool(natural thread_count = 0, bool pinned = false);
+
+        /// The destructor.
+        ~Thread_Pool();
+
+        /// Returns the number of threads, including the calling thread.
+        ///
+        /// @return the number of threads.
+        natural get_thread_count() const {
+            return thread_count;
+        }
+
+        /// Returns the number of NUMA nodes, which the worker threads are pinned to.
+        ///
+        /// @return the number of nodes. Is one, unless the worker threads are pinned.
+        natural get_node_count() const {
+            return node_count;
+        }
+
+        /// Applies a function to all indexes of a range in parallel. The range is divided
+        /// into chunks, which are dynamically assigned to the threads of this pool.
+        ///
+        /// @tparam F The function type.
+        ///
+        /// @param[in] n The number of indexes.
+        /// @param[in] f The function. Is called once for each index in [0, n).
+        /// @param[in] chunk_size The chunk size. If zero, a chunk size is chosen automatically.
+        ///
+        /// @throw any exception thrown by the function. Only the first exception is thrown.
+        template<class F>
+        void for_each(natural n, const F &f, natural chunk_size = 0) const {
+            if (chunk_size == 0) {
+                chunk_size = automatic_chunk_size(n);
+            }
+            run(n, chunk_size, &Thread_Pool::invoke<F>, &f);
+        }
+
+        /// Applies a function to the tasks of a number of partitions in parallel. Each partition
+        /// is assigned to a NUMA node, and its tasks are executed by the threads running on this
+        /// node first. The task @c k of the partition at position @c j is identified by the index
+        /// @c j * m + k.
+        ///
+        /// Unless the worker threads are pinned to more than one node, this is the same as
+        /// calling @c for_each(p * m, f, 1).
+        ///
+        /// @tparam F The function type.
+        ///
+        /// @param[in] p The number of partitions.
+        /// @param[in] keys The key of each partition. The partition with key @c i is assigned to
+        /// the node @c i % get_node_count(), for any loop.
+        /// @param[in] m The number of tasks of each partition.
+        /// @param[in] f The function. Is called once for each index in [0, p * m).
+        /// @param[in] steal Whether a thread, which has finished the tasks of its own node, executes
+        /// the tasks of other nodes. Without stealing, the tasks of a partition are executed by the
+        /// threads running on its node, for placing data by first touch. Any tasks left by a node
+        /// without threads are executed by the calling thread.
+        ///
+        /// @throw any exception thrown by the function. Only the first exception is thrown.
+        template<class F>
+        void for_each_local(natural p, const natural keys[], natural m, const F &f, bool steal = true) const {
+            if (node_count == 1) {
+                run(p * m, 1, &Thread_Pool::invoke<F>, &f);
+            } else {
+                run_local(p, keys, m, steal, &Thread_Pool::invoke<F>, &f);
+            }
+        }
+
+    private:
+        /// The type of a type-erased loop body.
+        typedef void (*Body)(const void *f, natural i);
+
+        /// Invokes a loop body.
+        ///
+        /// @tparam F The function type.
+        ///
+        /// @param[in] f The function.
+        /// @param[in] i The index.
+        template<class F>
+        static void invoke(const void *f, natural i) {
+            (*static_cast<const F *>(f))(i);
+        }
+
+        /// Returns a chunk size to balance the load between threads.
+        ///
+        /// @param[in] n The number of indexes.
+        /// @return the chunk size.
+        natural automatic_chunk_size(natural n) const;
+
+        /// Runs a loop.
+        ///
+        /// @param[in] n The number of indexes.
+        /// @param[in] chunk_size The chunk size.
+        /// @param[in] body The loop body.
+        /// @param[in] f The function called by the loop body.
+        void run(natural n, natural chunk_size, Body body, const void *f) const;
+
+        /// Runs a loop over the tasks of partitions, which are assigned to nodes.
+        ///
+        /// @param[in] p The number of partitions.
+        /// @param[in] keys The key of each partition.
+        /// @param[in] m The number of tasks of each partition.
+        /// @param[in] steal Whether threads execute the tasks of other nodes.
+        /// @param[in] body The loop body.
+        /// @param[in] f The function called by the loop body.
+        void run_local(natural p, const natural keys[], natural m, bool steal, Body body, const void *f) const;
+
+        /// Runs a loop by the calling thread only.
+        ///
+        /// @param[in] n The number of indexes.
+        /// @param[in] body The loop body.
+        /// @param[in] f The function called by the loop body.
+        static void run_serial(natural n, Body body, const void *f);
+
+        /// Executes chunks of the current loop, until no chunk is left.
+        void work() const;
+
+        /// Executes the tasks of the current loop over partitions, starting with the node the
+        /// calling thread is running on.
+        ///
+        /// @param[in] steal Whether to execute the tasks of other nodes.
+        void work_local(bool steal) const;
+
+        /// Executes the tasks of the current loop over partitions, which are assigned to a node.
+        ///
+        /// @param[in] g The node index.
+        void work_node(natural g) const;
+
+        /// Returns the index of the node the calling thread is running on.
+        ///
+        /// @return the node index, or the number of nodes if the thread is running on another node.
+        natural current_node() const;
+
+        /// The work loop of a worker thread.
+        ///
+        /// @param[in] t The thread index.
+        void serve(natural t) const;
+
+        /// Records the first exception thrown by a loop body.
+        void fail() const;
+
+        /// The number of threads, including the calling thread.
+        const natural thread_count;
+
+        /// The processor of each thread index (modulo the number of processors).
+        std::vector<natural> cpus;
+
+        /// The node index of each processor.
+        std::vector<natural> node_of_cpu;
+
+        /// The number of nodes, which the worker threads are pinned to.
+        natural node_count;
+
+        /// The worker threads.
+        std::vector<std::thread> workers;
+
+        /// Serializes the submission of loops.
+        mutable std::mutex submission;
+
+        /// Guards the state of the current loop.
+        mutable std::mutex guard;
+
+        /// Signals the start of a new loop or the shutdown of the pool.
+        mutable std::condition_variable started;
+
+        /// Signals that all workers have left the current loop.
+        mutable std::condition_variable finished;
+
+        /// The loop body.
+        mutable Body body = nullptr;
+
+        /// The function called by the loop body.
+        mutable const void *function = nullptr;
+
+        /// The number of indexes of the current loop.
+        mutable natural count = 0;
+
+        /// The chunk size of the current loop.
+        mutable natural chunk = 1;
+
+        /// The next index to be processed.
+        mutable std::atomic<natural> next;
+
+        /// Set to @c true, if the current loop is a loop over partitions.
+        mutable bool local = false;
+
+        /// Set to @c true, if threads execute the tasks of other nodes in the current loop.
+        mutable bool stealing = true;
+
+        /// The positions of the partitions, which are assigned to each node.
+        mutable std::vector<std::vector<natural>> positions;
+
+        /// The next task of each node to be processed.
+        std::unique_ptr<std::atomic<natural>[]> next_of_node;
+
+        /// The loop sequence number.
+        mutable natural sequence = 0;
+
+        /// The number of workers, which are busy with the current loop.
+        mutable natural busy = 0;
+
+        /// The first exception thrown by the loop body.
+        mutable std::exception_ptr error;
+
+        /// Set to @c true on destruction.
+        mutable bool shutdown = false;
+    };
+
+}
+
+#endif // ESPECIA_THREADS_H
@@ -0,0 +1,121 @@
+/// @file writer.cxx
+/// Buffered formatted output of text and numbers.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "writer.h"
+#include "scanner.h"
+
+using especia::natural;
+using especia::real;
+
+/// The maximum number of characters of a number formatted, excluding any padding.
+static const size_t max_number_length = 32;
+
+especia::Writer::Writer(std::ostream &os, const size_t capacity) : os(os), buffer(capacity), size(0) {
+}
+
+especia::Writer::~Writer() {
+    flush();
+}
+
+especia::Writer &especia::Writer::put(const std::string &s) {
+    reserve(s.size());
+    std::memcpy(&buffer[size], s.data(), s.size());
+    size += s.size();
+
+    return *this;
+}
+
+especia::Writer &especia::Writer::put(const natural k, const natural width) {
+    reserve(width + max_number_length);
+
+    const size_t start = size;
+    // The digits are written in reverse order
+    natural m = k;
+    do {
+        buffer[size++] = static_cast<char>('0' + m % 10);
+        m /= 10;
+    } while (m > 0);
+    for (size_t i = start, j = size - 1; i < j; ++i, --j) {
+        std::swap(buffer[i], buffer[j]);
+    }
+    pad(start, width);
+
+    return *this;
+}
+
+especia::Writer &especia::Writer::put_scientific(const real x, const natural precision, const natural width) {
+    reserve(width + precision + max_number_length);
+
+    const int k = std::snprintf(&buffer[size], buffer.size() - size, "%*.*e", static_cast<int>(width),
+                                static_cast<int>(precision), x);
+    size += static_cast<size_t>(k);
+
+    return *this;
+}
+
+especia::Writer &especia::Writer::put_shortest(const real x, const natural width) {
+    using std::isfinite;
+
+    reserve(width + max_number_length);
+
+    const size_t start = size;
+    char *const s = &buffer[size];
+
+    if (isfinite(x)) {
+        // Any decimal number of 15 significant digits is reproduced by rounding its double
+        // precision approximation to 15 digits, so a representation with up to 15 digits, if any,
+        // is found first. With 17 significant digits, any double precision number is reproduced.
+        int k = 0;
+        for (int p = 14; p <= 16; ++p) {
+            real y;
+
+            k = std::snprintf(s, max_number_length, "%.*e", p, x);
+            if (p == 16 or (parse(s, s + k, y) == s + k and y == x)) {
+                break;
+            }
+        }
+        // Trailing zeros of the significand and a dangling decimal point are removed
+        char *e = std::strchr(s, 'e');
+        char *t = e;
+        while (*(t - 1) == '0') {
+            --t;
+        }
+        if (*(t - 1) == '.') {
+            --t;
+        }
+        const auto m = static_cast<size_t>(s + k - e);
+        std::memmove(t, e, m);
+        size += static_cast<size_t>(t - s) + m;
+    } else {
+        size += static_cast<size_t>(std::snprintf(s, max_number_length, "%e", x));
+    }
+    pad(start, width);
+
+    return *this;
+}
+
+void especia::Writer::flush() {
+    if (size > 0) {
+        os.write(buffer.data(), static_cast<std::streamsize>(size));
+        size = 0;
+    }
+}
+
+void especia::Writer::pad(const size_t start, const natural width) {
+    const size_t length = size - start;
+
+    if (length < width) {
+        const size_t padding = width - length;
+
+        std::memmove(&buffer[start + padding], &buffer[start], length);
+        std::memset(&buffer[start], ' ', padding);
+        size += padding;
+    }
+}
@@ -0,0 +1,115 @@
+/// @file writer.h
+/// Buffered formatted output of text and numbers.
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_WRITER_H
+#define ESPECIA_WRITER_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base.h"
+
+namespace especia {
+
+    /// Writes formatted text into a large preallocated buffer, which is transferred to an
+    /// output stream only when full, or when flushed. Numbers are formatted without the
+    /// overhead of stream manipulators and locale facets, but exactly like an output stream
+    /// with the classic locale does.
+    ///
+    /// @remark This class is not thread safe.
+    class Writer {
+    public:
+        /// Constructs a new writer.
+        ///
+        /// @param[in,out] os The output stream.
+        /// @param[in] capacity The capacity of the buffer (bytes).
+        explicit Writer(std::ostream &os, size_t capacity = 1 << 20);
+
+        /// The destructor. Flushes the buffer.
+        ~Writer();
+
+        Writer(const Writer &) = delete;
+
+        Writer &operator=(const Writer &) = delete;
+
+        /// Writes a character.
+        ///
+        /// @param[in] c The character.
+        /// @return this writer.
+        Writer &put(char c) {
+            reserve(1);
+            buffer[size++] = c;
+
+            return *this;
+        }
+
+        /// Writes a string.
+        ///
+        /// @param[in] s The string.
+        /// @return this writer.
+        Writer &put(const std::string &s);
+
+        /// Writes a natural number, right-aligned to a certain width.
+        ///
+        /// @param[in] k The number.
+        /// @param[in] width The minimum width of the output field.
+        /// @return this writer.
+        Writer &put(natural k, natural width = 0);
+
+        /// Writes a real number in scientific notation, right-aligned to a certain width.
+        /// Like @c std::scientific with @c std::setprecision and @c std::setw.
+        ///
+        /// @param[in] x The number.
+        /// @param[in] precision The number of digits after the decimal point.
+        /// @param[in] width The minimum width of the output field.
+        /// @return this writer.
+        Writer &put_scientific(real x, natural precision, natural width = 0);
+
+        /// Writes a real number in scientific notation with the least number of digits,
+        /// which reproduce the number exactly, when read back, right-aligned to a certain
+        /// width.
+        ///
+        /// @param[in] x The number.
+        /// @param[in] width The minimum width of the output field.
+        /// @return this writer.
+        Writer &put_shortest(real x, natural width = 0);
+
+        /// Transfers the buffer to the output stream.
+        void flush();
+
+    private:
+        /// Ensures there is room for a certain number of characters in the buffer.
+        ///
+        /// @param[in] k The number of characters.
+        void reserve(size_t k) {
+            if (size + k > buffer.size()) {
+                flush();
+                if (k > buffer.size()) {
+                    buffer.resize(k);
+                }
+            }
+        }
+
+        /// Pads the output field written last with leading spaces.
+        ///
+        /// @param[in] start The start of the output field in the buffer.
+        /// @param[in] width The minimum width of the output field.
+        void pad(size_t start, natural width);
+
+        /// The output stream.
+        std::ostream &os;
+
+        /// The buffer.
+        std::vector<char> buffer;
+
+        /// The number of characters in the buffer.
+        size_t size;
+    };
+
+}
+
+#endif // ESPECIA_WRITER_H
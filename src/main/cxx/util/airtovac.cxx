@@ -6,9 +6,9 @@
 #include <exception>
 #include <stdexcept>
 
-#include "../core/dataio.h"
 #include "../core/equations.h"
 #include "../core/exitcodes.h"
+#include "../core/pipeline.h"
 
 using namespace std;
 
@@ -33,35 +33,39 @@ using especia::real;
 /// @param argc The number of command line arguments supplied.
 /// @param argv[0] The program name.
 /// @param argv[1] The number of lines to skip at the beginning (optional, default = 0).
+/// @param argv[2] The path name of the source file (optional). A source file in binary
+/// format is converted into binary format. When omitted, reads from standard input.
 /// @return an exit code.
 ///
-/// @remark Usage: airtovac [lines to skip] < {source file} [> {target file}]
+/// @remark The data are streamed in chunks, which are converted in parallel.
+///
+/// @remark Usage: airtovac [lines to skip] [{source file} | < {source file}] [> {target file}]
 int main(int argc, char *argv[]) {
     using especia::Equations;
 
     const string program_name(argv[0]);
 
     try {
-        if (argc != 1 and argc != 2) {
+        // Chunks are read by another thread, so lock-free standard streams matter
+        ios_base::sync_with_stdio(false);
+
+        if (argc > 3) {
             throw invalid_argument("Error: an invalid number of arguments was supplied");
         }
 
         natural skip = 0;
 
-        if (argc == 2) {
+        if (argc >= 2) {
             skip = especia::convert<natural>(string(argv[1]));
         }
 
-        valarray<real> x;
-        valarray<real> y;
-        valarray<real> z;
+        const auto f = [](real x) {
+            return real(10.0) / especia::solve(Equations::edlen66, real(10.0) / x, real(10.0) / x, real(1.0E-08));
+        };
+        const especia::Thread_Pool pool;
 
-        if (especia::get(cin, x, y, z, skip)) {
-            for (size_t i = 0; i < x.size(); ++i) {
-                x[i] = real(10.0) / especia::solve(Equations::edlen66, real(10.0) / x[i], real(10.0) / x[i], real(1.0E-08));
-            }
-            especia::put(cout, x, y, z);
-        } else {
+        if (!(argc == 3 ? especia::transform(string(argv[2]), cout, f, skip, pool)
+                        : especia::transform(cin, cout, f, skip, pool))) {
             throw runtime_error("Error: an input error occurred");
         }
         return 0;
@@ -7,8 +7,8 @@
 #include <stdexcept>
 
 #include "../core/base.h"
-#include "../core/dataio.h"
 #include "../core/exitcodes.h"
+#include "../core/pipeline.h"
 
 using namespace std;
 
@@ -21,7 +21,7 @@ using especia::real;
 /// @param os The ouput stream.
 /// @param pname The program name.
 void write_usage_message(ostream &os, const string &pname) {
-    os << "usage: " << pname << " {velocity (m s-1)} [skip] < {source data file} [> {target data file}]" << endl;
+    os << "usage: " << pname << " {velocity (m s-1)} [skip] [{source data file} | < {source data file}] [> {target data file}]" << endl;
 }
 
 /// Utility to apply the heliocentric (or barycentric) velocity correction to
@@ -33,9 +33,13 @@ void write_usage_message(ostream &os, const string &pname) {
 /// barycenter) of the solar system (m s-1) projected along the line of sight
 /// toward the observed object.
 /// @param argv[2] The number of lines to skip at the beginning (optional, default = 0).
+/// @param argv[3] The path name of the source file (optional). A source file in binary
+/// format is corrected into binary format. When omitted, reads from standard input.
 /// @return an exit code.
 ///
-/// @remark Usage: helicorr {velocity (m s-1)} [lines to skip] < {source file} [> {target file}]
+/// @remark The data are streamed in chunks, which are corrected in parallel.
+///
+/// @remark Usage: helicorr {velocity (m s-1)} [lines to skip] [{source file} | < {source file}] [> {target file}]
 int main(int argc, char *argv[]) {
     const string program_name(argv[0]);
 
@@ -44,7 +48,10 @@ int main(int argc, char *argv[]) {
         return 0;
     }
     try {
-        if (argc != 2 and argc != 3) {
+        // Chunks are read by another thread, so lock-free standard streams matter
+        ios_base::sync_with_stdio(false);
+
+        if (argc < 2 or argc > 4) {
             throw invalid_argument("Error: an invalid number of arguments was supplied");
         }
 
@@ -52,20 +59,18 @@ int main(int argc, char *argv[]) {
 
         natural skip = 0;
 
-        if (argc == 3) {
+        if (argc >= 3) {
             skip = especia::convert<natural>(string(argv[2]));
         }
 
-        valarray<real> x;
-        valarray<real> y;
-        valarray<real> z;
+        const real c = 1.0 + especia::redshift(v);
+        const auto f = [c](real x) {
+            return x * c;
+        };
+        const especia::Thread_Pool pool;
 
-        if (especia::get(cin, x, y, z, skip)) {
-            if (v != 0.0) {
-                x *= 1.0 + especia::redshift(v);
-            }
-            especia::put(cout, x, y, z);
-        } else {
+        if (!(argc == 4 ? especia::transform(string(argv[3]), cout, f, skip, pool)
+                        : especia::transform(cin, cout, f, skip, pool))) {
             throw runtime_error("Error: an input error occurred");
         }
         return 0;
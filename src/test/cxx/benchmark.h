@@ -0,0 +1,231 @@
+/// @file benchmark.h
+/// Simple microbenchmarking framework
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_BENCHMARK_H
+#define ESPECIA_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+/// The base class to be inherited by all benchmark suites.
+///
+/// Each benchmark is reported on a line of its own, consisting of the benchmark name
+/// and the median time per operation (ns), separated by white space. The same format
+/// is used for baseline files. When a baseline is supplied, the ratio of the time measured
+/// to the baseline time is reported, too, and a benchmark is marked as a regression when
+/// the ratio exceeds the tolerance.
+class Benchmark_Suite {
+public:
+    /// The destructor.
+    virtual ~Benchmark_Suite() = default;
+
+    /// Runs the benchmark suite.
+    ///
+    /// @param argc The number of command line arguments.
+    /// @param argv The command line arguments. Options of the form @c --name=value are
+    /// @parblock
+    /// @c --baseline={path} The baseline file to compare with. A missing file is ignored.
+    ///
+    /// @c --record={path} The baseline file to record.
+    ///
+    /// @c --tolerance={ratio} The maximum ratio of time measured to baseline time (default 1.25).
+    ///
+    /// @c --filter={text} Runs only benchmarks whose name contains the text.
+    /// @endparblock
+    /// @return an exit code. Is 1, if a regression is detected.
+    int run_suite(int argc, char *argv[]) {
+        using std::endl;
+        using std::exception;
+        using std::string;
+
+        try {
+            for (int i = 1; i < argc; ++i) {
+                const string option(argv[i]);
+                const string name = option.substr(0, option.find('='));
+                const string value = option.find('=') == string::npos ? string() : option.substr(option.find('=') + 1);
+
+                if (name == "--baseline") {
+                    read_baseline(value);
+                } else if (name == "--record") {
+                    record_path = value;
+                } else if (name == "--tolerance") {
+                    tolerance = std::strtod(value.c_str(), nullptr);
+                } else if (name == "--filter") {
+                    filter = value;
+                } else {
+                    throw std::invalid_argument("Error: the option '" + option + "' is unknown");
+                }
+            }
+            run_all();
+            if (!record_path.empty()) {
+                write_record();
+            }
+            return regression ? 1 : 0;
+        } catch (exception &e) {
+            std::cerr << e.what() << endl;
+            return 2;
+        }
+    }
+
+protected:
+    /// The constructor.
+    Benchmark_Suite() = default;
+
+    /// Runs all benchmarks.
+    virtual void run_all() = 0;
+
+    /// Measures the median time per operation of a function.
+    ///
+    /// The function is called repeatedly until a sample lasts for the minimum sample
+    /// duration. The median is taken over several samples.
+    ///
+    /// @tparam F The function type.
+    ///
+    /// @param name The benchmark name. Must not contain white space.
+    /// @param f The function.
+    /// @param operation_count The number of operations carried out by a single call of the function.
+    template<class F>
+    void measure(const std::string &name, const F &f, const double operation_count = 1.0) {
+        using std::chrono::duration;
+        using std::chrono::steady_clock;
+
+        if (name.find(filter) == std::string::npos) {
+            return;
+        }
+
+        // Warm up and calibrate the number of calls per sample
+        long calls = 1;
+        for (;;) {
+            const steady_clock::time_point start = steady_clock::now();
+            for (long i = 0; i < calls; ++i) {
+                f();
+            }
+            const double elapsed = duration<double>(steady_clock::now() - start).count();
+            if (elapsed >= min_sample_duration or calls >= max_calls) {
+                break;
+            }
+            calls = elapsed > 0.0 ? std::min(max_calls, 2 * static_cast<long>(calls * min_sample_duration / elapsed) + 1)
+                                  : 2 * calls;
+        }
+
+        std::vector<double> samples(sample_count);
+        for (auto &sample : samples) {
+            const steady_clock::time_point start = steady_clock::now();
+            for (long i = 0; i < calls; ++i) {
+                f();
+            }
+            sample = duration<double, std::nano>(steady_clock::now() - start).count() / (calls * operation_count);
+        }
+        std::nth_element(samples.begin(), samples.begin() + sample_count / 2, samples.end());
+
+        report(name, samples[sample_count / 2]);
+    }
+
+    /// Prevents the compiler from optimizing a computed value away.
+    ///
+    /// @param x The value.
+    static void consume(const double x) {
+        static volatile double sink;
+
+        sink = x;
+    }
+
+private:
+    /// Reports a benchmark result.
+    ///
+    /// @param name The benchmark name.
+    /// @param t The median time per operation (ns).
+    void report(const std::string &name, const double t) {
+        using std::setw;
+
+        std::ostringstream os;
+        os.setf(std::ios_base::scientific, std::ios_base::floatfield);
+        os.precision(4);
+        os << std::left << setw(56) << name << std::right << setw(12) << t;
+
+        const auto baseline = baselines.find(name);
+        if (baseline != baselines.end() and baseline->second > 0.0) {
+            const double ratio = t / baseline->second;
+
+            os << setw(12) << baseline->second;
+            os.setf(std::ios_base::fixed, std::ios_base::floatfield);
+            os.precision(3);
+            os << setw(8) << ratio;
+            if (ratio > tolerance) {
+                os << "  REGRESSION";
+                regression = true;
+            }
+        }
+        std::cout << os.str() << std::endl;
+        results.emplace_back(name, t);
+    }
+
+    /// Reads a baseline file. A missing file is ignored.
+    ///
+    /// @param path The path name of the baseline file.
+    void read_baseline(const std::string &path) {
+        std::ifstream ifs(path.c_str());
+        std::string name;
+        double t;
+
+        while (ifs >> name >> t) {
+            baselines[name] = t;
+        }
+    }
+
+    /// Writes the results into the baseline file to record.
+    void write_record() const {
+        std::ofstream ofs(record_path.c_str());
+
+        ofs.setf(std::ios_base::scientific, std::ios_base::floatfield);
+        ofs.precision(6);
+        for (const auto &result : results) {
+            ofs << result.first << ' ' << result.second << '\n';
+        }
+        if (!ofs) {
+            throw std::runtime_error("Error: the baseline file '" + record_path + "' cannot be written");
+        }
+    }
+
+    /// The minimum duration of a sample (s).
+    const double min_sample_duration = 0.05;
+
+    /// The maximum number of calls per sample.
+    const long max_calls = 100000000;
+
+    /// The number of samples.
+    const int sample_count = 5;
+
+    /// The baseline times per operation (ns).
+    std::map<std::string, double> baselines;
+
+    /// The results.
+    std::vector<std::pair<std::string, double>> results;
+
+    /// The path name of the baseline file to record.
+    std::string record_path;
+
+    /// The benchmark name filter.
+    std::string filter;
+
+    /// The maximum ratio of time measured to baseline time.
+    double tolerance = 1.25;
+
+    /// Set when a regression is detected.
+    bool regression = false;
+};
+
+#endif // ESPECIA_BENCHMARK_H
@@ -0,0 +1,64 @@
+/// @file decompose_benchmark.cxx
+/// Microbenchmarks
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <string>
+#include <vector>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/decompose.h"
+#include "../benchmark.h"
+
+using especia::D_Decompose;
+using especia::J_Decompose;
+using especia::R_Decompose;
+using especia::X_Decompose;
+using especia::natural;
+using especia::real;
+
+
+class Decompose_Benchmark : public Benchmark_Suite {
+private:
+
+    /// Returns a symmetric, positive definite matrix, which is stored in column-major order.
+    static std::vector<real> matrix(const natural n) {
+        std::vector<real> A(n * n);
+
+        for (natural i = 0; i < n; ++i) {
+            for (natural j = 0; j < n; ++j) {
+                A[i * n + j] = 1.0 / real(i + j + 1);
+            }
+            A[i * n + i] += real(n);
+        }
+        return A;
+    }
+
+    template<class D>
+    void measure_decompose(const std::string &name, const std::vector<natural> &dimensions) {
+        for (const natural n : dimensions) {
+            const D decompose(n);
+            const std::vector<real> A = matrix(n);
+            std::vector<real> Z(n * n);
+            std::vector<real> w(n);
+
+            measure(name + "/n=" + std::to_string(n), [&]() {
+                decompose(&A[0], &Z[0], &w[0]);
+                consume(w[0]);
+            });
+        }
+    }
+
+    void run_all() override {
+        measure_decompose<D_Decompose>("D_Decompose", {10, 20, 50, 100, 200, 500});
+        measure_decompose<R_Decompose>("R_Decompose", {10, 20, 50, 100, 200, 500});
+        measure_decompose<X_Decompose>("X_Decompose", {10, 20, 50, 100, 200, 500});
+        measure_decompose<R_Decompose>("R_Decompose", {4, 6, 8, 10});
+        measure_decompose<J_Decompose>("J_Decompose", {4, 6, 8, 10});
+    }
+};
+
+
+int main(int argc, char *argv[]) {
+    return Decompose_Benchmark().run_suite(argc, argv);
+}
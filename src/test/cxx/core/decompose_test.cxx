@@ -3,12 +3,30 @@
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
 #include "../../../main/cxx/core/decompose.h"
 #include "../unittest.h"
 
+using especia::integer;
 using especia::natural;
 using especia::real;
 
+extern "C" {
+/// Interface to LAPACK routine @c DSYEV, the reference solver.
+void dsyev_(const char &job,
+            const char &uplo,
+            const integer &n,
+            real A[],
+            const integer &lda,
+            real w[],
+            real work[],
+            const integer &lwork,
+            integer &info);
+}
+
 class Decompose_Test : public Unit_Test {
 private:
 
@@ -102,6 +120,37 @@ private:
         assert_equals(real(3), w[2], real(0), "X decompose diagonal matrix (w)");
     }
 
+    void test_decompose_symmetric_matrix_drivers() {
+        using especia::Decompose;
+
+        const natural n = 3;
+        const Decompose::Driver drivers[] = {Decompose::Driver::dsyevd,
+                                             Decompose::Driver::dsyevr,
+                                             Decompose::Driver::dsyevx,
+                                             Decompose::Driver::jacobi};
+
+        const real A[n * n] = { real(1), real(2), real(3),
+                                real(2), real(4), real(5),
+                                real(3), real(5), real(6) };
+
+        for (const auto driver : drivers) {
+            const Decompose decompose(n, driver);
+            const Decompose copy(decompose);
+
+            real Z[n * n];
+            real w[n];
+
+            copy(A, Z, w);
+
+            assert_true(copy.get_driver() == driver, "decompose symmetric matrix (driver)");
+            assert_equals(real(-0.515729), w[0], real(1.0E-06), "decompose symmetric matrix (w)");
+            assert_equals(real( 0.170915), w[1], real(1.0E-06), "decompose symmetric matrix (w)");
+            assert_equals(real( 11.34480), w[2], real(1.0E-04), "decompose symmetric matrix (w)");
+            assert_equals(real(0.327985), std::abs(Z[6]), real(1.0E-06), "decompose symmetric matrix (Z)");
+            assert_equals(real(0.736976), std::abs(Z[8]), real(1.0E-06), "decompose symmetric matrix (Z)");
+        }
+    }
+
     void test_decompose_symmetric_matrix_D() {
         using especia::D_Decompose;
 
@@ -195,14 +244,171 @@ private:
         assert_equals(real( 11.34480), w[2], real(1.0E-04), "X decompose symmetric matrix (w)");
     }
 
+    void test_decompose_diagonal_matrix_J() {
+        using especia::J_Decompose;
+
+        const natural n = 3;
+        const J_Decompose decompose(n);
+
+        const real A[n * n] = { real(3), real(0), real(0),
+                                real(0), real(1), real(0),
+                                real(0), real(0), real(2) };
+
+        real Z[n * n];
+        real w[n];
+
+        decompose(A, Z, w);
+
+        assert_equals(real(0), Z[0], real(0), "J decompose diagonal matrix (Z)");
+        assert_equals(real(1), Z[1], real(0), "J decompose diagonal matrix (Z)");
+        assert_equals(real(0), Z[2], real(0), "J decompose diagonal matrix (Z)");
+        assert_equals(real(0), Z[3], real(0), "J decompose diagonal matrix (Z)");
+        assert_equals(real(0), Z[4], real(0), "J decompose diagonal matrix (Z)");
+        assert_equals(real(1), Z[5], real(0), "J decompose diagonal matrix (Z)");
+        assert_equals(real(1), Z[6], real(0), "J decompose diagonal matrix (Z)");
+        assert_equals(real(0), Z[7], real(0), "J decompose diagonal matrix (Z)");
+        assert_equals(real(0), Z[8], real(0), "J decompose diagonal matrix (Z)");
+
+        assert_equals(real(1), w[0], real(0), "J decompose diagonal matrix (w)");
+        assert_equals(real(2), w[1], real(0), "J decompose diagonal matrix (w)");
+        assert_equals(real(3), w[2], real(0), "J decompose diagonal matrix (w)");
+    }
+
+    void test_decompose_symmetric_matrix_J() {
+        using especia::J_Decompose;
+
+        const natural n = 3;
+        const J_Decompose decompose(n);
+
+        const real A[n * n] = { real(1), real(2), real(3),
+                                real(2), real(4), real(5),
+                                real(3), real(5), real(6) };
+
+        real Z[n * n];
+        real w[n];
+
+        decompose(A, Z, w);
+
+        // the signs of the eigenvectors are arbitrary
+        assert_equals(real(0.736976), std::abs(Z[0]), real(1.0E-06), "J decompose symmetric matrix (Z)");
+        assert_equals(real(0.327985), std::abs(Z[1]), real(1.0E-06), "J decompose symmetric matrix (Z)");
+        assert_equals(real(0.591009), std::abs(Z[2]), real(1.0E-06), "J decompose symmetric matrix (Z)");
+        assert_equals(real(0.591009), std::abs(Z[3]), real(1.0E-06), "J decompose symmetric matrix (Z)");
+        assert_equals(real(0.736976), std::abs(Z[4]), real(1.0E-06), "J decompose symmetric matrix (Z)");
+        assert_equals(real(0.327985), std::abs(Z[5]), real(1.0E-06), "J decompose symmetric matrix (Z)");
+        assert_equals(real(0.327985), std::abs(Z[6]), real(1.0E-06), "J decompose symmetric matrix (Z)");
+        assert_equals(real(0.591009), std::abs(Z[7]), real(1.0E-06), "J decompose symmetric matrix (Z)");
+        assert_equals(real(0.736976), std::abs(Z[8]), real(1.0E-06), "J decompose symmetric matrix (Z)");
+
+        assert_equals(real(-0.515729), w[0], real(1.0E-06), "J decompose symmetric matrix (w)");
+        assert_equals(real( 0.170915), w[1], real(1.0E-06), "J decompose symmetric matrix (w)");
+        assert_equals(real( 11.34480), w[2], real(1.0E-04), "J decompose symmetric matrix (w)");
+    }
+
+    void test_decompose_symmetric_matrix_J_dimensions() {
+        using especia::J_Decompose;
+        using especia::R_Decompose;
+
+        for (natural n = 1; n <= J_Decompose::max_dimension; ++n) {
+            const J_Decompose decompose(n);
+            const R_Decompose reference(n);
+
+            // A Hilbert matrix plus a diagonal matrix (only the upper triangular part is used)
+            std::vector<real> A(n * n, real(0));
+            for (natural j = 0; j < n; ++j) {
+                for (natural i = 0; i <= j; ++i) {
+                    A[i + j * n] = real(1) / real(i + j + 1) + (i == j ? real(i % 3) : real(0));
+                }
+            }
+
+            std::vector<real> Z(n * n);
+            std::vector<real> w(n);
+            std::vector<real> v(n * n);
+            std::vector<real> u(n);
+
+            decompose(&A[0], &Z[0], &w[0]);
+            reference(&A[0], &v[0], &u[0]);
+
+            for (natural j = 0; j < n; ++j) {
+                assert_equals(u[j], w[j], real(1.0E-12), "J decompose symmetric matrix dimensions (w)");
+
+                // The residual of the eigenvector and the orthonormality of the eigenvectors
+                for (natural i = 0; i < n; ++i) {
+                    real t = -w[j] * Z[i + j * n];
+                    real p = (i == j) ? real(-1) : real(0);
+                    for (natural k = 0; k < n; ++k) {
+                        t += (k <= i ? A[k + i * n] : A[i + k * n]) * Z[k + j * n];
+                        p += Z[k + i * n] * Z[k + j * n];
+                    }
+                    assert_equals(real(0), t, real(1.0E-12), "J decompose symmetric matrix dimensions (Z)");
+                    assert_equals(real(0), p, real(1.0E-12), "J decompose symmetric matrix dimensions (Z)");
+                }
+            }
+        }
+
+        bool thrown = false;
+        try {
+            const J_Decompose decompose(J_Decompose::max_dimension + 1);
+        } catch (std::invalid_argument &) {
+            thrown = true;
+        }
+        assert_true(thrown, "J decompose symmetric matrix dimensions (unsupported)");
+    }
+
+    void test_decompose_symmetric_matrix_default_dsyev() {
+        using especia::Decompose;
+        using especia::J_Decompose;
+
+        for (natural n = 1; n <= J_Decompose::max_dimension; ++n) {
+            const Decompose decompose(n);
+
+            // A Hilbert matrix plus a diagonal matrix with distinct eigenvalues
+            std::vector<real> A(n * n, real(0));
+            for (natural j = 0; j < n; ++j) {
+                for (natural i = 0; i <= j; ++i) {
+                    A[i + j * n] = real(1) / real(i + j + 1) + (i == j ? real(i) : real(0));
+                }
+            }
+
+            std::vector<real> Z(n * n);
+            std::vector<real> w(n);
+            std::vector<real> V(A);
+            std::vector<real> u(n);
+            std::vector<real> work(64 * n);
+            integer info = 0;
+
+            decompose(&A[0], &Z[0], &w[0]);
+            dsyev_('V', 'U', static_cast<integer>(n), &V[0], static_cast<integer>(n), &u[0], &work[0],
+                   static_cast<integer>(work.size()), info);
+
+            assert_true(decompose.get_driver() == Decompose::Driver::jacobi,
+                        "decompose symmetric matrix default (driver)");
+            assert_equals(0, info, "decompose symmetric matrix default (dsyev)");
+            for (natural j = 0; j < n; ++j) {
+                assert_equals(u[j], w[j], real(1.0E-12), "decompose symmetric matrix default (w)");
+
+                // The eigenvectors are the same up to their sign
+                real p = real(0);
+                for (natural k = 0; k < n; ++k) {
+                    p += Z[k + j * n] * V[k + j * n];
+                }
+                assert_equals(real(1), std::abs(p), real(1.0E-12), "decompose symmetric matrix default (Z)");
+            }
+        }
+    }
 
     void run_all() override {
+        run(this, &Decompose_Test::test_decompose_symmetric_matrix_drivers);
         run(this, &Decompose_Test::test_decompose_diagonal_matrix_D);
         run(this, &Decompose_Test::test_decompose_diagonal_matrix_R);
         run(this, &Decompose_Test::test_decompose_diagonal_matrix_X);
         run(this, &Decompose_Test::test_decompose_symmetric_matrix_D);
         run(this, &Decompose_Test::test_decompose_symmetric_matrix_R);
         run(this, &Decompose_Test::test_decompose_symmetric_matrix_X);
+        run(this, &Decompose_Test::test_decompose_diagonal_matrix_J);
+        run(this, &Decompose_Test::test_decompose_symmetric_matrix_J);
+        run(this, &Decompose_Test::test_decompose_symmetric_matrix_J_dimensions);
+        run(this, &Decompose_Test::test_decompose_symmetric_matrix_default_dsyev);
     }
 };
 
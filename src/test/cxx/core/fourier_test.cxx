@@ -0,0 +1,102 @@
+/// @file fourier_test.cxx
+/// Unit tests
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/fourier.h"
+#include "../unittest.h"
+
+using especia::real;
+using especia::Fourier_Transform;
+
+
+class Fourier_Test : public Unit_Test {
+private:
+
+    void test_forward() {
+        using std::complex;
+        using std::cos;
+        using std::exp;
+        using std::sin;
+
+        const size_t n = 64;
+        const Fourier_Transform fourier_transform(n);
+
+        std::vector<complex<real>> z(n);
+        for (size_t i = 0; i < n; ++i) {
+            z[i] = complex<real>(cos(0.1 * real(i * i)), sin(0.3 * real(i)));
+        }
+        const std::vector<complex<real>> x = z;
+
+        fourier_transform.forward(z.data());
+
+        for (size_t k = 0; k < n; ++k) {
+            complex<real> expected = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                expected += x[i] * exp(complex<real>(0.0, -2.0 * especia::pi * real(i * k) / real(n)));
+            }
+            assert_equals(expected.real(), z[k].real(), real(1.0E-12), "forward transform (real part)");
+            assert_equals(expected.imag(), z[k].imag(), real(1.0E-12), "forward transform (imaginary part)");
+        }
+    }
+
+    void test_inverse() {
+        using std::complex;
+        using std::cos;
+        using std::sin;
+
+        const size_t n = 1024;
+        const Fourier_Transform fourier_transform(n);
+
+        std::vector<complex<real>> z(n);
+        for (size_t i = 0; i < n; ++i) {
+            z[i] = complex<real>(cos(0.1 * real(i * i)), sin(0.3 * real(i)));
+        }
+        const std::vector<complex<real>> x = z;
+
+        fourier_transform.forward(z.data());
+        fourier_transform.inverse(z.data());
+
+        for (size_t i = 0; i < n; ++i) {
+            assert_equals(x[i].real(), z[i].real() / real(n), real(1.0E-12), "inverse transform (real part)");
+            assert_equals(x[i].imag(), z[i].imag() / real(n), real(1.0E-12), "inverse transform (imaginary part)");
+        }
+    }
+
+    void test_power_of_two() {
+        assert_equals(size_t(1), Fourier_Transform::power_of_two(0), "power of two");
+        assert_equals(size_t(1), Fourier_Transform::power_of_two(1), "power of two");
+        assert_equals(size_t(64), Fourier_Transform::power_of_two(64), "power of two");
+        assert_equals(size_t(128), Fourier_Transform::power_of_two(65), "power of two");
+    }
+
+    void test_invalid_size() {
+        bool thrown = false;
+
+        try {
+            const Fourier_Transform fourier_transform(48);
+        } catch (std::invalid_argument &e) {
+            thrown = true;
+        }
+
+        assert_true(thrown, "invalid size");
+    }
+
+    void run_all() override {
+        run(this, &Fourier_Test::test_forward);
+        run(this, &Fourier_Test::test_inverse);
+        run(this, &Fourier_Test::test_power_of_two);
+        run(this, &Fourier_Test::test_invalid_size);
+    }
+};
+
+
+int main() {
+    return Fourier_Test().run_testsuite();
+}
@@ -13,6 +13,25 @@ using especia::Integrator;
 class Integrator_Test : public Unit_Test {
 private:
 
+    class Absorption {
+    public:
+        double operator()(double x) const {
+            using std::exp;
+            using especia::sq;
+
+            return 1.0 - exp(-exp(-sq(x)));
+        }
+
+        void evaluate(const double x[], double y[], size_t n) const {
+            for (size_t i = 0; i < n; ++i) {
+                y[i] = operator()(x[i]);
+            }
+            ++batch_count;
+        }
+
+        mutable size_t batch_count = 0;
+    };
+
     void test_integrate_cos() {
         using std::cos;
         using especia::pi;
@@ -85,6 +104,22 @@ private:
         assert_equals(1.285145, result, 0.5E-06, "integrate absorption (infinite)");
     }
 
+    void test_integrate_absorption_batched() {
+        const Absorption f;
+        const double result = integrator.integrate(f, 0.0, 4.0);
+
+        assert_true(f.batch_count > 0, "integrate absorption (batched)");
+        assert_equals(0.642572, result, 0.5E-06, "integrate absorption (batched)");
+    }
+
+    void test_integrate_absorption_infinite_batched() {
+        const Absorption f;
+        const double result = integrator.integrate_infinite(f);
+
+        assert_true(f.batch_count > 0, "integrate absorption (infinite, batched)");
+        assert_equals(1.285145, result, 0.5E-06, "integrate absorption (infinite, batched)");
+    }
+
     void run_all() override {
         run(this, &Integrator_Test::test_integrate_cos);
         run(this, &Integrator_Test::test_integrate_sin);
@@ -93,6 +128,8 @@ private:
         run(this, &Integrator_Test::test_integrate_absorption_positive_infinite);
         run(this, &Integrator_Test::test_integrate_absorption_negative_infinite);
         run(this, &Integrator_Test::test_integrate_absorption_infinite);
+        run(this, &Integrator_Test::test_integrate_absorption_batched);
+        run(this, &Integrator_Test::test_integrate_absorption_infinite_batched);
     }
 
     Integrator<double> integrator;
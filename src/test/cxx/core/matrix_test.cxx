@@ -0,0 +1,103 @@
+/// @file matrix_test.cxx
+/// Unit tests
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <cmath>
+#include <vector>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/matrix.h"
+#include "../unittest.h"
+
+using especia::natural;
+using especia::real;
+
+
+class Matrix_Test : public Unit_Test {
+private:
+
+    static std::vector<real> matrix(natural m, natural n) {
+        std::vector<real> a(m * n);
+
+        for (natural j = 0; j < n; ++j) {
+            for (natural i = 0; i < m; ++i) {
+                a[j * m + i] = std::sin(real(1 + i + 3 * j));
+            }
+        }
+
+        return a;
+    }
+
+    void test_multiply() {
+        const natural m = 7;
+        const natural n = 5;
+        const natural k = 3;
+
+        const std::vector<real> a = matrix(m, k);
+        const std::vector<real> b = matrix(k, n);
+        std::vector<real> c(m * n);
+
+        especia::multiply(m, n, k, a.data(), b.data(), c.data());
+
+        for (natural j = 0; j < n; ++j) {
+            for (natural i = 0; i < m; ++i) {
+                real expected = 0.0;
+                for (natural l = 0; l < k; ++l) {
+                    expected += a[l * m + i] * b[j * k + l];
+                }
+                assert_equals(expected, c[j * m + i], real(1.0E-14), "multiply");
+            }
+        }
+    }
+
+    void test_rank_k_update() {
+        const natural n = 6;
+        const natural k = 4;
+
+        const std::vector<real> a = matrix(n, k);
+        const std::vector<real> c = matrix(n, n);
+        std::vector<real> d = c;
+
+        especia::rank_k_update(n, k, 0.5, a.data(), 0.25, d.data());
+
+        for (natural j = 0; j < n; ++j) {
+            for (natural i = 0; i <= j; ++i) {
+                real expected = 0.0;
+                for (natural l = 0; l < k; ++l) {
+                    expected += a[l * n + i] * a[l * n + j];
+                }
+                expected = 0.5 * expected + 0.25 * c[j * n + i];
+                assert_equals(expected, d[j * n + i], real(1.0E-14), "rank-k update");
+            }
+        }
+    }
+
+    void test_rank_1_update() {
+        const natural n = 6;
+
+        const std::vector<real> x = matrix(n, 1);
+        const std::vector<real> c = matrix(n, n);
+        std::vector<real> d = c;
+
+        especia::rank_1_update(n, 0.5, x.data(), d.data());
+
+        for (natural j = 0; j < n; ++j) {
+            for (natural i = 0; i <= j; ++i) {
+                const real expected = 0.5 * x[i] * x[j] + c[j * n + i];
+                assert_equals(expected, d[j * n + i], real(1.0E-14), "rank-1 update");
+            }
+        }
+    }
+
+    void run_all() override {
+        run(this, &Matrix_Test::test_multiply);
+        run(this, &Matrix_Test::test_rank_k_update);
+        run(this, &Matrix_Test::test_rank_1_update);
+    }
+};
+
+
+int main() {
+    return Matrix_Test().run_testsuite();
+}
@@ -0,0 +1,90 @@
+/// @file optimize_benchmark.cxx
+/// Microbenchmarks
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <valarray>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/model.h"
+#include "../../../main/cxx/core/optimizer.h"
+#include "../../../main/cxx/core/profiles.h"
+#include "../benchmark.h"
+
+using especia::Intergalactic_Doppler;
+using especia::Model;
+using especia::Optimizer;
+using especia::real;
+
+
+/// Benchmarks the optimization of the model bundled with the @c especid integration test.
+///
+/// @remark Must be run from the build directory, where the model definition and the
+/// spectroscopic data referred to are found in the @c resources directory.
+class Optimize_Benchmark : public Benchmark_Suite {
+private:
+
+    /// Reads the model definition embedded in an Especia result HTML file.
+    static void read_model(Model<Intergalactic_Doppler> &model, const std::string &path) {
+        std::ifstream ifs(path.c_str());
+        std::ostringstream definition;
+        std::string s;
+        bool found = false;
+
+        while (std::getline(ifs, s)) {
+            if (found and s != "</model>") {
+                definition << s << '\n';
+            } else {
+                found = (s == "<model>");
+            }
+        }
+
+        std::istringstream is(definition.str());
+        std::ostringstream os;
+        model.get(is, os);
+        if (is.fail() or not is.eof()) {
+            throw std::runtime_error("Error: the model definition in '" + path + "' cannot be read");
+        }
+    }
+
+    void benchmark_optimize() {
+        Model<Intergalactic_Doppler> model;
+        read_model(model, "resources/especid_test.html");
+
+        const std::valarray<real> x = model.get_initial_parameter_values();
+        const std::valarray<real> d = model.get_initial_local_step_sizes();
+        // the model memorizes the cost of unchanged sections, so evaluations alternate between two parameter vectors
+        const std::valarray<real> y = x + real(0.01) * d;
+
+        bool alternate = false;
+        measure("Model<Intergalactic_Doppler>::operator()", [&]() {
+            alternate = not alternate;
+            consume(model(alternate ? &y[0] : &x[0], model.get_parameter_count()));
+        });
+
+        const Optimizer optimizer = Optimizer::Builder().
+                with_problem_dimension(model.get_parameter_count()).
+                with_parent_number(20).
+                with_population_size(40).
+                with_accuracy_goal(1.0E-04).
+                with_stop_generation(1).
+                build();
+
+        measure("optimize/generations=1", [&]() {
+            consume(optimizer.minimize(model, x, d, 2.0, model.get_constraint(), especia::No_Tracing<real>()).get_fitness());
+        });
+    }
+
+    void run_all() override {
+        benchmark_optimize();
+    }
+};
+
+
+int main(int argc, char *argv[]) {
+    return Optimize_Benchmark().run_suite(argc, argv);
+}
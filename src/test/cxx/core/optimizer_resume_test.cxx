@@ -0,0 +1,236 @@
+/// @file optimizer_resume_test.cxx
+/// Unit tests
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "optimizer_test.h"
+
+/// The optimizer tests of restarts, resumption from checkpoints and racing, which
+/// run several optimizations per test case.
+class Optimizer_Resume_Test : public Optimizer_Test_Fixture {
+private:
+
+    void test_minimize_rosenbrock_ipop_restarts() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+
+        const Optimizer::Result initial = builder.build().minimize(rosenbrock, x, d, s);
+        const Optimizer optimizer = builder.with_restart_count(2).with_thread_count(2).build();
+        const Optimizer::Result result = optimizer.minimize(rosenbrock, x, d, s);
+        const Optimizer::Result repeated = optimizer.minimize(rosenbrock, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock IPOP restarts (optimized)");
+        assert_true(result.get_restart_number() <= 2, "test minimize Rosenbrock IPOP restarts (restart number)");
+        assert_true(result.get_fitness() <= initial.get_fitness(), "test minimize Rosenbrock IPOP restarts (best)");
+        assert_equals(result.get_restart_number(), repeated.get_restart_number(),
+                      "test minimize Rosenbrock IPOP restarts (reproducible)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize Rosenbrock IPOP restarts (parameter)");
+            assert_equals(result.get_parameter_values()[i], repeated.get_parameter_values()[i], real(0),
+                          "test minimize Rosenbrock IPOP restarts (reproducible parameter)");
+        }
+    }
+
+
+    void test_minimize_rosenbrock_bipop_restarts() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+
+        const Optimizer optimizer = builder.with_restart_count(3).
+                with_restart_strategy(Optimizer::Restart_Strategy::bipop).build();
+        const Optimizer::Result result = optimizer.minimize(rosenbrock, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock BIPOP restarts (optimized)");
+        assert_true(result.get_restart_number() <= 3, "test minimize Rosenbrock BIPOP restarts (restart number)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize Rosenbrock BIPOP restarts (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize Rosenbrock BIPOP restarts (parameter)");
+        }
+    }
+
+
+    void test_minimize_rosenbrock_resume() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+        const std::string checkpoint_path = "optimizer_resume_test.checkpoint";
+
+        const Optimizer::Result expected = builder.build().minimize(rosenbrock, x, d, s);
+
+        builder.with_checkpoint_path(checkpoint_path).with_checkpoint_modulus(25);
+        const Optimizer::Result stopped = builder.with_stop_generation(60).build().minimize(rosenbrock, x, d, s);
+        const Optimizer::Result result = builder.with_stop_generation().build().minimize(rosenbrock, checkpoint_path,
+                                                                                         especia::No_Constraint<>(),
+                                                                                         especia::No_Tracing<>());
+        std::remove(checkpoint_path.c_str());
+
+        assert_false(stopped.is_optimized(), "test minimize Rosenbrock resume (stopped)");
+        assert_equals(natural(60), stopped.get_generation_number(), "test minimize Rosenbrock resume (stop generation)");
+        assert_true(result.is_optimized(), "test minimize Rosenbrock resume (optimized)");
+        assert_equals(expected.get_generation_number(), result.get_generation_number(),
+                      "test minimize Rosenbrock resume (generation number)");
+        assert_equals(expected.get_fitness(), result.get_fitness(), real(0), "test minimize Rosenbrock resume (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(expected.get_parameter_values()[i], result.get_parameter_values()[i], real(0),
+                          "test minimize Rosenbrock resume (parameter)");
+            assert_equals(expected.get_parameter_uncertainties()[i], result.get_parameter_uncertainties()[i], real(0),
+                          "test minimize Rosenbrock resume (uncertainty)");
+        }
+    }
+
+
+    void test_minimize_rosenbrock_async_decompose_resume() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+        const std::string checkpoint_path = "optimizer_resume_test.async.checkpoint";
+
+        // The decomposition started in the checkpoint generation is pending, when the checkpoint is written
+        Optimizer::Builder b = builder;
+        b.with_async_decompose(true).with_covariance_update_modulus(5);
+        const Optimizer::Result expected = b.build().minimize(rosenbrock, x, d, s);
+
+        b.with_checkpoint_path(checkpoint_path).with_checkpoint_modulus(25);
+        b.with_stop_generation(60).build().minimize(rosenbrock, x, d, s);
+        const Optimizer::Result result = b.with_stop_generation().build().minimize(rosenbrock, checkpoint_path,
+                                                                                   especia::No_Constraint<>(),
+                                                                                   especia::No_Tracing<>());
+        std::remove(checkpoint_path.c_str());
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock async decompose resume (optimized)");
+        assert_equals(expected.get_generation_number(), result.get_generation_number(),
+                      "test minimize Rosenbrock async decompose resume (generation number)");
+        assert_equals(expected.get_fitness(), result.get_fitness(), real(0),
+                      "test minimize Rosenbrock async decompose resume (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(expected.get_parameter_values()[i], result.get_parameter_values()[i], real(0),
+                          "test minimize Rosenbrock async decompose resume (parameter)");
+        }
+    }
+
+
+    void test_resume_invalid() {
+        const std::string checkpoint_path = "optimizer_resume_test.invalid";
+
+        std::ofstream(checkpoint_path) << "not a checkpoint";
+        bool thrown = false;
+        try {
+            builder.build().minimize(rosenbrock, checkpoint_path, especia::No_Constraint<>(), especia::No_Tracing<>());
+        } catch (std::runtime_error &) {
+            thrown = true;
+        }
+        std::remove(checkpoint_path.c_str());
+
+        assert_true(thrown, "test resume invalid checkpoint");
+    }
+
+
+    void test_minimize_ellipsoid_racing() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.build();
+        const Optimizer::Result expected = optimizer.minimize(Bounded_Ellipsoid(), x, d, s);
+
+        especia::Telemetry telemetry;
+        const Optimizer racing_optimizer = builder.with_racing(true).build();
+        const Optimizer::Result result = racing_optimizer.minimize(Bounded_Ellipsoid(), x, d, s,
+                                                                   especia::No_Constraint<real>(),
+                                                                   Telemetry_Tracing(&telemetry));
+
+        assert_true(result.is_optimized(), "test minimize ellipsoid racing (optimized)");
+        assert_equals(expected.get_generation_number(), result.get_generation_number(),
+                      "test minimize ellipsoid racing (generations)");
+        assert_equals(expected.get_fitness(), result.get_fitness(), real(0), "test minimize ellipsoid racing (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(expected.get_parameter_values()[i], result.get_parameter_values()[i], real(0),
+                          "test minimize ellipsoid racing (parameter)");
+        }
+
+        std::ostringstream os;
+        telemetry.put(os);
+        const std::string json = os.str();
+        const std::string evaluations = "\"evaluations\": " +
+                                        std::to_string(result.get_generation_number() * builder.get_population_size());
+
+        assert_true(json.find(evaluations) == std::string::npos, "test minimize ellipsoid racing (evaluations)");
+    }
+
+
+    void test_minimize_rosenbrock_polish_failed_resume() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+        const std::string checkpoint_path = "optimizer_resume_test.polish.checkpoint";
+
+        Optimizer::Builder b = builder;
+        b.with_polish_threshold(real(1.0E+03)).with_async_decompose(true);
+        const Optimizer::Result expected = b.build().minimize(Underdetermined_Rosenbrock(), x, d, s);
+
+        // The polishing has been attempted before the run is stopped
+        const natural stop_generation = (expected.get_generation_number() - 5) / 5 * 5;
+        b.with_checkpoint_path(checkpoint_path).with_checkpoint_modulus(5);
+        b.with_stop_generation(stop_generation).build().minimize(Underdetermined_Rosenbrock(), x, d, s);
+        const Optimizer::Result result = b.with_stop_generation(400).build().minimize(Underdetermined_Rosenbrock(),
+                                                                                      checkpoint_path,
+                                                                                      especia::No_Constraint<>(),
+                                                                                      especia::No_Tracing<>());
+        std::remove(checkpoint_path.c_str());
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock polish failed resume (optimized)");
+        assert_equals(expected.get_generation_number(), result.get_generation_number(),
+                      "test minimize Rosenbrock polish failed resume (generation number)");
+        assert_equals(expected.get_fitness(), result.get_fitness(), real(0),
+                      "test minimize Rosenbrock polish failed resume (fitness)");
+    }
+
+
+    void test_minimize_sphere_tol_fun_resume() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+        const std::string checkpoint_path = "optimizer_resume_test.termination.checkpoint";
+
+        builder.with_accuracy_goal(real(0)).with_fitness_tolerance(real(1.0E-10)).with_stagnation(true);
+        const Optimizer::Result expected = builder.build().minimize(sphere, x, d, s);
+
+        builder.with_checkpoint_path(checkpoint_path).with_checkpoint_modulus(25);
+        builder.with_stop_generation(60).build().minimize(sphere, x, d, s);
+        const Optimizer::Result result = builder.with_stop_generation(400).build().minimize(sphere, checkpoint_path,
+                                                                                            especia::No_Constraint<>(),
+                                                                                            especia::No_Tracing<>());
+        std::remove(checkpoint_path.c_str());
+
+        assert_true(result.get_termination() == expected.get_termination(), "test minimize sphere TolFun resume (termination)");
+        assert_equals(expected.get_generation_number(), result.get_generation_number(),
+                      "test minimize sphere TolFun resume (generation number)");
+        assert_equals(expected.get_fitness(), result.get_fitness(), real(0), "test minimize sphere TolFun resume (fitness)");
+    }
+
+    void run_all() override {
+        run(this, &Optimizer_Resume_Test::test_minimize_rosenbrock_ipop_restarts);
+        run(this, &Optimizer_Resume_Test::test_minimize_rosenbrock_bipop_restarts);
+        run(this, &Optimizer_Resume_Test::test_minimize_rosenbrock_resume);
+        run(this, &Optimizer_Resume_Test::test_minimize_rosenbrock_async_decompose_resume);
+        run(this, &Optimizer_Resume_Test::test_resume_invalid);
+        run(this, &Optimizer_Resume_Test::test_minimize_ellipsoid_racing);
+        run(this, &Optimizer_Resume_Test::test_minimize_rosenbrock_polish_failed_resume);
+        run(this, &Optimizer_Resume_Test::test_minimize_sphere_tol_fun_resume);
+    }
+};
+
+
+int main() {
+    return Optimizer_Resume_Test().run_testsuite();
+}
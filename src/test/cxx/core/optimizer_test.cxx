@@ -3,36 +3,115 @@
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
-#include "../../../main/cxx/core/base.h"
-#include "../../../main/cxx/core/optimizer.h"
-#include "../unittest.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "optimizer_test.h"
 
 using especia::natural;
 using especia::real;
 using especia::Optimizer;
 
-class Optimizer_Test : public Unit_Test {
+class Optimizer_Test : public Optimizer_Test_Fixture {
 private:
 
-    static real sphere(const real x[], natural n) {
-        using especia::sq;
+    /// A constraint requiring all parameter values to be positive.
+    class Positive_Constraint {
+    public:
+        bool is_violated(const real x[], natural n) const {
+            for (natural i = 0; i < n; ++i) {
+                if (x[i] <= real(0)) {
+                    return true;
+                }
+            }
+            return false;
+        }
 
-        auto y = real(0);
+        real cost(const real x[], natural n) const {
+            return real(0);
+        }
+    };
+
+    /// A box constraint requiring all parameter values to be in the interval [1, 3].
+    class Box_Constraint : public Positive_Constraint {
+    public:
+        bool is_violated(const real x[], natural n) const {
+            for (natural i = 0; i < n; ++i) {
+                if (x[i] < real(1) or x[i] > real(3)) {
+                    return true;
+                }
+            }
+            return false;
+        }
 
-        for (natural i = 0; i < n; ++i) {
-            y += sq(x[i]);
+        void reflect(real x[], natural n) const {
+            for (natural i = 0; i < n; ++i) {
+                while (x[i] < real(1) or x[i] > real(3)) {
+                    x[i] = x[i] < real(1) ? real(2) - x[i] : real(6) - x[i];
+                }
+            }
         }
 
-        return y;
-    }
+        void repair(real x[], natural n) const {
+            for (natural i = 0; i < n; ++i) {
+                x[i] = std::min(std::max(x[i], real(1)), real(3));
+            }
+        }
+    };
+
+    /// A tracer recording the maximum number of rejected samples per offspring.
+    class Rejection_Tracing : public especia::No_Tracing<real> {
+    public:
+        explicit Rejection_Tracing(real &max_rejection_rate) : max_rejection_rate(max_rejection_rate) {
+        }
+
+        bool is_tracing(natural g) const {
+            return true;
+        }
 
-    static real ellipsoid(const real x[], natural n) {
+        void trace(natural g, real y, real min_step, real max_step, real rejection_rate) const {
+            max_rejection_rate = std::max(max_rejection_rate, rejection_rate);
+        }
+
+    private:
+        real &max_rejection_rate;
+    };
+
+    /// An ellipsoid, which evaluates many parameter vectors in a single call.
+    class Batched_Ellipsoid {
+    public:
+        real operator()(const real x[], natural n) const {
+            return ellipsoid(x, n);
+        }
+
+        void cost_batch(const real x[], natural n, natural lambda, real y[]) const {
+            for (natural k = 0; k < lambda; ++k) {
+                y[k] = ellipsoid(&x[k * n], n);
+            }
+        }
+    };
+
+    /// An ellipsoid, which is partitioned into its terms and evaluates many parameter vectors in a
+    /// single call.
+    class Batched_Partitioned_Ellipsoid : public Bounded_Ellipsoid {
+    public:
+        void cost_batch(const real x[], natural n, natural lambda, natural i, real y[]) const {
+            for (natural k = 0; k < lambda; ++k) {
+                y[k] = cost(&x[k * n], n, i);
+            }
+        }
+    };
+
+    static real shifted_ellipsoid(const real x[], natural n) {
         using especia::sq;
 
         auto y = real(0);
 
         for (natural i = 0; i < n; ++i) {
-            y += std::pow(real(1.0E+06), real(i) / real(n - 1)) * sq(x[i]);
+            y += std::pow(real(1.0E+06), real(i) / real(n - 1)) * sq(x[i] - real(1.0E-03));
         }
 
         return y;
@@ -62,17 +141,16 @@ private:
         return real(1.0E+06) * sq(x[0]) + y;
     }
 
-    /// [The Rosenbrock function](https://en.wikipedia.org/wiki/Rosenbrock_function)
-    static real rosenbrock(const real x[], natural n) {
-        using especia::sq;
-
+    /// A function without any trend, whose values look random.
+    static real noise(const real x[], natural n) {
         auto y = real(0);
 
-        for (natural i = 0; i < n - 1; ++i) {
-            y += real(100) * sq(x[i + 1] - sq(x[i])) + sq(real(1) - x[i]);
+        for (natural i = 0; i < n; ++i) {
+            y += std::sin(real(12.9898) * x[i] + real(78.233) * real(i));
         }
 
-        return y;
+        const real t = std::sin(y) * real(43758.5453);
+        return t - std::floor(t);
     }
 
     static real different_powers(const real x[], natural n) {
@@ -88,17 +166,6 @@ private:
         return y;
     }
 
-    void before() override {
-        builder.with_problem_dimension(10).
-                with_stop_generation(400).
-                with_accuracy_goal(real(1.0E-06)).
-                with_random_seed(31415);
-    }
-
-    void after() override {
-        builder.with_defaults();
-    }
-
     void test_minimize_sphere() {
         const valarray<real> x(real(1), 10);
         const valarray<real> d(real(1), 10);
@@ -225,6 +292,533 @@ private:
         assert_equals(real(0), result.get_fitness(), real(1.0E-16), "test minimize different powers");
     }
 
+    void test_minimize_ellipsoid_block_sampling() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_block_sampling(true).build();
+        const Optimizer::Result result = optimizer.minimize(ellipsoid, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize ellipsoid block sampling (optimized)");
+        assert_false(result.is_underflow(), "test minimize ellipsoid block sampling (underflow)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize ellipsoid block sampling (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(0), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize ellipsoid block sampling (parameter)");
+        }
+    }
+
+    void test_minimize_rosenbrock_block_sampling() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+
+        const Optimizer optimizer = builder.with_block_sampling(true).build();
+        const Optimizer::Result result = optimizer.minimize(rosenbrock, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock block sampling (optimized)");
+        assert_false(result.is_underflow(), "test minimize Rosenbrock block sampling (underflow)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize Rosenbrock block sampling (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize Rosenbrock block sampling (parameter)");
+        }
+    }
+
+    void test_minimize_ellipsoid_blas_update() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_blas_update(true).build();
+        const Optimizer::Result result = optimizer.minimize(ellipsoid, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize ellipsoid BLAS update (optimized)");
+        assert_false(result.is_underflow(), "test minimize ellipsoid BLAS update (underflow)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize ellipsoid BLAS update (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(0), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize ellipsoid BLAS update (parameter)");
+        }
+    }
+
+    void test_minimize_rosenbrock_blas_update() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+
+        const Optimizer optimizer = builder.with_blas_update(true).build();
+        const Optimizer::Result result = optimizer.minimize(rosenbrock, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock BLAS update (optimized)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize Rosenbrock BLAS update (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize Rosenbrock BLAS update (parameter)");
+        }
+    }
+
+    void test_minimize_ellipsoid_automatic_update_modulus() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        builder.with_covariance_update_modulus(0);
+        assert_equals(natural(1), builder.get_covariance_update_modulus(),
+                      "test minimize ellipsoid automatic update modulus (modulus)");
+        builder.with_problem_dimension(1000);
+        assert_true(builder.get_covariance_update_modulus() > 1,
+                    "test minimize ellipsoid automatic update modulus (high dimensional modulus)");
+
+        const Optimizer optimizer = builder.with_problem_dimension(10).build();
+        const Optimizer::Result result = optimizer.minimize(ellipsoid, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize ellipsoid automatic update modulus (optimized)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10),
+                      "test minimize ellipsoid automatic update modulus (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(0), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize ellipsoid automatic update modulus (parameter)");
+        }
+    }
+
+    void test_minimize_rosenbrock_jacobi() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+
+        const Optimizer optimizer = builder.with_decompose_driver(especia::Decompose::Driver::jacobi).build();
+        const Optimizer::Result result = optimizer.minimize(rosenbrock, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock jacobi (optimized)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize Rosenbrock jacobi (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize Rosenbrock jacobi (parameter)");
+        }
+    }
+
+    void test_minimize_rosenbrock_dsyevd() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+
+        const Optimizer optimizer = builder.with_decompose_driver(especia::Decompose::Driver::dsyevd).build();
+        const Optimizer::Result result = optimizer.minimize(rosenbrock, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock dsyevd (optimized)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize Rosenbrock dsyevd (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize Rosenbrock dsyevd (parameter)");
+        }
+    }
+
+    void test_minimize_rosenbrock_async_decompose() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+
+        const Optimizer optimizer = builder.with_async_decompose(true).build();
+        const Optimizer::Result result = optimizer.minimize(rosenbrock, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock async decompose (optimized)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize Rosenbrock async decompose (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize Rosenbrock async decompose (parameter)");
+        }
+    }
+
+    void test_minimize_rosenbrock_parallel_sampling() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+
+        const Optimizer optimizer = builder.with_parallel_sampling(true).build();
+        const Optimizer::Result result = optimizer.minimize(rosenbrock, x, d, s);
+        const Optimizer::Result repeated = optimizer.minimize(rosenbrock, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock parallel sampling (optimized)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize Rosenbrock parallel sampling (fitness)");
+        assert_equals(result.get_generation_number(), repeated.get_generation_number(),
+                      "test minimize Rosenbrock parallel sampling (reproducible)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize Rosenbrock parallel sampling (parameter)");
+            assert_equals(result.get_parameter_values()[i], repeated.get_parameter_values()[i], real(0),
+                          "test minimize Rosenbrock parallel sampling (reproducible parameter)");
+        }
+    }
+
+    void test_minimize_ellipsoid_separable() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_separable(true).build();
+        const Optimizer::Result result = optimizer.minimize(ellipsoid, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize ellipsoid separable (optimized)");
+        assert_false(result.is_underflow(), "test minimize ellipsoid separable (underflow)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize ellipsoid separable (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(0), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize ellipsoid separable (parameter)");
+            assert_true(result.get_parameter_uncertainties()[i] > real(0),
+                        "test minimize ellipsoid separable (uncertainty)");
+            for (natural j = 0; j < 10; ++j) {
+                assert_equals(i == j ? real(1) : real(0), result.get_rotation_matrix()[i * 10 + j], real(0),
+                              "test minimize ellipsoid separable (rotation)");
+            }
+        }
+    }
+
+    void test_minimize_high_dimensional_ellipsoid_separable() {
+        const natural n = 200;
+        const valarray<real> x(real(1), n);
+        const valarray<real> d(real(1), n);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_problem_dimension(n).
+                with_stop_generation(10000).
+                with_separable(true).build();
+        const Optimizer::Result result = optimizer.minimize(ellipsoid, x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize high-dimensional ellipsoid separable (optimized)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-08),
+                      "test minimize high-dimensional ellipsoid separable (fitness)");
+    }
+
+    void test_minimize_constrained_sphere_separable() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_separable(true).with_parallel_sampling(true).build();
+        const Optimizer::Result result = optimizer.minimize(sphere, x, d, s, Positive_Constraint(),
+                                                            especia::No_Tracing<real>());
+
+        assert_true(result.is_optimized(), "test minimize constrained sphere separable (optimized)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_true(result.get_parameter_values()[i] > real(0),
+                        "test minimize constrained sphere separable (parameter)");
+        }
+    }
+
+    void test_minimize_constrained_sphere_block_sampling() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_block_sampling(true).build();
+        const Optimizer::Result result = optimizer.minimize(sphere, x, d, s, Positive_Constraint(),
+                                                            especia::No_Tracing<real>());
+
+        assert_true(result.is_optimized(), "test minimize constrained sphere block sampling (optimized)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_true(result.get_parameter_values()[i] > real(0),
+                        "test minimize constrained sphere block sampling (parameter)");
+        }
+    }
+
+    void minimize_bounded_sphere(especia::Boundary_Strategy boundary_strategy, const std::string &name) {
+        const valarray<real> x(real(2), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        real max_rejection_rate = real(0);
+        const Optimizer optimizer = builder.with_boundary_strategy(boundary_strategy).build();
+        const Optimizer::Result result = optimizer.minimize(sphere, x, d, s, Box_Constraint(),
+                                                            Rejection_Tracing(max_rejection_rate));
+
+        assert_true(result.is_optimized(), "test minimize bounded sphere " + name + " (optimized)");
+        assert_true(max_rejection_rate > real(0), "test minimize bounded sphere " + name + " (rejection rate)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_true(result.get_parameter_values()[i] >= real(1),
+                        "test minimize bounded sphere " + name + " (parameter)");
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-04),
+                          "test minimize bounded sphere " + name + " (parameter)");
+        }
+    }
+
+    void test_minimize_bounded_sphere_rejection() {
+        minimize_bounded_sphere(especia::Boundary_Strategy::rejection, "rejection");
+    }
+
+    void test_minimize_bounded_sphere_resampling() {
+        minimize_bounded_sphere(especia::Boundary_Strategy::resampling, "resampling");
+    }
+
+    void test_minimize_bounded_sphere_reflection() {
+        minimize_bounded_sphere(especia::Boundary_Strategy::reflection, "reflection");
+    }
+
+    void test_minimize_bounded_sphere_repair() {
+        minimize_bounded_sphere(especia::Boundary_Strategy::repair, "repair");
+    }
+
+    void test_minimize_bounded_ellipsoid_racing_repair() {
+        const valarray<real> x(real(2), 10);
+        const valarray<real> x_opt(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_boundary_strategy(especia::Boundary_Strategy::repair).
+                with_racing(true).with_stop_generation(2000).build();
+        const Optimizer::Result result = optimizer.minimize(Bounded_Ellipsoid(), x, d, s, Box_Constraint(),
+                                                            especia::No_Tracing<real>());
+
+        assert_true(result.is_optimized(), "test minimize bounded ellipsoid racing repair (optimized)");
+        assert_equals(ellipsoid(&x_opt[0], 10), result.get_fitness(), real(1.0E-06) * ellipsoid(&x_opt[0], 10),
+                      "test minimize bounded ellipsoid racing repair (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_true(result.get_parameter_values()[i] >= real(1),
+                        "test minimize bounded ellipsoid racing repair (parameter)");
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-04),
+                          "test minimize bounded ellipsoid racing repair (parameter)");
+        }
+    }
+
+    void test_minimize_bounded_sphere_rejection_limit() {
+        builder.with_rejection_limit(1);
+        minimize_bounded_sphere(especia::Boundary_Strategy::rejection, "rejection limit");
+    }
+
+    void test_minimize_constrained_sphere_reflection() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_boundary_strategy(especia::Boundary_Strategy::reflection).build();
+
+        try {
+            optimizer.minimize(sphere, x, d, s, Positive_Constraint(), especia::No_Tracing<real>());
+            assert_true(false, "test minimize constrained sphere reflection (no box constraint)");
+        } catch (std::invalid_argument &) {
+            assert_true(true, "test minimize constrained sphere reflection (no box constraint)");
+        }
+    }
+
+    void test_minimize_constrained_sphere_telemetry() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        especia::Telemetry telemetry;
+        const Optimizer optimizer = builder.build();
+        const Optimizer::Result result = optimizer.minimize(sphere, x, d, s, Positive_Constraint(),
+                                                            Telemetry_Tracing(&telemetry));
+
+        assert_true(result.is_optimized(), "test minimize constrained sphere telemetry (optimized)");
+
+        std::ostringstream os;
+        telemetry.put(os);
+        const std::string json = os.str();
+        const std::string generations = "\"generations\": " + std::to_string(result.get_generation_number());
+        const std::string evaluations = "\"evaluations\": " +
+                                        std::to_string(result.get_generation_number() * builder.get_population_size());
+
+        assert_true(json.find(generations) != std::string::npos, "test minimize constrained sphere telemetry (generations)");
+        assert_true(json.find(evaluations) != std::string::npos, "test minimize constrained sphere telemetry (evaluations)");
+        assert_true(json.find("\"rejections\": 0,") == std::string::npos,
+                    "test minimize constrained sphere telemetry (rejections)");
+        assert_true(json.find("\"postopti\": ") != std::string::npos, "test minimize constrained sphere telemetry (postopti)");
+    }
+
+    void test_minimize_ellipsoid_batched() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        builder.with_thread_count(3);
+
+        const Optimizer::Result expected = builder.build().minimize(ellipsoid, x, d, s);
+        const Optimizer::Result result = builder.build().minimize(Batched_Ellipsoid(), x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize ellipsoid batched (optimized)");
+        assert_equals(expected.get_generation_number(), result.get_generation_number(),
+                      "test minimize ellipsoid batched (generations)");
+        assert_equals(expected.get_fitness(), result.get_fitness(), real(0), "test minimize ellipsoid batched (fitness)");
+
+        const Optimizer::Result partitioned = builder.build().minimize(Bounded_Ellipsoid(), x, d, s);
+        const Optimizer::Result batched = builder.build().minimize(Batched_Partitioned_Ellipsoid(), x, d, s);
+
+        assert_true(batched.is_optimized(), "test minimize ellipsoid batched partitioned (optimized)");
+        assert_equals(partitioned.get_generation_number(), batched.get_generation_number(),
+                      "test minimize ellipsoid batched partitioned (generations)");
+        assert_equals(partitioned.get_fitness(), batched.get_fitness(), real(0),
+                      "test minimize ellipsoid batched partitioned (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(expected.get_parameter_values()[i], result.get_parameter_values()[i], real(0),
+                          "test minimize ellipsoid batched (parameter)");
+            assert_equals(partitioned.get_parameter_values()[i], batched.get_parameter_values()[i], real(0),
+                          "test minimize ellipsoid batched partitioned (parameter)");
+        }
+    }
+
+    void test_minimize_rosenbrock_polish() {
+        const valarray<real> x(real(0), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(0.1);
+
+        const Optimizer optimizer = builder.build();
+        const Optimizer::Result expected = optimizer.minimize(Least_Squares_Rosenbrock(), x, d, s);
+
+        const Optimizer polishing_optimizer = builder.with_polish_threshold(real(1.0E+03)).build();
+        const Optimizer::Result result = polishing_optimizer.minimize(Least_Squares_Rosenbrock(), x, d, s);
+
+        assert_true(result.is_optimized(), "test minimize Rosenbrock polish (optimized)");
+        assert_true(result.get_generation_number() < expected.get_generation_number(),
+                    "test minimize Rosenbrock polish (generations)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-10), "test minimize Rosenbrock polish (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(real(1), result.get_parameter_values()[i], real(1.0E-06),
+                          "test minimize Rosenbrock polish (parameter)");
+            assert_true(result.get_parameter_uncertainties()[i] > real(0),
+                        "test minimize Rosenbrock polish (uncertainty)");
+        }
+    }
+
+    void test_minimize_ellipsoid_warm_start() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        // The number of generations of the warm start depends on the final step size of the prior
+        // optimization, which is sensitive to rounding, so the decomposition driver is fixed
+        const Optimizer optimizer = builder.with_decompose_driver(especia::Decompose::Driver::dsyevr).build();
+        const Optimizer::Result prior = optimizer.minimize(ellipsoid, x, d, s);
+
+        std::vector<std::string> names;
+        for (natural i = 0; i < 10; ++i) {
+            names.push_back("x" + std::to_string(i));
+        }
+        std::stringstream ss;
+        Optimizer::write_state(ss, prior, names);
+        std::vector<std::string> prior_names;
+        const Optimizer::Result state = Optimizer::read_state(ss, prior_names);
+
+        assert_true(prior_names == names, "test minimize ellipsoid warm start (names)");
+        assert_equals(prior.get_global_step_size(), state.get_global_step_size(), real(0),
+                      "test minimize ellipsoid warm start (step size)");
+        assert_equals(prior.get_covariance_matrix()[99], state.get_covariance_matrix()[99], real(0),
+                      "test minimize ellipsoid warm start (covariance)");
+
+        // The minimum of the shifted ellipsoid is close to the minimum of the prior optimization
+        const Optimizer::Result cold = optimizer.minimize(shifted_ellipsoid, x, d, s);
+        const Optimizer::Result warm = optimizer.minimize(shifted_ellipsoid, state, especia::No_Constraint<real>(),
+                                                          especia::No_Tracing<real>());
+
+        assert_true(warm.is_optimized(), "test minimize ellipsoid warm start (optimized)");
+        assert_true(warm.get_generation_number() < cold.get_generation_number(),
+                    "test minimize ellipsoid warm start (generations)");
+        assert_equals(real(0), warm.get_fitness(), real(1.0E-10), "test minimize ellipsoid warm start (fitness)");
+        assert_equals(real(1.0E-03), warm.get_parameter_values()[0], real(1.0E-06), "test minimize ellipsoid warm start (0)");
+        assert_equals(real(1.0E-03), warm.get_parameter_values()[9], real(1.0E-06), "test minimize ellipsoid warm start (9)");
+
+        // The last parameter is not found in the prior state
+        std::vector<natural> indexes;
+        for (natural i = 0; i < 9; ++i) {
+            indexes.push_back(i);
+        }
+        indexes.push_back(10);
+
+        const Optimizer::Result mapped = optimizer.minimize(ellipsoid,
+                                                            optimizer.warm_start(x, d, s, state, indexes),
+                                                            especia::No_Constraint<real>(),
+                                                            especia::No_Tracing<real>());
+
+        assert_true(mapped.is_optimized(), "test minimize ellipsoid warm start mapped (optimized)");
+        assert_equals(real(0), mapped.get_parameter_values()[0], real(1.0E-06),
+                      "test minimize ellipsoid warm start mapped (0)");
+        assert_equals(real(0), mapped.get_parameter_values()[9], real(1.0E-06),
+                      "test minimize ellipsoid warm start mapped (9)");
+    }
+
+    void test_replay_ellipsoid() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.build();
+        const Optimizer::Result prior = optimizer.minimize(ellipsoid, x, d, s);
+
+        std::stringstream ss;
+        Optimizer::write_state(ss, prior, std::vector<std::string>());
+        std::vector<std::string> names;
+        const Optimizer::Result state = Optimizer::read_state(ss, names);
+        const Optimizer::Result replayed = optimizer.replay(ellipsoid, state, especia::No_Constraint<real>());
+
+        assert_true(replayed.is_optimized(), "test replay ellipsoid (optimized)");
+        assert_equals(natural(0), replayed.get_generation_number(), "test replay ellipsoid (generations)");
+        assert_equals(prior.get_fitness(), replayed.get_fitness(), real(0), "test replay ellipsoid (fitness)");
+        for (natural i = 0; i < 10; ++i) {
+            assert_equals(prior.get_parameter_values()[i], replayed.get_parameter_values()[i], real(0),
+                          "test replay ellipsoid (value)");
+            assert_equals(prior.get_parameter_uncertainties()[i], replayed.get_parameter_uncertainties()[i], real(0),
+                          "test replay ellipsoid (uncertainty)");
+        }
+    }
+
+    void test_minimize_sphere_tol_fun() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_accuracy_goal(real(0)).with_fitness_tolerance(real(1.0E-10)).build();
+        const Optimizer::Result result = optimizer.minimize(sphere, x, d, s);
+
+        assert_false(result.is_optimized(), "test minimize sphere TolFun (optimized)");
+        assert_true(result.get_termination() == especia::Termination::tol_fun, "test minimize sphere TolFun (termination)");
+        assert_true(result.get_generation_number() < natural(400), "test minimize sphere TolFun (generation number)");
+        assert_equals(real(0), result.get_fitness(), real(1.0E-09), "test minimize sphere TolFun (fitness)");
+    }
+
+    void test_minimize_sphere_tol_x() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_accuracy_goal(real(0)).with_parameter_tolerance(real(1.0E-05)).build();
+        const Optimizer::Result result = optimizer.minimize(sphere, x, d, s);
+
+        assert_false(result.is_optimized(), "test minimize sphere TolX (optimized)");
+        assert_true(result.get_termination() == especia::Termination::tol_x, "test minimize sphere TolX (termination)");
+        for (natural i = 0, ii = 0; i < 10; ++i, ii += 11) {
+            assert_true(result.get_global_step_size() * std::sqrt(result.get_covariance_matrix()[ii]) < real(1.0E-05),
+                        "test minimize sphere TolX (standard deviation)");
+        }
+    }
+
+    void test_minimize_ellipsoid_condition_cov() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_max_condition(real(1.0E+04)).build();
+        const Optimizer::Result result = optimizer.minimize(ellipsoid, x, d, s);
+
+        assert_false(result.is_optimized(), "test minimize ellipsoid ConditionCov (optimized)");
+        assert_true(result.get_termination() == especia::Termination::condition_cov,
+                    "test minimize ellipsoid ConditionCov (termination)");
+    }
+
+    void test_minimize_noise_stagnation() {
+        const valarray<real> x(real(1), 10);
+        const valarray<real> d(real(1), 10);
+        const auto s = real(1);
+
+        const Optimizer optimizer = builder.with_stop_generation(10000).with_stagnation(true).build();
+        const Optimizer::Result result = optimizer.minimize(noise, x, d, s);
+
+        assert_false(result.is_optimized(), "test minimize noise stagnation (optimized)");
+        assert_true(result.get_termination() == especia::Termination::stagnation,
+                    "test minimize noise stagnation (termination)");
+        assert_true(result.get_generation_number() < natural(10000), "test minimize noise stagnation (generation number)");
+    }
+
     void run_all() override {
         run(this, &Optimizer_Test::test_minimize_sphere);
         run(this, &Optimizer_Test::test_minimize_ellipsoid);
@@ -232,9 +826,36 @@ private:
         run(this, &Optimizer_Test::test_minimize_tablet);
         run(this, &Optimizer_Test::test_minimize_rosenbrock);
         run(this, &Optimizer_Test::test_minimize_different_powers);
+        run(this, &Optimizer_Test::test_minimize_ellipsoid_block_sampling);
+        run(this, &Optimizer_Test::test_minimize_rosenbrock_block_sampling);
+        run(this, &Optimizer_Test::test_minimize_constrained_sphere_block_sampling);
+        run(this, &Optimizer_Test::test_minimize_ellipsoid_blas_update);
+        run(this, &Optimizer_Test::test_minimize_rosenbrock_parallel_sampling);
+        run(this, &Optimizer_Test::test_minimize_rosenbrock_blas_update);
+        run(this, &Optimizer_Test::test_minimize_ellipsoid_automatic_update_modulus);
+        run(this, &Optimizer_Test::test_minimize_rosenbrock_dsyevd);
+        run(this, &Optimizer_Test::test_minimize_rosenbrock_jacobi);
+        run(this, &Optimizer_Test::test_minimize_rosenbrock_async_decompose);
+        run(this, &Optimizer_Test::test_minimize_ellipsoid_separable);
+        run(this, &Optimizer_Test::test_minimize_high_dimensional_ellipsoid_separable);
+        run(this, &Optimizer_Test::test_minimize_constrained_sphere_separable);
+        run(this, &Optimizer_Test::test_minimize_constrained_sphere_telemetry);
+        run(this, &Optimizer_Test::test_minimize_bounded_sphere_rejection);
+        run(this, &Optimizer_Test::test_minimize_bounded_sphere_resampling);
+        run(this, &Optimizer_Test::test_minimize_bounded_sphere_reflection);
+        run(this, &Optimizer_Test::test_minimize_bounded_sphere_repair);
+        run(this, &Optimizer_Test::test_minimize_bounded_ellipsoid_racing_repair);
+        run(this, &Optimizer_Test::test_minimize_bounded_sphere_rejection_limit);
+        run(this, &Optimizer_Test::test_minimize_constrained_sphere_reflection);
+        run(this, &Optimizer_Test::test_minimize_ellipsoid_batched);
+        run(this, &Optimizer_Test::test_minimize_rosenbrock_polish);
+        run(this, &Optimizer_Test::test_minimize_ellipsoid_warm_start);
+        run(this, &Optimizer_Test::test_replay_ellipsoid);
+        run(this, &Optimizer_Test::test_minimize_sphere_tol_fun);
+        run(this, &Optimizer_Test::test_minimize_sphere_tol_x);
+        run(this, &Optimizer_Test::test_minimize_ellipsoid_condition_cov);
+        run(this, &Optimizer_Test::test_minimize_noise_stagnation);
     }
-
-    Optimizer::Builder builder;
 };
 
 
@@ -0,0 +1,139 @@
+/// @file optimizer_test.h
+/// Unit test fixture shared by the optimizer tests
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#ifndef ESPECIA_OPTIMIZER_TEST_H
+#define ESPECIA_OPTIMIZER_TEST_H
+
+#include <cmath>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/optimizer.h"
+#include "../../../main/cxx/core/telemetry.h"
+#include "../unittest.h"
+
+/// The base class of the optimizer tests, which provides the test functions and a
+/// builder, which is reset before each test case.
+class Optimizer_Test_Fixture : public Unit_Test {
+protected:
+    using natural = especia::natural;
+    using real = especia::real;
+    using Optimizer = especia::Optimizer;
+
+    /// A tracer providing a telemetry collector.
+    class Telemetry_Tracing : public especia::No_Tracing<real> {
+    public:
+        explicit Telemetry_Tracing(especia::Telemetry *telemetry) : telemetry(telemetry) {
+        }
+
+        especia::Telemetry *get_telemetry() const {
+            return telemetry;
+        }
+
+    private:
+        especia::Telemetry *const telemetry;
+    };
+
+    /// An ellipsoid, which is partitioned into its terms and provides a lower bound of each term.
+    class Bounded_Ellipsoid {
+    public:
+        real operator()(const real x[], natural n) const {
+            return ellipsoid(x, n);
+        }
+
+        natural get_partition_count() const {
+            return 10;
+        }
+
+        real get_partition_weight(natural i) const {
+            return real(1);
+        }
+
+        real cost(const real x[], natural n, natural i) const {
+            return std::pow(real(1.0E+06), real(i) / real(n - 1)) * especia::sq(x[i]);
+        }
+
+        real cost_bound(const real x[], natural n, natural i) const {
+            return real(0.5) * cost(x, n, i);
+        }
+    };
+
+    /// Half the Rosenbrock function, which is the sum of squared residuals.
+    class Least_Squares_Rosenbrock {
+    public:
+        real operator()(const real x[], natural n) const {
+            return real(0.5) * rosenbrock(x, n);
+        }
+
+        natural get_residual_count() const {
+            return 18;
+        }
+
+        void residuals(const real x[], natural n, real z[]) const {
+            using especia::sq;
+
+            for (natural i = 0; i < n - 1; ++i) {
+                z[2 * i] = real(10) * (x[i + 1] - sq(x[i]));
+                z[2 * i + 1] = real(1) - x[i];
+            }
+        }
+    };
+
+    /// Half the Rosenbrock function, with fewer residuals than parameters, so polishing fails.
+    class Underdetermined_Rosenbrock : public Least_Squares_Rosenbrock {
+    public:
+        natural get_residual_count() const {
+            return 1;
+        }
+    };
+
+    static real sphere(const real x[], natural n) {
+        using especia::sq;
+
+        auto y = real(0);
+
+        for (natural i = 0; i < n; ++i) {
+            y += sq(x[i]);
+        }
+
+        return y;
+    }
+
+    static real ellipsoid(const real x[], natural n) {
+        using especia::sq;
+
+        auto y = real(0);
+
+        for (natural i = 0; i < n; ++i) {
+            y += std::pow(real(1.0E+06), real(i) / real(n - 1)) * sq(x[i]);
+        }
+
+        return y;
+    }
+
+    /// [The Rosenbrock function](https://en.wikipedia.org/wiki/Rosenbrock_function)
+    static real rosenbrock(const real x[], natural n) {
+        using especia::sq;
+
+        auto y = real(0);
+
+        for (natural i = 0; i < n - 1; ++i) {
+            y += real(100) * sq(x[i + 1] - sq(x[i])) + sq(real(1) - x[i]);
+        }
+
+        return y;
+    }
+
+    void before() override {
+        builder = Optimizer::Builder();
+        builder.with_problem_dimension(10).
+                with_stop_generation(400).
+                with_accuracy_goal(real(1.0E-06)).
+                with_random_seed(31415);
+    }
+
+    Optimizer::Builder builder;
+};
+
+#endif // ESPECIA_OPTIMIZER_TEST_H
@@ -0,0 +1,103 @@
+/// @file profiles_benchmark.cxx
+/// Microbenchmarks
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <string>
+#include <vector>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/profiles.h"
+#include "../benchmark.h"
+
+using especia::Extended_Pseudo_Voigt;
+using especia::Intergalactic_Doppler;
+using especia::Intergalactic_Voigt;
+using especia::Pseudo_Voigt;
+using especia::Superposition;
+using especia::Tabulated_Voigt;
+using especia::real;
+
+
+class Profiles_Benchmark : public Benchmark_Suite {
+private:
+
+    static std::vector<real> grid(const real a, const real b, const size_t n) {
+        std::vector<real> x(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = a + (b - a) * real(i) / real(n - 1);
+        }
+        return x;
+    }
+
+    template<class F>
+    void measure_profile(const std::string &name, const F &f, const real a, const real b) {
+        const size_t n = 1000;
+        const std::vector<real> x = grid(a, b, n);
+        std::vector<real> y(n);
+
+        measure(name + "::operator()", [&]() {
+            real s = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                s += f(x[i]);
+            }
+            consume(s);
+        }, n);
+        measure(name + "::evaluate", [&]() {
+            f.evaluate(&x[0], &y[0], n);
+            consume(y[n / 2]);
+        }, n);
+    }
+
+    void benchmark_pseudo_voigt() {
+        measure_profile("Pseudo_Voigt", Pseudo_Voigt(1.0, 0.5), -10.0, 10.0);
+    }
+
+    void benchmark_extended_pseudo_voigt() {
+        measure_profile("Extended_Pseudo_Voigt", Extended_Pseudo_Voigt(1.0, 0.5), -10.0, 10.0);
+    }
+
+    void benchmark_tabulated_voigt() {
+        measure_profile("Tabulated_Voigt", Tabulated_Voigt(1.0, 0.5), -10.0, 10.0);
+    }
+
+    void benchmark_intergalactic_doppler() {
+        const real q[] = {1215.6701, 0.416400, 3.1, 0.0, 20.0, 13.5};
+
+        measure_profile("Intergalactic_Doppler", Intergalactic_Doppler(q), 4975.0, 4995.0);
+    }
+
+    void benchmark_intergalactic_voigt() {
+        const real q[] = {1215.6701, 0.416400, 3.1, 0.0, 20.0, 13.5, 6.265E+08};
+
+        measure_profile("Intergalactic_Voigt<Pseudo_Voigt>", Intergalactic_Voigt<Pseudo_Voigt>(q), 4975.0, 4995.0);
+        measure_profile("Intergalactic_Voigt<Extended_Pseudo_Voigt>", Intergalactic_Voigt<Extended_Pseudo_Voigt>(q),
+                        4975.0, 4995.0);
+    }
+
+    void benchmark_superposition() {
+        std::vector<real> q;
+
+        for (int k = 0; k < 10; ++k) {
+            const real p[] = {1215.6701, 0.416400, 3.1, -100.0 + 20.0 * k, 20.0, 13.5};
+            q.insert(q.end(), p, p + 6);
+        }
+        measure_profile("Superposition<Intergalactic_Doppler>[10]", Superposition<Intergalactic_Doppler>(10, &q[0]),
+                        4975.0, 4995.0);
+    }
+
+    void run_all() override {
+        benchmark_pseudo_voigt();
+        benchmark_extended_pseudo_voigt();
+        benchmark_tabulated_voigt();
+        benchmark_intergalactic_doppler();
+        benchmark_intergalactic_voigt();
+        benchmark_superposition();
+    }
+};
+
+
+int main(int argc, char *argv[]) {
+    return Profiles_Benchmark().run_suite(argc, argv);
+}
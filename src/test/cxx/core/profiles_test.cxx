@@ -3,6 +3,11 @@
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
+#include <cmath>
+#include <complex>
+#include <string>
+#include <vector>
+
 #include "../../../main/cxx/core/base.h"
 #include "../../../main/cxx/core/integrator.h"
 #include "../../../main/cxx/core/profiles.h"
@@ -12,6 +17,14 @@ using especia::real;
 using especia::Equivalent_Width_Calculator;
 using especia::Integrator;
 
+#ifdef ESPECIA_WITH_SIMD
+/// The relative accuracy of batch evaluations, which approximate the exponential function.
+const real batch_accuracy = 1.0E-14;
+#else
+/// The relative accuracy of batch evaluations, whose arithmetic is the same as for a single value.
+const real batch_accuracy = 0.0;
+#endif
+
 
 class Profiles_Test : public Unit_Test {
 private:
@@ -54,6 +67,17 @@ private:
         assert_equals(real(0.881143), w, real(4.5E-03), "equivalent width (intergalactic Voigt, extended)");
     }
 
+    void test_equivalent_width_intergalactic_voigt_tabulated() {
+        using especia::Intergalactic_Voigt;
+        using especia::Tabulated_Voigt;
+
+        const real w = calculator.calculate(Intergalactic_Voigt<Tabulated_Voigt>());
+
+        // <https://www.wolframalpha.com/input/?i=NIntegrate%5B1+-+Exp%5B-PDF%5BVoigtDistribution%5B0.5,+0.5%2FSqrt%5B2%5D%5D,+x%5D%5D,+%7Bx,+-Infinity,+Infinity%7D%5D>
+        // the accuracy is limited by the numerical integration of the Lorentzian wings
+        assert_equals(real(0.881143), w, real(4.5E-03), "equivalent width (intergalactic Voigt, tabulated)");
+    }
+
     void test_maximum_pseudo_voigt() {
         using especia::Pseudo_Voigt;
 
@@ -78,13 +102,294 @@ private:
                       "Voigt function maximum (extended pseudo-Voigt approximation)");
     }
 
+    void test_maximum_tabulated_voigt() {
+        using especia::Tabulated_Voigt;
+
+        // <https://www.wolframalpha.com/input/?i=PDF%5BVoigtDistribution%5B0.5,+0.5%2FSqrt%5B2%5D%5D,+0%5D>
+        assert_equals(real(0.482476), Tabulated_Voigt(0.5, 0.5)(0.0), real(1.0E-06),
+                      "Voigt function maximum (tabulated Voigt function)");
+
+        // <https://www.wolframalpha.com/input/?i=PDF%5BVoigtDistribution%5B1.0,+1.0%2FSqrt%5B2%5D%5D,+0%5D>
+        assert_equals(real(0.241238), Tabulated_Voigt(1.0, 1.0)(0.0), real(1.0E-06),
+                      "Voigt function maximum (tabulated Voigt function)");
+    }
+
+    void test_tabulated_voigt_limits() {
+        using especia::sqrt_of_pi;
+        using especia::Tabulated_Voigt;
+
+        const Tabulated_Voigt gaussian(1.0, 0.0);
+        for (real x = 0.0; x < 8.0; x += 0.01) {
+            assert_equals(std::exp(-x * x) / sqrt_of_pi, gaussian(x), real(1.0E-06),
+                          "Gaussian limit (tabulated Voigt function)");
+        }
+        // The value at the center is the scaled complementary error function of the ratio of widths
+        for (real a = 0.001; a < 20.0; a *= 1.5) {
+            const real expected = std::exp(a * a) * std::erfc(a) / sqrt_of_pi;
+
+            assert_equals(expected, Tabulated_Voigt(1.0, a)(0.0), real(1.0E-06) * expected,
+                          "center (tabulated Voigt function)");
+        }
+    }
+
+    void test_tabulated_voigt_border() {
+        using especia::Tabulated_Voigt;
+
+        // The largest arguments inside the table join the values outside the table
+        const real a = std::nextafter(8.0, 0.0);
+        const Tabulated_Voigt inside(1.0, a);
+        const Tabulated_Voigt outside(1.0, 8.0);
+
+        assert_equals(outside(8.0), inside(a), real(1.0E-06) * outside(8.0),
+                      "border (tabulated Voigt function)");
+        assert_equals(outside(0.0), inside(0.0), real(1.0E-06) * outside(0.0),
+                      "border center (tabulated Voigt function)");
+    }
+
+    void test_tabulated_voigt_beyond_table() {
+        using especia::sqrt_of_pi;
+        using especia::Tabulated_Voigt;
+
+        // Beyond the table the values agree with the Laplace continued fraction of the Faddeeva
+        // function, which converges rapidly far from the origin
+        const auto faddeeva = [](const std::complex<real> &z) {
+            std::complex<real> f = z;
+            for (int k = 200; k > 0; --k) {
+                f = z - 0.5 * k / f;
+            }
+            return (std::complex<real>(0.0, 1.0 / sqrt_of_pi) / f).real();
+        };
+        for (real a = 8.0; a < 15.0; a += 0.5) {
+            const Tabulated_Voigt voigt(1.0, a);
+            const real peak = faddeeva(std::complex<real>(0.0, a)) / sqrt_of_pi;
+
+            for (real x = 0.0; x < 40.0; x += 0.1) {
+                const real expected = faddeeva(std::complex<real>(x, a)) / sqrt_of_pi;
+
+                assert_equals(expected, voigt(x), real(4.0E-07) * peak,
+                              "beyond table (tabulated Voigt function)");
+            }
+        }
+    }
+
+    void test_extent_pseudo_voigt() {
+        using especia::Pseudo_Voigt;
+
+        const Pseudo_Voigt voigt(0.5, 0.5);
+        const real x = voigt.extent(1.0E-08);
+
+        assert_true(voigt(x) <= 1.0E-08, "extent (pseudo-Voigt approximation)");
+        assert_true(voigt(0.5 * x) > 1.0E-08, "extent (pseudo-Voigt approximation)");
+    }
+
+    void test_extent_pseudo_voigt_extended() {
+        using especia::Extended_Pseudo_Voigt;
+
+        const Extended_Pseudo_Voigt voigt(0.5, 0.5);
+        const real x = voigt.extent(1.0E-08);
+
+        assert_true(voigt(x) <= 1.0E-08, "extent (extended pseudo-Voigt approximation)");
+        assert_true(voigt(0.5 * x) > 1.0E-08, "extent (extended pseudo-Voigt approximation)");
+    }
+
+    void test_evaluate_superposition() {
+        using especia::Intergalactic_Doppler;
+        using especia::Superposition;
+
+        const real q[] = {1215.6701, 0.4164, 2.0, 0.0, 10.0, 13.0,
+                          1215.6701, 0.4164, 2.0, 30.0, 20.0, 14.0};
+        const Superposition<Intergalactic_Doppler> superposition(2, q);
+
+        real x[1000];
+        real y[1000];
+        for (size_t i = 0; i < 1000; ++i) {
+            x[i] = 3640.0 + 0.01 * i;
+        }
+        superposition.evaluate(x, y, 1000);
+
+        for (size_t i = 0; i < 1000; ++i) {
+            const real t = superposition(x[i]);
+
+            assert_equals(t, y[i], batch_accuracy * t, "evaluate (superposition)");
+        }
+    }
+
+    void test_evaluate_superposition_float() {
+        using especia::Intergalactic_Doppler;
+        using especia::Superposition;
+
+        const real q[] = {1215.6701, 0.4164, 2.0, 0.0, 10.0, 13.0,
+                          1215.6701, 0.4164, 2.0, 30.0, 20.0, 14.0};
+        const Superposition<Intergalactic_Doppler> superposition(2, q);
+
+        real x[1000];
+        float y[1000];
+        for (size_t i = 0; i < 1000; ++i) {
+            x[i] = 3640.0 + 0.01 * i;
+        }
+        superposition.evaluate(x, y, 1000);
+
+        for (size_t i = 0; i < 1000; ++i) {
+            const real t = superposition(x[i]);
+
+            assert_equals(t, real(y[i]), 1.0E-06 * t, "evaluate (superposition, single precision)");
+        }
+    }
+
+    void test_evaluate_superposition_assigned() {
+        using especia::Many_Multiplet;
+        using especia::Superposition;
+
+        const real q[] = {1215.6701, 0.4164, 2.0, 0.0, 10.0, 13.0, 0.0, 0.0,
+                          1215.6701, 0.4164, 2.0, 30.0, 20.0, 14.0, 0.0, 0.0};
+        const real r[] = {1215.6701, 0.4164, 2.0, 10.0, 15.0, 13.5, 0.0, 0.0};
+        Superposition<Many_Multiplet> superposition(2, q);
+        superposition.assign(1, r);
+
+        real x[1000];
+        real y[1000];
+        for (size_t i = 0; i < 1000; ++i) {
+            x[i] = 3640.0 + 0.01 * i;
+        }
+        superposition.evaluate(x, y, 1000);
+
+        for (size_t i = 0; i < 1000; ++i) {
+            const real t = superposition(x[i]);
+
+            assert_equals(t, y[i], batch_accuracy * t, "evaluate (superposition, assigned)");
+        }
+    }
+
+    void test_evaluate_superposition_many() {
+        using especia::Intergalactic_Doppler;
+        using especia::Superposition;
+
+        // The number of profile evaluations exceeds the threshold for offloading
+        std::vector<real> q;
+        for (size_t k = 0; k < 128; ++k) {
+            const real r[] = {1215.6701, 0.4164, 1.996 + 0.001 * (k % 8), 10.0 * (k % 5), 10.0 + (k % 20),
+                              12.0 + 0.01 * k};
+            q.insert(q.end(), r, r + 6);
+        }
+        const Superposition<Intergalactic_Doppler> superposition(128, q.data());
+
+        real x[1000];
+        real y[1000];
+        for (size_t i = 0; i < 1000; ++i) {
+            x[i] = 3640.0 + 0.01 * i;
+        }
+        superposition.evaluate(x, y, 1000);
+
+        for (size_t i = 0; i < 1000; ++i) {
+            const real t = superposition(x[i]);
+
+            assert_equals(t, y[i], 1.0E-12 * t, "evaluate (superposition, many profiles)");
+        }
+    }
+
+    void test_evaluate_pseudo_voigt() {
+        using especia::Pseudo_Voigt;
+
+        assert_evaluate(Pseudo_Voigt(0.5, 0.5), -5.0, 0.01, "evaluate (pseudo-Voigt approximation)");
+    }
+
+    void test_extent_tabulated_voigt() {
+        using especia::Tabulated_Voigt;
+
+        const Tabulated_Voigt voigt(0.5, 0.5);
+        const real x = voigt.extent(1.0E-08);
+
+        assert_true(voigt(x) <= 1.0E-08, "extent (tabulated Voigt function)");
+        assert_true(voigt(0.5 * x) > 1.0E-08, "extent (tabulated Voigt function)");
+    }
+
+    void test_evaluate_tabulated_voigt() {
+        using especia::Tabulated_Voigt;
+
+        assert_evaluate(Tabulated_Voigt(0.5, 0.5), -5.0, 0.01, "evaluate (tabulated Voigt function)");
+        assert_evaluate(Tabulated_Voigt(0.5, 0.001), -5.0, 0.01, "evaluate (tabulated Voigt function)");
+        assert_evaluate(Tabulated_Voigt(0.05, 0.5), -5.0, 0.01, "evaluate (tabulated Voigt function)");
+    }
+
+    void test_evaluate_pseudo_voigt_extended() {
+        using especia::Extended_Pseudo_Voigt;
+
+        assert_evaluate(Extended_Pseudo_Voigt(0.5, 0.5), -5.0, 0.01,
+                        "evaluate (extended pseudo-Voigt approximation)");
+    }
+
+    void test_evaluate_intergalactic_doppler() {
+        using especia::Intergalactic_Doppler;
+
+        assert_evaluate(Intergalactic_Doppler(), -5.0, 0.01, "evaluate (intergalactic Doppler)");
+    }
+
+    void test_evaluate_many_multiplet() {
+        using especia::Many_Multiplet;
+
+        assert_evaluate(Many_Multiplet(), -5.0, 0.01, "evaluate (many-multiplet)");
+    }
+
+    void test_evaluate_intergalactic_voigt() {
+        using especia::Intergalactic_Voigt;
+        using especia::Pseudo_Voigt;
+
+        assert_evaluate(Intergalactic_Voigt<Pseudo_Voigt>(), -5.0, 0.01, "evaluate (intergalactic Voigt)");
+    }
+
+    void test_fast_exp() {
+        using especia::fast_exp;
+
+        for (real x = -708.0; x <= 709.0; x += 0.0123) {
+            assert_equals(std::exp(x), fast_exp(x), 1.0E-15 * std::exp(x), "fast exponential function");
+        }
+        assert_equals(real(1.0), fast_exp(0.0), "fast exponential function (zero)");
+        assert_equals(std::exp(-708.0), fast_exp(-1000.0), 1.0E-15 * std::exp(-708.0),
+                      "fast exponential function (lower limit)");
+        assert_equals(std::exp(709.0), fast_exp(1000.0), 1.0E-15 * std::exp(709.0),
+                      "fast exponential function (upper limit)");
+    }
+
+    template<class F>
+    void assert_evaluate(const F &f, const real x0, const real dx, const std::string &name) const {
+        real x[1000];
+        real y[1000];
+        for (size_t i = 0; i < 1000; ++i) {
+            x[i] = x0 + dx * i;
+        }
+        f.evaluate(x, y, 1000);
+
+        for (size_t i = 0; i < 1000; ++i) {
+            assert_equals(f(x[i]), y[i], batch_accuracy * std::abs(f(x[i])), name);
+        }
+    }
+
     void run_all() override {
         run(this, &Profiles_Test::test_equivalent_width_intergalactic_doppler);
         run(this, &Profiles_Test::test_equivalent_width_many_multiplet);
         run(this, &Profiles_Test::test_equivalent_width_intergalactic_voigt);
         run(this, &Profiles_Test::test_equivalent_width_intergalactic_voigt_extended);
+        run(this, &Profiles_Test::test_equivalent_width_intergalactic_voigt_tabulated);
         run(this, &Profiles_Test::test_maximum_pseudo_voigt);
         run(this, &Profiles_Test::test_maximum_pseudo_voigt_extended);
+        run(this, &Profiles_Test::test_maximum_tabulated_voigt);
+        run(this, &Profiles_Test::test_tabulated_voigt_limits);
+        run(this, &Profiles_Test::test_tabulated_voigt_border);
+        run(this, &Profiles_Test::test_tabulated_voigt_beyond_table);
+        run(this, &Profiles_Test::test_extent_pseudo_voigt);
+        run(this, &Profiles_Test::test_extent_pseudo_voigt_extended);
+        run(this, &Profiles_Test::test_evaluate_superposition);
+        run(this, &Profiles_Test::test_evaluate_superposition_float);
+        run(this, &Profiles_Test::test_evaluate_superposition_assigned);
+        run(this, &Profiles_Test::test_evaluate_superposition_many);
+        run(this, &Profiles_Test::test_evaluate_pseudo_voigt);
+        run(this, &Profiles_Test::test_evaluate_pseudo_voigt_extended);
+        run(this, &Profiles_Test::test_extent_tabulated_voigt);
+        run(this, &Profiles_Test::test_evaluate_tabulated_voigt);
+        run(this, &Profiles_Test::test_evaluate_intergalactic_doppler);
+        run(this, &Profiles_Test::test_evaluate_many_multiplet);
+        run(this, &Profiles_Test::test_evaluate_intergalactic_voigt);
+        run(this, &Profiles_Test::test_fast_exp);
     }
 
     Equivalent_Width_Calculator<Integrator<real>> calculator;
@@ -0,0 +1,75 @@
+/// @file random_benchmark.cxx
+/// Microbenchmarks
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <string>
+#include <vector>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/deviates.h"
+#include "../../../main/cxx/core/random.h"
+#include "../benchmark.h"
+
+using especia::Melg19937_64;
+using especia::Mt11213a_32;
+using especia::Mt11213b_32;
+using especia::Mt19937_32;
+using especia::Mt19937_64;
+using especia::Normal_Deviate;
+using especia::Pcg_32;
+using especia::real;
+
+
+class Random_Benchmark : public Benchmark_Suite {
+private:
+
+    template<class U>
+    void measure_uniform(const std::string &name) {
+        const size_t n = 10000;
+        const U u(9600629759793949339ULL);
+
+        measure(name + "::operator()", [&]() {
+            real s = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                s += u();
+            }
+            consume(s);
+        }, n);
+    }
+
+    template<class U>
+    void measure_normal(const std::string &name) {
+        const size_t n = 10000;
+        const Normal_Deviate<U> z;
+        std::vector<real> x(n);
+
+        measure("Normal_Deviate<" + name + ">::operator()", [&]() {
+            real s = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                s += z();
+            }
+            consume(s);
+        }, n);
+        measure("Normal_Deviate<" + name + ">::fill", [&]() {
+            z.fill(&x[0], n);
+            consume(x[n / 2]);
+        }, n);
+    }
+
+    void run_all() override {
+        measure_uniform<Melg19937_64>("Melg19937_64");
+        measure_uniform<Mt11213a_32>("Mt11213a_32");
+        measure_uniform<Mt11213b_32>("Mt11213b_32");
+        measure_uniform<Mt19937_32>("Mt19937_32");
+        measure_uniform<Mt19937_64>("Mt19937_64");
+        measure_uniform<Pcg_32>("Pcg_32");
+        measure_normal<Melg19937_64>("Melg19937_64");
+        measure_normal<Mt19937_32>("Mt19937_32");
+    }
+};
+
+
+int main(int argc, char *argv[]) {
+    return Random_Benchmark().run_suite(argc, argv);
+}
@@ -3,6 +3,11 @@
 /// @author Ralf Quast
 /// @date 2021
 /// @copyright MIT License
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+#include "../../../main/cxx/core/deviates.h"
 #include "../../../main/cxx/core/random.h"
 #include "../unittest.h"
 
@@ -74,12 +79,142 @@ private:
         assert_equals(0xcbed606eul, pcg.rand(), "test PCG-XSH-RR-64-32 (5)");
     }
 
+    template<class U>
+    void assert_generate(const U &u, const U &v, const char *message) {
+        using especia::real;
+
+        // an odd number of deviates, which spans several state refills
+        std::vector<real> x(2001);
+
+        u.generate(&x[0], 1);
+        u.generate(&x[1], 999);
+        u.generate(&x[1000], x.size() - 1000);
+
+        for (size_t i = 0; i < x.size(); ++i) {
+            assert_equals(v(), x[i], message);
+        }
+    }
+
+    void test_generate() {
+        using especia::word64;
+
+        const word64 seeds[] = {0x12345ULL, 0x23456ULL, 0x34567ULL, 0x45678ULL};
+
+        assert_generate(Melg19937_64(4, seeds), Melg19937_64(4, seeds), "test MELG-19937-64 generate");
+        assert_generate(Mt19937_32(4, seeds), Mt19937_32(4, seeds), "test MT-19937-32 generate");
+        assert_generate(Mt19937_64(4, seeds), Mt19937_64(4, seeds), "test MT-19937-64 generate");
+        assert_generate(Pcg_32(42ULL, 54ULL), Pcg_32(42ULL, 54ULL), "test PCG-XSH-RR-64-32 generate");
+    }
+
+    template<class U>
+    void assert_put_get(const U &u, const U &v, const char *message) {
+        std::stringstream ss;
+
+        for (int i = 0; i < 1001; ++i) {
+            u();
+        }
+        u.put(ss);
+        v.get(ss);
+
+        assert_true(static_cast<bool>(ss), message);
+        for (int i = 0; i < 10000; ++i) {
+            assert_equals(u(), v(), 0.0, message);
+        }
+    }
+
+    void test_put_get() {
+        using especia::Normal_Deviate;
+        using especia::word64;
+
+        const word64 seeds[] = {0x12345ULL, 0x23456ULL, 0x34567ULL, 0x45678ULL};
+
+        assert_put_get(Melg19937_64(4, seeds), Melg19937_64(5489ULL), "test MELG-19937-64 put and get");
+        assert_put_get(Mt19937_32(4, seeds), Mt19937_32(), "test MT-19937-32 put and get");
+        assert_put_get(Mt19937_64(4, seeds), Mt19937_64(), "test MT-19937-64 put and get");
+        assert_put_get(Pcg_32(42ULL, 54ULL), Pcg_32(0ULL, 54ULL), "test PCG-XSH-RR-64-32 put and get");
+        assert_put_get(Normal_Deviate<Mt19937_32>(31415ULL), Normal_Deviate<Mt19937_32>(),
+                       "test normal deviate put and get");
+    }
+
+    void test_get_invalid() {
+        std::stringstream ss;
+
+        Pcg_32(42ULL, 54ULL).put(ss);
+        assert_false(static_cast<bool>(Pcg_32(42ULL, 55ULL).get(ss)), "test PCG-XSH-RR-64-32 get other stream");
+
+        std::stringstream empty;
+        assert_false(static_cast<bool>(Mt19937_32().get(empty)), "test MT-19937-32 get empty");
+    }
+
+    void test_pcg_advance() {
+        const Pcg_32 pcg(42ULL, 54ULL);
+        const Pcg_32 ref(42ULL, 54ULL);
+
+        for (int i = 0; i < 1000; ++i) {
+            ref.rand();
+        }
+        pcg.advance(1000);
+
+        assert_equals(ref.rand(), pcg.rand(), "test PCG-XSH-RR-64-32 advance");
+    }
+
+    template<class U>
+    void assert_streams_differ(const char *message) {
+        const U u = U::for_stream(31415ULL, 0ULL);
+        const U v = U::for_stream(31415ULL, 1ULL);
+        const U w = U::for_stream(31415ULL, 1ULL);
+
+        bool differ = false;
+        for (int i = 0; i < 10; ++i) {
+            const auto b = v.rand();
+
+            differ = differ or u.rand() != b;
+            assert_equals(w.rand(), b, message);
+        }
+        assert_true(differ, message);
+    }
+
+    void test_streams() {
+        assert_streams_differ<Melg19937_64>("test MELG-19937-64 streams");
+        assert_streams_differ<Mt19937_32>("test MT-19937-32 streams");
+        assert_streams_differ<Mt19937_64>("test MT-19937-64 streams");
+        assert_streams_differ<Pcg_32>("test PCG-XSH-RR-64-32 streams");
+    }
+
+    void test_normal_deviate_fill() {
+        using especia::real;
+
+        const especia::Normal_Deviate<Mt19937_32> deviate(31415);
+        std::vector<real> z(100001);
+
+        deviate.fill(&z[0], z.size());
+
+        real mean = 0.0;
+        for (size_t i = 0; i < z.size(); ++i) {
+            mean += z[i];
+        }
+        mean /= real(z.size());
+        real variance = 0.0;
+        for (size_t i = 0; i < z.size(); ++i) {
+            variance += (z[i] - mean) * (z[i] - mean);
+        }
+        variance /= real(z.size() - 1);
+
+        assert_equals(real(0.0), mean, real(0.01), "test normal deviate fill (mean)");
+        assert_equals(real(1.0), variance, real(0.01), "test normal deviate fill (variance)");
+    }
 
     void run_all() override {
         run(this, &Rng_Test::test_melg19937_64);
         run(this, &Rng_Test::test_mt19937_32);
         run(this, &Rng_Test::test_mt19937_64);
         run(this, &Rng_Test::test_pcg);
+        run(this, &Rng_Test::test_generate);
+        run(this, &Rng_Test::test_normal_deviate_fill);
+        run(this, &Rng_Test::test_put_get);
+        run(this, &Rng_Test::test_get_invalid);
+        run(this, &Rng_Test::test_pcg_advance);
+        run(this, &Rng_Test::test_streams);
     }
 };
 
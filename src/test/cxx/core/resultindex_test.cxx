@@ -0,0 +1,110 @@
+/// @file resultindex_test.cxx
+/// Unit tests
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/resultindex.h"
+#include "../unittest.h"
+
+using especia::Indexing_Buffer;
+using especia::Result_Block;
+using especia::word64;
+
+
+class Result_Index_Test : public Unit_Test {
+private:
+
+    static std::string data_lines() {
+        std::ostringstream os;
+
+        for (int i = 0; i < 1000; ++i) {
+            os << "   3000.0" << i << "  1.0e+00  1.0e-02\n";
+        }
+        return os.str();
+    }
+
+    static std::string result(bool indexed) {
+        std::ostringstream result;
+        Indexing_Buffer index(result.rdbuf());
+        std::ostream os(&index);
+
+        os << "<!DOCTYPE html>\n<html>\n<!--\n<command>\n" << " especia 1 2\n" << "</command>\n-->\n</html>\n";
+        os << "<html>\n<model>\nnot a block\n</model>\n</html>\n";
+        os << "<!--\n<model>\n";
+        for (char c : std::string("% comment\n{\n}\n")) {
+            os.put(c);
+        }
+        os << "</model>\n-->\n";
+        os << "<!--\n<data>\n" << data_lines() << "</data>\n-->\n</html>\n";
+        os.flush();
+
+        if (indexed) {
+            index.put_index();
+        }
+        return result.str();
+    }
+
+    static bool copy(const std::string &result, const std::string &name, std::string &block) {
+        std::istringstream is(result);
+        std::ostringstream os;
+        const bool indexed = especia::copy_blocks(is, name, os);
+
+        block = os.str();
+        return indexed;
+    }
+
+    void test_blocks() {
+        std::ostringstream result;
+        Indexing_Buffer index(result.rdbuf());
+        std::ostream os(&index);
+
+        os << "<!--\n<log>\nline\n</log>\n-->\n";
+
+        const std::vector<Result_Block> &blocks = index.get_blocks();
+        assert_equals(size_t(1), blocks.size(), "blocks (count)");
+        assert_equals(std::string("log"), blocks[0].name, "blocks (name)");
+        assert_equals(word64(11), blocks[0].offset, "blocks (offset)");
+        assert_equals(word64(5), blocks[0].length, "blocks (length)");
+        assert_equals(std::string("<!--\n<log>\nline\n</log>\n-->\n"), result.str(), "blocks (pass through)");
+    }
+
+    void test_copy_blocks() {
+        const std::string indexed = result(true);
+        std::string block;
+
+        assert_equals(result(false), indexed.substr(0, result(false).size()), "copy blocks (result unchanged)");
+        assert_true(copy(indexed, "command", block), "copy blocks (indexed)");
+        assert_equals(std::string(" especia 1 2\n"), block, "copy blocks (command)");
+        assert_true(copy(indexed, "model", block), "copy blocks (indexed)");
+        assert_equals(std::string("% comment\n{\n}\n"), block, "copy blocks (model)");
+        assert_true(copy(indexed, "data", block), "copy blocks (indexed)");
+        assert_equals(data_lines(), block, "copy blocks (data)");
+        assert_true(copy(indexed, "log", block), "copy blocks (indexed)");
+        assert_equals(std::string(), block, "copy blocks (missing block)");
+    }
+
+    void test_copy_blocks_not_indexed() {
+        std::istringstream is(result(false));
+        std::ostringstream os;
+
+        assert_false(especia::copy_blocks(is, "model", os), "copy blocks not indexed");
+        assert_equals(std::string(), os.str(), "copy blocks not indexed (output)");
+        assert_true(is.tellg() == std::streampos(0), "copy blocks not indexed (rewound)");
+    }
+
+    void run_all() override {
+        run(this, &Result_Index_Test::test_blocks);
+        run(this, &Result_Index_Test::test_copy_blocks);
+        run(this, &Result_Index_Test::test_copy_blocks_not_indexed);
+    }
+};
+
+
+int main() {
+    return Result_Index_Test().run_testsuite();
+}
@@ -0,0 +1,179 @@
+/// @file scanner_test.cxx
+/// Unit tests
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/scanner.h"
+#include "../unittest.h"
+
+using especia::real;
+using especia::Scanner;
+
+
+class Scanner_Test : public Unit_Test {
+private:
+
+    static real parse(const char *s, size_t &length) {
+        real x = 0.0;
+        const char *end = especia::parse(s, s + std::strlen(s), x);
+
+        length = static_cast<size_t>(end - s);
+        return x;
+    }
+
+    void assert_parse(const char *s) {
+        size_t length = 0;
+        const real x = parse(s, length);
+
+        assert_equals(std::strlen(s), length, s);
+        assert_equals(std::strtod(s, nullptr), x, real(0.0), s);
+    }
+
+    void test_parse() {
+        assert_parse("0");
+        assert_parse("-0.0");
+        assert_parse("1");
+        assert_parse("+1.5");
+        assert_parse("3000.12345");
+        assert_parse("-0.001");
+        assert_parse(".5");
+        assert_parse("5.");
+        assert_parse("1.0E-08");
+        assert_parse("2.5e+12");
+        assert_parse("1.7976931348623157e308");
+        assert_parse("4.9406564584124654e-324");
+        assert_parse("2.2250738585072011e-308");
+        assert_parse("123456789012345678901234567890");
+        assert_parse("0.1000000000000000055511151231257827021181583404541015625");
+        assert_parse("9007199254740993");
+        assert_parse("1.00000000000000011102230246251565404236316680908203125");
+    }
+
+    void test_parse_random() {
+        std::srand(5489);
+
+        for (int i = 0; i < 100000; ++i) {
+            std::string s = std::rand() % 2 == 0 ? "-" : "";
+            const int digit_count = 1 + std::rand() % 24;
+            const int point = std::rand() % (digit_count + 1);
+
+            for (int k = 0; k < digit_count; ++k) {
+                if (k == point) {
+                    s += '.';
+                }
+                s += static_cast<char>('0' + std::rand() % 10);
+            }
+            if (i % 3 == 0) {
+                s += 'e' + std::to_string(std::rand() % 80 - 40);
+            }
+            assert_parse(s.c_str());
+        }
+    }
+
+    void test_parse_invalid() {
+        size_t length = 0;
+
+        parse("", length);
+        assert_equals(size_t(0), length, "parse empty");
+        parse("abc", length);
+        assert_equals(size_t(0), length, "parse letters");
+        parse("-.", length);
+        assert_equals(size_t(0), length, "parse sign and point");
+        parse("1.0e", length);
+        assert_equals(size_t(0), length, "parse incomplete exponent");
+        parse("1.0e999", length);
+        assert_equals(size_t(0), length, "parse overflow");
+        parse("1.5 2.5", length);
+        assert_equals(size_t(3), length, "parse first of two");
+    }
+
+    void test_parse_locale() {
+        // Numbers beyond the fast path, which are parsed like in the C locale
+        const char *const numbers[] = {"0.1000000000000000055511151231257827021181583404541015625",
+                                       "1.7976931348623157e308",
+                                       "2.5e-30"};
+        real expected[3];
+        for (size_t i = 0; i < 3; ++i) {
+            expected[i] = std::strtod(numbers[i], nullptr);
+        }
+
+        // A locale using the decimal comma, if any is installed
+        const char *const locales[] = {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8", "de_DE", "fr_FR"};
+        const std::string previous = std::setlocale(LC_NUMERIC, nullptr);
+        for (const char *locale : locales) {
+            if (std::setlocale(LC_NUMERIC, locale) != nullptr) {
+                break;
+            }
+        }
+        real actual[3];
+        size_t length[3];
+        for (size_t i = 0; i < 3; ++i) {
+            actual[i] = parse(numbers[i], length[i]);
+        }
+        std::setlocale(LC_NUMERIC, previous.c_str());
+
+        for (size_t i = 0; i < 3; ++i) {
+            assert_equals(std::strlen(numbers[i]), length[i], "parse locale (length)");
+            assert_equals(expected[i], actual[i], real(0.0), "parse locale");
+        }
+    }
+
+    void test_scanner() {
+        const std::string line = "  3000.25\t0.5 1.0E-02 0 abc";
+        Scanner scanner(line);
+        real x, y, z;
+        bool b;
+
+        assert_true(static_cast<bool>(scanner >> x >> y >> z >> b), "scanner (status)");
+        assert_equals(real(3000.25), x, "scanner (first)");
+        assert_equals(real(0.5), y, "scanner (second)");
+        assert_equals(real(0.01), z, "scanner (third)");
+        assert_false(b, "scanner (flag)");
+        assert_false(static_cast<bool>(scanner >> x), "scanner (invalid)");
+        assert_equals(real(3000.25), x, "scanner (unchanged)");
+    }
+
+    void test_scan_stream() {
+        std::istringstream is("1.5 -2E3 1 2\n");
+        real x, y;
+        bool b;
+
+        assert_true(static_cast<bool>(especia::scan(is, x) and especia::scan(is, y)), "scan (status)");
+        assert_equals(real(1.5), x, "scan (first)");
+        assert_equals(real(-2000.0), y, "scan (second)");
+        assert_true(static_cast<bool>(especia::scan(is, b)), "scan flag (status)");
+        assert_true(b, "scan flag");
+        assert_false(static_cast<bool>(especia::scan(is, b)), "scan invalid flag");
+    }
+
+    void test_scan_stream_end() {
+        std::istringstream is("42.0");
+        real x;
+
+        assert_true(static_cast<bool>(especia::scan(is, x)), "scan at end (status)");
+        assert_true(is.eof(), "scan at end (eof)");
+        assert_equals(real(42.0), x, "scan at end");
+    }
+
+    void run_all() override {
+        run(this, &Scanner_Test::test_parse);
+        run(this, &Scanner_Test::test_parse_random);
+        run(this, &Scanner_Test::test_parse_invalid);
+        run(this, &Scanner_Test::test_parse_locale);
+        run(this, &Scanner_Test::test_scanner);
+        run(this, &Scanner_Test::test_scan_stream);
+        run(this, &Scanner_Test::test_scan_stream_end);
+    }
+};
+
+
+int main() {
+    return Scanner_Test().run_testsuite();
+}
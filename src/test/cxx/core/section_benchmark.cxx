@@ -0,0 +1,111 @@
+/// @file section_benchmark.cxx
+/// Microbenchmarks
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/profiles.h"
+#include "../../../main/cxx/core/section.h"
+#include "../benchmark.h"
+
+using especia::Intergalactic_Doppler;
+using especia::Section;
+using especia::Superposition;
+using especia::natural;
+using especia::real;
+
+
+/// The convolution and the continuum fit of a section are private, so they are measured
+/// by means of the cost function. With zero Legendre polynomials the cost is dominated by
+/// the convolution, with an increasing number of polynomials the continuum fit is added.
+class Section_Benchmark : public Benchmark_Suite {
+private:
+
+    class Transparent {
+    public:
+        template<class T>
+        void evaluate(const real x[], T y[], size_t n) const {
+            for (size_t i = 0; i < n; ++i) {
+                y[i] = T(0.0);
+            }
+        }
+    };
+
+    static Section section(const size_t n) {
+        std::vector<real> wav(n);
+        std::vector<real> flx(n);
+        std::vector<real> unc(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            wav[i] = a + h * real(i);
+            flx[i] = 1.0 + 0.1 * std::sin(0.01 * real(i));
+            unc[i] = 0.01;
+        }
+        return Section(n, &wav[0], &flx[0], &unc[0]);
+    }
+
+    static std::string name(const std::string &prefix, const size_t n, const real r, const natural m) {
+        const real c = a + 0.5 * h * real(n - 1);
+        // the super-sampling factor, as computed by the section
+        const auto s = static_cast<natural>(std::ceil(h / (0.5 * c / (r * 1000.0))));
+
+        return prefix + "/n=" + std::to_string(n) + "/r=" + std::to_string(static_cast<int>(r)) + "/s=" +
+               std::to_string(s) + "/m=" + std::to_string(m);
+    }
+
+    void benchmark_convolute() {
+        std::vector<real> q;
+        for (int k = 0; k < 10; ++k) {
+            const real p[] = {1215.6701, 0.416400, 3.1, -100.0 + 20.0 * k, 20.0, 13.5};
+            q.insert(q.end(), p, p + 6);
+        }
+        const Superposition<Intergalactic_Doppler> tau(10, &q[0]);
+
+        for (const size_t n : {1000, 4000}) {
+            const Section s = section(n);
+
+            for (const real r : {40.0, 100.0, 200.0, 400.0}) {
+                measure(name("Section::convolute", n, r, 0), [&]() {
+                    consume(s.cost(tau, r, 0));
+                });
+            }
+        }
+    }
+
+    void benchmark_continuum() {
+        const Transparent tau;
+
+        for (const size_t n : {1000, 4000}) {
+            const Section s = section(n);
+
+            for (const natural m : {1, 4, 10}) {
+                measure(name("Section::continuum", n, 40.0, m), [&]() {
+                    consume(s.cost(tau, 40.0, m));
+                });
+            }
+        }
+    }
+
+    void run_all() override {
+        benchmark_convolute();
+        benchmark_continuum();
+    }
+
+    /// The lower wavelength bound of the sections (Angstrom).
+    static constexpr real a = 4970.0;
+
+    /// The data spacing of the sections (Angstrom).
+    static constexpr real h = 0.025;
+};
+
+constexpr real Section_Benchmark::a;
+constexpr real Section_Benchmark::h;
+
+
+int main(int argc, char *argv[]) {
+    return Section_Benchmark().run_suite(argc, argv);
+}
@@ -0,0 +1,356 @@
+/// @file spectrum_test.cxx
+/// Unit tests
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/dataio.h"
+#include "../../../main/cxx/core/pipeline.h"
+#include "../../../main/cxx/core/profiles.h"
+#include "../../../main/cxx/core/section.h"
+#include "../../../main/cxx/core/spectrum.h"
+#include "../unittest.h"
+
+using especia::real;
+using especia::Section;
+using especia::Spectrum;
+
+
+class Spectrum_Test : public Unit_Test {
+private:
+
+    class Transparent {
+    public:
+        template<class T>
+        void evaluate(const real x[], T y[], size_t n) const {
+            std::fill(y, y + n, T(0.0));
+        }
+    };
+
+    template<class Function>
+    class Unsupported {
+    public:
+        explicit Unsupported(const Function &tau) : tau(tau) {
+        }
+
+        template<class T>
+        void evaluate(const real x[], T y[], size_t n) const {
+            tau.evaluate(x, y, n);
+        }
+
+    private:
+        const Function &tau;
+    };
+
+    void test_convolute_locally() {
+        using especia::Intergalactic_Doppler;
+        using especia::natural;
+        using especia::Superposition;
+
+        const size_t n = 400;
+        std::vector<real> x(n);
+        std::vector<real> y(n);
+        std::vector<real> z(n, 0.01);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = 3600.0 + 0.5 * real(i);
+            y[i] = 1.0 + 0.001 * real(i % 7);
+        }
+        const real q[] = {1215.6701, 0.4164, 1.9614, 0.0, 10.0, 13.0,
+                          1215.6701, 0.4164, 2.0, 0.0, 10.0, 13.0,
+                          1215.6701, 0.4164, 2.0, 30.0, 20.0, 14.0,
+                          1215.6701, 0.4164, 2.1255, 0.0, 10.0, 13.0};
+        const Superposition<Intergalactic_Doppler> tau(4, q);
+
+        // The data spacing exceeds the line spread function, so the data are super-sampled
+        const Section section(n, x.data(), y.data(), z.data());
+        const real c = section.cost(Unsupported<Superposition<Intergalactic_Doppler>>(tau), 40.0, natural(1));
+        assert_true(c > 0.0, "convolute locally (cost)");
+        assert_equals(c, section.cost(tau, 40.0, natural(1)), "convolute locally");
+        assert_equals(section.cost(Transparent(), 40.0, natural(1)), section.cost(Superposition<Intergalactic_Doppler>(),
+                                                                                  40.0, natural(1)),
+                      "convolute locally (transparent)");
+    }
+
+    void test_convolute_fft() {
+        using especia::Intergalactic_Doppler;
+        using especia::natural;
+        using especia::Superposition;
+
+        // The data spacing is much less than the line spread function, which is wide
+        const size_t n = 2000;
+        std::vector<real> x(n);
+        std::vector<real> y(n, 1.0);
+        std::vector<real> z(n, 0.01);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = 3650.0 + 0.02 * real(i);
+        }
+        const real q[] = {1215.6701, 0.4164, 2.018, 0.0, 10.0, 13.5,
+                          1215.6701, 0.4164, 2.018, 80.0, 20.0, 14.0};
+        const Superposition<Intergalactic_Doppler> tau(2, q);
+
+        Section section(n, x.data(), y.data(), z.data());
+        const std::vector<real> fast = convoluted(section.apply(natural(1), 10.0, tau));
+        section.set_fast_convolution(false);
+        const std::vector<real> direct = convoluted(section.apply(natural(1), 10.0, tau));
+
+        real max_difference = 0.0;
+        real min_value = 1.0;
+        for (size_t i = 0; i < n; ++i) {
+            max_difference = std::max(max_difference, std::abs(fast[i] - direct[i]));
+            min_value = std::min(min_value, direct[i]);
+        }
+        assert_true(min_value < 0.5, "convolute FFT (absorption)");
+        assert_equals(real(0.0), max_difference, real(1.0E-06), "convolute FFT");
+    }
+
+    /// Returns the evaluated convoluted absorption term of a section.
+    static std::vector<real> convoluted(const Section &section) {
+        const size_t n = section.data_count();
+        std::ostringstream os;
+        section.write(os);
+
+        const std::string data = os.str();
+        std::vector<real> records(n * especia::data_record_length);
+        std::copy(data.data() + sizeof(especia::word64), data.data() + data.size(),
+                  reinterpret_cast<char *>(records.data()));
+
+        std::vector<real> cat(n);
+        for (size_t i = 0; i < n; ++i) {
+            cat[i] = records[especia::data_record_length * i + 6];
+        }
+        return cat;
+    }
+
+    void test_continuum() {
+        using especia::natural;
+
+        const size_t n = 200;
+        std::vector<real> x(n);
+        std::vector<real> y(n);
+        std::vector<real> z(n, 0.01);
+        for (size_t i = 0; i < n; ++i) {
+            const real t = 2.0 * real(i) / real(n - 1) - 1.0;
+
+            x[i] = 3000.0 + 0.05 * real(i);
+            y[i] = 2.0 + 0.5 * t + 0.25 * (1.5 * t * t - 0.5);
+        }
+
+        Section section(n, x.data(), y.data(), z.data());
+        assert_equals(real(0.0), section.cost(Transparent(), 100.0, natural(3)), real(1.0E-12), "continuum");
+        assert_true(section.cost(Transparent(), 100.0, natural(2)) > 1.0, "continuum (too few polynomials)");
+
+        // The cached basis is invalidated by masking
+        section.mask(3000.0, 3004.0);
+        assert_equals(size_t(n - 81), section.valid_data_count(), "continuum (valid data count)");
+        assert_equals(real(0.0), section.cost(Transparent(), 100.0, natural(3)), real(1.0E-12), "continuum (masked)");
+    }
+
+    void test_get() {
+        std::istringstream is("# comment\n3000.2 0.5 0.1 0\n3000.0 0.7\n3000.1 0.6 0.2\n");
+        Spectrum spectrum;
+
+        assert_true(static_cast<bool>(spectrum.get(is)), "get (status)");
+        assert_equals(size_t(3), spectrum.size(), "get (size)");
+        assert_equals(real(3000.0), spectrum.wavelengths()[0], "get (sorted wavelength)");
+        assert_equals(real(3000.1), spectrum.wavelengths()[1], "get (sorted wavelength)");
+        assert_equals(real(3000.2), spectrum.wavelengths()[2], "get (sorted wavelength)");
+        assert_equals(real(0.7), spectrum.fluxes()[0], "get (flux)");
+        assert_equals(real(1.0), spectrum.uncertainties()[0], "get (default uncertainty)");
+        assert_equals(real(0.2), spectrum.uncertainties()[1], "get (uncertainty)");
+        assert_true(spectrum.masks()[0] != 0, "get (default mask)");
+        assert_true(spectrum.masks()[2] == 0, "get (mask)");
+    }
+
+    void test_map() {
+        const std::string path = "spectrum_test.bin";
+
+        std::ostringstream data;
+        for (int i = 0; i < 1000; ++i) {
+            data << 3000.0 + 0.1 * i << " " << 0.001 * i << " " << 0.01 << "\n";
+        }
+        std::istringstream is(data.str());
+        Spectrum original;
+        original.get(is);
+
+        std::ofstream ofs(path.c_str(), std::ios_base::binary);
+        original.put(ofs);
+        ofs.close();
+
+        assert_true(Spectrum::is_binary(path), "map (is binary)");
+
+        Spectrum spectrum;
+        assert_true(spectrum.map(path), "map (status)");
+        assert_equals(original.size(), spectrum.size(), "map (size)");
+        for (size_t i = 0; i < spectrum.size(); ++i) {
+            assert_equals(original.wavelengths()[i], spectrum.wavelengths()[i], "map (wavelength)");
+            assert_equals(original.fluxes()[i], spectrum.fluxes()[i], "map (flux)");
+            assert_equals(original.uncertainties()[i], spectrum.uncertainties()[i], "map (uncertainty)");
+        }
+
+        const Section section(spectrum, 3009.95, 3019.95);
+        assert_equals(size_t(100), section.data_count(), "map (section data count)");
+        assert_equals(real(3010.0), section.lower_bound(), real(1.0E-06), "map (section lower bound)");
+
+        std::remove(path.c_str());
+    }
+
+    void test_map_unsorted() {
+        const std::string path = "spectrum_test.unsorted.bin";
+
+        std::istringstream is("3000.0 0.7\n3000.1 0.6\n3000.2 0.5\n");
+        Spectrum original;
+        original.get(is);
+
+        std::ostringstream os;
+        original.put(os);
+        std::string data = os.str();
+        // The first two wavelengths are exchanged
+        const size_t header_size = data.size() - 3 * (3 * sizeof(real) + 1);
+        std::swap_ranges(&data[header_size], &data[header_size + sizeof(real)], &data[header_size + sizeof(real)]);
+
+        std::ofstream ofs(path.c_str(), std::ios_base::binary);
+        ofs << data;
+        ofs.close();
+
+        Spectrum spectrum;
+        const bool mapped = spectrum.map(path);
+        std::remove(path.c_str());
+
+        assert_false(mapped, "map (unsorted)");
+        assert_equals(size_t(0), spectrum.size(), "map (unsorted size)");
+    }
+
+    void test_map_text_file() {
+        const std::string path = "spectrum_test.txt";
+
+        std::ofstream ofs(path.c_str());
+        ofs << "3000.0 0.5\n";
+        ofs.close();
+
+        Spectrum spectrum;
+        assert_false(Spectrum::is_binary(path), "map text file (is binary)");
+        assert_false(spectrum.map(path), "map text file (status)");
+
+        std::remove(path.c_str());
+    }
+
+    void test_transform() {
+        std::ostringstream data;
+        data << "# header\n";
+        for (int i = 0; i < 1000; ++i) {
+            data << 3000.0 + 0.1 * i << " " << 0.001 * i << " " << 0.01 << "\n";
+        }
+        const auto f = [](real x) {
+            return 2.0 * x;
+        };
+
+        std::istringstream whole(data.str());
+        std::valarray<real> x;
+        std::valarray<real> y;
+        std::valarray<real> z;
+        especia::get(whole, x, y, z, 1);
+        for (size_t i = 0; i < x.size(); ++i) {
+            x[i] = f(x[i]);
+        }
+        std::ostringstream expected;
+        especia::put(expected, x, y, z);
+
+        const especia::Thread_Pool pool(4);
+        std::istringstream is(data.str());
+        std::ostringstream os;
+        assert_true(especia::transform(is, os, f, 1, pool, 64), "transform (status)");
+        assert_equals(expected.str(), os.str(), "transform");
+
+        std::istringstream invalid("3000.0 0.5\ninvalid\n");
+        std::ostringstream ignored;
+        assert_false(especia::transform(invalid, ignored, f, 0, pool, 64), "transform (invalid)");
+    }
+
+    void test_transform_binary() {
+        const std::string path = "spectrum_test.bin";
+
+        std::ostringstream data;
+        for (int i = 0; i < 1000; ++i) {
+            data << 3000.0 + 0.1 * i << " " << 0.001 * i << " " << 0.01 << " " << i % 2 << "\n";
+        }
+        std::istringstream is(data.str());
+        Spectrum original;
+        original.get(is);
+
+        std::ofstream ofs(path.c_str(), std::ios_base::binary);
+        original.put(ofs);
+        ofs.close();
+
+        const especia::Thread_Pool pool(4);
+        std::ostringstream os;
+        assert_true(especia::transform(path, os, [](real x) { return 2.0 * x; }, 0, pool, 64), "transform binary (status)");
+
+        std::ofstream target(path.c_str(), std::ios_base::binary);
+        target << os.str();
+        target.close();
+
+        Spectrum spectrum;
+        assert_true(spectrum.map(path), "transform binary (map)");
+        assert_equals(original.size(), spectrum.size(), "transform binary (size)");
+        for (size_t i = 0; i < spectrum.size(); ++i) {
+            assert_equals(2.0 * original.wavelengths()[i], spectrum.wavelengths()[i], "transform binary (wavelength)");
+            assert_equals(original.fluxes()[i], spectrum.fluxes()[i], "transform binary (flux)");
+            assert_equals(original.uncertainties()[i], spectrum.uncertainties()[i], "transform binary (uncertainty)");
+            assert_equals(original.masks()[i], spectrum.masks()[i], "transform binary (mask)");
+        }
+
+        std::remove(path.c_str());
+    }
+
+    void test_write_data() {
+        using especia::natural;
+
+        const size_t n = 50;
+        std::vector<real> x(n);
+        std::vector<real> y(n, 1.0);
+        std::vector<real> z(n, 0.01);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = 3000.0 + 0.05 * real(i);
+        }
+
+        std::vector<Section> sections(2, Section(n, x.data(), y.data(), z.data()));
+        sections[0].apply(natural(1), 100.0, Transparent());
+        sections[1].mask(3000.0, 3001.0);
+        sections[1].apply(natural(2), 100.0, Transparent());
+
+        std::ostringstream text;
+        std::ostringstream data;
+        text << sections;
+        especia::write(data, sections);
+
+        std::istringstream is(data.str());
+        std::ostringstream os;
+        assert_true(static_cast<bool>(especia::read_data(is, os)), "write data (status)");
+        assert_equals(text.str(), os.str(), "write data");
+    }
+
+        void run_all() override {
+        run(this, &Spectrum_Test::test_get);
+        run(this, &Spectrum_Test::test_map);
+        run(this, &Spectrum_Test::test_map_unsorted);
+        run(this, &Spectrum_Test::test_map_text_file);
+        run(this, &Spectrum_Test::test_continuum);
+        run(this, &Spectrum_Test::test_convolute_locally);
+        run(this, &Spectrum_Test::test_convolute_fft);
+        run(this, &Spectrum_Test::test_transform);
+        run(this, &Spectrum_Test::test_transform_binary);
+        run(this, &Spectrum_Test::test_write_data);
+    }
+};
+
+
+int main() {
+    return Spectrum_Test().run_testsuite();
+}
@@ -0,0 +1,127 @@
+/// @file threads_test.cxx
+/// Unit tests
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <stdexcept>
+#include <valarray>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/threads.h"
+#include "../unittest.h"
+
+using especia::natural;
+using especia::Thread_Pool;
+
+
+class Threads_Test : public Unit_Test {
+private:
+
+    void test_for_each() {
+        std::valarray<natural> counts(natural(0), 1000);
+
+        pool.for_each(1000, [&counts](natural i) { counts[i] += 1; });
+
+        assert_equals(natural(1000), counts.sum(), "for each (sum)");
+        assert_equals(natural(1), counts.min(), "for each (min)");
+        assert_equals(natural(1), counts.max(), "for each (max)");
+    }
+
+    void test_for_each_chunked() {
+        std::valarray<natural> counts(natural(0), 1001);
+
+        for (natural k = 0; k < 100; ++k) {
+            pool.for_each(1001, [&counts](natural i) { counts[i] += 1; }, 7);
+        }
+
+        assert_equals(natural(100), counts.min(), "for each chunked (min)");
+        assert_equals(natural(100), counts.max(), "for each chunked (max)");
+    }
+
+    void test_for_each_nested() {
+        std::valarray<natural> counts(natural(0), 100);
+
+        pool.for_each(10, [this, &counts](natural i) {
+            pool.for_each(10, [i, &counts](natural j) { counts[10 * i + j] += 1; });
+        });
+
+        assert_equals(natural(1), counts.min(), "for each nested (min)");
+        assert_equals(natural(1), counts.max(), "for each nested (max)");
+    }
+
+    void test_for_each_exception() {
+        bool thrown = false;
+
+        try {
+            pool.for_each(100, [](natural i) {
+                if (i == 42) {
+                    throw std::runtime_error("42");
+                }
+            });
+        } catch (std::runtime_error &e) {
+            thrown = true;
+        }
+
+        assert_true(thrown, "for each exception");
+    }
+
+    void test_for_each_local() {
+        const Thread_Pool pinned{4, true};
+        const natural keys[] = {3, 0, 2, 1, 4};
+        std::valarray<natural> counts(natural(0), 5 * 7);
+
+        pinned.for_each_local(5, keys, 7, [&counts](natural t) { counts[t] += 1; });
+        pinned.for_each_local(5, keys, 7, [&counts](natural t) { counts[t] += 1; }, false);
+
+        assert_true(pinned.get_node_count() >= natural(1), "for each local (node count)");
+        assert_equals(natural(2), counts.min(), "for each local (min)");
+        assert_equals(natural(2), counts.max(), "for each local (max)");
+    }
+
+    void test_for_each_pinned_restores_affinity() {
+        natural restored = 4;
+#if defined(_OPENMP) and defined(__linux__)
+        cpu_set_t available;
+        CPU_ZERO(&available);
+        sched_getaffinity(0, sizeof(available), &available);
+        {
+            const Thread_Pool pinned{4, true};
+            std::valarray<natural> counts(natural(0), 100);
+
+            pinned.for_each(100, [&counts](natural i) { counts[i] += 1; });
+        }
+        restored = 0;
+#pragma omp parallel num_threads(4) reduction(+:restored)
+        {
+            cpu_set_t current;
+            CPU_ZERO(&current);
+            sched_getaffinity(0, sizeof(current), &current);
+            restored += CPU_EQUAL(&current, &available) ? 1 : 0;
+        }
+#endif
+        assert_equals(natural(4), restored, "for each pinned (affinity restored)");
+    }
+
+    void run_all() override {
+        run(this, &Threads_Test::test_for_each);
+        run(this, &Threads_Test::test_for_each_chunked);
+        run(this, &Threads_Test::test_for_each_nested);
+        run(this, &Threads_Test::test_for_each_exception);
+        run(this, &Threads_Test::test_for_each_local);
+        run(this, &Threads_Test::test_for_each_pinned_restores_affinity);
+    }
+
+    const Thread_Pool pool{4};
+};
+
+
+int main() {
+    return Threads_Test().run_testsuite();
+}
@@ -0,0 +1,114 @@
+/// @file writer_test.cxx
+/// Unit tests
+/// @author Ralf Quast
+/// @date 2021
+/// @copyright MIT License
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "../../../main/cxx/core/base.h"
+#include "../../../main/cxx/core/scanner.h"
+#include "../../../main/cxx/core/writer.h"
+#include "../unittest.h"
+
+using especia::natural;
+using especia::real;
+using especia::Writer;
+
+
+class Writer_Test : public Unit_Test {
+private:
+
+    static std::string shortest(const real x, const natural width = 0) {
+        std::ostringstream os;
+        {
+            Writer writer(os);
+            writer.put_shortest(x, width);
+        }
+        return os.str();
+    }
+
+    void test_put() {
+        std::ostringstream os;
+        {
+            Writer writer(os, 4);
+            writer.put(std::string("<data>")).put('\n').put(natural(1), 3).put(natural(1234567890));
+        }
+        assert_equals(std::string("<data>\n  11234567890"), os.str(), "put");
+    }
+
+    void test_put_scientific() {
+        std::srand(5489);
+
+        std::ostringstream expected;
+        std::ostringstream actual;
+        expected.setf(std::ios_base::scientific, std::ios_base::floatfield);
+        expected.setf(std::ios_base::right, std::ios_base::adjustfield);
+        expected.precision(8);
+        {
+            Writer writer(actual, 64);
+
+            for (int i = 0; i < 10000; ++i) {
+                const real x = (std::rand() - RAND_MAX / 2) * std::pow(10.0, std::rand() % 40 - 20);
+
+                expected << std::setw(16) << x;
+                writer.put_scientific(x, 8, 16);
+            }
+        }
+        assert_equals(expected.str(), actual.str(), "put scientific");
+    }
+
+    void test_put_shortest() {
+        assert_equals(std::string("1e-01"), shortest(0.1), "put shortest (0.1)");
+        assert_equals(std::string("3e-01"), shortest(0.3), "put shortest (0.3)");
+        assert_equals(std::string("3.0000000000000004e-01"), shortest(0.1 + 0.2), "put shortest (0.1 + 0.2)");
+        assert_equals(std::string("0e+00"), shortest(0.0), "put shortest (zero)");
+        assert_equals(std::string("-1.5e+10"), shortest(-1.5E+10), "put shortest (negative)");
+        assert_equals(std::string("   2.5e+00"), shortest(2.5, 10), "put shortest (width)");
+        assert_equals(std::string("inf"), shortest(std::numeric_limits<real>::infinity()), "put shortest (inf)");
+    }
+
+    void test_put_shortest_random() {
+        std::srand(5489);
+
+        real x[1000];
+        std::ostringstream os;
+        {
+            Writer writer(os, 64);
+
+            for (natural i = 0; i < 1000; ++i) {
+                x[i] = real(std::rand()) / real(std::rand() + 1) * std::pow(10.0, std::rand() % 600 - 300);
+                writer.put_shortest(x[i]).put(' ');
+            }
+        }
+        const std::string s = os.str();
+        const char *p = s.data();
+        natural mismatches = 0;
+
+        for (natural i = 0; i < 1000; ++i) {
+            real y = 0.0;
+
+            p = especia::parse(p, s.data() + s.size(), y) + 1;
+            if (y != x[i]) {
+                ++mismatches;
+            }
+        }
+        assert_equals(natural(0), mismatches, "put shortest (random round trip)");
+    }
+
+    void run_all() override {
+        run(this, &Writer_Test::test_put);
+        run(this, &Writer_Test::test_put_scientific);
+        run(this, &Writer_Test::test_put_shortest);
+        run(this, &Writer_Test::test_put_shortest_random);
+    }
+};
+
+
+int main() {
+    return Writer_Test().run_testsuite();
+}